@@ -0,0 +1,178 @@
+/**
+ * @file    data.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoding of binary measurement data sent by `board read` (see `help format` on the board).
+ */
+
+#ifndef IMPY_DATA_HPP_
+#define IMPY_DATA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace impy {
+
+/**
+ * Thrown when data received from the board does not match the expected format.
+ */
+class ProtocolError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Measurement data in polar coordinates, each value in its own contiguous array.
+ */
+struct PolarData
+{
+    std::vector<uint32_t> frequency;    //!< Frequency in Hz
+    std::vector<float> magnitude;       //!< Impedance magnitude in Ohms
+    std::vector<float> angle;           //!< Impedance angle in radians
+
+    std::size_t size() const { return frequency.size(); }
+};
+
+/**
+ * Measurement data in cartesian coordinates, each value in its own contiguous array.
+ */
+struct CartesianData
+{
+    std::vector<uint32_t> frequency;    //!< Frequency in Hz
+    std::vector<float> real;            //!< Real part of the impedance in Ohms
+    std::vector<float> imag;            //!< Imaginary part of the impedance in Ohms
+
+    std::size_t size() const { return frequency.size(); }
+};
+
+/**
+ * Raw AD5933 data, each value in its own contiguous array.
+ */
+struct RawData
+{
+    std::vector<uint32_t> frequency;    //!< Frequency in Hz
+    std::vector<int16_t> real;          //!< Real data register value
+    std::vector<int16_t> imag;          //!< Imaginary data register value
+
+    std::size_t size() const { return frequency.size(); }
+};
+
+/**
+ * Features of a sweep (`board read --features`, see `help features` on the board), NaN where not determined.
+ */
+struct SweepFeatures
+{
+    float minFrequency = 0;         //!< Frequency of the minimum magnitude in Hz
+    float minMagnitude = 0;         //!< Minimum magnitude in Ohms
+    float maxFrequency = 0;         //!< Frequency of the maximum magnitude in Hz
+    float maxMagnitude = 0;         //!< Maximum magnitude in Ohms
+    float resonanceFrequency = 0;   //!< Frequency of the first phase zero crossing in Hz
+    float resonanceQ = 0;           //!< Quality factor of the resonance
+    float arcFrequency = 0;         //!< Characteristic frequency of a capacitive arc in Hz
+    float arcReactance = 0;         //!< Reactance at the peak of the arc in Ohms
+    uint32_t crossings = 0;         //!< Number of phase zero crossings
+    std::vector<float> crossingFrequency;   //!< Frequencies of the first (up to 4) phase zero crossings in Hz
+};
+
+/**
+ * Counters and gauges of a board since reset (`board telemetry binary`, see `help telemetry` on the board). Counters
+ * wrap around at 2^32.
+ */
+struct Telemetry
+{
+    uint64_t uptime = 0;            //!< Time since reset in ms
+    uint32_t sweeps = 0;            //!< Sweeps completed
+    uint32_t points = 0;            //!< Points measured in sweeps and continuous measurements
+    uint32_t i2cErrors = 0;         //!< AD5933 I2C errors recovered from
+    uint32_t i2cRetries = 0;        //!< AD5933 writes repeated after an I2C error
+    uint32_t usbStalls = 0;         //!< USB transfers the host left unread for too long
+    uint32_t usbBytes = 0;          //!< Bytes sent over USB
+    uint32_t droppedLines = 0;      //!< Command lines ignored because a command was still busy
+    uint32_t eepromWrites = 0;      //!< EEPROM page writes
+    uint32_t heapFailures = 0;      //!< Failed allocations
+    std::vector<uint32_t> maxIsrTime;   //!< Longest run of each interrupt handler in ns, see {@link TELEMETRY_IRQS}
+};
+
+/** Size of a polar or cartesian record: uint32 frequency, two floats. */
+constexpr std::size_t IMPEDANCE_RECORD_SIZE = 12;
+/** Size of a raw record: uint32 frequency, two int16 values. */
+constexpr std::size_t RAW_RECORD_SIZE = 8;
+/** Size of the sweep features: 13 32-bit words. */
+constexpr std::size_t FEATURES_RECORD_SIZE = 52;
+/** Telemetry is sent as 32-bit words. */
+constexpr std::size_t TELEMETRY_WORD_SIZE = 4;
+/** Interrupt handlers in the order of {@link Telemetry::maxIsrTime} (`Monitor_Irq` in the firmware). */
+constexpr const char* TELEMETRY_IRQS[] = { "SysTick", "I2C1", "SPI3", "TIM3", "OTG_FS" };
+/** Byte counts above this are not plausible and mean the board sent an error message instead of data. */
+constexpr uint32_t MAX_READ_SIZE = 4 * 1024 * 1024;
+
+std::size_t recordCount(std::size_t size, std::size_t recordSize);
+PolarData decodePolar(const uint8_t *data, std::size_t size);
+CartesianData decodeCartesian(const uint8_t *data, std::size_t size);
+RawData decodeRaw(const uint8_t *data, std::size_t size);
+SweepFeatures decodeFeatures(const uint8_t *data, std::size_t size);
+Telemetry decodeTelemetry(const uint8_t *data, std::size_t size);
+
+namespace detail {
+
+inline uint32_t be32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline int16_t be16s(const uint8_t *p) {
+    return static_cast<int16_t>((p[0] << 8) | p[1]);
+}
+
+inline float beFloat(const uint8_t *p) {
+    uint32_t bits = be32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace detail
+
+/**
+ * Decodes polar or cartesian records into arrays provided by the caller, so the data can go straight into the arrays
+ * of another environment (such as MATLAB) without an intermediate copy.
+ *
+ * The value arrays are written with the specified stride, which allows filling interleaved arrays (e.g. a 2xN matrix
+ * with `first` and `second` one element apart and a stride of 2).
+ *
+ * @param data Pointer to the records, without byte count
+ * @param count Number of records
+ * @param freq Receives the frequencies
+ * @param first Receives magnitude or real part
+ * @param second Receives angle or imaginary part
+ * @param stride Distance between consecutive values in `first` and `second`
+ */
+template<typename F, typename V>
+void decodeImpedanceInto(const uint8_t *data, std::size_t count, F *freq, V *first, V *second,
+        std::size_t stride = 1) {
+    for(std::size_t j = 0; j < count; j++, data += IMPEDANCE_RECORD_SIZE) {
+        freq[j] = static_cast<F>(detail::be32(data));
+        first[j * stride] = static_cast<V>(detail::beFloat(data + 4));
+        second[j * stride] = static_cast<V>(detail::beFloat(data + 8));
+    }
+}
+
+/**
+ * Decodes raw records into arrays provided by the caller, see {@link decodeImpedanceInto}.
+ */
+template<typename F, typename V>
+void decodeRawInto(const uint8_t *data, std::size_t count, F *freq, V *real, V *imag, std::size_t stride = 1) {
+    for(std::size_t j = 0; j < count; j++, data += RAW_RECORD_SIZE) {
+        freq[j] = static_cast<F>(detail::be32(data));
+        real[j * stride] = static_cast<V>(detail::be16s(data + 4));
+        imag[j * stride] = static_cast<V>(detail::be16s(data + 6));
+    }
+}
+
+} // namespace impy
+
+#endif /* IMPY_DATA_HPP_ */
@@ -0,0 +1,198 @@
+/**
+ * @file    device.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Asynchronous, typed access to the console commands of one board.
+ */
+
+#ifndef IMPY_DEVICE_HPP_
+#define IMPY_DEVICE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "impy/data.hpp"
+#include "impy/event_loop.hpp"
+#include "impy/serial.hpp"
+
+namespace impy {
+
+/**
+ * Thrown (passed to callbacks) when the board answers a command with an error message.
+ */
+class DeviceError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Sweep parameters as printed by `board get all`.
+ *
+ * Gain, voltage and feedback are only reported by the board when autoranging is disabled, and only sent by
+ * {@link Device::setSweep} if they are set.
+ */
+struct SweepSettings
+{
+    uint32_t start = 0;                 //!< Start frequency in Hz
+    uint32_t stop = 0;                  //!< Stop frequency in Hz
+    uint16_t steps = 0;                 //!< Number of frequency steps
+    uint16_t settl = 0;                 //!< Number of settling cycles (up to 2044)
+    uint16_t avg = 1;                   //!< Number of averages per frequency point
+    bool autorange = false;             //!< Whether autoranging is enabled
+    std::optional<bool> gain;           //!< Whether the x5 PGA gain is enabled
+    std::optional<uint16_t> voltage;    //!< Output voltage range in mV
+    std::optional<uint32_t> feedback;   //!< Feedback resistor value in Ohms
+};
+
+/**
+ * What the board is doing, see {@link Status}.
+ */
+enum class MeasurementState
+{
+    Idle,
+    Sweep,
+    Finished,
+    Temperature,
+    Calibration,
+    Unknown
+};
+
+/**
+ * Parsed output of `board status`.
+ */
+struct Status
+{
+    MeasurementState state = MeasurementState::Unknown;
+    uint32_t point = 0;                 //!< Points measured so far (sweep running or finished)
+    uint32_t totalPoints = 0;           //!< Points in the running sweep
+    bool interrupted = false;           //!< Whether the last measurement was interrupted
+    bool validData = false;             //!< Whether measurement data can be read
+    bool validGain = false;             //!< Whether the board is calibrated
+    std::vector<std::string> lines;     //!< All lines as printed by the board
+};
+
+/**
+ * Parsed output of `board info`, the fixed capabilities of a board.
+ */
+struct BoardInfo
+{
+    unsigned ports = 0;                         //!< Number of output ports
+    uint32_t minFrequency = 0;                  //!< Lowest sweep frequency in Hz
+    uint32_t maxFrequency = 0;                  //!< Highest sweep frequency in Hz
+    uint32_t maxSteps = 0;                      //!< Maximum number of frequency steps
+    std::vector<uint32_t> attenuations;         //!< Available output attenuations
+    std::vector<uint32_t> feedbackResistors;    //!< Fitted feedback resistors in Ohms
+    std::vector<uint32_t> calibrationValues;    //!< Fitted calibration resistors in Ohms
+    std::vector<std::string> lines;             //!< All lines as printed by the board
+};
+
+/** Called when a command without result has finished, `error` is set if it failed. */
+using Done = std::function<void(std::exception_ptr error)>;
+
+/** Called with the result of a command, `value` is default constructed if `error` is set. */
+template<typename T>
+using Callback = std::function<void(T value, std::exception_ptr error)>;
+
+/**
+ * One board connected over its virtual COM port.
+ *
+ * All methods only queue a command and return immediately, the callback is called from the {@link EventLoop} once the
+ * response has been received. Commands are sent preceded with '$', so the board terminates each response with an EOT
+ * character and the next command is written the moment the previous one finished, before its callback runs. Any
+ * number of commands can be queued, so a whole measurement (set, start, wait, read) can be submitted at once, and any
+ * number of devices can share one loop.
+ *
+ * When the port fails or a command times out the device fails all queued commands with the same error and does not
+ * accept new ones (their callbacks are called with the error). A device has to be destroyed on the loop thread, and
+ * not from within one of its own callbacks; callbacks of commands still queued are not called then.
+ */
+class Device
+{
+public:
+    using Clock = EventLoop::Clock;
+    /** Timeout for commands that finish immediately on the board. */
+    static constexpr Clock::duration DEFAULT_TIMEOUT = std::chrono::seconds(5);
+    /** Means a command may take any amount of time (`board wait`). */
+    static constexpr Clock::duration NO_TIMEOUT = Clock::duration::zero();
+
+    Device(EventLoop &loop, const std::string &path);
+    ~Device();
+
+    Device(const Device&) = delete;
+    Device& operator=(const Device&) = delete;
+
+    void command(const std::string &line, Callback<std::string> callback, Clock::duration timeout = DEFAULT_TIMEOUT);
+    void readBinary(const std::string &line, std::size_t recordSize, Callback<std::vector<uint8_t>> callback);
+
+    void info(Callback<BoardInfo> callback);
+    void getSettings(Callback<SweepSettings> callback);
+    void setSweep(const SweepSettings &settings, Done done);
+    void start(unsigned port, Done done);
+    void stop(Done done);
+    void status(Callback<Status> callback);
+    void wait(Callback<uint32_t> callback);
+    void calibrate(uint32_t ohms, Done done);
+    void temperature(Callback<float> callback);
+    void readPolar(Callback<PolarData> callback);
+    void readCartesian(Callback<CartesianData> callback);
+    void readRaw(Callback<RawData> callback);
+    void readFeatures(Callback<SweepFeatures> callback);
+    void telemetry(Callback<Telemetry> callback);
+
+    /** Gets the number of commands queued or in progress. */
+    std::size_t pending() const { return m_queue.size(); }
+    /** Gets whether the device has failed, see {@link error}. */
+    bool failed() const { return static_cast<bool>(m_failure); }
+    /** Gets the error the device failed with, `nullptr` if it is working. */
+    std::exception_ptr error() const { return m_failure; }
+    /** Gets the path of the serial port. */
+    const std::string& path() const { return m_port.path(); }
+
+private:
+    /** Response of the board, binary data is only present for reads. */
+    struct Reply
+    {
+        std::string text;
+        std::vector<uint8_t> data;
+    };
+
+    struct Request
+    {
+        std::string line;
+        std::size_t recordSize;     //!< Record size for binary reads, `0` for text responses
+        Clock::duration timeout;
+        bool ready;                 //!< Whether the line is complete, the request blocks the queue until it is
+        std::function<void(Reply, std::exception_ptr)> done;
+    };
+
+    void submit(Request request);
+    void sendNext();
+    void writePending();
+    void onEvents(uint32_t events);
+    bool parseReply(Reply &reply);
+    void complete(Reply reply, std::exception_ptr error);
+    void fail(std::exception_ptr error);
+
+    EventLoop &m_loop;
+    SerialPort m_port;
+    std::deque<Request> m_queue;        //!< The first request is in progress if m_sent is set
+    bool m_sent = false;
+    std::string m_tx;                   //!< Command line being written
+    std::size_t m_txPos = 0;
+    std::vector<uint8_t> m_rx;          //!< Received bytes not yet consumed
+    std::optional<EventLoop::TimerId> m_timer;
+    std::exception_ptr m_failure;
+};
+
+} // namespace impy
+
+#endif /* IMPY_DEVICE_HPP_ */
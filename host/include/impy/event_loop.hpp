@@ -0,0 +1,80 @@
+/**
+ * @file    event_loop.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Single threaded event loop based on epoll, drives any number of devices.
+ */
+
+#ifndef IMPY_EVENT_LOOP_HPP_
+#define IMPY_EVENT_LOOP_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace impy {
+
+/**
+ * Waits for file descriptors to become ready and for timers to expire, and calls the registered handlers.
+ *
+ * All handlers run on the thread calling {@link run} or {@link runOnce}, so they don't need any locking among
+ * themselves. Only {@link post} and {@link stop} may be called from other threads.
+ */
+class EventLoop
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    /** Called with the ready events (`EPOLLIN`, `EPOLLOUT`, ...) of a file descriptor. */
+    using IoHandler = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void add(int fd, uint32_t events, IoHandler handler);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    TimerId addTimer(Clock::duration delay, Task task);
+    void cancelTimer(TimerId id);
+
+    void post(Task task);
+
+    bool runOnce(int timeoutMs = -1);
+    void run();
+    void runUntil(const std::function<bool()> &done);
+    void stop();
+
+private:
+    int nextTimeout(int timeoutMs) const;
+    void runTimers();
+    void runPosted();
+    void wake();
+
+    int m_epoll = -1;
+    int m_wakeup = -1;              //!< eventfd used by post and stop
+    bool m_stopped = false;
+
+    // Handlers are shared so one can remove itself (or others) while being called
+    std::unordered_map<int, std::shared_ptr<IoHandler>> m_handlers;
+
+    std::multimap<Clock::time_point, TimerId> m_timers;
+    std::unordered_map<TimerId, std::pair<std::multimap<Clock::time_point, TimerId>::iterator, Task>> m_timerTasks;
+    TimerId m_nextTimer = 1;
+
+    std::mutex m_postLock;
+    std::vector<Task> m_posted;
+};
+
+} // namespace impy
+
+#endif /* IMPY_EVENT_LOOP_HPP_ */
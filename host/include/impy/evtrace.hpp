@@ -0,0 +1,110 @@
+/**
+ * @file    evtrace.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoder for event traces recorded by the firmware, from `debug evtrace dump` or an SWO capture.
+ */
+
+#ifndef IMPY_EVTRACE_HPP_
+#define IMPY_EVTRACE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace impy {
+
+/**
+ * The kind of event recorded, values match `EvTrace_Type` in the firmware.
+ */
+enum class EventType : uint8_t
+{
+    IsrEnter = 1,
+    IsrExit,
+    I2CStart,
+    I2CDone,
+    PointStored,
+    UsbPacket,
+    CommandStart,
+    CommandFinish
+};
+
+/**
+ * A single recorded event, see `EvTrace_Record` in the firmware.
+ */
+struct Event
+{
+    uint64_t cycles;        //!< Core clock cycles since the first event, unwrapped from the 32 bit cycle counter
+    EventType type;         //!< Kind of event
+    uint8_t arg8;           //!< Event specific argument (interrupt number, I2C transfer kind or HAL result)
+    uint16_t arg;           //!< Event specific argument (I2C register or length, point index, packet length)
+};
+
+/**
+ * A decoded event trace.
+ */
+struct EventTrace
+{
+    uint32_t clock = 0;             //!< Core clock frequency in Hz
+    uint32_t dropped = 0;           //!< Number of events lost on the device, or ITM overflows in an SWO capture
+    std::vector<Event> events;      //!< Events in chronological order
+
+    /** Converts a cycle count to µs. */
+    double micros(uint64_t cycles) const { return 1e6 * cycles / clock; }
+};
+
+/**
+ * The activities that take time, built from pairs of start and end events.
+ */
+enum class Lane : uint8_t
+{
+    Tim3,       //!< TIM3 interrupt, runs the AD5933 and EEPROM state machines
+    Usb,        //!< USB interrupt, runs console commands
+    I2C,        //!< I2C transfer
+    Command     //!< Console command, from the command line until the command finishes
+};
+
+/** The number of values in {@link Lane}. */
+constexpr std::size_t LANE_COUNT = 4;
+
+/**
+ * An interval in which one activity was running.
+ */
+struct Span
+{
+    Lane lane;
+    uint64_t start;         //!< Start in cycles, see {@link Event::cycles}
+    uint64_t end;           //!< End in cycles
+};
+
+/**
+ * Thrown when a trace cannot be decoded.
+ */
+class EventTraceError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/** Size of a record in a binary dump. */
+constexpr std::size_t EVENT_RECORD_SIZE = 8;
+/** Dump format version understood by {@link decodeEventTrace}. */
+constexpr uint16_t EVENT_TRACE_VERSION = 1;
+/** ITM stimulus port receiving event timestamps, the rest of each event is on the next port (`EVTRACE_ITM_PORT`). */
+constexpr unsigned EVENT_ITM_PORT = 1;
+/** Default core clock frequency for SWO captures, which don't include it. */
+constexpr uint32_t EVENT_DEFAULT_CLOCK = 120000000;
+
+EventTrace decodeEventTrace(const uint8_t *data, std::size_t size);
+EventTrace decodeSwoTrace(const uint8_t *data, std::size_t size, uint32_t clock);
+EventTrace loadEventTrace(const std::string &path);
+EventTrace loadSwoTrace(const std::string &path, uint32_t clock);
+std::vector<Span> eventSpans(const EventTrace &trace);
+const char* eventTypeName(EventType type);
+const char* laneName(Lane lane);
+
+} // namespace impy
+
+#endif /* IMPY_EVTRACE_HPP_ */
@@ -0,0 +1,71 @@
+/**
+ * @file    fit.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Levenberg-Marquardt fitting of equivalent circuit models to impedance spectra, for single sweeps or batches.
+ */
+
+#ifndef IMPY_FIT_HPP_
+#define IMPY_FIT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "impy/data.hpp"
+
+namespace impy {
+
+class SweepStore;
+class ThreadPool;
+
+/**
+ * Equivalent circuit models, parameters in the order listed.
+ */
+enum class CircuitModel
+{
+    SeriesRC,       //!< R - C: R, C
+    ParallelRC,     //!< R || C: R, C
+    SeriesRL,       //!< R - L: R, L
+    Randles,        //!< Rs - (Rct || C): Rs, Rct, C
+    RandlesCPE      //!< Rs - (Rct || CPE): Rs, Rct, Q, n (CPE impedance 1 / (Q (jw)^n))
+};
+
+/** Maximum number of parameters of a model. */
+constexpr std::size_t FIT_MAX_PARAMETERS = 4;
+
+std::size_t parameterCount(CircuitModel model);
+std::vector<std::string> parameterNames(CircuitModel model);
+bool parseModel(const std::string &name, CircuitModel &model);
+
+/**
+ * Result of fitting one sweep.
+ */
+struct FitResult
+{
+    std::array<double, FIT_MAX_PARAMETERS> parameters = {};    //!< Parameters in SI units
+    double error = 0;               //!< RMS of the residuals relative to |Z|
+    unsigned iterations = 0;
+    bool converged = false;
+};
+
+struct FitOptions
+{
+    unsigned maxIterations = 100;
+    double tolerance = 1e-9;        //!< Relative decrease of the cost below which the fit has converged
+    bool warmStart = true;          //!< Start each sweep of a batch from the result of the previous one
+    std::size_t chunkSize = 64;     //!< Sweeps per task of a batch, warm starts work within a chunk
+};
+
+FitResult fit(CircuitModel model, const PolarData &data, const FitOptions &options = FitOptions(),
+        const FitResult *start = nullptr);
+std::vector<FitResult> fitBatch(ThreadPool &pool, CircuitModel model, const std::vector<PolarData> &sweeps,
+        const FitOptions &options = FitOptions());
+std::vector<FitResult> fitStore(ThreadPool &pool, CircuitModel model, const SweepStore &store, uint64_t first,
+        uint64_t count, const FitOptions &options = FitOptions());
+
+} // namespace impy
+
+#endif /* IMPY_FIT_HPP_ */
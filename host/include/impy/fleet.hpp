@@ -0,0 +1,146 @@
+/**
+ * @file    fleet.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Shared job queue for many boards, dispatching sweeps to idle instruments from one event loop.
+ */
+
+#ifndef IMPY_FLEET_HPP_
+#define IMPY_FLEET_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "impy/data.hpp"
+#include "impy/device.hpp"
+#include "impy/event_loop.hpp"
+
+namespace impy {
+
+/**
+ * A measurement job: optionally new sweep settings, then a sweep whose polar data is the result.
+ */
+struct FleetJob
+{
+    unsigned port = 0;                          //!< Port to sweep
+    std::optional<SweepSettings> settings;      //!< Settings to apply first, the instrument's current ones if not set
+    std::string device;                         //!< Path of the instrument to run on, any suitable one if empty
+};
+
+/**
+ * The result of a job, successful or not.
+ */
+struct FleetResult
+{
+    uint64_t job = 0;                           //!< Number returned by {@link Fleet::submit}
+    std::string device;                         //!< Path of the instrument that ran the job, empty if none could
+    unsigned port = 0;                          //!< Port that was swept
+    EventLoop::Clock::time_point queued;        //!< Time the job was submitted
+    EventLoop::Clock::time_point started;       //!< Time the job was sent to the instrument
+    EventLoop::Clock::time_point finished;      //!< Time the result was in
+    PolarData data;                             //!< The sweep, empty if the job failed
+    std::exception_ptr error;                   //!< Set if the job failed
+};
+
+/**
+ * State of one instrument of a {@link Fleet}.
+ */
+struct InstrumentState
+{
+    std::string path;                           //!< Path of the serial port
+    BoardInfo info;                             //!< Capabilities from `board info`
+    SweepSettings settings;                     //!< Current sweep settings
+    bool ready = false;                         //!< Whether the capabilities are known
+    bool calibrated = false;                    //!< Whether the board was calibrated after the last job
+    bool busy = false;                          //!< Whether a job is running
+    std::exception_ptr error;                   //!< Set if the instrument failed and is not used anymore
+    uint64_t jobs = 0;                          //!< Number of jobs finished
+    EventLoop::Clock::duration busyTime{};      //!< Total time spent running jobs
+    double speed = 1.0;                         //!< Run time over estimated time, learned from finished jobs
+    std::optional<Telemetry> telemetry;         //!< Counters of the board after the last job, if it has them
+};
+
+/**
+ * Runs jobs from one queue on any number of boards.
+ *
+ * Each instrument is asked for its capabilities, settings and calibration state when it is added, and only runs jobs
+ * it can do: the port exists, the frequencies and steps are in range, the feedback resistor is fitted and the board is
+ * calibrated for the job's frequency range, feedback resistor and gain. Jobs are dispatched in the order they were submitted to the instrument that is estimated to finish them
+ * first, which may mean waiting for a faster busy instrument while later jobs go to an idle one. Run times are
+ * estimated from the sweep settings (see {@link estimate}) and scaled for each instrument by what its finished jobs
+ * took.
+ *
+ * All I/O runs on the {@link EventLoop}. Results are passed to the result handler and kept in the order the jobs
+ * finished. A job whose instrument fails (port error or timeout) is queued again for another one, a job
+ * the board rejects fails with the error. Jobs that no instrument can run fail right away.
+ */
+class Fleet
+{
+public:
+    using Clock = EventLoop::Clock;
+    using ResultHandler = std::function<void(const FleetResult &result)>;
+
+    explicit Fleet(EventLoop &loop);
+    ~Fleet();
+
+    Fleet(const Fleet&) = delete;
+    Fleet& operator=(const Fleet&) = delete;
+
+    void addInstrument(const std::string &path);
+    uint64_t submit(FleetJob job);
+
+    /** Sets the function called with each result, on the loop thread. */
+    void onResult(ResultHandler handler) { m_onResult = std::move(handler); }
+    /** Gets the results of all finished jobs, in the order they finished (the handler sees each one first). */
+    const std::vector<FleetResult>& results() const { return m_results; }
+    /** Gets the number of jobs waiting for an instrument. */
+    std::size_t queued() const { return m_queue.size(); }
+    std::size_t running() const;
+    bool done() const;
+    std::vector<InstrumentState> instruments() const;
+
+    static Clock::duration estimate(const SweepSettings &settings);
+
+private:
+    struct Instrument
+    {
+        InstrumentState state;
+        std::unique_ptr<Device> device;
+        bool probing = true;                    //!< Whether the probe commands are still running
+        Clock::time_point busyUntil;            //!< Estimated end of the running job
+    };
+
+    struct Pending
+    {
+        uint64_t id;
+        FleetJob job;
+        Clock::time_point queued;
+    };
+
+    void probe(Instrument &inst);
+    bool canRun(const Instrument &inst, const FleetJob &job) const;
+    void dispatch();
+    void run(Instrument &inst, Pending pending);
+    void finish(Instrument &inst, Pending pending, std::shared_ptr<FleetResult> result);
+    void deliver(FleetResult result);
+
+    EventLoop &m_loop;
+    std::vector<std::unique_ptr<Instrument>> m_instruments;
+    std::deque<Pending> m_queue;
+    std::vector<FleetResult> m_results;
+    ResultHandler m_onResult;
+    uint64_t m_nextJob = 0;
+    bool m_dispatching = false;
+    bool m_dispatchAgain = false;               //!< Whether {@link dispatch} was called while it was running
+};
+
+} // namespace impy
+
+#endif /* IMPY_FLEET_HPP_ */
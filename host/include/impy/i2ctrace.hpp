@@ -0,0 +1,112 @@
+/**
+ * @file    i2ctrace.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoder and replay device for I2C traces recorded by the firmware (`debug i2ctrace dump`).
+ */
+
+#ifndef IMPY_I2CTRACE_HPP_
+#define IMPY_I2CTRACE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace impy {
+
+/**
+ * The kind of I2C transfer recorded, values match `I2CTrace_Op` in the firmware.
+ */
+enum class I2COp : uint8_t
+{
+    MemWrite = 1,
+    MemRead,
+    Transmit,
+    Receive,
+    DeviceReady
+};
+
+/**
+ * A single recorded I2C transaction, see `I2CTrace_Record` in the firmware.
+ */
+struct I2CRecord
+{
+    uint32_t timestamp;             //!< Start of the transaction in µs since boot
+    uint32_t duration;              //!< Duration of the transaction in µs
+    I2COp op;                       //!< Kind of transfer
+    uint8_t address;                //!< Device address (8 bit format)
+    uint16_t reg;                   //!< Memory address, or first data byte for transmits
+    uint16_t length;                //!< Number of data bytes (number of trials for device ready checks)
+    uint8_t result;                 //!< HAL status code, `0` is success
+    std::array<uint8_t, 4> data;    //!< The first data bytes transferred
+};
+
+/**
+ * A decoded trace dump.
+ */
+struct I2CTrace
+{
+    uint32_t dropped = 0;               //!< Number of records lost on the device because the ring buffer was full
+    std::vector<I2CRecord> records;     //!< Records in chronological order
+};
+
+/**
+ * Thrown when a trace cannot be decoded, or a replayed transfer does not match the recording.
+ */
+class I2CTraceError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/** Size of a record in a binary dump. */
+constexpr std::size_t I2C_RECORD_SIZE = 20;
+/** Dump format version understood by {@link decodeI2CTrace}. */
+constexpr uint16_t I2C_TRACE_VERSION = 1;
+
+I2CTrace decodeI2CTrace(const uint8_t *data, std::size_t size);
+I2CTrace loadI2CTrace(const std::string &path);
+const char* i2cOpName(I2COp op);
+
+/**
+ * Stands in for the devices on the bus by serving transfers from a recorded trace.
+ *
+ * Transfers have to be issued in the recorded order, each one is checked against the next record and the recorded
+ * result and read data are returned. A virtual clock advances by the recorded gaps and durations, so a host port of a
+ * driver can be timed exactly as it ran on the hardware, and changes that save transfers show up as saved time.
+ */
+class I2CReplayDevice
+{
+public:
+    explicit I2CReplayDevice(I2CTrace trace);
+
+    uint8_t memWrite(uint8_t address, uint16_t reg, const uint8_t *data, uint16_t length);
+    uint8_t memRead(uint8_t address, uint16_t reg, uint8_t *data, uint16_t length);
+    uint8_t transmit(uint8_t address, const uint8_t *data, uint16_t length);
+    uint8_t receive(uint8_t address, uint8_t *data, uint16_t length);
+    uint8_t isDeviceReady(uint8_t address, uint32_t trials);
+
+    /** Gets the virtual time in µs, relative to the start of the first record. */
+    uint64_t now() const { return m_now; }
+    /** Gets the summed duration of all transfers replayed so far in µs. */
+    uint64_t busTime() const { return m_busTime; }
+    /** Gets whether all records have been replayed. */
+    bool finished() const { return m_next == m_trace.records.size(); }
+    /** Gets the number of records replayed so far. */
+    std::size_t position() const { return m_next; }
+
+private:
+    const I2CRecord& next(I2COp op, uint8_t address, uint16_t reg, uint16_t length);
+
+    I2CTrace m_trace;
+    std::size_t m_next = 0;
+    uint64_t m_now = 0;
+    uint64_t m_busTime = 0;
+};
+
+} // namespace impy
+
+#endif /* IMPY_I2CTRACE_HPP_ */
@@ -0,0 +1,60 @@
+/**
+ * @file    serial.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Non-blocking access to the virtual COM port of the board through termios.
+ */
+
+#ifndef IMPY_SERIAL_HPP_
+#define IMPY_SERIAL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace impy {
+
+/**
+ * Thrown when a system call on a serial port or the event loop fails.
+ */
+class IoError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * A serial port opened in raw, non-blocking mode.
+ *
+ * The board is a USB CDC device, so the baud rate is irrelevant and the port is simply configured for 8N1 without any
+ * input or output processing. Reads and writes never block, they transfer what is possible right now and are meant to
+ * be driven from an {@link EventLoop}.
+ */
+class SerialPort
+{
+public:
+    explicit SerialPort(const std::string &path);
+    ~SerialPort();
+
+    SerialPort(const SerialPort&) = delete;
+    SerialPort& operator=(const SerialPort&) = delete;
+
+    std::size_t read(uint8_t *data, std::size_t size);
+    std::size_t write(const uint8_t *data, std::size_t size);
+    void flushInput();
+    void close();
+
+    /** Gets the file descriptor, `-1` if the port is closed. */
+    int fd() const { return m_fd; }
+    /** Gets the path the port was opened with. */
+    const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+    int m_fd = -1;
+};
+
+} // namespace impy
+
+#endif /* IMPY_SERIAL_HPP_ */
@@ -0,0 +1,80 @@
+/**
+ * @file    sweep_ring.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Ring of completed sweeps in POSIX shared memory, written by `impyd` and read by any number of processes.
+ */
+
+#ifndef IMPY_SWEEP_RING_HPP_
+#define IMPY_SWEEP_RING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "impy/data.hpp"
+
+namespace impy {
+
+/** Maximum number of points in a sweep (511 frequency increments plus the start frequency). */
+constexpr std::size_t SWEEP_MAX_POINTS = 512;
+
+/**
+ * A completed sweep as published by the daemon.
+ */
+struct SweepRecord
+{
+    uint64_t sweep = 0;         //!< Sweep number, counting from 1 since the daemon started
+    int64_t timestamp = 0;      //!< Time the sweep finished in ns since the epoch
+    uint32_t port = 0;          //!< Port the sweep was measured on
+    PolarData polar;            //!< Calibrated data
+    RawData raw;                //!< Raw AD5933 data, may be empty
+};
+
+/**
+ * Fixed size ring of the latest sweeps in shared memory.
+ *
+ * There is one writer and any number of readers, which never block the writer. Each slot has a sequence number that
+ * is odd while the slot is being written, readers check it before and after copying a slot and discard the copy if
+ * the slot changed meanwhile (a seqlock). Values are stored in host byte order, one array per value.
+ */
+class SweepRing
+{
+public:
+    static constexpr uint32_t MAGIC = 0x696D7079;      // "impy"
+    static constexpr uint32_t VERSION = 1;
+
+    static SweepRing create(const std::string &name, uint32_t slots);
+    static SweepRing open(const std::string &name);
+
+    SweepRing(SweepRing &&other) noexcept;
+    SweepRing& operator=(SweepRing &&other) noexcept;
+    ~SweepRing();
+
+    SweepRing(const SweepRing&) = delete;
+    SweepRing& operator=(const SweepRing&) = delete;
+
+    void publish(const SweepRecord &record);
+    uint64_t latest() const;
+    bool read(uint64_t sweep, SweepRecord &record) const;
+
+    /** Gets the number of sweeps the ring holds. */
+    uint32_t slots() const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    SweepRing(void *map, std::size_t size, bool writer, std::string name);
+    Slot& slot(uint64_t sweep) const;
+
+    void *m_map = nullptr;
+    std::size_t m_size = 0;
+    bool m_writer = false;
+    std::string m_name;
+};
+
+} // namespace impy
+
+#endif /* IMPY_SWEEP_RING_HPP_ */
@@ -0,0 +1,140 @@
+/**
+ * @file    sweep_store.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Append-only columnar file of sweeps with the same frequency plan, memory mapped for reading.
+ */
+
+#ifndef IMPY_SWEEP_STORE_HPP_
+#define IMPY_SWEEP_STORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "impy/data.hpp"
+
+namespace impy {
+
+/**
+ * Thrown when a store file cannot be used, or data does not fit the store.
+ */
+class StoreError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Metadata of a stored sweep.
+ */
+struct SweepInfo
+{
+    int64_t timestamp = 0;      //!< Time the sweep finished in ns since the epoch
+    uint32_t port = 0;          //!< Port the sweep was measured on
+    uint32_t points = 0;        //!< Number of valid points, less than the frequency plan for interrupted sweeps
+    uint32_t rawPoints = 0;     //!< Number of valid raw points
+};
+
+/*
+ * File layout
+ *
+ * The file starts with a 4 KiB header holding the frequency plan, followed by blocks of a fixed number of sweeps.
+ * Each block consists of columns: the metadata table (timestamp, port, points, raw points) followed by magnitude and
+ * angle, and raw real and imaginary part if the store has raw data. Value columns are frequency major, so one
+ * frequency across all sweeps of a block is contiguous. Header and metadata are in host byte order, frequencies and
+ * values are stored as sent by the board (big endian), so the writer copies them out of the binary frames as they are.
+ *
+ * The sweep count in the header is updated after a sweep has been written completely, so readers (and the writer
+ * after a crash) never see partial sweeps. Timestamps don't decrease, the timestamp column is the time index.
+ */
+
+/**
+ * Writes sweeps to a store file, there must only be one writer per file.
+ */
+class SweepStoreWriter
+{
+public:
+    /** Default number of sweeps per block. */
+    static constexpr uint32_t DEFAULT_BLOCK_SWEEPS = 256;
+
+    static SweepStoreWriter create(const std::string &path, const std::vector<uint32_t> &frequencies, bool raw,
+            uint32_t blockSweeps = DEFAULT_BLOCK_SWEEPS);
+    static SweepStoreWriter open(const std::string &path);
+
+    SweepStoreWriter(SweepStoreWriter &&other) noexcept;
+    SweepStoreWriter& operator=(SweepStoreWriter &&other) noexcept;
+    ~SweepStoreWriter();
+
+    SweepStoreWriter(const SweepStoreWriter&) = delete;
+    SweepStoreWriter& operator=(const SweepStoreWriter&) = delete;
+
+    uint64_t append(const SweepInfo &info, const uint8_t *polar, std::size_t polarSize, const uint8_t *raw = nullptr,
+            std::size_t rawSize = 0);
+    void sync();
+
+    /** Gets the number of sweeps in the store. */
+    uint64_t size() const { return m_count; }
+
+private:
+    SweepStoreWriter(int fd, void *header, uint64_t count);
+    void mapBlock(uint64_t block);
+
+    int m_fd = -1;
+    void *m_header = nullptr;
+    uint8_t *m_block = nullptr;         //!< Current block, `nullptr` if not mapped
+    uint64_t m_blockIndex = 0;
+    uint64_t m_count = 0;
+    int64_t m_lastTimestamp = 0;
+};
+
+/**
+ * Read access to a store file, any number of readers can use a file while it is being written.
+ */
+class SweepStore
+{
+public:
+    static SweepStore open(const std::string &path);
+
+    SweepStore(SweepStore &&other) noexcept;
+    SweepStore& operator=(SweepStore &&other) noexcept;
+    ~SweepStore();
+
+    SweepStore(const SweepStore&) = delete;
+    SweepStore& operator=(const SweepStore&) = delete;
+
+    bool refresh();
+
+    /** Gets the number of sweeps in the store (as of the last {@link refresh}). */
+    uint64_t size() const { return m_count; }
+    /** Gets the frequency plan shared by all sweeps. */
+    const std::vector<uint32_t>& frequencies() const { return m_frequencies; }
+    /** Gets whether raw data is stored. */
+    bool hasRaw() const { return m_raw; }
+
+    SweepInfo info(uint64_t sweep) const;
+    PolarData polar(uint64_t sweep) const;
+    RawData raw(uint64_t sweep) const;
+    void slice(std::size_t point, uint64_t first, uint64_t count, float *magnitude, float *angle) const;
+    uint64_t find(int64_t timestamp) const;
+
+private:
+    SweepStore(int fd);
+    void map();
+    const uint8_t* block(uint64_t sweep) const;
+
+    int m_fd = -1;
+    uint8_t *m_map = nullptr;
+    std::size_t m_size = 0;
+    uint64_t m_count = 0;
+    std::vector<uint32_t> m_frequencies;
+    uint32_t m_blockSweeps = 0;
+    std::size_t m_blockSize = 0;
+    bool m_raw = false;
+};
+
+} // namespace impy
+
+#endif /* IMPY_SWEEP_STORE_HPP_ */
@@ -0,0 +1,72 @@
+/**
+ * @file    thread_pool.hpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Fixed size thread pool with work stealing, for batches of independent tasks.
+ */
+
+#ifndef IMPY_THREAD_POOL_HPP_
+#define IMPY_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace impy {
+
+/**
+ * Runs batches of tasks on a fixed set of worker threads.
+ *
+ * The tasks of a batch are dealt out to the workers in contiguous ranges up front. Each worker takes tasks from the
+ * back of its own queue and, when that is empty, steals from the front of the others, so uneven task durations don't
+ * leave threads idle at the end of a batch.
+ */
+class ThreadPool
+{
+public:
+    /** Called with the index of the task and the index of the worker running it. */
+    using Task = std::function<void(std::size_t task, std::size_t worker)>;
+
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void run(std::size_t tasks, const Task &task);
+
+    /** Gets the number of worker threads. */
+    std::size_t size() const { return m_queues.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    void work(std::size_t worker);
+    bool next(std::size_t worker, std::size_t &task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const Task *m_task = nullptr;       //!< Task of the current batch
+    unsigned long m_batch = 0;          //!< Incremented for each batch, wakes the workers
+    std::size_t m_busy = 0;             //!< Number of workers still working on the current batch
+    std::exception_ptr m_error;         //!< First exception thrown by a task of the current batch
+    bool m_stop = false;
+};
+
+} // namespace impy
+
+#endif /* IMPY_THREAD_POOL_HPP_ */
@@ -0,0 +1,335 @@
+/**
+ * @file    impy_mex.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   MATLAB MEX gateway to libimpy, used by the `impy_*` functions for ports opened with `impy_open`.
+ *
+ * Usage from MATLAB (normally through the `impy_*` functions, not directly):
+ *   h = impy_mex('open', path)
+ *   impy_mex('close', h)
+ *   text = impy_mex('command', h, line)
+ *   sweep = impy_mex('getall', h)
+ *   impy_mex('setsweep', h, sweep)
+ *   impy_mex('calibrate', h, ohms)
+ *   impy_mex('start', h, port)
+ *   numpoints = impy_mex('wait', h)
+ *   [finished, numpoints] = impy_mex('poll', h)
+ *   [freq, data] = impy_mex('read', h, format)
+ *
+ * Binary data read from the board is decoded straight into the output arrays, there is no text parsing and no
+ * intermediate array. Build with `make mex` in the host directory, the result ends up in the matlab directory.
+ */
+
+#include <cstdio>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mex.h"
+
+#include "impy/data.hpp"
+#include "impy/device.hpp"
+#include "impy/event_loop.hpp"
+
+namespace {
+
+std::unique_ptr<impy::EventLoop> loop;
+std::map<uint64_t, std::unique_ptr<impy::Device>> devices;
+uint64_t nextHandle = 1;
+
+void cleanup() {
+    devices.clear();
+    loop.reset();
+}
+
+/**
+ * Thrown for wrong arguments, reported with a different message identifier than board errors.
+ */
+class UsageError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+std::string getString(const mxArray *arr) {
+    if(!mxIsChar(arr)) {
+        throw UsageError("Argument needs to be a string.");
+    }
+    char *str = mxArrayToString(arr);
+    std::string ret(str);
+    mxFree(str);
+    return ret;
+}
+
+double getScalar(const mxArray *arr, const char *name) {
+    if(!mxIsNumeric(arr) && !mxIsLogical(arr)) {
+        throw UsageError(std::string(name) + " needs to be a number.");
+    }
+    return mxGetScalar(arr);
+}
+
+impy::Device& getDevice(int nrhs, const mxArray *prhs[]) {
+    if(nrhs < 2 || !mxIsUint64(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1) {
+        throw UsageError("Second argument needs to be a port opened with impy_open.");
+    }
+    auto it = devices.find(*static_cast<uint64_t *>(mxGetData(prhs[1])));
+    if(it == devices.end()) {
+        throw UsageError("Port is not open.");
+    }
+    return *it->second;
+}
+
+/**
+ * Runs the event loop until the callback passed to the issuing function has been called.
+ *
+ * @param issue Function that queues a command with the callback it is passed
+ * @return The value passed to the callback, errors are rethrown
+ */
+template<typename T, typename Issue>
+T call(Issue issue) {
+    bool done = false;
+    T result{};
+    std::exception_ptr error;
+    issue([&](T value, std::exception_ptr err) {
+        result = std::move(value);
+        error = err;
+        done = true;
+    });
+    loop->runUntil([&done]() { return done; });
+    if(error) {
+        std::rethrow_exception(error);
+    }
+    return result;
+}
+
+/**
+ * Same as {@link call} for commands without result.
+ */
+template<typename Issue>
+void callDone(Issue issue) {
+    call<bool>([&issue](impy::Callback<bool> callback) {
+        issue([callback](std::exception_ptr error) { callback(true, error); });
+    });
+}
+
+void addField(mxArray *st, const char *name, mxArray *value) {
+    mxSetFieldByNumber(st, 0, mxAddField(st, name), value);
+}
+
+/**
+ * Makes the same structure as `impy_getall` does, fields in the order the board prints them.
+ */
+mxArray* settingsToStruct(const impy::SweepSettings &settings) {
+    mxArray *st = mxCreateStructMatrix(1, 1, 0, nullptr);
+    addField(st, "start", mxCreateDoubleScalar(settings.start));
+    addField(st, "steps", mxCreateDoubleScalar(settings.steps));
+    addField(st, "stop", mxCreateDoubleScalar(settings.stop));
+    addField(st, "settl", mxCreateDoubleScalar(settings.settl));
+    addField(st, "avg", mxCreateDoubleScalar(settings.avg));
+    addField(st, "autorange", mxCreateLogicalScalar(settings.autorange));
+    if(settings.gain) {
+        addField(st, "gain", mxCreateLogicalScalar(*settings.gain));
+    }
+    if(settings.voltage) {
+        addField(st, "voltage", mxCreateDoubleScalar(*settings.voltage));
+    }
+    if(settings.feedback) {
+        addField(st, "feedback", mxCreateDoubleScalar(*settings.feedback));
+    }
+    return st;
+}
+
+/**
+ * Reads the sweep structure passed to `impy_setsweep`, which has already checked for the required fields.
+ */
+impy::SweepSettings settingsFromStruct(const mxArray *st) {
+    if(!mxIsStruct(st)) {
+        throw UsageError("sweep needs to be a structure.");
+    }
+    auto field = [st](const char *name) -> const mxArray* {
+        const mxArray *value = mxGetField(st, 0, name);
+        return (value != nullptr && !mxIsEmpty(value) ? value : nullptr);
+    };
+
+    impy::SweepSettings settings;
+    for(const char *name : { "start", "stop", "steps", "settl", "voltage", "feedback", "gain" }) {
+        if(field(name) == nullptr) {
+            throw UsageError(std::string("Required field missing from sweep: ") + name);
+        }
+    }
+    settings.start = static_cast<uint32_t>(getScalar(field("start"), "start"));
+    settings.stop = static_cast<uint32_t>(getScalar(field("stop"), "stop"));
+    settings.steps = static_cast<uint16_t>(getScalar(field("steps"), "steps"));
+    settings.settl = static_cast<uint16_t>(getScalar(field("settl"), "settl"));
+    settings.voltage = static_cast<uint16_t>(getScalar(field("voltage"), "voltage"));
+    settings.feedback = static_cast<uint32_t>(getScalar(field("feedback"), "feedback"));
+    settings.gain = (getScalar(field("gain"), "gain") != 0);
+    if(field("avg") != nullptr) {
+        settings.avg = static_cast<uint16_t>(getScalar(field("avg"), "avg"));
+    }
+    if(field("autorange") != nullptr) {
+        settings.autorange = (getScalar(field("autorange"), "autorange") != 0);
+    }
+    return settings;
+}
+
+/**
+ * Reads measurement data and decodes it straight into the output arrays, see `impy_read` for the format.
+ */
+void readData(impy::Device &dev, const std::string &format, int nlhs, mxArray *plhs[]) {
+    bool raw = (format == "raw");
+    bool polar = (format != "cartesian");
+    std::size_t recordSize = (raw ? impy::RAW_RECORD_SIZE : impy::IMPEDANCE_RECORD_SIZE);
+    const char *line = (raw ? "board read --format=BH --raw" : polar ? "board read --format=BPH" :
+            "board read --format=BCH");
+
+    std::vector<uint8_t> data = call<std::vector<uint8_t>>([&](impy::Callback<std::vector<uint8_t>> callback) {
+        dev.readBinary(line, recordSize, std::move(callback));
+    });
+    std::size_t count = impy::recordCount(data.size(), recordSize);
+
+    if(count == 0) {
+        // The board sends a byte count of zero if there is no data
+        plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
+        if(nlhs > 1) {
+            plhs[1] = mxCreateDoubleMatrix(0, 0, mxREAL);
+        }
+        return;
+    }
+
+    mxArray *freq = mxCreateDoubleMatrix(1, count, mxREAL);
+    mxArray *out;
+    if(raw) {
+        out = mxCreateDoubleMatrix(2, count, mxREAL);
+        impy::decodeRawInto(data.data(), count, mxGetPr(freq), mxGetPr(out), mxGetPr(out) + 1, 2);
+    } else if(polar) {
+        out = mxCreateDoubleMatrix(2, count, mxREAL);
+        impy::decodeImpedanceInto(data.data(), count, mxGetPr(freq), mxGetPr(out), mxGetPr(out) + 1, 2);
+    } else {
+        out = mxCreateDoubleMatrix(1, count, mxCOMPLEX);
+        impy::decodeImpedanceInto(data.data(), count, mxGetPr(freq), mxGetPr(out), mxGetPi(out));
+    }
+
+    plhs[0] = freq;
+    if(nlhs > 1) {
+        plhs[1] = out;
+    } else {
+        mxDestroyArray(out);
+    }
+}
+
+void dispatch(const std::string &cmd, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+    if(!loop) {
+        loop = std::make_unique<impy::EventLoop>();
+        mexAtExit(cleanup);
+    }
+
+    if(cmd == "open") {
+        if(nrhs != 2) {
+            throw UsageError("Expected a device path.");
+        }
+        uint64_t handle = nextHandle++;
+        devices[handle] = std::make_unique<impy::Device>(*loop, getString(prhs[1]));
+        if(devices.size() == 1) {
+            // Don't let 'clear' unload the MEX file while ports are open
+            mexLock();
+        }
+        plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+        *static_cast<uint64_t *>(mxGetData(plhs[0])) = handle;
+        return;
+    }
+
+    impy::Device &dev = getDevice(nrhs, prhs);
+    if(cmd == "close") {
+        devices.erase(*static_cast<uint64_t *>(mxGetData(prhs[1])));
+        if(devices.empty()) {
+            mexUnlock();
+        }
+
+    } else if(cmd == "command") {
+        if(nrhs != 3) {
+            throw UsageError("Expected a command line.");
+        }
+        std::string line = getString(prhs[2]);
+        std::string text = call<std::string>([&](impy::Callback<std::string> callback) {
+            dev.command(line, std::move(callback));
+        });
+        plhs[0] = mxCreateString(text.c_str());
+
+    } else if(cmd == "getall") {
+        impy::SweepSettings settings = call<impy::SweepSettings>([&](impy::Callback<impy::SweepSettings> callback) {
+            dev.getSettings(std::move(callback));
+        });
+        plhs[0] = settingsToStruct(settings);
+
+    } else if(cmd == "setsweep") {
+        if(nrhs != 3) {
+            throw UsageError("Expected a sweep structure.");
+        }
+        impy::SweepSettings settings = settingsFromStruct(prhs[2]);
+        callDone([&](impy::Done done) { dev.setSweep(settings, std::move(done)); });
+
+    } else if(cmd == "calibrate") {
+        if(nrhs != 3) {
+            throw UsageError("Expected a resistor value.");
+        }
+        uint32_t ohms = static_cast<uint32_t>(getScalar(prhs[2], "resistor"));
+        callDone([&](impy::Done done) { dev.calibrate(ohms, std::move(done)); });
+
+    } else if(cmd == "start") {
+        if(nrhs != 3) {
+            throw UsageError("Expected a port number.");
+        }
+        unsigned port = static_cast<unsigned>(getScalar(prhs[2], "port"));
+        callDone([&](impy::Done done) { dev.start(port, std::move(done)); });
+
+    } else if(cmd == "wait") {
+        uint32_t points = call<uint32_t>([&](impy::Callback<uint32_t> callback) { dev.wait(std::move(callback)); });
+        plhs[0] = mxCreateDoubleScalar(points);
+
+    } else if(cmd == "poll") {
+        impy::Status status = call<impy::Status>([&](impy::Callback<impy::Status> callback) {
+            dev.status(std::move(callback));
+        });
+        bool finished = (status.state == impy::MeasurementState::Finished);
+        plhs[0] = mxCreateLogicalScalar(finished);
+        if(nlhs > 1) {
+            plhs[1] = mxCreateDoubleScalar(finished ? status.point : 0);
+        }
+
+    } else if(cmd == "read") {
+        std::string format = (nrhs > 2 ? getString(prhs[2]) : std::string("polar"));
+        if(format != "polar" && format != "cartesian" && format != "raw") {
+            mexWarnMsgIdAndTxt("impy:format", "Unknown format \"%s\", using polar instead.", format.c_str());
+            format = "polar";
+        }
+        readData(dev, format, nlhs, plhs);
+
+    } else {
+        throw UsageError("Unknown command: " + cmd);
+    }
+}
+
+} // namespace
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+    // mexErrMsgIdAndTxt does not return, so it must not be called with C++ objects alive
+    static char message[256];
+    const char *id = "impy:device";
+
+    try {
+        if(nrhs < 1) {
+            throw UsageError("Expected a command name.");
+        }
+        dispatch(getString(prhs[0]), nlhs, plhs, nrhs, prhs);
+        return;
+    } catch(const UsageError &e) {
+        id = "impy:usage";
+        std::snprintf(message, sizeof(message), "%s", e.what());
+    } catch(const std::exception &e) {
+        std::snprintf(message, sizeof(message), "%s", e.what());
+    }
+    mexErrMsgIdAndTxt(id, "%s", message);
+}
@@ -0,0 +1,135 @@
+/**
+ * @file    data.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoding of binary measurement data sent by `board read` (see `help format` on the board).
+ */
+
+#include "impy/data.hpp"
+
+#include <string>
+
+namespace impy {
+
+/**
+ * Gets the number of records in binary data of the specified size.
+ *
+ * @param size Size of the data in bytes, without byte count
+ * @param recordSize Size of a record ({@link IMPEDANCE_RECORD_SIZE} or {@link RAW_RECORD_SIZE})
+ * @return The number of records
+ */
+std::size_t recordCount(std::size_t size, std::size_t recordSize) {
+    if(size % recordSize != 0) {
+        throw ProtocolError("Data size " + std::to_string(size) + " is not a multiple of the record size " +
+                std::to_string(recordSize));
+    }
+    return size / recordSize;
+}
+
+/**
+ * Decodes polar data (format `BP`), without the leading byte count.
+ *
+ * @param data Pointer to the records
+ * @param size Size of the data in bytes
+ * @return The decoded data
+ */
+PolarData decodePolar(const uint8_t *data, std::size_t size) {
+    std::size_t count = recordCount(size, IMPEDANCE_RECORD_SIZE);
+    PolarData ret;
+    ret.frequency.resize(count);
+    ret.magnitude.resize(count);
+    ret.angle.resize(count);
+    decodeImpedanceInto(data, count, ret.frequency.data(), ret.magnitude.data(), ret.angle.data());
+    return ret;
+}
+
+/**
+ * Decodes cartesian data (format `BC`), without the leading byte count.
+ */
+CartesianData decodeCartesian(const uint8_t *data, std::size_t size) {
+    std::size_t count = recordCount(size, IMPEDANCE_RECORD_SIZE);
+    CartesianData ret;
+    ret.frequency.resize(count);
+    ret.real.resize(count);
+    ret.imag.resize(count);
+    decodeImpedanceInto(data, count, ret.frequency.data(), ret.real.data(), ret.imag.data());
+    return ret;
+}
+
+/**
+ * Decodes raw data (`board read --raw` in binary format), without the leading byte count.
+ */
+RawData decodeRaw(const uint8_t *data, std::size_t size) {
+    std::size_t count = recordCount(size, RAW_RECORD_SIZE);
+    RawData ret;
+    ret.frequency.resize(count);
+    ret.real.resize(count);
+    ret.imag.resize(count);
+    decodeRawInto(data, count, ret.frequency.data(), ret.real.data(), ret.imag.data());
+    return ret;
+}
+
+/**
+ * Decodes sweep features (`board read --features` in binary format), without the leading byte count.
+ */
+SweepFeatures decodeFeatures(const uint8_t *data, std::size_t size) {
+    if(size == 0) {
+        throw ProtocolError("No measurement data");
+    }
+    if(size != FEATURES_RECORD_SIZE) {
+        throw ProtocolError("Features size " + std::to_string(size) + " does not match " +
+                std::to_string(FEATURES_RECORD_SIZE));
+    }
+    SweepFeatures ret;
+    ret.minFrequency = detail::beFloat(data);
+    ret.minMagnitude = detail::beFloat(data + 4);
+    ret.maxFrequency = detail::beFloat(data + 8);
+    ret.maxMagnitude = detail::beFloat(data + 12);
+    ret.resonanceFrequency = detail::beFloat(data + 16);
+    ret.resonanceQ = detail::beFloat(data + 20);
+    ret.arcFrequency = detail::beFloat(data + 24);
+    ret.arcReactance = detail::beFloat(data + 28);
+    ret.crossings = detail::be32(data + 32);
+    for(std::size_t j = 0; j < 4 && j < ret.crossings; j++) {
+        ret.crossingFrequency.push_back(detail::beFloat(data + 36 + 4 * j));
+    }
+    return ret;
+}
+
+/**
+ * Decodes telemetry (`board telemetry binary`), without the leading byte count.
+ *
+ * Later format versions only append values, so values that are not known here are ignored.
+ */
+Telemetry decodeTelemetry(const uint8_t *data, std::size_t size) {
+    // Uptime as two values and the nine counters
+    constexpr std::size_t MIN_VALUES = 11;
+    constexpr std::size_t IRQS = sizeof(TELEMETRY_IRQS) / sizeof(TELEMETRY_IRQS[0]);
+
+    if(size == 0) {
+        throw ProtocolError("No telemetry");
+    }
+    std::size_t values = (size >= 4 ? (static_cast<std::size_t>(data[2]) << 8) | data[3] : 0);
+    if(size < 4 || values < MIN_VALUES || size < 4 + 4 * values) {
+        throw ProtocolError("Telemetry size " + std::to_string(size) + " does not match its header");
+    }
+    data += 4;
+
+    Telemetry ret;
+    ret.uptime = (static_cast<uint64_t>(detail::be32(data)) << 32) | detail::be32(data + 4);
+    ret.sweeps = detail::be32(data + 8);
+    ret.points = detail::be32(data + 12);
+    ret.i2cErrors = detail::be32(data + 16);
+    ret.i2cRetries = detail::be32(data + 20);
+    ret.usbStalls = detail::be32(data + 24);
+    ret.usbBytes = detail::be32(data + 28);
+    ret.droppedLines = detail::be32(data + 32);
+    ret.eepromWrites = detail::be32(data + 36);
+    ret.heapFailures = detail::be32(data + 40);
+    for(std::size_t j = 0; j < IRQS && MIN_VALUES + j < values; j++) {
+        ret.maxIsrTime.push_back(detail::be32(data + 4 * (MIN_VALUES + j)));
+    }
+    return ret;
+}
+
+} // namespace impy
@@ -0,0 +1,688 @@
+/**
+ * @file    device.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Asynchronous, typed access to the console commands of one board.
+ */
+
+#include "impy/device.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sys/epoll.h>
+#include <utility>
+
+namespace impy {
+
+namespace {
+
+/** Sent by the board after the response to a line preceded with '$' (`VCP_END_OF_RESPONSE`). */
+constexpr uint8_t END_OF_RESPONSE = 0x04;
+/** Maximum command line length accepted by the board (`MAX_CMDLINE_LENGTH`). */
+constexpr std::size_t MAX_LINE_LENGTH = 200;
+/** Calibration runs a sweep for each clock range, allow for long settling times. */
+constexpr auto CALIBRATE_TIMEOUT = std::chrono::seconds(60);
+
+// Texts from strings_en.h that the parsers look for
+const std::string txtOK = "OK";
+const std::string txtAdStatusSweep = "Impedance measurement is running, points measured: ";
+const std::string txtAdStatusIdle = "No measurement is running.";
+const std::string txtAdStatusFinishImpedance = "Impedance measurement finished, points measured: ";
+const std::string txtAdStatusTemp = "Temperature measurement is running.";
+const std::string txtAdStatusCalibrate = "Calibration measurement is running.";
+const std::string txtLastInterrupted = "The last measurement was interrupted.";
+const std::string txtValidData = "Measurement data can be read.";
+const std::string txtValidGain = "Calibration finished, measurement can be started.";
+const std::string txtOf = " of ";
+const std::string txtEnabled = "enabled";
+
+uint32_t be32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+/**
+ * Splits text at line breaks, empty lines are dropped.
+ */
+std::vector<std::string> splitLines(const std::string &text) {
+    std::vector<std::string> lines;
+    std::size_t pos = 0;
+    while(pos < text.size()) {
+        std::size_t end = text.find_first_of("\r\n", pos);
+        if(end == std::string::npos) {
+            end = text.size();
+        }
+        if(end > pos) {
+            lines.push_back(text.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+    return lines;
+}
+
+bool startsWith(const std::string &str, const std::string &prefix) {
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::exception_ptr deviceError(const std::string &text) {
+    return std::make_exception_ptr(DeviceError(text.empty() ? "No response" : text));
+}
+
+/**
+ * Makes a callback for commands that print nothing on success (or only the accepted text) and an error otherwise.
+ */
+Callback<std::string> expect(Done done, const std::string &accept = std::string()) {
+    return [done = std::move(done), accept](std::string text, std::exception_ptr error) {
+        if(!error && text != accept) {
+            error = deviceError(text);
+        }
+        done(error);
+    };
+}
+
+/**
+ * Parses a number after the specified prefix.
+ */
+uint32_t parseAfter(const std::string &line, const std::string &prefix) {
+    return static_cast<uint32_t>(std::strtoul(line.c_str() + prefix.size(), nullptr, 10));
+}
+
+/**
+ * Parses the output of `board get all`.
+ */
+SweepSettings parseSettings(const std::string &text) {
+    SweepSettings settings;
+    for(const std::string &line : splitLines(text)) {
+        std::size_t eq = line.find('=');
+        if(eq == std::string::npos) {
+            throw DeviceError(line);
+        }
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        unsigned long num = std::strtoul(value.c_str(), nullptr, 10);
+
+        if(key == "start") {
+            settings.start = static_cast<uint32_t>(num);
+        } else if(key == "stop") {
+            settings.stop = static_cast<uint32_t>(num);
+        } else if(key == "steps") {
+            settings.steps = static_cast<uint16_t>(num);
+        } else if(key == "settl") {
+            settings.settl = static_cast<uint16_t>(num);
+        } else if(key == "avg") {
+            settings.avg = static_cast<uint16_t>(num);
+        } else if(key == "autorange") {
+            settings.autorange = (value == txtEnabled);
+        } else if(key == "gain") {
+            settings.gain = (value == txtEnabled);
+        } else if(key == "voltage") {
+            settings.voltage = static_cast<uint16_t>(num);
+        } else if(key == "feedback") {
+            settings.feedback = static_cast<uint32_t>(num);
+        }
+    }
+    return settings;
+}
+
+/**
+ * Parses a number with an optional SI suffix as printed by the board (`10k`, `1M`), see `SiStringFromInt`.
+ */
+uint32_t parseSi(const std::string &str, std::size_t &pos) {
+    char *end;
+    unsigned long num = std::strtoul(str.c_str() + pos, &end, 10);
+    pos = static_cast<std::size_t>(end - str.c_str());
+    if(pos < str.size() && str[pos] == 'k') {
+        num *= 1000;
+        pos++;
+    } else if(pos < str.size() && str[pos] == 'M') {
+        num *= 1000000;
+        pos++;
+    }
+    return static_cast<uint32_t>(num);
+}
+
+/**
+ * Parses the values after a tag like `(rfb)` separated by spaces.
+ */
+std::vector<uint32_t> parseSiList(const std::string &line, std::size_t pos) {
+    std::vector<uint32_t> values;
+    while((pos = line.find_first_of("0123456789", pos)) != std::string::npos) {
+        values.push_back(parseSi(line, pos));
+    }
+    return values;
+}
+
+/**
+ * Parses the output of `board info`, each value follows a tag in parentheses.
+ */
+BoardInfo parseInfo(const std::string &text) {
+    BoardInfo info;
+    info.lines = splitLines(text);
+
+    bool found = false;
+    for(const std::string &line : info.lines) {
+        auto tag = [&line](const char *name) {
+            std::size_t pos = line.find(name);
+            return (pos == std::string::npos ? pos : pos + std::strlen(name));
+        };
+        std::size_t pos;
+        if((pos = tag("(out) ")) != std::string::npos) {
+            info.ports = parseSi(line, pos);
+            found = true;
+        } else if((pos = tag("(frq) ")) != std::string::npos) {
+            info.minFrequency = parseSi(line, pos);
+            pos = line.find("..", pos);
+            if(pos != std::string::npos) {
+                pos += 2;
+                info.maxFrequency = parseSi(line, pos);
+            }
+        } else if((pos = tag("(inc) ")) != std::string::npos) {
+            info.maxSteps = parseSi(line, pos);
+        } else if((pos = tag("(att) ")) != std::string::npos) {
+            info.attenuations = parseSiList(line, pos);
+        } else if((pos = tag("(rfb) ")) != std::string::npos) {
+            info.feedbackResistors = parseSiList(line, pos);
+        } else if((pos = tag("(rca) ")) != std::string::npos) {
+            info.calibrationValues = parseSiList(line, pos);
+        }
+    }
+    if(!found) {
+        throw DeviceError(info.lines.empty() ? "No response" : info.lines.front());
+    }
+    return info;
+}
+
+/**
+ * Parses the output of `board status`.
+ */
+Status parseStatus(const std::string &text) {
+    Status status;
+    status.lines = splitLines(text);
+    if(status.lines.empty()) {
+        throw DeviceError("No response");
+    }
+
+    for(const std::string &line : status.lines) {
+        if(startsWith(line, txtAdStatusSweep)) {
+            status.state = MeasurementState::Sweep;
+            status.point = parseAfter(line, txtAdStatusSweep);
+            std::size_t of = line.find(txtOf, txtAdStatusSweep.size());
+            if(of != std::string::npos) {
+                status.totalPoints = parseAfter(line.substr(of), txtOf);
+            }
+        } else if(startsWith(line, txtAdStatusFinishImpedance)) {
+            status.state = MeasurementState::Finished;
+            status.point = parseAfter(line, txtAdStatusFinishImpedance);
+        } else if(line == txtAdStatusIdle) {
+            status.state = MeasurementState::Idle;
+        } else if(line == txtAdStatusTemp) {
+            status.state = MeasurementState::Temperature;
+        } else if(line == txtAdStatusCalibrate) {
+            status.state = MeasurementState::Calibration;
+        } else if(line == txtLastInterrupted) {
+            status.interrupted = true;
+        } else if(line == txtValidData) {
+            status.validData = true;
+        } else if(line == txtValidGain) {
+            status.validGain = true;
+        }
+    }
+    return status;
+}
+
+/**
+ * Builds the `board set` command line for the specified settings.
+ *
+ * The board checks start and stop frequency against each other while processing the options, so they need to be
+ * ordered depending on the current settings (see 'help options'). The settings that need a new calibration are only
+ * sent if they change, so older firmware doesn't discard the gain factor for the same values.
+ */
+std::string setCommand(const SweepSettings &settings, const SweepSettings &current) {
+    std::string start = " --start=" + std::to_string(settings.start);
+    std::string stop = " --stop=" + std::to_string(settings.stop);
+
+    // Settling cycles are a 9 bit number and a multiplier of 1, 2 or 4
+    unsigned num = settings.settl;
+    unsigned mult = 1;
+    while(num > 511 && mult < 4) {
+        num /= 2;
+        mult *= 2;
+    }
+    num = std::min(num, 511u);
+
+    std::string cmd = "board set";
+    if(settings.start != current.start || settings.stop != current.stop) {
+        cmd += (settings.start >= current.stop ? stop + start : start + stop);
+    }
+    cmd += " --steps=" + std::to_string(settings.steps);
+    cmd += " --settl=" + std::to_string(num) + "x" + std::to_string(mult);
+    cmd += " --avg=" + std::to_string(settings.avg);
+    cmd += std::string(" --autorange=") + (settings.autorange ? "on" : "off");
+    if(settings.voltage) {
+        cmd += " --voltage=" + std::to_string(*settings.voltage);
+    }
+    if(settings.feedback && settings.feedback != current.feedback) {
+        cmd += " --feedback=" + std::to_string(*settings.feedback);
+    }
+    if(settings.gain && settings.gain != current.gain) {
+        cmd += std::string(" --gain=") + (*settings.gain ? "on" : "off");
+    }
+    return cmd;
+}
+
+/**
+ * Makes a callback that decodes binary data with the specified function.
+ */
+template<typename T>
+Callback<std::vector<uint8_t>> decodeWith(Callback<T> callback, T (*decode)(const uint8_t*, std::size_t)) {
+    return [callback = std::move(callback), decode](std::vector<uint8_t> data, std::exception_ptr error) {
+        T value;
+        if(!error) {
+            try {
+                value = decode(data.data(), data.size());
+            } catch(...) {
+                error = std::current_exception();
+            }
+        }
+        callback(std::move(value), error);
+    };
+}
+
+} // namespace
+
+/**
+ * Opens the port of a board and registers it with the event loop.
+ *
+ * @param loop The loop that will drive the device
+ * @param path Path of the serial port, for example `/dev/ttyACM0`
+ */
+Device::Device(EventLoop &loop, const std::string &path) : m_loop(loop), m_port(path) {
+    m_loop.add(m_port.fd(), EPOLLIN, [this](uint32_t events) { onEvents(events); });
+}
+
+Device::~Device() {
+    if(m_timer) {
+        m_loop.cancelTimer(*m_timer);
+    }
+    if(m_port.fd() >= 0) {
+        m_loop.remove(m_port.fd());
+    }
+}
+
+/**
+ * Queues a command with a text response.
+ *
+ * @param line The command line, without line break
+ * @param callback Called with the response text, line breaks at the end removed
+ * @param timeout Maximum time from sending the command to the end of the response, {@link NO_TIMEOUT} for none
+ */
+void Device::command(const std::string &line, Callback<std::string> callback, Clock::duration timeout) {
+    submit(Request{line, 0, timeout, true, [callback = std::move(callback)](Reply reply, std::exception_ptr error) {
+        std::string &text = reply.text;
+        text.erase(text.find_last_not_of("\r\n") + 1);
+        callback(std::move(text), error);
+    }});
+}
+
+/**
+ * Queues a command with a binary response (with byte count), such as `board read --format=BP`.
+ *
+ * @param line The command line, without line break
+ * @param recordSize Size of a record, used to tell data from an error message
+ * @param callback Called with the data, without byte count
+ */
+void Device::readBinary(const std::string &line, std::size_t recordSize, Callback<std::vector<uint8_t>> callback) {
+    submit(Request{line, recordSize, DEFAULT_TIMEOUT, true,
+            [callback = std::move(callback)](Reply reply, std::exception_ptr error) {
+        if(!error && !reply.text.empty()) {
+            error = deviceError(reply.text.substr(0, reply.text.find_last_not_of("\r\n") + 1));
+        }
+        callback(std::move(reply.data), error);
+    }});
+}
+
+/**
+ * Gets the current sweep settings (`board get all`).
+ */
+void Device::getSettings(Callback<SweepSettings> callback) {
+    command("board get all", [callback = std::move(callback)](std::string text, std::exception_ptr error) {
+        SweepSettings settings;
+        if(!error) {
+            try {
+                settings = parseSettings(text);
+            } catch(...) {
+                error = std::current_exception();
+            }
+        }
+        callback(settings, error);
+    });
+}
+
+/**
+ * Sets the sweep parameters (`board set`).
+ *
+ * This queues `board get all` first, because the order of start and stop frequency depends on the current settings.
+ * The `board set` line is queued right behind it, but only completed and sent once the settings have been received.
+ */
+void Device::setSweep(const SweepSettings &settings, Done done) {
+    submit(Request{"board get all", 0, DEFAULT_TIMEOUT, true,
+            [this, settings](Reply reply, std::exception_ptr error) {
+        // The set command is next in the queue, unless the device failed
+        if(m_failure) {
+            return;
+        }
+        if(!error) {
+            try {
+                m_queue.front().line = setCommand(settings, parseSettings(reply.text));
+                m_queue.front().ready = true;
+                sendNext();
+                return;
+            } catch(...) {
+                error = std::current_exception();
+            }
+        }
+        complete(Reply(), error);
+    }});
+
+    Callback<std::string> check = expect(std::move(done));
+    submit(Request{std::string(), 0, DEFAULT_TIMEOUT, false,
+            [check = std::move(check)](Reply reply, std::exception_ptr error) {
+        reply.text.erase(reply.text.find_last_not_of("\r\n") + 1);
+        check(std::move(reply.text), error);
+    }});
+}
+
+/**
+ * Starts a frequency sweep on the specified port (`board start`).
+ */
+void Device::start(unsigned port, Done done) {
+    command("board start " + std::to_string(port), expect(std::move(done), txtOK));
+}
+
+/**
+ * Stops a running sweep (`board stop`), not running a sweep is not an error.
+ */
+void Device::stop(Done done) {
+    command("board stop", [done = std::move(done)](std::string text, std::exception_ptr error) {
+        if(!error && text != txtOK && text != txtAdStatusIdle) {
+            error = deviceError(text);
+        }
+        done(error);
+    });
+}
+
+/**
+ * Gets the capabilities of the board (`board info`).
+ */
+void Device::info(Callback<BoardInfo> callback) {
+    command("board info", [callback = std::move(callback)](std::string text, std::exception_ptr error) {
+        BoardInfo info;
+        if(!error) {
+            try {
+                info = parseInfo(text);
+            } catch(...) {
+                error = std::current_exception();
+            }
+        }
+        callback(std::move(info), error);
+    });
+}
+
+/**
+ * Gets the measurement status (`board status`).
+ */
+void Device::status(Callback<Status> callback) {
+    command("board status", [callback = std::move(callback)](std::string text, std::exception_ptr error) {
+        Status status;
+        if(!error) {
+            try {
+                status = parseStatus(text);
+            } catch(...) {
+                error = std::current_exception();
+            }
+        }
+        callback(std::move(status), error);
+    });
+}
+
+/**
+ * Waits for a running sweep to finish (`board wait`).
+ *
+ * @param callback Called with the number of points measured, `0` if no sweep was running or finished
+ */
+void Device::wait(Callback<uint32_t> callback) {
+    command("board wait", [callback = std::move(callback)](std::string text, std::exception_ptr error) {
+        uint32_t points = 0;
+        if(!error) {
+            if(startsWith(text, txtAdStatusFinishImpedance)) {
+                points = parseAfter(text, txtAdStatusFinishImpedance);
+            } else if(text != txtAdStatusIdle) {
+                error = deviceError(text);
+            }
+        }
+        callback(points, error);
+    }, NO_TIMEOUT);
+}
+
+/**
+ * Performs a calibration with the specified resistor (`board calibrate`).
+ */
+void Device::calibrate(uint32_t ohms, Done done) {
+    command("board calibrate " + std::to_string(ohms), expect(std::move(done), txtOK), CALIBRATE_TIMEOUT);
+}
+
+/**
+ * Measures the AD5933 temperature (`board temp`).
+ *
+ * @param callback Called with the temperature in degrees Celsius
+ */
+void Device::temperature(Callback<float> callback) {
+    command("board temp", [callback = std::move(callback)](std::string text, std::exception_ptr error) {
+        float temp = 0;
+        if(!error) {
+            char *end;
+            temp = std::strtof(text.c_str(), &end);
+            if(end == text.c_str()) {
+                error = deviceError(text);
+            }
+        }
+        callback(temp, error);
+    });
+}
+
+/**
+ * Reads measurement data in polar coordinates.
+ */
+void Device::readPolar(Callback<PolarData> callback) {
+    readBinary("board read --format=BPH", IMPEDANCE_RECORD_SIZE, decodeWith(std::move(callback), decodePolar));
+}
+
+/**
+ * Reads measurement data in cartesian coordinates.
+ */
+void Device::readCartesian(Callback<CartesianData> callback) {
+    readBinary("board read --format=BCH", IMPEDANCE_RECORD_SIZE,
+            decodeWith(std::move(callback), decodeCartesian));
+}
+
+/**
+ * Reads raw AD5933 data.
+ */
+void Device::readRaw(Callback<RawData> callback) {
+    readBinary("board read --format=BH --raw", RAW_RECORD_SIZE, decodeWith(std::move(callback), decodeRaw));
+}
+
+/**
+ * Reads the features of the last sweep, which is much less data than the sweep itself.
+ */
+void Device::readFeatures(Callback<SweepFeatures> callback) {
+    readBinary("board read --format=BH --features", FEATURES_RECORD_SIZE,
+            decodeWith(std::move(callback), decodeFeatures));
+}
+
+/**
+ * Reads the counters the board keeps since reset (`board telemetry binary`).
+ */
+void Device::telemetry(Callback<Telemetry> callback) {
+    readBinary("board telemetry binary", TELEMETRY_WORD_SIZE, decodeWith(std::move(callback), decodeTelemetry));
+}
+
+// Private --------------------------------------------------------------------
+
+void Device::submit(Request request) {
+    if(request.line.size() > MAX_LINE_LENGTH) {
+        throw std::invalid_argument("Command line too long: " + request.line);
+    }
+    if(m_failure) {
+        // Keep callbacks asynchronous, even for a failed device
+        m_loop.post([done = std::move(request.done), error = m_failure]() { done(Reply(), error); });
+        return;
+    }
+    m_queue.push_back(std::move(request));
+    sendNext();
+}
+
+/**
+ * Sends the next queued command if none is in progress.
+ */
+void Device::sendNext() {
+    if(m_sent || m_queue.empty() || !m_queue.front().ready || m_failure) {
+        return;
+    }
+
+    const Request &request = m_queue.front();
+    m_tx = "$" + request.line + "\n";
+    m_txPos = 0;
+    m_sent = true;
+    if(request.timeout != NO_TIMEOUT) {
+        m_timer = m_loop.addTimer(request.timeout, [this]() {
+            m_timer.reset();
+            fail(std::make_exception_ptr(IoError("Timeout on " + path() + ": " + m_queue.front().line)));
+        });
+    }
+    writePending();
+}
+
+void Device::writePending() {
+    try {
+        m_txPos += m_port.write(reinterpret_cast<const uint8_t *>(m_tx.data()) + m_txPos, m_tx.size() - m_txPos);
+        m_loop.modify(m_port.fd(), (m_txPos < m_tx.size() ? EPOLLIN | EPOLLOUT : EPOLLIN));
+    } catch(...) {
+        fail(std::current_exception());
+    }
+}
+
+void Device::onEvents(uint32_t events) {
+    if(events & EPOLLOUT) {
+        writePending();
+    }
+    if(m_failure) {
+        return;
+    }
+
+    if(events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        uint8_t buf[4096];
+        try {
+            std::size_t len;
+            while((len = m_port.read(buf, sizeof(buf))) > 0) {
+                m_rx.insert(m_rx.end(), buf, buf + len);
+            }
+        } catch(...) {
+            fail(std::current_exception());
+            return;
+        }
+
+        Reply reply;
+        while(m_sent && parseReply(reply)) {
+            complete(std::move(reply), nullptr);
+            reply = Reply();
+        }
+        if(!m_sent && !m_rx.empty()) {
+            // Output nobody asked for (e.g. from a previous session), drop it
+            m_rx.clear();
+        }
+    }
+}
+
+/**
+ * Extracts the reply to the command in progress from the receive buffer, if it is complete.
+ *
+ * @return `true` if a reply was extracted
+ */
+bool Device::parseReply(Reply &reply) {
+    const Request &request = m_queue.front();
+    std::size_t end = 0;
+
+    if(request.recordSize > 0) {
+        if(m_rx.size() < 4) {
+            return false;
+        }
+        uint32_t count = be32(m_rx.data());
+        if(count <= MAX_READ_SIZE && count % request.recordSize == 0) {
+            if(m_rx.size() < 4 + count + 1) {
+                return false;
+            }
+            if(m_rx[4 + count] != END_OF_RESPONSE) {
+                fail(std::make_exception_ptr(ProtocolError("Missing end of response after binary data from " +
+                        path())));
+                return false;
+            }
+            reply.data.assign(m_rx.begin() + 4, m_rx.begin() + 4 + count);
+            end = 4 + count;
+            m_rx.erase(m_rx.begin(), m_rx.begin() + end + 1);
+            return true;
+        }
+        // Errors detected before the format is known are sent as text, handled below
+    }
+
+    auto it = std::find(m_rx.begin(), m_rx.end(), END_OF_RESPONSE);
+    if(it == m_rx.end()) {
+        return false;
+    }
+    reply.text.assign(m_rx.begin(), it);
+    m_rx.erase(m_rx.begin(), it + 1);
+    return true;
+}
+
+/**
+ * Finishes the command in progress, sends the next one and calls the callback.
+ */
+void Device::complete(Reply reply, std::exception_ptr error) {
+    if(m_timer) {
+        m_loop.cancelTimer(*m_timer);
+        m_timer.reset();
+    }
+    Request request = std::move(m_queue.front());
+    m_queue.pop_front();
+    m_sent = false;
+
+    // Keep the board busy while the host processes the result
+    sendNext();
+    request.done(std::move(reply), error);
+}
+
+/**
+ * Closes the port and fails all queued commands.
+ */
+void Device::fail(std::exception_ptr error) {
+    if(m_failure) {
+        return;
+    }
+    m_failure = error;
+    if(m_timer) {
+        m_loop.cancelTimer(*m_timer);
+        m_timer.reset();
+    }
+    m_loop.remove(m_port.fd());
+    m_port.close();
+    m_sent = false;
+
+    std::deque<Request> queue;
+    queue.swap(m_queue);
+    for(Request &request : queue) {
+        request.done(Reply(), error);
+    }
+}
+
+} // namespace impy
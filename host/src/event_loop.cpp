@@ -0,0 +1,238 @@
+/**
+ * @file    event_loop.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Single threaded event loop based on epoll, drives any number of devices.
+ */
+
+#include "impy/event_loop.hpp"
+#include "impy/serial.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace impy {
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+
+IoError systemError(const char *what) {
+    return IoError(std::string(what) + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+EventLoop::EventLoop() {
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if(m_epoll < 0) {
+        throw systemError("epoll_create1");
+    }
+    m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_wakeup < 0) {
+        IoError err = systemError("eventfd");
+        ::close(m_epoll);
+        throw err;
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeup;
+    if(epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &ev) != 0) {
+        IoError err = systemError("epoll_ctl");
+        ::close(m_wakeup);
+        ::close(m_epoll);
+        throw err;
+    }
+}
+
+EventLoop::~EventLoop() {
+    ::close(m_wakeup);
+    ::close(m_epoll);
+}
+
+/**
+ * Starts watching a file descriptor.
+ *
+ * @param fd The file descriptor, needs to be non-blocking
+ * @param events The events to wait for (`EPOLLIN`, `EPOLLOUT`)
+ * @param handler Called when any of the events occur, or on errors (`EPOLLERR`, `EPOLLHUP`)
+ */
+void EventLoop::add(int fd, uint32_t events, IoHandler handler) {
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    if(epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        throw systemError("epoll_ctl");
+    }
+    m_handlers[fd] = std::make_shared<IoHandler>(std::move(handler));
+}
+
+/**
+ * Changes the events a file descriptor is watched for.
+ */
+void EventLoop::modify(int fd, uint32_t events) {
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    if(epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        throw systemError("epoll_ctl");
+    }
+}
+
+/**
+ * Stops watching a file descriptor, needs to be called before it is closed.
+ */
+void EventLoop::remove(int fd) {
+    if(m_handlers.erase(fd) != 0) {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+/**
+ * Calls a task once after the specified delay.
+ *
+ * @return Identifier to cancel the timer with
+ */
+EventLoop::TimerId EventLoop::addTimer(Clock::duration delay, Task task) {
+    TimerId id = m_nextTimer++;
+    auto it = m_timers.emplace(Clock::now() + delay, id);
+    m_timerTasks.emplace(id, std::make_pair(it, std::move(task)));
+    return id;
+}
+
+/**
+ * Cancels a timer, does nothing if it has already expired.
+ */
+void EventLoop::cancelTimer(TimerId id) {
+    auto it = m_timerTasks.find(id);
+    if(it != m_timerTasks.end()) {
+        m_timers.erase(it->second.first);
+        m_timerTasks.erase(it);
+    }
+}
+
+/**
+ * Queues a task to be called on the loop thread, this can be called from any thread.
+ */
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_postLock);
+        m_posted.push_back(std::move(task));
+    }
+    wake();
+}
+
+/**
+ * Waits for events once and calls the handlers for all of them, as well as expired timers and posted tasks.
+ *
+ * @param timeoutMs Maximum time to wait in milliseconds, `-1` to wait until something happens
+ * @return `false` if {@link stop} was called, `true` otherwise
+ */
+bool EventLoop::runOnce(int timeoutMs) {
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(m_epoll, events, MAX_EVENTS, nextTimeout(timeoutMs));
+    if(count < 0 && errno != EINTR) {
+        throw systemError("epoll_wait");
+    }
+
+    for(int j = 0; j < count; j++) {
+        int fd = events[j].data.fd;
+        if(fd == m_wakeup) {
+            uint64_t value;
+            while(::read(m_wakeup, &value, sizeof(value)) > 0) {
+            }
+            continue;
+        }
+
+        // Keep the handler alive even if it removes itself
+        auto it = m_handlers.find(fd);
+        if(it != m_handlers.end()) {
+            std::shared_ptr<IoHandler> handler = it->second;
+            (*handler)(events[j].events);
+        }
+    }
+
+    runTimers();
+    runPosted();
+
+    if(m_stopped) {
+        m_stopped = false;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Runs the loop until {@link stop} is called.
+ */
+void EventLoop::run() {
+    while(runOnce()) {
+    }
+}
+
+/**
+ * Runs the loop until the specified condition is met (checked after each iteration), or {@link stop} is called.
+ */
+void EventLoop::runUntil(const std::function<bool()> &done) {
+    while(!done() && runOnce()) {
+    }
+}
+
+/**
+ * Makes {@link run} return after the current iteration, this can be called from any thread.
+ */
+void EventLoop::stop() {
+    post([this]() { m_stopped = true; });
+}
+
+/**
+ * Gets the epoll timeout, taking the next timer into account.
+ */
+int EventLoop::nextTimeout(int timeoutMs) const {
+    if(m_timers.empty()) {
+        return timeoutMs;
+    }
+
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(m_timers.begin()->first - Clock::now()).count();
+    wait = std::max<decltype(wait)>(wait, 0);
+    if(timeoutMs >= 0 && timeoutMs < wait) {
+        return timeoutMs;
+    }
+    return static_cast<int>(std::min<decltype(wait)>(wait, INT32_MAX));
+}
+
+void EventLoop::runTimers() {
+    Clock::time_point now = Clock::now();
+    while(!m_timers.empty() && m_timers.begin()->first <= now) {
+        TimerId id = m_timers.begin()->second;
+        m_timers.erase(m_timers.begin());
+        auto it = m_timerTasks.find(id);
+        Task task = std::move(it->second.second);
+        m_timerTasks.erase(it);
+        task();
+    }
+}
+
+void EventLoop::runPosted() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_postLock);
+        tasks.swap(m_posted);
+    }
+    for(Task &task : tasks) {
+        task();
+    }
+}
+
+void EventLoop::wake() {
+    uint64_t one = 1;
+    ssize_t ret = ::write(m_wakeup, &one, sizeof(one));
+    (void)ret;
+}
+
+} // namespace impy
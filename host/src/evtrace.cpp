@@ -0,0 +1,319 @@
+/**
+ * @file    evtrace.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoder for event traces recorded by the firmware.
+ */
+
+#include "impy/evtrace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace impy {
+
+namespace {
+
+// Values from monitor.h
+constexpr uint8_t MON_IRQ_TIM3 = 3;
+constexpr uint8_t MON_IRQ_OTG_FS = 4;
+
+uint16_t be16(const uint8_t *p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+std::vector<uint8_t> readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw EventTraceError("Cannot open " + path);
+    }
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Unwraps 32 bit cycle counter values into a monotonic count starting at the first value.
+ *
+ * This assumes consecutive events are less than one counter period apart (about 35 s at 120MHz), which holds as long
+ * as TIM3 interrupts are traced.
+ */
+class Unwrapper
+{
+public:
+    uint64_t operator()(uint32_t value) {
+        if(m_first) {
+            m_first = false;
+            m_origin = value;
+        } else if(value < m_last) {
+            m_base += UINT64_C(1) << 32;
+        }
+        m_last = value;
+        return m_base + value - m_origin;
+    }
+
+private:
+    bool m_first = true;
+    uint32_t m_origin = 0;
+    uint32_t m_last = 0;
+    uint64_t m_base = 0;
+};
+
+} // namespace
+
+/**
+ * Decodes a binary trace dump, including the leading byte count.
+ *
+ * @param data Pointer to the dump
+ * @param size Size of the dump in bytes
+ * @return The decoded trace
+ */
+EventTrace decodeEventTrace(const uint8_t *data, std::size_t size) {
+    constexpr std::size_t header = 4 + 16;
+    if(size < header) {
+        throw EventTraceError("Event trace too short");
+    }
+
+    uint32_t bytes = be32(data);
+    uint16_t version = be16(data + 4);
+    uint16_t recordSize = be16(data + 6);
+    uint32_t count = be32(data + 8);
+    if(bytes + 4 != size) {
+        throw EventTraceError("Event trace byte count does not match size");
+    }
+    if(version != EVENT_TRACE_VERSION || recordSize != EVENT_RECORD_SIZE) {
+        throw EventTraceError("Unsupported event trace format version " + std::to_string(version));
+    }
+    if(header + static_cast<std::size_t>(count) * recordSize != size) {
+        throw EventTraceError("Event trace record count does not match size");
+    }
+
+    EventTrace trace;
+    trace.dropped = be32(data + 12);
+    trace.clock = be32(data + 16);
+    if(trace.clock == 0) {
+        throw EventTraceError("Event trace has no clock frequency");
+    }
+    trace.events.reserve(count);
+    Unwrapper unwrap;
+    for(const uint8_t *p = data + header; p < data + size; p += recordSize) {
+        Event ev;
+        ev.cycles = unwrap(be32(p));
+        ev.type = static_cast<EventType>(p[4]);
+        ev.arg8 = p[5];
+        ev.arg = be16(p + 6);
+        trace.events.push_back(ev);
+    }
+    return trace;
+}
+
+/**
+ * Decodes the events from a raw SWO capture of the ITM packet stream (for example saved by OpenOCD with
+ * `tpiu config internal <file> uart off <clock>`).
+ *
+ * Each event is a timestamp word on stimulus port {@link EVENT_ITM_PORT} followed by a word with the rest of the record
+ * on the next port. Packets on other ports and protocol packets are skipped, a word on the second port without a
+ * preceding timestamp is discarded.
+ *
+ * @param data Pointer to the captured data
+ * @param size Size of the data in bytes
+ * @param clock Core clock frequency in Hz
+ * @return The decoded trace
+ */
+EventTrace decodeSwoTrace(const uint8_t *data, std::size_t size, uint32_t clock) {
+    if(clock == 0) {
+        throw EventTraceError("Clock frequency must not be 0");
+    }
+
+    EventTrace trace;
+    trace.clock = clock;
+    Unwrapper unwrap;
+    bool pending = false;
+    uint32_t timestamp = 0;
+
+    std::size_t j = 0;
+    while(j < size) {
+        uint8_t hdr = data[j++];
+        if(hdr == 0x70) {
+            // Overflow, at least one packet was lost
+            trace.dropped++;
+            pending = false;
+            continue;
+        }
+        if(hdr == 0x00) {
+            // Synchronization packet, zeros followed by 0x80
+            while(j < size && data[j] == 0x00) {
+                j++;
+            }
+            if(j < size && data[j] == 0x80) {
+                j++;
+            }
+            continue;
+        }
+        if((hdr & 0x03) == 0) {
+            // Protocol packet (timestamp, extension), skip the continuation bytes
+            if(hdr & 0x80) {
+                while(j < size && (data[j++] & 0x80))
+                    ;
+            }
+            continue;
+        }
+
+        std::size_t length = ((hdr & 0x03) == 3 ? 4 : (hdr & 0x03));
+        if(j + length > size) {
+            break;
+        }
+        uint32_t value = 0;
+        for(std::size_t k = 0; k < length; k++) {
+            value |= static_cast<uint32_t>(data[j + k]) << (8 * k);
+        }
+        j += length;
+
+        // Hardware source packets (DWT) have bit 2 set
+        unsigned port = hdr >> 3;
+        if((hdr & 0x04) || length != 4) {
+            continue;
+        }
+        if(port == EVENT_ITM_PORT) {
+            timestamp = value;
+            pending = true;
+        } else if(port == EVENT_ITM_PORT + 1 && pending) {
+            Event ev;
+            ev.cycles = unwrap(timestamp);
+            ev.type = static_cast<EventType>(value & 0xFF);
+            ev.arg8 = static_cast<uint8_t>(value >> 8);
+            ev.arg = static_cast<uint16_t>(value >> 16);
+            trace.events.push_back(ev);
+            pending = false;
+        }
+    }
+    return trace;
+}
+
+/**
+ * Loads a binary trace dump from a file.
+ */
+EventTrace loadEventTrace(const std::string &path) {
+    std::vector<uint8_t> buf = readFile(path);
+    return decodeEventTrace(buf.data(), buf.size());
+}
+
+/**
+ * Loads a raw SWO capture from a file, see {@link decodeSwoTrace}.
+ */
+EventTrace loadSwoTrace(const std::string &path, uint32_t clock) {
+    std::vector<uint8_t> buf = readFile(path);
+    return decodeSwoTrace(buf.data(), buf.size(), clock);
+}
+
+/**
+ * Pairs start and end events into the intervals in which each activity was running.
+ *
+ * End events without a start (the start was overwritten on the device) and starts that never end are skipped.
+ *
+ * @param trace The trace
+ * @return The intervals, ordered by their end
+ */
+std::vector<Span> eventSpans(const EventTrace &trace) {
+    std::vector<Span> spans;
+    // I2C transfers can be nested when an interrupt preempts a transfer, so keep a stack for each lane
+    std::vector<uint64_t> open[LANE_COUNT];
+
+    auto begin = [&](Lane lane, uint64_t cycles) {
+        open[static_cast<std::size_t>(lane)].push_back(cycles);
+    };
+    auto end = [&](Lane lane, uint64_t cycles) {
+        std::vector<uint64_t> &stack = open[static_cast<std::size_t>(lane)];
+        if(!stack.empty()) {
+            spans.push_back(Span{ lane, stack.back(), cycles });
+            stack.pop_back();
+        }
+    };
+
+    for(const Event &ev : trace.events) {
+        switch(ev.type) {
+            case EventType::IsrEnter:
+            case EventType::IsrExit: {
+                Lane lane;
+                if(ev.arg8 == MON_IRQ_TIM3) {
+                    lane = Lane::Tim3;
+                } else if(ev.arg8 == MON_IRQ_OTG_FS) {
+                    lane = Lane::Usb;
+                } else {
+                    break;
+                }
+                if(ev.type == EventType::IsrEnter) {
+                    begin(lane, ev.cycles);
+                } else {
+                    end(lane, ev.cycles);
+                }
+                break;
+            }
+            case EventType::I2CStart:
+                begin(Lane::I2C, ev.cycles);
+                break;
+            case EventType::I2CDone:
+                end(Lane::I2C, ev.cycles);
+                break;
+            case EventType::CommandStart:
+                // A new command line means the previous command has finished, even if the finish was lost
+                open[static_cast<std::size_t>(Lane::Command)].clear();
+                begin(Lane::Command, ev.cycles);
+                break;
+            case EventType::CommandFinish:
+                end(Lane::Command, ev.cycles);
+                break;
+            default:
+                break;
+        }
+    }
+    return spans;
+}
+
+/**
+ * Gets a short name for an event type.
+ */
+const char* eventTypeName(EventType type) {
+    switch(type) {
+        case EventType::IsrEnter:
+            return "isr-enter";
+        case EventType::IsrExit:
+            return "isr-exit";
+        case EventType::I2CStart:
+            return "i2c-start";
+        case EventType::I2CDone:
+            return "i2c-done";
+        case EventType::PointStored:
+            return "point";
+        case EventType::UsbPacket:
+            return "usb-packet";
+        case EventType::CommandStart:
+            return "cmd-start";
+        case EventType::CommandFinish:
+            return "cmd-finish";
+    }
+    return "unknown";
+}
+
+/**
+ * Gets a short name for a lane.
+ */
+const char* laneName(Lane lane) {
+    switch(lane) {
+        case Lane::Tim3:
+            return "TIM3";
+        case Lane::Usb:
+            return "USB";
+        case Lane::I2C:
+            return "I2C";
+        case Lane::Command:
+            return "command";
+    }
+    return "unknown";
+}
+
+} // namespace impy
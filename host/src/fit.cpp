@@ -0,0 +1,575 @@
+/**
+ * @file    fit.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Levenberg-Marquardt fitting of equivalent circuit models to impedance spectra, for single sweeps or batches.
+ *
+ * Positive parameters are fitted as their logarithm, which keeps them positive and makes the problem much better
+ * conditioned over the decades a spectrum spans. Residuals are relative to |Z| (modulus weighting). The models are
+ * evaluated with their analytic Jacobian in plain loops over separate arrays of real and imaginary parts, without
+ * std::complex, so the compiler can vectorize them.
+ */
+
+#include "impy/fit.hpp"
+#include "impy/sweep_store.hpp"
+#include "impy/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace impy {
+
+namespace {
+
+constexpr double HALF_PI = 1.5707963267948966;
+constexpr double LAMBDA_START = 1e-3;
+constexpr double LAMBDA_MAX = 1e12;
+/** Fitted logarithms are kept in this range, so exp() can't overflow. */
+constexpr double LOG_LIMIT = 200;
+
+using Parameters = std::array<double, FIT_MAX_PARAMETERS>;
+
+/**
+ * Spectrum prepared for fitting.
+ */
+struct Spectrum
+{
+    std::vector<double> omega;
+    std::vector<double> logOmega;
+    std::vector<double> real;
+    std::vector<double> imag;
+    std::vector<double> weight;         //!< 1 / |Z|
+
+    std::size_t size() const { return omega.size(); }
+};
+
+/**
+ * Model values and Jacobian (with respect to the fitted parameters) for a spectrum.
+ */
+struct Workspace
+{
+    std::vector<double> real;
+    std::vector<double> imag;
+    std::array<std::vector<double>, FIT_MAX_PARAMETERS> jacReal;
+    std::array<std::vector<double>, FIT_MAX_PARAMETERS> jacImag;
+
+    void resize(std::size_t n) {
+        real.resize(n);
+        imag.resize(n);
+        for(std::size_t k = 0; k < FIT_MAX_PARAMETERS; k++) {
+            jacReal[k].resize(n);
+            jacImag[k].resize(n);
+        }
+    }
+};
+
+/** Points with invalid values (e.g. of interrupted sweeps) are dropped. */
+Spectrum prepare(const PolarData &data) {
+    Spectrum s;
+    for(std::size_t j = 0; j < data.size(); j++) {
+        double mag = data.magnitude[j];
+        double angle = data.angle[j];
+        if(!(mag > 0) || !std::isfinite(mag) || !std::isfinite(angle) || data.frequency[j] == 0) {
+            continue;
+        }
+        double omega = 2 * M_PI * data.frequency[j];
+        s.omega.push_back(omega);
+        s.logOmega.push_back(std::log(omega));
+        s.real.push_back(mag * std::cos(angle));
+        s.imag.push_back(mag * std::sin(angle));
+        s.weight.push_back(1 / mag);
+    }
+    return s;
+}
+
+/** Whether parameter `k` is fitted as its logarithm (all but the CPE exponent). */
+bool isLog(CircuitModel model, std::size_t k) {
+    return !(model == CircuitModel::RandlesCPE && k == 3);
+}
+
+Parameters toPhysical(CircuitModel model, const Parameters &theta) {
+    Parameters p = theta;
+    for(std::size_t k = 0; k < parameterCount(model); k++) {
+        if(isLog(model, k)) {
+            p[k] = std::exp(theta[k]);
+        }
+    }
+    return p;
+}
+
+Parameters toFitted(CircuitModel model, const Parameters &p) {
+    Parameters theta = p;
+    for(std::size_t k = 0; k < parameterCount(model); k++) {
+        if(isLog(model, k)) {
+            theta[k] = std::log(std::max(p[k], std::numeric_limits<double>::min()));
+        }
+    }
+    return theta;
+}
+
+void evalSeriesRC(const Parameters &p, const Spectrum &s, Workspace &ws, bool jacobian) {
+    const double r = p[0];
+    const double c = p[1];
+    const std::size_t n = s.size();
+    for(std::size_t j = 0; j < n; j++) {
+        ws.real[j] = r;
+        ws.imag[j] = -1 / (s.omega[j] * c);
+    }
+    if(jacobian) {
+        for(std::size_t j = 0; j < n; j++) {
+            ws.jacReal[0][j] = r;
+            ws.jacImag[0][j] = 0;
+            ws.jacReal[1][j] = 0;
+            ws.jacImag[1][j] = -ws.imag[j];
+        }
+    }
+}
+
+void evalSeriesRL(const Parameters &p, const Spectrum &s, Workspace &ws, bool jacobian) {
+    const double r = p[0];
+    const double l = p[1];
+    const std::size_t n = s.size();
+    for(std::size_t j = 0; j < n; j++) {
+        ws.real[j] = r;
+        ws.imag[j] = s.omega[j] * l;
+    }
+    if(jacobian) {
+        for(std::size_t j = 0; j < n; j++) {
+            ws.jacReal[0][j] = r;
+            ws.jacImag[0][j] = 0;
+            ws.jacReal[1][j] = 0;
+            ws.jacImag[1][j] = ws.imag[j];
+        }
+    }
+}
+
+/**
+ * Rs - (R || C), the Jacobian for R and C goes to columns `kr` and `kr + 1`. With Zp = 1 / (G + jB):
+ * dZp/dln(R) = Zp^2 / R and dZp/dln(C) = -Zp^2 jB.
+ *
+ * The Jacobian flag is a template parameter, so there are no branches in the loop.
+ */
+template<bool Jacobian>
+void evalRandles(double rs, double rct, double c, const Spectrum &s, Workspace &ws, std::size_t kr) {
+    const double g = 1 / rct;
+    const std::size_t n = s.size();
+    double *jr1 = ws.jacReal[kr].data();
+    double *ji1 = ws.jacImag[kr].data();
+    double *jr2 = ws.jacReal[kr + 1].data();
+    double *ji2 = ws.jacImag[kr + 1].data();
+    for(std::size_t j = 0; j < n; j++) {
+        double b = s.omega[j] * c;
+        double d = g * g + b * b;
+        double a = g / d;
+        double bi = -b / d;
+        ws.real[j] = rs + a;
+        ws.imag[j] = bi;
+        if(Jacobian) {
+            double a2 = a * a - bi * bi;
+            double b2 = 2 * a * bi;
+            jr1[j] = a2 * g;
+            ji1[j] = b2 * g;
+            jr2[j] = b2 * b;
+            ji2[j] = -a2 * b;
+        }
+    }
+}
+
+/**
+ * Rs - (Rct || CPE). With Yq = Q w^n (cos(n pi/2) + j sin(n pi/2)) and Zp = 1 / (G + Yq):
+ * dZp/dln(Q) = -Zp^2 Yq and dZp/dn = -Zp^2 Yq (ln(w) + j pi/2).
+ */
+template<bool Jacobian>
+void evalRandlesCPE(const Parameters &p, const Spectrum &s, Workspace &ws) {
+    const double rs = p[0];
+    const double g = 1 / p[1];
+    const double q = p[2];
+    const double e = p[3];
+    const double cs = std::cos(e * HALF_PI);
+    const double sn = std::sin(e * HALF_PI);
+    const std::size_t n = s.size();
+    for(std::size_t j = 0; j < n; j++) {
+        double mag = q * std::exp(e * s.logOmega[j]);
+        double yr = mag * cs;
+        double yi = mag * sn;
+        double gt = g + yr;
+        double d = gt * gt + yi * yi;
+        double a = gt / d;
+        double bi = -yi / d;
+        ws.real[j] = rs + a;
+        ws.imag[j] = bi;
+        if(Jacobian) {
+            double a2 = a * a - bi * bi;
+            double b2 = 2 * a * bi;
+            double tr = a2 * yr - b2 * yi;
+            double ti = a2 * yi + b2 * yr;
+            ws.jacReal[0][j] = rs;
+            ws.jacImag[0][j] = 0;
+            ws.jacReal[1][j] = a2 * g;
+            ws.jacImag[1][j] = b2 * g;
+            ws.jacReal[2][j] = -tr;
+            ws.jacImag[2][j] = -ti;
+            ws.jacReal[3][j] = -(tr * s.logOmega[j] - ti * HALF_PI);
+            ws.jacImag[3][j] = -(tr * HALF_PI + ti * s.logOmega[j]);
+        }
+    }
+}
+
+void evaluate(CircuitModel model, const Parameters &theta, const Spectrum &s, Workspace &ws, bool jacobian) {
+    Parameters p = toPhysical(model, theta);
+    switch(model) {
+    case CircuitModel::SeriesRC:
+        evalSeriesRC(p, s, ws, jacobian);
+        break;
+    case CircuitModel::SeriesRL:
+        evalSeriesRL(p, s, ws, jacobian);
+        break;
+    case CircuitModel::ParallelRC:
+        if(jacobian) {
+            evalRandles<true>(0, p[0], p[1], s, ws, 0);
+        } else {
+            evalRandles<false>(0, p[0], p[1], s, ws, 0);
+        }
+        break;
+    case CircuitModel::Randles:
+        if(jacobian) {
+            evalRandles<true>(p[0], p[1], p[2], s, ws, 1);
+        } else {
+            evalRandles<false>(p[0], p[1], p[2], s, ws, 1);
+        }
+        if(jacobian) {
+            std::fill(ws.jacReal[0].begin(), ws.jacReal[0].end(), p[0]);
+            std::fill(ws.jacImag[0].begin(), ws.jacImag[0].end(), 0);
+        }
+        break;
+    case CircuitModel::RandlesCPE:
+        if(jacobian) {
+            evalRandlesCPE<true>(p, s, ws);
+        } else {
+            evalRandlesCPE<false>(p, s, ws);
+        }
+        break;
+    }
+}
+
+double cost(const Spectrum &s, const Workspace &ws) {
+    double sum = 0;
+    for(std::size_t j = 0; j < s.size(); j++) {
+        double dr = (ws.real[j] - s.real[j]) * s.weight[j];
+        double di = (ws.imag[j] - s.imag[j]) * s.weight[j];
+        sum += dr * dr + di * di;
+    }
+    return sum;
+}
+
+/**
+ * Estimates the parameters from the shape of the spectrum.
+ */
+Parameters initialGuess(CircuitModel model, const Spectrum &s) {
+    std::size_t lo = 0;
+    std::size_t hi = 0;
+    std::size_t peak = 0;
+    for(std::size_t j = 1; j < s.size(); j++) {
+        if(s.omega[j] < s.omega[lo]) {
+            lo = j;
+        }
+        if(s.omega[j] > s.omega[hi]) {
+            hi = j;
+        }
+        if(-s.imag[j] > -s.imag[peak]) {
+            peak = j;
+        }
+    }
+    const double magLo = std::hypot(s.real[lo], s.imag[lo]);
+    const double tiny = 1e-6 * magLo;
+    const double realHi = std::max(s.real[hi], tiny);
+
+    Parameters p = {};
+    switch(model) {
+    case CircuitModel::SeriesRC:
+        p[0] = realHi;
+        p[1] = 1 / (s.omega[lo] * std::max(-s.imag[lo], tiny));
+        break;
+    case CircuitModel::SeriesRL:
+        p[0] = realHi;
+        p[1] = std::max(s.imag[hi], tiny) / s.omega[hi];
+        break;
+    case CircuitModel::ParallelRC:
+        p[0] = magLo;
+        p[1] = 1 / (s.omega[peak] * magLo);
+        break;
+    case CircuitModel::Randles:
+    case CircuitModel::RandlesCPE:
+        p[0] = std::min(realHi, 0.5 * magLo);
+        p[1] = std::max(s.real[lo] - p[0], 0.1 * magLo);
+        p[2] = 1 / (s.omega[peak] * p[1]);
+        p[3] = 0.9;
+        break;
+    }
+    return p;
+}
+
+/**
+ * Solves the (symmetric, positive definite) system `a x = b` by Cholesky decomposition.
+ *
+ * @return `false` if the matrix is not positive definite
+ */
+bool solve(std::size_t n, double a[FIT_MAX_PARAMETERS][FIT_MAX_PARAMETERS], const double *b, double *x) {
+    double l[FIT_MAX_PARAMETERS][FIT_MAX_PARAMETERS] = {};
+    for(std::size_t i = 0; i < n; i++) {
+        for(std::size_t j = 0; j <= i; j++) {
+            double sum = a[i][j];
+            for(std::size_t k = 0; k < j; k++) {
+                sum -= l[i][k] * l[j][k];
+            }
+            if(i == j) {
+                if(!(sum > 0)) {
+                    return false;
+                }
+                l[i][i] = std::sqrt(sum);
+            } else {
+                l[i][j] = sum / l[j][j];
+            }
+        }
+    }
+    double y[FIT_MAX_PARAMETERS];
+    for(std::size_t i = 0; i < n; i++) {
+        double sum = b[i];
+        for(std::size_t k = 0; k < i; k++) {
+            sum -= l[i][k] * y[k];
+        }
+        y[i] = sum / l[i][i];
+    }
+    for(std::size_t i = n; i-- > 0;) {
+        double sum = y[i];
+        for(std::size_t k = i + 1; k < n; k++) {
+            sum -= l[k][i] * x[k];
+        }
+        x[i] = sum / l[i][i];
+    }
+    return true;
+}
+
+void clamp(CircuitModel model, Parameters &theta) {
+    for(std::size_t k = 0; k < parameterCount(model); k++) {
+        if(isLog(model, k)) {
+            theta[k] = std::min(std::max(theta[k], -LOG_LIMIT), LOG_LIMIT);
+        } else {
+            theta[k] = std::min(std::max(theta[k], 0.0), 1.0);
+        }
+    }
+}
+
+FitResult fitSpectrum(CircuitModel model, const Spectrum &s, const Parameters &start, const FitOptions &options,
+        Workspace &ws) {
+    const std::size_t np = parameterCount(model);
+    FitResult result;
+    if(2 * s.size() < np) {
+        result.parameters.fill(std::numeric_limits<double>::quiet_NaN());
+        result.error = std::numeric_limits<double>::quiet_NaN();
+        return result;
+    }
+    ws.resize(s.size());
+
+    Parameters theta = toFitted(model, start);
+    clamp(model, theta);
+    evaluate(model, theta, s, ws, true);
+    double current = cost(s, ws);
+    double lambda = LAMBDA_START;
+
+    while(result.iterations < options.maxIterations && !result.converged) {
+        result.iterations++;
+
+        // Normal equations J'J and J'r, weights applied here
+        double a[FIT_MAX_PARAMETERS][FIT_MAX_PARAMETERS] = {};
+        double g[FIT_MAX_PARAMETERS] = {};
+        for(std::size_t j = 0; j < s.size(); j++) {
+            double w2 = s.weight[j] * s.weight[j];
+            double dr = ws.real[j] - s.real[j];
+            double di = ws.imag[j] - s.imag[j];
+            for(std::size_t k = 0; k < np; k++) {
+                double jr = ws.jacReal[k][j];
+                double ji = ws.jacImag[k][j];
+                g[k] -= w2 * (jr * dr + ji * di);
+                for(std::size_t m = 0; m <= k; m++) {
+                    a[k][m] += w2 * (jr * ws.jacReal[m][j] + ji * ws.jacImag[m][j]);
+                }
+            }
+        }
+        for(std::size_t k = 0; k < np; k++) {
+            for(std::size_t m = 0; m < k; m++) {
+                a[m][k] = a[k][m];
+            }
+        }
+
+        // Increase damping until a step decreases the cost
+        bool improved = false;
+        while(!improved && lambda < LAMBDA_MAX) {
+            double damped[FIT_MAX_PARAMETERS][FIT_MAX_PARAMETERS];
+            for(std::size_t k = 0; k < np; k++) {
+                for(std::size_t m = 0; m < np; m++) {
+                    damped[k][m] = a[k][m];
+                }
+                damped[k][k] += lambda * std::max(a[k][k], 1e-12);
+            }
+            double step[FIT_MAX_PARAMETERS];
+            if(!solve(np, damped, g, step)) {
+                lambda *= 10;
+                continue;
+            }
+
+            Parameters trial = theta;
+            for(std::size_t k = 0; k < np; k++) {
+                trial[k] += step[k];
+            }
+            clamp(model, trial);
+            evaluate(model, trial, s, ws, false);
+            double next = cost(s, ws);
+            if(next < current) {
+                improved = true;
+                result.converged = (current - next <= options.tolerance * current);
+                theta = trial;
+                current = next;
+                lambda = std::max(lambda / 10, 1e-12);
+            } else {
+                lambda *= 10;
+            }
+        }
+        if(!improved) {
+            // No step reduces the cost any more, this is a minimum
+            result.converged = true;
+        }
+        evaluate(model, theta, s, ws, true);
+    }
+
+    result.parameters = toPhysical(model, theta);
+    result.error = std::sqrt(current / (2 * s.size()));
+    return result;
+}
+
+/**
+ * Fits a series of sweeps in chunks, warm starting from the previous sweep within each chunk.
+ */
+template<typename Get>
+std::vector<FitResult> fitSeries(ThreadPool &pool, CircuitModel model, std::size_t count, const Get &get,
+        const FitOptions &options) {
+    std::vector<FitResult> results(count);
+    std::vector<Workspace> workspaces(pool.size());
+    const std::size_t chunk = std::max<std::size_t>(options.chunkSize, 1);
+    const std::size_t chunks = (count + chunk - 1) / chunk;
+
+    pool.run(chunks, [&](std::size_t task, std::size_t worker) {
+        Workspace &ws = workspaces[worker];
+        const FitResult *previous = nullptr;
+        for(std::size_t j = task * chunk; j < std::min(count, (task + 1) * chunk); j++) {
+            Spectrum s = prepare(get(j));
+            Parameters cold = (s.size() > 0 ? initialGuess(model, s) : Parameters());
+            if(options.warmStart && previous != nullptr && previous->converged) {
+                results[j] = fitSpectrum(model, s, previous->parameters, options, ws);
+                if(!results[j].converged) {
+                    FitResult retry = fitSpectrum(model, s, cold, options, ws);
+                    if(retry.error < results[j].error) {
+                        results[j] = retry;
+                    }
+                }
+            } else {
+                results[j] = fitSpectrum(model, s, cold, options, ws);
+            }
+            previous = &results[j];
+        }
+    });
+    return results;
+}
+
+} // namespace
+
+std::size_t parameterCount(CircuitModel model) {
+    switch(model) {
+    case CircuitModel::SeriesRC:
+    case CircuitModel::ParallelRC:
+    case CircuitModel::SeriesRL:
+        return 2;
+    case CircuitModel::Randles:
+        return 3;
+    case CircuitModel::RandlesCPE:
+        return 4;
+    }
+    return 0;
+}
+
+std::vector<std::string> parameterNames(CircuitModel model) {
+    switch(model) {
+    case CircuitModel::SeriesRC:
+    case CircuitModel::ParallelRC:
+        return {"R", "C"};
+    case CircuitModel::SeriesRL:
+        return {"R", "L"};
+    case CircuitModel::Randles:
+        return {"Rs", "Rct", "C"};
+    case CircuitModel::RandlesCPE:
+        return {"Rs", "Rct", "Q", "n"};
+    }
+    return {};
+}
+
+/**
+ * Gets a model by name (`series-rc`, `parallel-rc`, `series-rl`, `randles`, `randles-cpe`).
+ *
+ * @return `false` if the name is not known
+ */
+bool parseModel(const std::string &name, CircuitModel &model) {
+    static const std::pair<const char*, CircuitModel> models[] = {
+        {"series-rc", CircuitModel::SeriesRC},
+        {"parallel-rc", CircuitModel::ParallelRC},
+        {"series-rl", CircuitModel::SeriesRL},
+        {"randles", CircuitModel::Randles},
+        {"randles-cpe", CircuitModel::RandlesCPE}
+    };
+    for(const auto &m : models) {
+        if(name == m.first) {
+            model = m.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Fits a model to one sweep.
+ *
+ * @param model The model to fit
+ * @param data The measured spectrum, invalid points are ignored
+ * @param options Iteration limit and tolerance
+ * @param start Start from these parameters (e.g. the result for a similar sweep), estimated from the data if `nullptr`
+ * @return The fit result, parameters are NaN if there are not enough valid points
+ */
+FitResult fit(CircuitModel model, const PolarData &data, const FitOptions &options, const FitResult *start) {
+    Spectrum s = prepare(data);
+    Workspace ws;
+    Parameters initial = (start != nullptr ? start->parameters : s.size() > 0 ? initialGuess(model, s) : Parameters());
+    return fitSpectrum(model, s, initial, options, ws);
+}
+
+/**
+ * Fits a model to a series of sweeps, in parallel on all threads of the pool.
+ */
+std::vector<FitResult> fitBatch(ThreadPool &pool, CircuitModel model, const std::vector<PolarData> &sweeps,
+        const FitOptions &options) {
+    return fitSeries(pool, model, sweeps.size(), [&sweeps](std::size_t j) -> const PolarData& { return sweeps[j]; },
+            options);
+}
+
+/**
+ * Fits a model to a range of sweeps in a store, the sweeps are read straight from the mapped file by the workers.
+ */
+std::vector<FitResult> fitStore(ThreadPool &pool, CircuitModel model, const SweepStore &store, uint64_t first,
+        uint64_t count, const FitOptions &options) {
+    if(first > store.size() || count > store.size() - first) {
+        throw StoreError("Sweeps to fit are out of range");
+    }
+    return fitSeries(pool, model, static_cast<std::size_t>(count),
+            [&store, first](std::size_t j) { return store.polar(first + j); }, options);
+}
+
+} // namespace impy
@@ -0,0 +1,349 @@
+/**
+ * @file    fleet.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Shared job queue for many boards, dispatching sweeps to idle instruments from one event loop.
+ */
+
+#include "impy/fleet.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+namespace impy {
+
+namespace {
+
+// Timing of a sweep on the board, see ad5933.c
+/** The AD5933 takes 1024 samples at MCLK/16 (16.776MHz) for each point. */
+constexpr double DFT_TIME = 1024.0 / (16.776e6 / 16);
+/** The firmware polls the AD5933 from the TIM3 interrupt every 2ms. */
+constexpr double POLL_INTERVAL = 0.002;
+/** The coupling capacitor is charged for 4 time constants (110ms by default) before each sweep. */
+constexpr double COUPLING_TIME = 0.44;
+/** Sending the commands and transferring the data. */
+constexpr double COMMAND_TIME = 0.05;
+/** Weight of the last job when updating the speed of an instrument. */
+constexpr double SPEED_WEIGHT = 0.3;
+
+std::exception_ptr fleetError(const std::string &text) {
+    return std::make_exception_ptr(DeviceError(text));
+}
+
+double seconds(EventLoop::Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+EventLoop::Clock::duration fromSeconds(double s) {
+    return std::chrono::duration_cast<EventLoop::Clock::duration>(std::chrono::duration<double>(s));
+}
+
+} // namespace
+
+Fleet::Fleet(EventLoop &loop) : m_loop(loop) {
+}
+
+Fleet::~Fleet() = default;
+
+/**
+ * Opens the port of a board and queries its capabilities, settings and calibration. The board is used for jobs as
+ * soon as the answers are in.
+ *
+ * @param path Path of the serial port
+ * @throws IoError if the port cannot be opened
+ */
+void Fleet::addInstrument(const std::string &path) {
+    auto inst = std::make_unique<Instrument>();
+    inst->state.path = path;
+    inst->device = std::make_unique<Device>(m_loop, path);
+    m_instruments.push_back(std::move(inst));
+    probe(*m_instruments.back());
+}
+
+/**
+ * Queues a job.
+ *
+ * @param job The job
+ * @return Number of the job, counting from 0, see {@link FleetResult::job}
+ */
+uint64_t Fleet::submit(FleetJob job) {
+    uint64_t id = m_nextJob++;
+    m_queue.push_back(Pending{id, std::move(job), Clock::now()});
+    dispatch();
+    return id;
+}
+
+/**
+ * Gets the number of jobs running on instruments.
+ */
+std::size_t Fleet::running() const {
+    return std::count_if(m_instruments.begin(), m_instruments.end(),
+            [](const std::unique_ptr<Instrument> &inst) { return inst->state.busy; });
+}
+
+/**
+ * Gets whether all jobs have finished and all instruments have been probed.
+ */
+bool Fleet::done() const {
+    return m_queue.empty() && std::none_of(m_instruments.begin(), m_instruments.end(),
+            [](const std::unique_ptr<Instrument> &inst) { return inst->state.busy || inst->probing; });
+}
+
+/**
+ * Gets a copy of the state of all instruments, in the order they were added.
+ */
+std::vector<InstrumentState> Fleet::instruments() const {
+    std::vector<InstrumentState> ret;
+    for(const auto &inst : m_instruments) {
+        ret.push_back(inst->state);
+    }
+    return ret;
+}
+
+/**
+ * Estimates how long a sweep takes on the board, including charging the coupling capacitor and the commands.
+ *
+ * Each point takes the settling cycles at its frequency and the DFT, rounded up to the polling interval, once for
+ * each average.
+ */
+Fleet::Clock::duration Fleet::estimate(const SweepSettings &settings) {
+    double total = COUPLING_TIME + COMMAND_TIME;
+    double increment = (settings.steps ? static_cast<double>(settings.stop - settings.start) / settings.steps : 0.0);
+    for(uint32_t j = 0; j <= settings.steps; j++) {
+        double freq = std::max(1.0, settings.start + j * increment);
+        double point = settings.settl / freq + DFT_TIME;
+        total += settings.avg * std::ceil(point / POLL_INTERVAL) * POLL_INTERVAL;
+    }
+    return fromSeconds(total);
+}
+
+/**
+ * Queues the commands that find out what an instrument can do, and reads its telemetry.
+ */
+void Fleet::probe(Instrument &inst) {
+    Device &dev = *inst.device;
+    auto check = [&inst](std::exception_ptr error) {
+        if(error && !inst.state.error) {
+            inst.state.error = error;
+        }
+    };
+
+    dev.info([&inst, check](BoardInfo info, std::exception_ptr error) {
+        check(error);
+        inst.state.info = std::move(info);
+    });
+    dev.getSettings([&inst, check](SweepSettings settings, std::exception_ptr error) {
+        check(error);
+        inst.state.settings = settings;
+    });
+    dev.telemetry([&inst](Telemetry telemetry, std::exception_ptr error) {
+        // Older firmware doesn't have telemetry, which is not a reason not to use the board
+        if(!error) {
+            inst.state.telemetry = std::move(telemetry);
+        }
+    });
+    dev.status([this, &inst, check](Status status, std::exception_ptr error) {
+        check(error);
+        inst.state.calibrated = status.validGain;
+        inst.state.ready = !inst.state.error;
+        inst.probing = false;
+        dispatch();
+    });
+}
+
+/**
+ * Checks whether an instrument can run a job, regardless of whether it is busy.
+ */
+bool Fleet::canRun(const Instrument &inst, const FleetJob &job) const {
+    const InstrumentState &st = inst.state;
+    const SweepSettings &settings = (job.settings ? *job.settings : st.settings);
+
+    if(!st.ready || st.error || !st.calibrated) {
+        return false;
+    }
+    if(!job.device.empty() && job.device != st.path) {
+        return false;
+    }
+    if(job.port >= st.info.ports || settings.start < st.info.minFrequency || settings.stop > st.info.maxFrequency ||
+            settings.steps > st.info.maxSteps) {
+        return false;
+    }
+    if(settings.feedback && std::find(st.info.feedbackResistors.begin(), st.info.feedbackResistors.end(),
+            *settings.feedback) == st.info.feedbackResistors.end()) {
+        return false;
+    }
+    // The fleet doesn't calibrate, so the settings the calibration depends on have to stay as they are
+    if(settings.start != st.settings.start || settings.stop != st.settings.stop ||
+            (settings.feedback && settings.feedback != st.settings.feedback) ||
+            (settings.gain && settings.gain != st.settings.gain)) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Starts queued jobs on idle instruments.
+ *
+ * Jobs are considered in the order they were submitted. Each one goes to the instrument with the earliest estimated
+ * finish, counting the rest of the running job on busy instruments, and stays queued if that instrument is busy.
+ */
+void Fleet::dispatch() {
+    // Starting a job can fail synchronously and finish it, which comes back here
+    if(m_dispatching) {
+        m_dispatchAgain = true;
+        return;
+    }
+    m_dispatching = true;
+
+    do {
+        m_dispatchAgain = false;
+        Clock::time_point now = Clock::now();
+        bool probing = std::any_of(m_instruments.begin(), m_instruments.end(),
+                [](const std::unique_ptr<Instrument> &inst) { return inst->probing; });
+
+        for(std::size_t j = 0; j < m_queue.size();) {
+            const FleetJob &job = m_queue[j].job;
+            Instrument *best = nullptr;
+            Clock::time_point bestFinish;
+            for(const auto &inst : m_instruments) {
+                if(!canRun(*inst, job)) {
+                    continue;
+                }
+                const SweepSettings &settings = (job.settings ? *job.settings : inst->state.settings);
+                Clock::time_point start = (inst->state.busy ? std::max(now, inst->busyUntil) : now);
+                Clock::time_point finish = start + fromSeconds(inst->state.speed * seconds(estimate(settings)));
+                if(best == nullptr || finish < bestFinish) {
+                    best = inst.get();
+                    bestFinish = finish;
+                }
+            }
+
+            if(best != nullptr && !best->state.busy) {
+                Pending pending = std::move(m_queue[j]);
+                m_queue.erase(m_queue.begin() + j);
+                run(*best, std::move(pending));
+            } else if(best == nullptr && !probing) {
+                FleetResult result;
+                result.job = m_queue[j].id;
+                result.port = job.port;
+                result.queued = m_queue[j].queued;
+                result.started = now;
+                result.finished = now;
+                result.error = fleetError("No instrument can run this job");
+                m_queue.erase(m_queue.begin() + j);
+                deliver(std::move(result));
+            } else {
+                j++;
+            }
+        }
+    } while(m_dispatchAgain);
+    m_dispatching = false;
+}
+
+/**
+ * Queues the commands of a job on an instrument: settings, sweep, read, status for the calibration state and the
+ * telemetry of the board.
+ */
+void Fleet::run(Instrument &inst, Pending pending) {
+    const SweepSettings &settings = (pending.job.settings ? *pending.job.settings : inst.state.settings);
+    Clock::time_point now = Clock::now();
+    inst.state.busy = true;
+    inst.busyUntil = now + fromSeconds(inst.state.speed * seconds(estimate(settings)));
+
+    auto result = std::make_shared<FleetResult>();
+    result->job = pending.id;
+    result->device = inst.state.path;
+    result->port = pending.job.port;
+    result->queued = pending.queued;
+    result->started = now;
+
+    // Only the first error counts, the data read after a failed start is from an earlier sweep
+    auto check = [result](std::exception_ptr error) {
+        if(error && !result->error) {
+            result->error = error;
+        }
+    };
+    auto measure = [this, &inst, check, result, pending]() {
+        Device &dev = *inst.device;
+        dev.start(pending.job.port, check);
+        dev.wait([check](uint32_t, std::exception_ptr error) { check(error); });
+        dev.readPolar([check, result](PolarData data, std::exception_ptr error) {
+            check(error);
+            result->data = std::move(data);
+        });
+        dev.status([&inst, check](Status status, std::exception_ptr error) {
+            check(error);
+            if(!error) {
+                inst.state.calibrated = status.validGain;
+            }
+        });
+        dev.telemetry([this, &inst, result, pending](Telemetry telemetry, std::exception_ptr error) {
+            if(!error) {
+                inst.state.telemetry = std::move(telemetry);
+            }
+            finish(inst, pending, result);
+        });
+    };
+
+    if(pending.job.settings) {
+        // Don't sweep with the wrong settings if they can't be set
+        inst.device->setSweep(*pending.job.settings,
+                [this, &inst, check, result, pending, measure](std::exception_ptr error) {
+            check(error);
+            if(error) {
+                finish(inst, pending, result);
+            } else {
+                measure();
+            }
+        });
+    } else {
+        measure();
+    }
+}
+
+/**
+ * Completes a job when its last command has finished.
+ */
+void Fleet::finish(Instrument &inst, Pending pending, std::shared_ptr<FleetResult> result) {
+    Clock::time_point now = Clock::now();
+    InstrumentState &st = inst.state;
+    st.busy = false;
+    st.busyTime += now - result->started;
+
+    if(inst.device->failed()) {
+        // Not the fault of the job, another instrument can run it
+        st.error = inst.device->error();
+        m_queue.push_front(std::move(pending));
+        dispatch();
+        return;
+    }
+
+    st.jobs++;
+    result->finished = now;
+    if(result->error) {
+        result->data = PolarData();
+    } else {
+        if(pending.job.settings) {
+            st.settings = *pending.job.settings;
+        }
+        double ratio = seconds(now - result->started) / seconds(estimate(st.settings));
+        st.speed += SPEED_WEIGHT * (ratio - st.speed);
+    }
+    deliver(std::move(*result));
+    dispatch();
+}
+
+/**
+ * Passes a result to the handler and adds it to the store.
+ */
+void Fleet::deliver(FleetResult result) {
+    // The handler may submit jobs, which could add results while it holds a reference into the store
+    if(m_onResult) {
+        m_onResult(result);
+    }
+    m_results.push_back(std::move(result));
+}
+
+} // namespace impy
@@ -0,0 +1,166 @@
+/**
+ * @file    i2ctrace.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Decoder and replay device for I2C traces recorded by the firmware.
+ */
+
+#include "impy/i2ctrace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace impy {
+
+namespace {
+
+uint16_t be16(const uint8_t *p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+} // namespace
+
+/**
+ * Decodes a binary trace dump, including the leading byte count.
+ *
+ * @param data Pointer to the dump
+ * @param size Size of the dump in bytes
+ * @return The decoded trace
+ */
+I2CTrace decodeI2CTrace(const uint8_t *data, std::size_t size) {
+    constexpr std::size_t header = 4 + 12;
+    if(size < header) {
+        throw I2CTraceError("I2C trace too short");
+    }
+
+    uint32_t bytes = be32(data);
+    uint16_t version = be16(data + 4);
+    uint16_t recordSize = be16(data + 6);
+    uint32_t count = be32(data + 8);
+    if(bytes + 4 != size) {
+        throw I2CTraceError("I2C trace byte count does not match size");
+    }
+    if(version != I2C_TRACE_VERSION || recordSize != I2C_RECORD_SIZE) {
+        throw I2CTraceError("Unsupported I2C trace format version " + std::to_string(version));
+    }
+    if(header + static_cast<std::size_t>(count) * recordSize != size) {
+        throw I2CTraceError("I2C trace record count does not match size");
+    }
+
+    I2CTrace trace;
+    trace.dropped = be32(data + 12);
+    trace.records.reserve(count);
+    for(const uint8_t *p = data + header; p < data + size; p += recordSize) {
+        I2CRecord rec;
+        rec.timestamp = be32(p);
+        rec.duration = be32(p + 4);
+        rec.op = static_cast<I2COp>(p[8]);
+        rec.address = p[9];
+        rec.reg = be16(p + 10);
+        rec.length = be16(p + 12);
+        rec.result = p[14];
+        std::copy(p + 16, p + 20, rec.data.begin());
+        trace.records.push_back(rec);
+    }
+    return trace;
+}
+
+/**
+ * Loads a binary trace dump from a file.
+ */
+I2CTrace loadI2CTrace(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw I2CTraceError("Cannot open " + path);
+    }
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return decodeI2CTrace(buf.data(), buf.size());
+}
+
+/**
+ * Gets a short name for a transfer kind, matching the HAL function names.
+ */
+const char* i2cOpName(I2COp op) {
+    switch(op) {
+        case I2COp::MemWrite:
+            return "Mem_Write";
+        case I2COp::MemRead:
+            return "Mem_Read";
+        case I2COp::Transmit:
+            return "Master_Transmit";
+        case I2COp::Receive:
+            return "Master_Receive";
+        case I2COp::DeviceReady:
+            return "IsDeviceReady";
+    }
+    return "unknown";
+}
+
+// I2CReplayDevice ------------------------------------------------------------
+
+I2CReplayDevice::I2CReplayDevice(I2CTrace trace) : m_trace(std::move(trace)) {
+}
+
+/**
+ * Consumes the next record after checking it against the transfer being issued, and advances the virtual clock.
+ */
+const I2CRecord& I2CReplayDevice::next(I2COp op, uint8_t address, uint16_t reg, uint16_t length) {
+    if(finished()) {
+        throw I2CTraceError("Replay past the end of the trace");
+    }
+    const I2CRecord &rec = m_trace.records[m_next];
+    if(rec.op != op || rec.address != address || rec.reg != reg || rec.length != length) {
+        throw I2CTraceError("Transfer " + std::to_string(m_next) + " does not match the trace: expected " +
+                i2cOpName(rec.op) + ", got " + i2cOpName(op));
+    }
+
+    // Keep the recorded gap to the previous transfer, it was spent outside the bus (timer period, processing)
+    if(m_next > 0) {
+        const I2CRecord &prev = m_trace.records[m_next - 1];
+        uint32_t gap = rec.timestamp - (prev.timestamp + prev.duration);
+        if(static_cast<int32_t>(gap) > 0) {
+            m_now += gap;
+        }
+    }
+    m_now += rec.duration;
+    m_busTime += rec.duration;
+    m_next++;
+    return rec;
+}
+
+uint8_t I2CReplayDevice::memWrite(uint8_t address, uint16_t reg, const uint8_t *, uint16_t length) {
+    return next(I2COp::MemWrite, address, reg, length).result;
+}
+
+uint8_t I2CReplayDevice::memRead(uint8_t address, uint16_t reg, uint8_t *data, uint16_t length) {
+    const I2CRecord &rec = next(I2COp::MemRead, address, reg, length);
+    // Only the first bytes are recorded, anything beyond reads as zero
+    std::memset(data, 0, length);
+    std::memcpy(data, rec.data.data(), std::min<std::size_t>(length, rec.data.size()));
+    return rec.result;
+}
+
+uint8_t I2CReplayDevice::transmit(uint8_t address, const uint8_t *data, uint16_t length) {
+    return next(I2COp::Transmit, address, (length > 0 ? data[0] : 0), length).result;
+}
+
+uint8_t I2CReplayDevice::receive(uint8_t address, uint8_t *data, uint16_t length) {
+    const I2CRecord &rec = next(I2COp::Receive, address, 0, length);
+    std::memset(data, 0, length);
+    std::memcpy(data, rec.data.data(), std::min<std::size_t>(length, rec.data.size()));
+    return rec.result;
+}
+
+uint8_t I2CReplayDevice::isDeviceReady(uint8_t address, uint32_t trials) {
+    return next(I2COp::DeviceReady, address, 0, static_cast<uint16_t>(trials)).result;
+}
+
+} // namespace impy
@@ -0,0 +1,121 @@
+/**
+ * @file    serial.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Non-blocking access to the virtual COM port of the board through termios.
+ */
+
+#include "impy/serial.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace impy {
+
+namespace {
+
+IoError systemError(const std::string &what, const std::string &path) {
+    return IoError(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+/**
+ * Opens the specified port and puts it into raw mode.
+ *
+ * @param path Path of the device node, for example `/dev/ttyACM0`
+ */
+SerialPort::SerialPort(const std::string &path) : m_path(path) {
+    m_fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(m_fd < 0) {
+        throw systemError("Cannot open", path);
+    }
+
+    termios tio;
+    if(tcgetattr(m_fd, &tio) != 0) {
+        IoError err = systemError("Cannot get attributes of", path);
+        close();
+        throw err;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cflag |= CLOCAL | CREAD;
+    // With O_NONBLOCK this makes reads without data fail with EAGAIN, so a return value of 0 means hangup
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if(tcsetattr(m_fd, TCSANOW, &tio) != 0) {
+        IoError err = systemError("Cannot configure", path);
+        close();
+        throw err;
+    }
+    flushInput();
+}
+
+SerialPort::~SerialPort() {
+    close();
+}
+
+/**
+ * Reads as much data as is available, up to the specified size.
+ *
+ * @param data Buffer to read into
+ * @param size Size of the buffer
+ * @return The number of bytes read, `0` if no data is available
+ */
+std::size_t SerialPort::read(uint8_t *data, std::size_t size) {
+    for(;;) {
+        ssize_t ret = ::read(m_fd, data, size);
+        if(ret > 0) {
+            return static_cast<std::size_t>(ret);
+        } else if(ret == 0) {
+            throw IoError("Device disconnected: " + m_path);
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        } else if(errno != EINTR) {
+            throw systemError("Cannot read from", m_path);
+        }
+    }
+}
+
+/**
+ * Writes as much of the specified data as the driver accepts right now.
+ *
+ * @param data Data to write
+ * @param size Number of bytes to write
+ * @return The number of bytes written, may be less than `size`
+ */
+std::size_t SerialPort::write(const uint8_t *data, std::size_t size) {
+    for(;;) {
+        ssize_t ret = ::write(m_fd, data, size);
+        if(ret >= 0) {
+            return static_cast<std::size_t>(ret);
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        } else if(errno != EINTR) {
+            throw systemError("Cannot write to", m_path);
+        }
+    }
+}
+
+/**
+ * Discards data received but not read yet, such as output left over from a previous session.
+ */
+void SerialPort::flushInput() {
+    tcflush(m_fd, TCIFLUSH);
+}
+
+/**
+ * Closes the port, does nothing if it is already closed.
+ */
+void SerialPort::close() {
+    if(m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+} // namespace impy
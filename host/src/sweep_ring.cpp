@@ -0,0 +1,231 @@
+/**
+ * @file    sweep_ring.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Ring of completed sweeps in POSIX shared memory, written by `impyd` and read by any number of processes.
+ */
+
+#include "impy/sweep_ring.hpp"
+#include "impy/serial.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace impy {
+
+struct SweepRing::Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slotSize;
+    std::atomic<uint64_t> latest;       //!< Number of the latest complete sweep, `0` if none
+};
+
+struct SweepRing::Slot
+{
+    std::atomic<uint64_t> seq;          //!< `2 * sweep` when complete, odd while being written
+    int64_t timestamp;
+    uint32_t port;
+    uint32_t points;
+    uint32_t rawPoints;
+    uint32_t reserved;
+    uint32_t frequency[SWEEP_MAX_POINTS];
+    float magnitude[SWEEP_MAX_POINTS];
+    float angle[SWEEP_MAX_POINTS];
+    uint32_t rawFrequency[SWEEP_MAX_POINTS];
+    int16_t real[SWEEP_MAX_POINTS];
+    int16_t imag[SWEEP_MAX_POINTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory needs lock free atomics");
+
+namespace {
+
+IoError systemError(const std::string &what, const std::string &name) {
+    return IoError(what + " " + name + ": " + std::strerror(errno));
+}
+
+template<typename T>
+void copyOut(std::vector<T> &dst, const T *src, uint32_t count) {
+    dst.assign(src, src + count);
+}
+
+} // namespace
+
+/**
+ * Creates the shared memory object (replacing an existing one) for writing.
+ *
+ * @param name Name of the object, starting with '/' (see shm_open)
+ * @param slots Number of sweeps to keep
+ */
+SweepRing SweepRing::create(const std::string &name, uint32_t slots) {
+    std::size_t size = sizeof(Header) + static_cast<std::size_t>(slots) * sizeof(Slot);
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        throw systemError("Cannot create shared memory", name);
+    }
+    if(ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        IoError err = systemError("Cannot size shared memory", name);
+        ::close(fd);
+        throw err;
+    }
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED) {
+        throw systemError("Cannot map shared memory", name);
+    }
+
+    // The object is zero filled, so all slots are empty (sequence 0) and no sweep is published yet
+    Header *header = static_cast<Header *>(map);
+    header->slots = slots;
+    header->slotSize = sizeof(Slot);
+    header->version = VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC;
+    return SweepRing(map, size, true, name);
+}
+
+/**
+ * Opens an existing ring for reading.
+ *
+ * @param name Name the daemon was started with
+ */
+SweepRing SweepRing::open(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if(fd < 0) {
+        throw systemError("Cannot open shared memory", name);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw IoError("Shared memory " + name + " is not a sweep ring");
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED) {
+        throw systemError("Cannot map shared memory", name);
+    }
+
+    const Header *header = static_cast<const Header *>(map);
+    if(header->magic != MAGIC || header->version != VERSION || header->slotSize != sizeof(Slot) ||
+            sizeof(Header) + static_cast<std::size_t>(header->slots) * sizeof(Slot) > size) {
+        munmap(map, size);
+        throw IoError("Shared memory " + name + " has an unsupported format");
+    }
+    return SweepRing(map, size, false, name);
+}
+
+SweepRing::SweepRing(void *map, std::size_t size, bool writer, std::string name) :
+        m_map(map), m_size(size), m_writer(writer), m_name(std::move(name)) {
+}
+
+SweepRing::SweepRing(SweepRing &&other) noexcept :
+        m_map(std::exchange(other.m_map, nullptr)), m_size(other.m_size), m_writer(other.m_writer),
+        m_name(std::move(other.m_name)) {
+}
+
+SweepRing& SweepRing::operator=(SweepRing &&other) noexcept {
+    std::swap(m_map, other.m_map);
+    std::swap(m_size, other.m_size);
+    std::swap(m_writer, other.m_writer);
+    std::swap(m_name, other.m_name);
+    return *this;
+}
+
+SweepRing::~SweepRing() {
+    if(m_map != nullptr) {
+        munmap(m_map, m_size);
+        if(m_writer) {
+            shm_unlink(m_name.c_str());
+        }
+    }
+}
+
+uint32_t SweepRing::slots() const {
+    return static_cast<const Header *>(m_map)->slots;
+}
+
+SweepRing::Slot& SweepRing::slot(uint64_t sweep) const {
+    Slot *first = reinterpret_cast<Slot *>(static_cast<uint8_t *>(m_map) + sizeof(Header));
+    return first[(sweep - 1) % slots()];
+}
+
+/**
+ * Writes a sweep into the ring, overwriting the oldest one. Only valid for a ring obtained from {@link create}.
+ *
+ * Sweep numbers need to increase by one with each call, data beyond {@link SWEEP_MAX_POINTS} is dropped.
+ */
+void SweepRing::publish(const SweepRecord &record) {
+    Slot &s = slot(record.sweep);
+    uint32_t points = static_cast<uint32_t>(std::min(record.polar.size(), SWEEP_MAX_POINTS));
+    uint32_t rawPoints = static_cast<uint32_t>(std::min(record.raw.size(), SWEEP_MAX_POINTS));
+
+    s.seq.store(2 * record.sweep - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s.timestamp = record.timestamp;
+    s.port = record.port;
+    s.points = points;
+    s.rawPoints = rawPoints;
+    std::copy_n(record.polar.frequency.begin(), points, s.frequency);
+    std::copy_n(record.polar.magnitude.begin(), points, s.magnitude);
+    std::copy_n(record.polar.angle.begin(), points, s.angle);
+    std::copy_n(record.raw.frequency.begin(), rawPoints, s.rawFrequency);
+    std::copy_n(record.raw.real.begin(), rawPoints, s.real);
+    std::copy_n(record.raw.imag.begin(), rawPoints, s.imag);
+
+    s.seq.store(2 * record.sweep, std::memory_order_release);
+    static_cast<Header *>(m_map)->latest.store(record.sweep, std::memory_order_release);
+}
+
+/**
+ * Gets the number of the latest published sweep, `0` if none has been published yet.
+ */
+uint64_t SweepRing::latest() const {
+    return static_cast<const Header *>(m_map)->latest.load(std::memory_order_acquire);
+}
+
+/**
+ * Copies a sweep out of the ring.
+ *
+ * @param sweep Number of the sweep, for example {@link latest}
+ * @param record Receives the sweep
+ * @return `false` if the sweep has not been published yet or has already been overwritten
+ */
+bool SweepRing::read(uint64_t sweep, SweepRecord &record) const {
+    if(sweep == 0) {
+        return false;
+    }
+    const Slot &s = slot(sweep);
+    if(s.seq.load(std::memory_order_acquire) != 2 * sweep) {
+        return false;
+    }
+
+    record.sweep = sweep;
+    record.timestamp = s.timestamp;
+    record.port = s.port;
+    uint32_t points = std::min<uint32_t>(s.points, SWEEP_MAX_POINTS);
+    uint32_t rawPoints = std::min<uint32_t>(s.rawPoints, SWEEP_MAX_POINTS);
+    copyOut(record.polar.frequency, s.frequency, points);
+    copyOut(record.polar.magnitude, s.magnitude, points);
+    copyOut(record.polar.angle, s.angle, points);
+    copyOut(record.raw.frequency, s.rawFrequency, rawPoints);
+    copyOut(record.raw.real, s.real, rawPoints);
+    copyOut(record.raw.imag, s.imag, rawPoints);
+
+    // The writer may have started on this slot while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.seq.load(std::memory_order_relaxed) == 2 * sweep;
+}
+
+} // namespace impy
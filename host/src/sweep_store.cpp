@@ -0,0 +1,558 @@
+/**
+ * @file    sweep_store.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Append-only columnar file of sweeps with the same frequency plan, memory mapped for reading.
+ */
+
+#include "impy/sweep_store.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace impy {
+
+namespace {
+
+constexpr uint32_t MAGIC = 0x696D7073;          // "imps"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t FLAG_RAW = 0x1;
+constexpr std::size_t HEADER_SIZE = 4096;
+constexpr std::size_t FREQUENCY_OFFSET = 64;
+constexpr std::size_t PAGE_SIZE = 4096;
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t points;                    //!< Number of points in the frequency plan
+    uint32_t blockSweeps;               //!< Number of sweeps per block
+    uint32_t flags;
+    uint32_t reserved[3];
+    std::atomic<uint64_t> count;        //!< Number of complete sweeps
+};
+
+static_assert(sizeof(FileHeader) <= FREQUENCY_OFFSET, "Header overlaps the frequency plan");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Mapped files need lock free atomics");
+
+/** Maximum number of points in the frequency plan, limited by the header size. */
+constexpr uint32_t MAX_POINTS = (HEADER_SIZE - FREQUENCY_OFFSET) / 4;
+
+/**
+ * Offsets of the columns in a block.
+ */
+struct Layout
+{
+    std::size_t timestamp, port, points, rawPoints;
+    std::size_t magnitude, angle, real, imag;
+    std::size_t blockSize;
+
+    Layout(uint32_t points, uint32_t sweeps, bool raw) {
+        std::size_t values = static_cast<std::size_t>(points) * sweeps;
+        timestamp = 0;
+        port = timestamp + 8 * static_cast<std::size_t>(sweeps);
+        this->points = port + 4 * static_cast<std::size_t>(sweeps);
+        rawPoints = this->points + 4 * static_cast<std::size_t>(sweeps);
+        magnitude = rawPoints + 4 * static_cast<std::size_t>(sweeps);
+        angle = magnitude + 4 * values;
+        real = angle + 4 * values;
+        imag = real + 2 * values;
+        std::size_t end = (raw ? imag + 2 * values : real);
+        blockSize = (end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    }
+};
+
+StoreError systemError(const std::string &what, const std::string &path) {
+    return StoreError(what + " " + path + ": " + std::strerror(errno));
+}
+
+FileHeader& header(void *map) {
+    return *static_cast<FileHeader *>(map);
+}
+
+const uint8_t* frequencyPlan(const void *map) {
+    return static_cast<const uint8_t *>(map) + FREQUENCY_OFFSET;
+}
+
+Layout layout(const FileHeader &hdr) {
+    return Layout(hdr.points, hdr.blockSweeps, (hdr.flags & FLAG_RAW) != 0);
+}
+
+template<typename T>
+T load(const uint8_t *p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+template<typename T>
+void store(uint8_t *p, T value) {
+    std::memcpy(p, &value, sizeof(value));
+}
+
+/**
+ * Maps the header of a store file and checks it.
+ */
+void* mapHeader(int fd, const std::string &path, int prot) {
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < HEADER_SIZE) {
+        throw StoreError(path + " is not a sweep store");
+    }
+    void *map = mmap(nullptr, HEADER_SIZE, prot, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED) {
+        throw systemError("Cannot map", path);
+    }
+    const FileHeader &hdr = header(map);
+    if(hdr.magic != MAGIC || hdr.version != VERSION || hdr.points == 0 || hdr.points > MAX_POINTS ||
+            hdr.blockSweeps == 0) {
+        munmap(map, HEADER_SIZE);
+        throw StoreError(path + " is not a supported sweep store");
+    }
+    return map;
+}
+
+} // namespace
+
+/**
+ * Creates a new store file, replacing an existing one.
+ *
+ * @param path Path of the file
+ * @param frequencies Frequency plan of all sweeps
+ * @param raw Whether raw data is stored as well
+ * @param blockSweeps Number of sweeps per block, the file grows by one block at a time
+ */
+SweepStoreWriter SweepStoreWriter::create(const std::string &path, const std::vector<uint32_t> &frequencies, bool raw,
+        uint32_t blockSweeps) {
+    if(frequencies.empty() || frequencies.size() > MAX_POINTS || blockSweeps == 0) {
+        throw StoreError("Invalid frequency plan or block size for " + path);
+    }
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        throw systemError("Cannot create", path);
+    }
+    if(ftruncate(fd, HEADER_SIZE) != 0) {
+        StoreError err = systemError("Cannot write", path);
+        ::close(fd);
+        throw err;
+    }
+    void *map = mmap(nullptr, HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED) {
+        StoreError err = systemError("Cannot map", path);
+        ::close(fd);
+        throw err;
+    }
+
+    // Frequencies in the same byte order as in the records, so they can be compared without decoding
+    uint8_t *plan = static_cast<uint8_t *>(map) + FREQUENCY_OFFSET;
+    for(std::size_t j = 0; j < frequencies.size(); j++) {
+        plan[4 * j] = static_cast<uint8_t>(frequencies[j] >> 24);
+        plan[4 * j + 1] = static_cast<uint8_t>(frequencies[j] >> 16);
+        plan[4 * j + 2] = static_cast<uint8_t>(frequencies[j] >> 8);
+        plan[4 * j + 3] = static_cast<uint8_t>(frequencies[j]);
+    }
+    FileHeader &hdr = header(map);
+    hdr.version = VERSION;
+    hdr.points = static_cast<uint32_t>(frequencies.size());
+    hdr.blockSweeps = blockSweeps;
+    hdr.flags = (raw ? FLAG_RAW : 0);
+    hdr.count.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr.magic = MAGIC;
+    return SweepStoreWriter(fd, map, 0);
+}
+
+/**
+ * Opens an existing store file to append more sweeps.
+ */
+SweepStoreWriter SweepStoreWriter::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if(fd < 0) {
+        throw systemError("Cannot open", path);
+    }
+    void *map;
+    try {
+        map = mapHeader(fd, path, PROT_READ | PROT_WRITE);
+    } catch(...) {
+        ::close(fd);
+        throw;
+    }
+
+    SweepStoreWriter writer(fd, map, header(map).count.load(std::memory_order_acquire));
+    if(writer.m_count > 0) {
+        const FileHeader &hdr = header(map);
+        uint64_t last = writer.m_count - 1;
+        writer.mapBlock(last / hdr.blockSweeps);
+        writer.m_lastTimestamp = load<int64_t>(writer.m_block + 8 * (last % hdr.blockSweeps));
+    }
+    return writer;
+}
+
+SweepStoreWriter::SweepStoreWriter(int fd, void *header, uint64_t count) :
+        m_fd(fd), m_header(header), m_count(count) {
+}
+
+SweepStoreWriter::SweepStoreWriter(SweepStoreWriter &&other) noexcept :
+        m_fd(std::exchange(other.m_fd, -1)), m_header(std::exchange(other.m_header, nullptr)),
+        m_block(std::exchange(other.m_block, nullptr)), m_blockIndex(other.m_blockIndex), m_count(other.m_count),
+        m_lastTimestamp(other.m_lastTimestamp) {
+}
+
+SweepStoreWriter& SweepStoreWriter::operator=(SweepStoreWriter &&other) noexcept {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_header, other.m_header);
+    std::swap(m_block, other.m_block);
+    std::swap(m_blockIndex, other.m_blockIndex);
+    std::swap(m_count, other.m_count);
+    std::swap(m_lastTimestamp, other.m_lastTimestamp);
+    return *this;
+}
+
+SweepStoreWriter::~SweepStoreWriter() {
+    if(m_block != nullptr) {
+        munmap(m_block, layout(header(m_header)).blockSize);
+    }
+    if(m_header != nullptr) {
+        munmap(m_header, HEADER_SIZE);
+    }
+    if(m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+/**
+ * Maps the specified block, growing the file if necessary.
+ */
+void SweepStoreWriter::mapBlock(uint64_t block) {
+    std::size_t blockSize = layout(header(m_header)).blockSize;
+    if(m_block != nullptr) {
+        munmap(m_block, blockSize);
+        m_block = nullptr;
+    }
+
+    off_t offset = static_cast<off_t>(HEADER_SIZE + block * blockSize);
+    struct stat st;
+    if(fstat(m_fd, &st) != 0 || (st.st_size < offset + static_cast<off_t>(blockSize) &&
+            ftruncate(m_fd, offset + static_cast<off_t>(blockSize)) != 0)) {
+        throw StoreError(std::string("Cannot grow store: ") + std::strerror(errno));
+    }
+    void *map = mmap(nullptr, blockSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset);
+    if(map == MAP_FAILED) {
+        throw StoreError(std::string("Cannot map store: ") + std::strerror(errno));
+    }
+    m_block = static_cast<uint8_t *>(map);
+    m_blockIndex = block;
+}
+
+/**
+ * Appends a sweep from the binary data sent by the board.
+ *
+ * @param info Metadata of the sweep, the number of points is taken from the data
+ * @param polar Polar data (format `BP`), without byte count
+ * @param polarSize Size of the polar data in bytes
+ * @param raw Raw data (`board read --raw` in binary format) without byte count, ignored if the store has no raw data
+ * @param rawSize Size of the raw data in bytes, may be `0`
+ * @return Index of the sweep in the store
+ */
+uint64_t SweepStoreWriter::append(const SweepInfo &info, const uint8_t *polar, std::size_t polarSize,
+        const uint8_t *raw, std::size_t rawSize) {
+    const FileHeader &hdr = header(m_header);
+    const Layout lay = layout(hdr);
+    const uint8_t *plan = frequencyPlan(m_header);
+    if(!(hdr.flags & FLAG_RAW)) {
+        rawSize = 0;
+    }
+
+    std::size_t points = recordCount(polarSize, IMPEDANCE_RECORD_SIZE);
+    std::size_t rawPoints = recordCount(rawSize, RAW_RECORD_SIZE);
+    if(points > hdr.points || rawPoints > hdr.points) {
+        throw StoreError("Sweep has more points than the frequency plan");
+    }
+    for(std::size_t j = 0; j < points; j++) {
+        if(std::memcmp(polar + j * IMPEDANCE_RECORD_SIZE, plan + 4 * j, 4) != 0) {
+            throw StoreError("Sweep does not match the frequency plan at point " + std::to_string(j));
+        }
+    }
+    for(std::size_t j = 0; j < rawPoints; j++) {
+        if(std::memcmp(raw + j * RAW_RECORD_SIZE, plan + 4 * j, 4) != 0) {
+            throw StoreError("Raw data does not match the frequency plan at point " + std::to_string(j));
+        }
+    }
+    if(info.timestamp < m_lastTimestamp) {
+        throw StoreError("Timestamp is before the last stored sweep");
+    }
+
+    uint64_t block = m_count / hdr.blockSweeps;
+    std::size_t slot = m_count % hdr.blockSweeps;
+    if(m_block == nullptr || m_blockIndex != block) {
+        mapBlock(block);
+    }
+
+    // Values are copied as they are, missing points of interrupted sweeps are zero
+    for(std::size_t j = 0; j < hdr.points; j++) {
+        std::size_t index = j * hdr.blockSweeps + slot;
+        if(j < points) {
+            std::memcpy(m_block + lay.magnitude + 4 * index, polar + j * IMPEDANCE_RECORD_SIZE + 4, 4);
+            std::memcpy(m_block + lay.angle + 4 * index, polar + j * IMPEDANCE_RECORD_SIZE + 8, 4);
+        } else {
+            std::memset(m_block + lay.magnitude + 4 * index, 0, 4);
+            std::memset(m_block + lay.angle + 4 * index, 0, 4);
+        }
+        if(hdr.flags & FLAG_RAW) {
+            if(j < rawPoints) {
+                std::memcpy(m_block + lay.real + 2 * index, raw + j * RAW_RECORD_SIZE + 4, 2);
+                std::memcpy(m_block + lay.imag + 2 * index, raw + j * RAW_RECORD_SIZE + 6, 2);
+            } else {
+                std::memset(m_block + lay.real + 2 * index, 0, 2);
+                std::memset(m_block + lay.imag + 2 * index, 0, 2);
+            }
+        }
+    }
+    store<int64_t>(m_block + lay.timestamp + 8 * slot, info.timestamp);
+    store<uint32_t>(m_block + lay.port + 4 * slot, info.port);
+    store<uint32_t>(m_block + lay.points + 4 * slot, static_cast<uint32_t>(points));
+    store<uint32_t>(m_block + lay.rawPoints + 4 * slot, static_cast<uint32_t>(rawPoints));
+
+    m_lastTimestamp = info.timestamp;
+    header(m_header).count.store(++m_count, std::memory_order_release);
+    return m_count - 1;
+}
+
+/**
+ * Writes everything appended so far to disk.
+ */
+void SweepStoreWriter::sync() {
+    if(m_block != nullptr) {
+        msync(m_block, layout(header(m_header)).blockSize, MS_SYNC);
+    }
+    msync(m_header, HEADER_SIZE, MS_SYNC);
+}
+
+/**
+ * Opens a store file for reading.
+ */
+SweepStore SweepStore::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        throw systemError("Cannot open", path);
+    }
+    SweepStore ret(fd);
+    void *map = mapHeader(fd, path, PROT_READ);
+    const FileHeader &hdr = header(map);
+    const uint8_t *plan = frequencyPlan(map);
+    for(uint32_t j = 0; j < hdr.points; j++) {
+        ret.m_frequencies.push_back(detail::be32(plan + 4 * j));
+    }
+    ret.m_blockSweeps = hdr.blockSweeps;
+    ret.m_blockSize = layout(hdr).blockSize;
+    ret.m_raw = (hdr.flags & FLAG_RAW) != 0;
+    munmap(map, HEADER_SIZE);
+
+    ret.map();
+    return ret;
+}
+
+SweepStore::SweepStore(int fd) : m_fd(fd) {
+}
+
+SweepStore::SweepStore(SweepStore &&other) noexcept :
+        m_fd(std::exchange(other.m_fd, -1)), m_map(std::exchange(other.m_map, nullptr)), m_size(other.m_size),
+        m_count(other.m_count), m_frequencies(std::move(other.m_frequencies)), m_blockSweeps(other.m_blockSweeps),
+        m_blockSize(other.m_blockSize), m_raw(other.m_raw) {
+}
+
+SweepStore& SweepStore::operator=(SweepStore &&other) noexcept {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_map, other.m_map);
+    std::swap(m_size, other.m_size);
+    std::swap(m_count, other.m_count);
+    std::swap(m_frequencies, other.m_frequencies);
+    std::swap(m_blockSweeps, other.m_blockSweeps);
+    std::swap(m_blockSize, other.m_blockSize);
+    std::swap(m_raw, other.m_raw);
+    return *this;
+}
+
+SweepStore::~SweepStore() {
+    if(m_map != nullptr) {
+        munmap(m_map, m_size);
+    }
+    if(m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+/**
+ * Maps the whole file, and gets the number of sweeps in the mapped blocks.
+ */
+void SweepStore::map() {
+    struct stat st;
+    if(fstat(m_fd, &st) != 0) {
+        throw StoreError(std::string("Cannot read store: ") + std::strerror(errno));
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    if(size != m_size) {
+        void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, m_fd, 0);
+        if(map == MAP_FAILED) {
+            throw StoreError(std::string("Cannot map store: ") + std::strerror(errno));
+        }
+        if(m_map != nullptr) {
+            munmap(m_map, m_size);
+        }
+        m_map = static_cast<uint8_t *>(map);
+        m_size = size;
+    }
+
+    uint64_t blocks = (m_size - HEADER_SIZE) / m_blockSize;
+    uint64_t count = header(m_map).count.load(std::memory_order_acquire);
+    m_count = std::min<uint64_t>(count, blocks * m_blockSweeps);
+}
+
+/**
+ * Picks up sweeps appended since the store was opened or last refreshed.
+ *
+ * @return `true` if there are new sweeps
+ */
+bool SweepStore::refresh() {
+    uint64_t before = m_count;
+    uint64_t count = header(m_map).count.load(std::memory_order_acquire);
+    if(count > m_count) {
+        map();
+    }
+    return m_count != before;
+}
+
+const uint8_t* SweepStore::block(uint64_t sweep) const {
+    if(sweep >= m_count) {
+        throw StoreError("Sweep " + std::to_string(sweep) + " is not in the store");
+    }
+    return m_map + HEADER_SIZE + (sweep / m_blockSweeps) * m_blockSize;
+}
+
+/**
+ * Gets the metadata of a sweep.
+ *
+ * @param sweep Index of the sweep, from `0` to {@link size}` - 1`
+ */
+SweepInfo SweepStore::info(uint64_t sweep) const {
+    const uint8_t *blk = block(sweep);
+    const Layout lay(static_cast<uint32_t>(m_frequencies.size()), m_blockSweeps, m_raw);
+    std::size_t slot = sweep % m_blockSweeps;
+
+    SweepInfo info;
+    info.timestamp = load<int64_t>(blk + lay.timestamp + 8 * slot);
+    info.port = load<uint32_t>(blk + lay.port + 4 * slot);
+    info.points = load<uint32_t>(blk + lay.points + 4 * slot);
+    info.rawPoints = load<uint32_t>(blk + lay.rawPoints + 4 * slot);
+    return info;
+}
+
+/**
+ * Gets the calibrated data of a sweep.
+ */
+PolarData SweepStore::polar(uint64_t sweep) const {
+    const uint8_t *blk = block(sweep);
+    const Layout lay(static_cast<uint32_t>(m_frequencies.size()), m_blockSweeps, m_raw);
+    std::size_t slot = sweep % m_blockSweeps;
+    uint32_t points = std::min<uint32_t>(info(sweep).points, static_cast<uint32_t>(m_frequencies.size()));
+
+    PolarData ret;
+    ret.frequency.assign(m_frequencies.begin(), m_frequencies.begin() + points);
+    ret.magnitude.resize(points);
+    ret.angle.resize(points);
+    for(std::size_t j = 0; j < points; j++) {
+        std::size_t index = j * m_blockSweeps + slot;
+        ret.magnitude[j] = detail::beFloat(blk + lay.magnitude + 4 * index);
+        ret.angle[j] = detail::beFloat(blk + lay.angle + 4 * index);
+    }
+    return ret;
+}
+
+/**
+ * Gets the raw data of a sweep, empty if the store has no raw data.
+ */
+RawData SweepStore::raw(uint64_t sweep) const {
+    const uint8_t *blk = block(sweep);
+    const Layout lay(static_cast<uint32_t>(m_frequencies.size()), m_blockSweeps, m_raw);
+    std::size_t slot = sweep % m_blockSweeps;
+    uint32_t points = (m_raw ? std::min<uint32_t>(info(sweep).rawPoints, m_frequencies.size()) : 0);
+
+    RawData ret;
+    ret.frequency.assign(m_frequencies.begin(), m_frequencies.begin() + points);
+    ret.real.resize(points);
+    ret.imag.resize(points);
+    for(std::size_t j = 0; j < points; j++) {
+        std::size_t index = j * m_blockSweeps + slot;
+        ret.real[j] = detail::be16s(blk + lay.real + 2 * index);
+        ret.imag[j] = detail::be16s(blk + lay.imag + 2 * index);
+    }
+    return ret;
+}
+
+/**
+ * Gets the values at one frequency across a range of sweeps. Sweeps that don't have the point (interrupted sweeps)
+ * give NaN.
+ *
+ * @param point Index of the frequency in {@link frequencies}
+ * @param first Index of the first sweep
+ * @param count Number of sweeps
+ * @param magnitude Receives `count` magnitude values
+ * @param angle Receives `count` angle values
+ */
+void SweepStore::slice(std::size_t point, uint64_t first, uint64_t count, float *magnitude, float *angle) const {
+    if(point >= m_frequencies.size() || first > m_count || count > m_count - first) {
+        throw StoreError("Slice is out of range");
+    }
+    const Layout lay(static_cast<uint32_t>(m_frequencies.size()), m_blockSweeps, m_raw);
+
+    for(uint64_t sweep = first; sweep < first + count;) {
+        const uint8_t *blk = block(sweep);
+        std::size_t slot = sweep % m_blockSweeps;
+        std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(m_blockSweeps - slot, first + count - sweep));
+        // The values of one frequency are contiguous within a block
+        const uint8_t *mag = blk + lay.magnitude + 4 * (point * m_blockSweeps + slot);
+        const uint8_t *ang = blk + lay.angle + 4 * (point * m_blockSweeps + slot);
+        const uint8_t *points = blk + lay.points + 4 * slot;
+        for(std::size_t j = 0; j < n; j++, magnitude++, angle++) {
+            if(point < load<uint32_t>(points + 4 * j)) {
+                *magnitude = detail::beFloat(mag + 4 * j);
+                *angle = detail::beFloat(ang + 4 * j);
+            } else {
+                *magnitude = *angle = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+        sweep += n;
+    }
+}
+
+/**
+ * Finds the first sweep at or after the specified time.
+ *
+ * @param timestamp Time in ns since the epoch
+ * @return Index of the sweep, {@link size} if there is none
+ */
+uint64_t SweepStore::find(int64_t timestamp) const {
+    const Layout lay(static_cast<uint32_t>(m_frequencies.size()), m_blockSweeps, m_raw);
+    uint64_t lo = 0;
+    uint64_t hi = m_count;
+    while(lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if(load<int64_t>(block(mid) + lay.timestamp + 8 * (mid % m_blockSweeps)) < timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+} // namespace impy
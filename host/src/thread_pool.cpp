@@ -0,0 +1,133 @@
+/**
+ * @file    thread_pool.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Fixed size thread pool with work stealing, for batches of independent tasks.
+ */
+
+#include "impy/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace impy {
+
+/**
+ * Starts the worker threads.
+ *
+ * @param threads Number of threads, `0` for one per hardware thread
+ */
+ThreadPool::ThreadPool(std::size_t threads) {
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for(std::size_t j = 0; j < threads; j++) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for(std::size_t j = 0; j < threads; j++) {
+        m_threads.emplace_back(&ThreadPool::work, this, j);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for(std::thread &t : m_threads) {
+        t.join();
+    }
+}
+
+/**
+ * Runs tasks `0` to `tasks - 1` and waits until all of them have finished. If a task throws, the remaining tasks are
+ * skipped and the exception is rethrown here.
+ */
+void ThreadPool::run(std::size_t tasks, const Task &task) {
+    std::size_t workers = m_queues.size();
+    for(std::size_t w = 0; w < workers; w++) {
+        std::lock_guard<std::mutex> lock(m_queues[w]->mutex);
+        for(std::size_t j = tasks * w / workers; j < tasks * (w + 1) / workers; j++) {
+            m_queues[w]->tasks.push_back(j);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_error = nullptr;
+    m_busy = workers;
+    m_batch++;
+    m_start.notify_all();
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_task = nullptr;
+    if(m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void ThreadPool::work(std::size_t worker) {
+    unsigned long batch = 0;
+    while(true) {
+        const Task *task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, batch]() { return m_stop || m_batch != batch; });
+            if(m_stop) {
+                return;
+            }
+            batch = m_batch;
+            task = m_task;
+        }
+
+        std::size_t index;
+        while(next(worker, index)) {
+            try {
+                (*task)(index, worker);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(!m_error) {
+                    m_error = std::current_exception();
+                }
+                // Drop the rest of the batch
+                for(auto &queue : m_queues) {
+                    std::lock_guard<std::mutex> queueLock(queue->mutex);
+                    queue->tasks.clear();
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(--m_busy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+/**
+ * Gets the next task for a worker, from its own queue or stolen from another one.
+ *
+ * @return `false` if there are no tasks left
+ */
+bool ThreadPool::next(std::size_t worker, std::size_t &task) {
+    {
+        Queue &own = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for(std::size_t j = 1; j < m_queues.size(); j++) {
+        Queue &other = *m_queues[(worker + j) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.tasks.empty()) {
+            task = other.tasks.front();
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace impy
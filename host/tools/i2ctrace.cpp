@@ -0,0 +1,180 @@
+/**
+ * @file    i2ctrace.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to list, analyze and replay I2C traces recorded by the firmware.
+ *
+ * Usage:
+ *   i2ctrace list <file>       Print all records
+ *   i2ctrace stats <file>      Print bus time per transfer kind and register, and wasted transfers
+ *   i2ctrace replay <file>     Replay the trace through the stand-in device and print the timing
+ *
+ * A trace is recorded with `debug i2ctrace clear`, followed by the commands of interest and
+ * `debug i2ctrace dump`, whose binary output is saved to a file.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "impy/i2ctrace.hpp"
+
+namespace {
+
+// Values from ad5933.h
+constexpr uint8_t AD5933_ADDR = 0x0D << 1;
+constexpr uint8_t AD5933_CMD_SET_ADDRESS = 0xB0;
+constexpr uint8_t AD5933_STATUS_ADDR = 0x8F;
+constexpr uint8_t AD5933_STATUS_VALID_MASK = 0x03;
+
+struct Stat
+{
+    uint32_t count = 0;
+    uint32_t errors = 0;
+    uint64_t total = 0;
+    uint32_t max = 0;
+
+    void add(const impy::I2CRecord &rec) {
+        count++;
+        errors += (rec.result != 0);
+        total += rec.duration;
+        if(rec.duration > max) {
+            max = rec.duration;
+        }
+    }
+};
+
+int usage() {
+    std::fprintf(stderr, "Usage: i2ctrace (list | stats | replay) <file>\n");
+    return 2;
+}
+
+void list(const impy::I2CTrace &trace) {
+    std::printf("%12s %8s  %-15s %4s %6s %5s %3s  %s\n", "time/us", "dur/us", "op", "addr", "reg", "len", "res",
+            "data");
+    for(const impy::I2CRecord &rec : trace.records) {
+        std::printf("%12" PRIu32 " %8" PRIu32 "  %-15s 0x%02X 0x%04X %5u %3u  %02X %02X %02X %02X\n", rec.timestamp,
+                rec.duration, impy::i2cOpName(rec.op), rec.address, rec.reg, rec.length, rec.result, rec.data[0],
+                rec.data[1], rec.data[2], rec.data[3]);
+    }
+}
+
+void stats(const impy::I2CTrace &trace) {
+    std::map<std::tuple<uint8_t, impy::I2COp, uint16_t>, Stat> byReg;
+    Stat all, repeatedAddress, notReady;
+    int pointer = -1;           // Last AD5933 address pointer value, -1 if unknown
+    bool statusSelected = false;
+
+    for(const impy::I2CRecord &rec : trace.records) {
+        all.add(rec);
+        byReg[std::make_tuple(rec.address, rec.op, rec.reg)].add(rec);
+
+        if(rec.address != AD5933_ADDR) {
+            continue;
+        }
+        if(rec.op == impy::I2COp::MemWrite && rec.reg == AD5933_CMD_SET_ADDRESS) {
+            if(rec.data[0] == pointer) {
+                repeatedAddress.add(rec);
+            }
+            pointer = (rec.result == 0 ? rec.data[0] : -1);
+            statusSelected = (pointer == AD5933_STATUS_ADDR);
+        } else if(rec.op == impy::I2COp::Receive && statusSelected) {
+            if((rec.data[0] & AD5933_STATUS_VALID_MASK) == 0) {
+                notReady.add(rec);
+            }
+        }
+    }
+
+    uint64_t span = 0;
+    if(!trace.records.empty()) {
+        const impy::I2CRecord &last = trace.records.back();
+        span = (last.timestamp + last.duration) - trace.records.front().timestamp;
+    }
+
+    std::printf("Records: %zu (%" PRIu32 " dropped on device)\n", trace.records.size(), trace.dropped);
+    std::printf("Time span: %" PRIu64 " us, bus busy: %" PRIu64 " us (%.1f%%), errors: %" PRIu32 "\n\n", span,
+            all.total, (span ? 100.0 * all.total / span : 0.0), all.errors);
+
+    std::printf("%4s  %-15s %6s %8s %10s %8s %8s %6s\n", "addr", "op", "reg", "count", "total/us", "mean/us",
+            "max/us", "errors");
+    for(const auto &entry : byReg) {
+        const Stat &s = entry.second;
+        std::printf("0x%02X  %-15s 0x%04X %8" PRIu32 " %10" PRIu64 " %8.1f %8" PRIu32 " %6" PRIu32 "\n",
+                std::get<0>(entry.first), impy::i2cOpName(std::get<1>(entry.first)), std::get<2>(entry.first),
+                s.count, s.total, static_cast<double>(s.total) / s.count, s.max, s.errors);
+    }
+
+    std::printf("\nAD5933 address pointer set to the value it already had: %" PRIu32 " transfers, %" PRIu64 " us\n",
+            repeatedAddress.count, repeatedAddress.total);
+    std::printf("AD5933 status polls without valid data: %" PRIu32 " transfers, %" PRIu64 " us\n", notReady.count,
+            notReady.total);
+}
+
+int replay(const impy::I2CTrace &trace) {
+    impy::I2CReplayDevice dev(trace);
+
+    // Issue exactly the recorded transfers, this checks the replay device and shows the timing a driver port would see
+    for(const impy::I2CRecord &rec : trace.records) {
+        switch(rec.op) {
+            case impy::I2COp::MemWrite:
+                dev.memWrite(rec.address, rec.reg, rec.data.data(), rec.length);
+                break;
+            case impy::I2COp::MemRead: {
+                std::vector<uint8_t> data(rec.length);
+                dev.memRead(rec.address, rec.reg, data.data(), rec.length);
+                break;
+            }
+            case impy::I2COp::Transmit: {
+                std::vector<uint8_t> data(rec.length);
+                if(!data.empty()) {
+                    data[0] = static_cast<uint8_t>(rec.reg);
+                }
+                dev.transmit(rec.address, data.data(), rec.length);
+                break;
+            }
+            case impy::I2COp::Receive: {
+                std::vector<uint8_t> data(rec.length);
+                dev.receive(rec.address, data.data(), rec.length);
+                break;
+            }
+            case impy::I2COp::DeviceReady:
+                dev.isDeviceReady(rec.address, rec.length);
+                break;
+            default:
+                std::fprintf(stderr, "Unknown transfer kind %u\n", static_cast<unsigned>(rec.op));
+                return 1;
+        }
+    }
+
+    std::printf("Replayed %zu transfers, virtual time %" PRIu64 " us, bus time %" PRIu64 " us\n", dev.position(),
+            dev.now(), dev.busTime());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if(argc != 3) {
+        return usage();
+    }
+
+    try {
+        impy::I2CTrace trace = impy::loadI2CTrace(argv[2]);
+        if(std::strcmp(argv[1], "list") == 0) {
+            list(trace);
+        } else if(std::strcmp(argv[1], "stats") == 0) {
+            stats(trace);
+        } else if(std::strcmp(argv[1], "replay") == 0) {
+            return replay(trace);
+        } else {
+            return usage();
+        }
+    } catch(const impy::I2CTraceError &e) {
+        std::fprintf(stderr, "i2ctrace: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
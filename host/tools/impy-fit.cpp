@@ -0,0 +1,123 @@
+/**
+ * @file    impy-fit.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to fit an equivalent circuit model to many sweeps in parallel.
+ *
+ * Usage:
+ *   impy-fit [--model=NAME] [--threads=N] [--cold] <store> [<first> [<count>]]
+ *   impy-fit [--model=NAME] [--threads=N] [--cold] -
+ *
+ * Fits the model (series-rc, parallel-rc, series-rl, randles (default), randles-cpe) to the sweeps of a store, or to
+ * the output of `board read --format=BPH` (any number of sweeps, each with byte count) read from standard input. Each
+ * sweep is started from the result for the previous one unless `--cold` is specified. The parameters are printed as
+ * comma separated values, one line per sweep, the fit rate goes to standard error.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "impy/data.hpp"
+#include "impy/fit.hpp"
+#include "impy/sweep_store.hpp"
+#include "impy/thread_pool.hpp"
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "Usage: impy-fit [--model=NAME] [--threads=N] [--cold] <store> [<first> [<count>]]\n"
+            "       impy-fit [--model=NAME] [--threads=N] [--cold] -\n");
+    return 2;
+}
+
+/**
+ * Reads sweeps in binary polar format with byte count from standard input.
+ */
+std::vector<impy::PolarData> readSweeps() {
+    std::vector<impy::PolarData> sweeps;
+    uint8_t count[4];
+    while(std::fread(count, 1, sizeof(count), stdin) == sizeof(count)) {
+        uint32_t size = impy::detail::be32(count);
+        if(size > impy::MAX_READ_SIZE) {
+            throw impy::ProtocolError("Implausible byte count " + std::to_string(size));
+        }
+        std::vector<uint8_t> data(size);
+        if(std::fread(data.data(), 1, size, stdin) != size) {
+            throw impy::ProtocolError("Incomplete sweep");
+        }
+        sweeps.push_back(impy::decodePolar(data.data(), data.size()));
+    }
+    return sweeps;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    impy::CircuitModel model = impy::CircuitModel::Randles;
+    std::size_t threads = 0;
+    impy::FitOptions options;
+    std::vector<std::string> args;
+
+    for(int j = 1; j < argc; j++) {
+        if(std::strncmp(argv[j], "--model=", 8) == 0) {
+            if(!impy::parseModel(argv[j] + 8, model)) {
+                return usage();
+            }
+        } else if(std::strncmp(argv[j], "--threads=", 10) == 0) {
+            threads = std::strtoul(argv[j] + 10, nullptr, 10);
+        } else if(std::strcmp(argv[j], "--cold") == 0) {
+            options.warmStart = false;
+        } else if(argv[j][0] == '-' && argv[j][1] != '\0') {
+            return usage();
+        } else {
+            args.push_back(argv[j]);
+        }
+    }
+    if(args.empty() || args.size() > 3 || (args[0] == "-" && args.size() > 1)) {
+        return usage();
+    }
+
+    try {
+        impy::ThreadPool pool(threads);
+        std::vector<impy::FitResult> results;
+        uint64_t first = 0;
+        auto start = std::chrono::steady_clock::now();
+        if(args[0] == "-") {
+            std::vector<impy::PolarData> sweeps = readSweeps();
+            start = std::chrono::steady_clock::now();
+            results = impy::fitBatch(pool, model, sweeps, options);
+        } else {
+            impy::SweepStore store = impy::SweepStore::open(args[0]);
+            first = (args.size() > 1 ? std::strtoull(args[1].c_str(), nullptr, 10) : 0);
+            uint64_t count = (args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 10) :
+                    store.size() - std::min(first, store.size()));
+            results = impy::fitStore(pool, model, store, first, count, options);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("sweep");
+        for(const std::string &name : impy::parameterNames(model)) {
+            std::printf(",%s", name.c_str());
+        }
+        std::printf(",error,iterations,converged\n");
+        for(std::size_t j = 0; j < results.size(); j++) {
+            std::printf("%" PRIu64, first + j);
+            for(std::size_t k = 0; k < impy::parameterCount(model); k++) {
+                std::printf(",%g", results[j].parameters[k]);
+            }
+            std::printf(",%g,%u,%d\n", results[j].error, results[j].iterations, results[j].converged ? 1 : 0);
+        }
+        std::fprintf(stderr, "%zu fits in %.3f s on %zu threads (%.0f fits/s)\n", results.size(), seconds,
+                pool.size(), results.size() / seconds);
+    } catch(const std::exception &e) {
+        std::fprintf(stderr, "impy-fit: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file    impy-fleet.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to run a list of jobs on any number of boards from one queue.
+ *
+ * Usage:
+ *   impy-fleet [--jobs=FILE] <device>...
+ *
+ * Jobs are read from the file (standard input by default), one per line with `key=value` fields:
+ *   port=N            Port to sweep [default: 0]
+ *   start=HZ stop=HZ steps=N settl=N avg=N voltage=MV feedback=OHMS gain=(on|off)
+ *                     Sweep settings, if any is given the others default to the board's defaults
+ *   device=PATH       Only run on this board
+ *   count=N           Queue the job N times [default: 1]
+ * Empty lines and lines starting with '#' are skipped.
+ *
+ * All results are printed as comma separated values (job, device, port, frequency, magnitude, angle) in the order the
+ * jobs finish, and a summary of each board goes to standard error at the end, including the I2C errors, dropped
+ * command lines, USB stalls and longest interrupt handler run from the board's telemetry.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "impy/event_loop.hpp"
+#include "impy/fleet.hpp"
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "Usage: impy-fleet [--jobs=FILE] <device>...\n");
+    return 2;
+}
+
+std::string message(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch(const std::exception &e) {
+        return e.what();
+    }
+}
+
+/**
+ * Parses one line of the job file.
+ *
+ * @param line The line
+ * @param job Receives the job
+ * @param count Receives the number of times the job is queued
+ * @return An error message, empty if the line is valid
+ */
+std::string parseJob(const std::string &line, impy::FleetJob &job, unsigned long &count) {
+    // Defaults of the board (see 'help options')
+    impy::SweepSettings settings;
+    settings.start = 10000;
+    settings.stop = 100000;
+    settings.steps = 50;
+    settings.settl = 16;
+    settings.avg = 1;
+    bool hasSettings = false;
+
+    std::istringstream in(line);
+    std::string field;
+    count = 1;
+    while(in >> field) {
+        std::size_t eq = field.find('=');
+        if(eq == std::string::npos) {
+            return "Expected key=value: " + field;
+        }
+        std::string key = field.substr(0, eq);
+        std::string value = field.substr(eq + 1);
+        char *end;
+        unsigned long num = std::strtoul(value.c_str(), &end, 10);
+        bool isNum = !value.empty() && *end == '\0';
+
+        if(key == "device") {
+            job.device = value;
+            continue;
+        }
+        if(key == "gain") {
+            if(value != "on" && value != "off") {
+                return "Invalid value: " + field;
+            }
+            settings.gain = (value == "on");
+            hasSettings = true;
+            continue;
+        }
+        if(!isNum) {
+            return "Invalid value: " + field;
+        }
+        if(key == "port") {
+            job.port = static_cast<unsigned>(num);
+        } else if(key == "count") {
+            count = num;
+        } else {
+            hasSettings = true;
+            if(key == "start") {
+                settings.start = static_cast<uint32_t>(num);
+            } else if(key == "stop") {
+                settings.stop = static_cast<uint32_t>(num);
+            } else if(key == "steps") {
+                settings.steps = static_cast<uint16_t>(num);
+            } else if(key == "settl") {
+                settings.settl = static_cast<uint16_t>(num);
+            } else if(key == "avg") {
+                settings.avg = static_cast<uint16_t>(num);
+            } else if(key == "voltage") {
+                settings.voltage = static_cast<uint16_t>(num);
+            } else if(key == "feedback") {
+                settings.feedback = static_cast<uint32_t>(num);
+            } else {
+                return "Unknown key: " + key;
+            }
+        }
+    }
+    if(hasSettings) {
+        job.settings = settings;
+    }
+    return std::string();
+}
+
+/**
+ * Formats a telemetry counter for the summary, "-" for a board without telemetry.
+ */
+std::string counter(const impy::InstrumentState &st, uint32_t impy::Telemetry::*value) {
+    return (st.telemetry ? std::to_string((*st.telemetry).*value) : "-");
+}
+
+/**
+ * Formats the longest run of any interrupt handler in s for the summary.
+ */
+std::string maxIsr(const impy::InstrumentState &st) {
+    if(!st.telemetry || st.telemetry->maxIsrTime.empty()) {
+        return "-";
+    }
+    uint32_t ns = *std::max_element(st.telemetry->maxIsrTime.begin(), st.telemetry->maxIsrTime.end());
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%.1f", ns / 1000.0);
+    return buf;
+}
+
+void printResult(const impy::FleetResult &result) {
+    const impy::PolarData &data = result.data;
+    for(std::size_t j = 0; j < data.size(); j++) {
+        std::printf("%" PRIu64 ",%s,%u,%" PRIu32 ",%g,%g\n", result.job, result.device.c_str(), result.port,
+                data.frequency[j], static_cast<double>(data.magnitude[j]), static_cast<double>(data.angle[j]));
+    }
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *jobsPath = nullptr;
+    std::vector<std::string> paths;
+
+    for(int j = 1; j < argc; j++) {
+        if(std::strncmp(argv[j], "--jobs=", 7) == 0) {
+            jobsPath = argv[j] + 7;
+        } else if(argv[j][0] == '-') {
+            return usage();
+        } else {
+            paths.push_back(argv[j]);
+        }
+    }
+    if(paths.empty()) {
+        return usage();
+    }
+
+    // Read all jobs first, so a mistake in the file doesn't leave half of them run
+    std::ifstream file;
+    if(jobsPath != nullptr) {
+        file.open(jobsPath);
+        if(!file) {
+            std::fprintf(stderr, "impy-fleet: Cannot open %s\n", jobsPath);
+            return 1;
+        }
+    }
+    std::istream &in = (jobsPath != nullptr ? static_cast<std::istream&>(file) : std::cin);
+    std::vector<std::pair<impy::FleetJob, unsigned long>> jobs;
+    std::string line;
+    for(unsigned lineNo = 1; std::getline(in, line); lineNo++) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        impy::FleetJob job;
+        unsigned long count;
+        std::string err = parseJob(line, job, count);
+        if(!err.empty()) {
+            std::fprintf(stderr, "impy-fleet: line %u: %s\n", lineNo, err.c_str());
+            return 1;
+        }
+        jobs.emplace_back(std::move(job), count);
+    }
+
+    impy::EventLoop loop;
+    impy::Fleet fleet(loop);
+    int ret = 0;
+
+    try {
+        for(const std::string &path : paths) {
+            fleet.addInstrument(path);
+        }
+    } catch(const impy::IoError &e) {
+        std::fprintf(stderr, "impy-fleet: %s\n", e.what());
+        return 1;
+    }
+
+    fleet.onResult([&ret](const impy::FleetResult &result) {
+        if(result.error) {
+            std::fprintf(stderr, "impy-fleet: job %" PRIu64 "%s%s: %s\n", result.job,
+                    (result.device.empty() ? "" : " on "), result.device.c_str(), message(result.error).c_str());
+            ret = 1;
+        } else {
+            printResult(result);
+        }
+    });
+    for(const auto &job : jobs) {
+        for(unsigned long k = 0; k < job.second; k++) {
+            fleet.submit(job.first);
+        }
+    }
+
+    auto start = impy::EventLoop::Clock::now();
+    loop.runUntil([&fleet]() { return fleet.done(); });
+    double total = std::chrono::duration<double>(impy::EventLoop::Clock::now() - start).count();
+
+    std::fprintf(stderr, "%-20s %6s %10s %6s %6s %7s %6s %6s %8s  %s\n", "device", "jobs", "busy/s", "busy%", "speed",
+            "i2cerr", "drop", "stall", "isr/us", "state");
+    for(const impy::InstrumentState &st : fleet.instruments()) {
+        double busy = std::chrono::duration<double>(st.busyTime).count();
+        std::string state = (st.error ? message(st.error) : (st.calibrated ? "ok" : "not calibrated"));
+        std::fprintf(stderr, "%-20s %6" PRIu64 " %10.1f %5.1f%% %6.2f %7s %6s %6s %8s  %s\n", st.path.c_str(), st.jobs,
+                busy, (total > 0 ? 100.0 * busy / total : 0.0), st.speed,
+                counter(st, &impy::Telemetry::i2cErrors).c_str(), counter(st, &impy::Telemetry::droppedLines).c_str(),
+                counter(st, &impy::Telemetry::usbStalls).c_str(), maxIsr(st).c_str(), state.c_str());
+    }
+    std::fprintf(stderr, "%zu results in %.1f s\n", fleet.results().size(), total);
+    return ret;
+}
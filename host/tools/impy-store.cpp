@@ -0,0 +1,237 @@
+/**
+ * @file    impy-store.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to record sweeps from `impyd` into a sweep store, and to read stored sweeps.
+ *
+ * Usage:
+ *   impy-store record [--no-raw] <socket> <file>
+ *   impy-store info <file>
+ *   impy-store sweep <file> <index>
+ *   impy-store slice <file> <frequency>
+ *
+ * `record` subscribes to the daemon and appends every completed sweep, the file is created with the frequency plan of
+ * the first sweep if it does not exist. Each sweep is committed on its own, so stopping the tool at any time leaves a
+ * valid file. `sweep` prints one sweep, `slice` prints the values at one frequency (in Hz) across all sweeps, both as
+ * comma separated values.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "impy/data.hpp"
+#include "impy/serial.hpp"
+#include "impy/sweep_store.hpp"
+
+namespace {
+
+constexpr uint8_t END_OF_RESPONSE = 0x04;
+
+int usage() {
+    std::fprintf(stderr, "Usage: impy-store record [--no-raw] <socket> <file>\n"
+            "       impy-store info <file>\n"
+            "       impy-store sweep <file> <index>\n"
+            "       impy-store slice <file> <frequency>\n");
+    return 2;
+}
+
+/**
+ * Blocking reader for the daemon's socket.
+ */
+class Connection
+{
+public:
+    explicit Connection(const std::string &path) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(addr.sun_path)) {
+            throw impy::IoError("Socket path too long: " + path);
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(m_fd < 0 || connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            throw impy::IoError("Cannot connect to " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    ~Connection() {
+        if(m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    void send(const std::string &line) {
+        if(::send(m_fd, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) {
+            throw impy::IoError(std::string("Cannot send: ") + std::strerror(errno));
+        }
+    }
+
+    void read(uint8_t *data, std::size_t size) {
+        while(size > 0) {
+            ssize_t len = recv(m_fd, data, size, 0);
+            if(len <= 0) {
+                if(len < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw impy::IoError("Daemon closed the connection");
+            }
+            data += len;
+            size -= static_cast<std::size_t>(len);
+        }
+    }
+
+    uint8_t readByte() {
+        uint8_t c;
+        read(&c, 1);
+        return c;
+    }
+
+    std::string readLine() {
+        std::string line;
+        uint8_t c;
+        while((c = readByte()) != '\n') {
+            if(c != '\r') {
+                line += static_cast<char>(c);
+            }
+        }
+        return line;
+    }
+
+    /** Reads binary data preceded by its byte count. */
+    std::vector<uint8_t> readCounted() {
+        uint8_t count[4];
+        read(count, sizeof(count));
+        uint32_t size = impy::detail::be32(count);
+        if(size > impy::MAX_READ_SIZE) {
+            throw impy::ProtocolError("Implausible byte count " + std::to_string(size));
+        }
+        std::vector<uint8_t> data(size);
+        read(data.data(), data.size());
+        return data;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+int record(const std::string &socket, const std::string &path, bool raw) {
+    Connection conn(socket);
+    conn.send("subscribe\n");
+    if(conn.readLine() != "OK" || conn.readByte() != END_OF_RESPONSE) {
+        throw impy::ProtocolError("Subscription not accepted");
+    }
+
+    // Append to an existing file, create it with the frequency plan of the first sweep otherwise
+    std::unique_ptr<impy::SweepStoreWriter> writer;
+    if(access(path.c_str(), F_OK) == 0) {
+        writer.reset(new impy::SweepStoreWriter(impy::SweepStoreWriter::open(path)));
+    }
+
+    while(true) {
+        std::string header = conn.readLine();
+        std::vector<uint8_t> polar = conn.readCounted();
+        std::vector<uint8_t> rawData = conn.readCounted();
+        if(conn.readByte() != END_OF_RESPONSE) {
+            throw impy::ProtocolError("Sweep not terminated");
+        }
+
+        impy::SweepInfo info;
+        info.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        std::size_t pos = header.find("port=");
+        if(pos != std::string::npos) {
+            info.port = static_cast<uint32_t>(std::strtoul(header.c_str() + pos + 5, nullptr, 10));
+        }
+
+        if(!writer) {
+            impy::PolarData first = impy::decodePolar(polar.data(), polar.size());
+            if(first.size() == 0) {
+                continue;
+            }
+            writer.reset(new impy::SweepStoreWriter(impy::SweepStoreWriter::create(path, first.frequency, raw)));
+        }
+        uint64_t index = writer->append(info, polar.data(), polar.size(), rawData.data(), rawData.size());
+        std::fprintf(stderr, "%s -> %" PRIu64 "\n", header.c_str(), index);
+    }
+}
+
+int info(const std::string &path) {
+    impy::SweepStore store = impy::SweepStore::open(path);
+    const std::vector<uint32_t> &freq = store.frequencies();
+    std::printf("sweeps=%" PRIu64 "\npoints=%zu\nstart=%" PRIu32 "\nstop=%" PRIu32 "\nraw=%s\n", store.size(),
+            freq.size(), freq.front(), freq.back(), (store.hasRaw() ? "yes" : "no"));
+    if(store.size() > 0) {
+        std::printf("first=%" PRId64 "\nlast=%" PRId64 "\n", store.info(0).timestamp,
+                store.info(store.size() - 1).timestamp);
+    }
+    return 0;
+}
+
+int sweep(const std::string &path, uint64_t index) {
+    impy::SweepStore store = impy::SweepStore::open(path);
+    impy::PolarData data = store.polar(index);
+    for(std::size_t j = 0; j < data.size(); j++) {
+        std::printf("%" PRIu32 ",%g,%g\n", data.frequency[j], static_cast<double>(data.magnitude[j]),
+                static_cast<double>(data.angle[j]));
+    }
+    return 0;
+}
+
+int slice(const std::string &path, uint32_t frequency) {
+    impy::SweepStore store = impy::SweepStore::open(path);
+    const std::vector<uint32_t> &freq = store.frequencies();
+    std::size_t point = 0;
+    while(point < freq.size() && freq[point] != frequency) {
+        point++;
+    }
+    if(point == freq.size()) {
+        std::fprintf(stderr, "impy-store: %" PRIu32 " Hz is not in the frequency plan\n", frequency);
+        return 1;
+    }
+
+    std::vector<float> magnitude(store.size());
+    std::vector<float> angle(store.size());
+    store.slice(point, 0, store.size(), magnitude.data(), angle.data());
+    for(uint64_t j = 0; j < store.size(); j++) {
+        std::printf("%" PRIu64 ",%" PRId64 ",%g,%g\n", j, store.info(j).timestamp, static_cast<double>(magnitude[j]),
+                static_cast<double>(angle[j]));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    bool raw = true;
+    if(args.size() >= 2 && args[0] == "record" && args[1] == "--no-raw") {
+        raw = false;
+        args.erase(args.begin() + 1);
+    }
+
+    try {
+        if(args.size() == 3 && args[0] == "record") {
+            return record(args[1], args[2], raw);
+        } else if(args.size() == 2 && args[0] == "info") {
+            return info(args[1]);
+        } else if(args.size() == 3 && args[0] == "sweep") {
+            return sweep(args[1], std::strtoull(args[2].c_str(), nullptr, 10));
+        } else if(args.size() == 3 && args[0] == "slice") {
+            return slice(args[1], static_cast<uint32_t>(std::strtoul(args[2].c_str(), nullptr, 10)));
+        }
+    } catch(const std::exception &e) {
+        std::fprintf(stderr, "impy-store: %s\n", e.what());
+        return 1;
+    }
+    return usage();
+}
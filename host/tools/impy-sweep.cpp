@@ -0,0 +1,135 @@
+/**
+ * @file    impy-sweep.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to run a sweep on any number of boards at the same time and print the results.
+ *
+ * Usage:
+ *   impy-sweep [--port=N] [--format=(polar|cartesian|raw)] <device>...
+ *
+ * Each board runs a sweep with its current settings on the specified port (default 0), all boards are driven from one
+ * thread. The results are printed as comma separated values, with the device as the first column.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "impy/device.hpp"
+#include "impy/event_loop.hpp"
+
+namespace {
+
+enum class Format
+{
+    Polar,
+    Cartesian,
+    Raw
+};
+
+int usage() {
+    std::fprintf(stderr, "Usage: impy-sweep [--port=N] [--format=(polar|cartesian|raw)] <device>...\n");
+    return 2;
+}
+
+std::string message(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch(const std::exception &e) {
+        return e.what();
+    }
+}
+
+template<typename Data, typename T>
+void print(const std::string &dev, const Data &data, const std::vector<T> &first, const std::vector<T> &second) {
+    for(std::size_t j = 0; j < data.size(); j++) {
+        std::printf("%s,%" PRIu32 ",%g,%g\n", dev.c_str(), data.frequency[j], static_cast<double>(first[j]),
+                static_cast<double>(second[j]));
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    unsigned port = 0;
+    Format format = Format::Polar;
+    std::vector<std::string> paths;
+
+    for(int j = 1; j < argc; j++) {
+        if(std::strncmp(argv[j], "--port=", 7) == 0) {
+            port = static_cast<unsigned>(std::strtoul(argv[j] + 7, nullptr, 10));
+        } else if(std::strcmp(argv[j], "--format=polar") == 0) {
+            format = Format::Polar;
+        } else if(std::strcmp(argv[j], "--format=cartesian") == 0) {
+            format = Format::Cartesian;
+        } else if(std::strcmp(argv[j], "--format=raw") == 0) {
+            format = Format::Raw;
+        } else if(argv[j][0] == '-') {
+            return usage();
+        } else {
+            paths.push_back(argv[j]);
+        }
+    }
+    if(paths.empty()) {
+        return usage();
+    }
+
+    impy::EventLoop loop;
+    std::vector<std::unique_ptr<impy::Device>> devices;
+    std::size_t running = 0;
+    int ret = 0;
+
+    try {
+        for(const std::string &path : paths) {
+            devices.push_back(std::make_unique<impy::Device>(loop, path));
+        }
+    } catch(const impy::IoError &e) {
+        std::fprintf(stderr, "impy-sweep: %s\n", e.what());
+        return 1;
+    }
+
+    // Queue the whole measurement on every board, the commands run back to back without waiting for the host
+    for(auto &dev : devices) {
+        const std::string path = dev->path();
+        auto fail = [&ret, path](std::exception_ptr error) {
+            if(error) {
+                std::fprintf(stderr, "impy-sweep: %s: %s\n", path.c_str(), message(error).c_str());
+                ret = 1;
+            }
+        };
+
+        running++;
+        dev->start(port, fail);
+        dev->wait([fail](uint32_t, std::exception_ptr error) { fail(error); });
+        switch(format) {
+            case Format::Polar:
+                dev->readPolar([&running, fail, path](impy::PolarData data, std::exception_ptr error) {
+                    fail(error);
+                    print(path, data, data.magnitude, data.angle);
+                    running--;
+                });
+                break;
+            case Format::Cartesian:
+                dev->readCartesian([&running, fail, path](impy::CartesianData data, std::exception_ptr error) {
+                    fail(error);
+                    print(path, data, data.real, data.imag);
+                    running--;
+                });
+                break;
+            case Format::Raw:
+                dev->readRaw([&running, fail, path](impy::RawData data, std::exception_ptr error) {
+                    fail(error);
+                    print(path, data, data.real, data.imag);
+                    running--;
+                });
+                break;
+        }
+    }
+
+    loop.runUntil([&running]() { return running == 0; });
+    return ret;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file    impy-timeline.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Command line tool to show event traces recorded by the firmware as a timeline.
+ *
+ * Usage:
+ *   impy-timeline [--swo] [--clock=HZ] list <file>                 Print all events
+ *   impy-timeline [--swo] [--clock=HZ] summary <file>              Print busy time and overlap of the activities
+ *   impy-timeline [--swo] [--clock=HZ] [--width=N] chart <file>    Draw the activities as text, one line each
+ *
+ * A trace is recorded with `debug evtrace clear` and `debug evtrace on`, followed by the commands of interest and
+ * `debug evtrace dump`, whose binary output is saved to a file. With `--swo` the file is a raw SWO capture instead,
+ * which doesn't include the core clock frequency, so it can be specified with `--clock` (120MHz by default).
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "impy/evtrace.hpp"
+
+namespace {
+
+/** Disjoint intervals in cycles, ordered by start. */
+using Intervals = std::vector<std::pair<uint64_t, uint64_t>>;
+
+int usage() {
+    std::fprintf(stderr, "Usage: impy-timeline [--swo] [--clock=HZ] [--width=N] (list | summary | chart) <file>\n");
+    return 2;
+}
+
+/**
+ * Merges the spans of one lane into disjoint intervals, so nested spans are counted once.
+ */
+Intervals merge(const std::vector<impy::Span> &spans, impy::Lane lane) {
+    Intervals all;
+    for(const impy::Span &s : spans) {
+        if(s.lane == lane) {
+            all.emplace_back(s.start, s.end);
+        }
+    }
+    std::sort(all.begin(), all.end());
+
+    Intervals ret;
+    for(const auto &iv : all) {
+        if(!ret.empty() && iv.first <= ret.back().second) {
+            ret.back().second = std::max(ret.back().second, iv.second);
+        } else {
+            ret.push_back(iv);
+        }
+    }
+    return ret;
+}
+
+uint64_t total(const Intervals &ivs) {
+    uint64_t sum = 0;
+    for(const auto &iv : ivs) {
+        sum += iv.second - iv.first;
+    }
+    return sum;
+}
+
+/**
+ * Gets the time in which both lanes were busy.
+ */
+uint64_t overlap(const Intervals &a, const Intervals &b) {
+    uint64_t sum = 0;
+    std::size_t j = 0, k = 0;
+    while(j < a.size() && k < b.size()) {
+        uint64_t start = std::max(a[j].first, b[k].first);
+        uint64_t end = std::min(a[j].second, b[k].second);
+        if(start < end) {
+            sum += end - start;
+        }
+        if(a[j].second < b[k].second) {
+            j++;
+        } else {
+            k++;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Gets whether a point in time is inside one of the intervals.
+ */
+bool contains(const Intervals &ivs, uint64_t cycles) {
+    auto it = std::upper_bound(ivs.begin(), ivs.end(), std::make_pair(cycles, UINT64_MAX));
+    return it != ivs.begin() && cycles <= std::prev(it)->second;
+}
+
+void list(const impy::EventTrace &trace) {
+    std::printf("%14s %10s  %-10s %s\n", "time/us", "delta/us", "event", "args");
+    uint64_t last = 0;
+    for(const impy::Event &ev : trace.events) {
+        std::printf("%14.2f %10.2f  %-10s %3u %5u\n", trace.micros(ev.cycles), trace.micros(ev.cycles - last),
+                impy::eventTypeName(ev.type), ev.arg8, ev.arg);
+        last = ev.cycles;
+    }
+}
+
+void summary(const impy::EventTrace &trace) {
+    std::vector<impy::Span> spans = impy::eventSpans(trace);
+    uint64_t span = (trace.events.empty() ? 0 : trace.events.back().cycles);
+
+    std::printf("Events: %zu (%" PRIu32 " dropped), time span: %.1f us\n\n", trace.events.size(), trace.dropped,
+            trace.micros(span));
+
+    Intervals lanes[impy::LANE_COUNT];
+    std::printf("%-8s %8s %12s %10s %10s %7s %8s %8s\n", "lane", "count", "busy/us", "mean/us", "max/us", "busy%",
+            "points", "packets");
+    for(std::size_t j = 0; j < impy::LANE_COUNT; j++) {
+        impy::Lane lane = static_cast<impy::Lane>(j);
+        lanes[j] = merge(spans, lane);
+
+        uint32_t count = 0;
+        uint64_t max = 0;
+        for(const impy::Span &s : spans) {
+            if(s.lane == lane) {
+                count++;
+                max = std::max(max, s.end - s.start);
+            }
+        }
+        uint32_t points = 0, packets = 0;
+        for(const impy::Event &ev : trace.events) {
+            if(ev.type == impy::EventType::PointStored && contains(lanes[j], ev.cycles)) {
+                points++;
+            } else if(ev.type == impy::EventType::UsbPacket && contains(lanes[j], ev.cycles)) {
+                packets++;
+            }
+        }
+
+        uint64_t busy = total(lanes[j]);
+        std::printf("%-8s %8" PRIu32 " %12.1f %10.2f %10.2f %6.1f%% %8" PRIu32 " %8" PRIu32 "\n",
+                impy::laneName(lane), count, trace.micros(busy), (count ? trace.micros(busy) / count : 0.0),
+                trace.micros(max), (span ? 100.0 * busy / span : 0.0), points, packets);
+    }
+
+    std::printf("\nOverlap/us");
+    for(std::size_t k = 0; k < impy::LANE_COUNT; k++) {
+        std::printf(" %10s", impy::laneName(static_cast<impy::Lane>(k)));
+    }
+    std::printf("\n");
+    for(std::size_t j = 0; j < impy::LANE_COUNT; j++) {
+        std::printf("%-10s", impy::laneName(static_cast<impy::Lane>(j)));
+        for(std::size_t k = 0; k < impy::LANE_COUNT; k++) {
+            if(j == k) {
+                std::printf(" %10s", "-");
+            } else {
+                std::printf(" %10.1f", trace.micros(overlap(lanes[j], lanes[k])));
+            }
+        }
+        std::printf("\n");
+    }
+}
+
+/**
+ * Draws one line per lane, where `#` marks columns busy for at least half the time and `-` columns busy for less.
+ * Points stored and USB packets are drawn as the number of events in each column, `*` meaning more than 9.
+ */
+void chart(const impy::EventTrace &trace, std::size_t width) {
+    std::vector<impy::Span> spans = impy::eventSpans(trace);
+    uint64_t span = (trace.events.empty() ? 0 : trace.events.back().cycles) + 1;
+    double perColumn = static_cast<double>(span) / width;
+
+    auto draw = [&](const char *name, const std::string &line) {
+        std::printf("%-10s |%s|\n", name, line.c_str());
+    };
+
+    for(std::size_t j = 0; j < impy::LANE_COUNT; j++) {
+        impy::Lane lane = static_cast<impy::Lane>(j);
+        std::vector<double> busy(width, 0.0);
+        for(const auto &iv : merge(spans, lane)) {
+            // Distribute the interval over the columns it covers
+            for(std::size_t c = static_cast<std::size_t>(iv.first / perColumn); c < width; c++) {
+                double colStart = c * perColumn;
+                double colEnd = colStart + perColumn;
+                if(colStart >= iv.second) {
+                    break;
+                }
+                busy[c] += std::min<double>(colEnd, iv.second) - std::max<double>(colStart, iv.first);
+            }
+        }
+        std::string line(width, ' ');
+        for(std::size_t c = 0; c < width; c++) {
+            if(busy[c] >= perColumn / 2) {
+                line[c] = '#';
+            } else if(busy[c] > 0) {
+                line[c] = '-';
+            }
+        }
+        draw(impy::laneName(lane), line);
+    }
+
+    for(impy::EventType type : { impy::EventType::PointStored, impy::EventType::UsbPacket }) {
+        std::vector<unsigned> count(width, 0);
+        for(const impy::Event &ev : trace.events) {
+            if(ev.type == type) {
+                count[std::min(width - 1, static_cast<std::size_t>(ev.cycles / perColumn))]++;
+            }
+        }
+        std::string line(width, ' ');
+        for(std::size_t c = 0; c < width; c++) {
+            if(count[c] > 9) {
+                line[c] = '*';
+            } else if(count[c] > 0) {
+                line[c] = static_cast<char>('0' + count[c]);
+            }
+        }
+        draw(impy::eventTypeName(type), line);
+    }
+
+    std::printf("%-10s  0 us%*.1f us\n", "", static_cast<int>(width) - 5, trace.micros(span));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bool swo = false;
+    uint32_t clock = impy::EVENT_DEFAULT_CLOCK;
+    std::size_t width = 100;
+    std::vector<const char*> args;
+
+    for(int j = 1; j < argc; j++) {
+        if(std::strcmp(argv[j], "--swo") == 0) {
+            swo = true;
+        } else if(std::strncmp(argv[j], "--clock=", 8) == 0) {
+            clock = static_cast<uint32_t>(std::strtoul(argv[j] + 8, nullptr, 10));
+        } else if(std::strncmp(argv[j], "--width=", 8) == 0) {
+            width = std::strtoul(argv[j] + 8, nullptr, 10);
+        } else if(argv[j][0] == '-' && argv[j][1] != '\0') {
+            return usage();
+        } else {
+            args.push_back(argv[j]);
+        }
+    }
+    if(args.size() != 2 || width < 10) {
+        return usage();
+    }
+
+    try {
+        impy::EventTrace trace = (swo ? impy::loadSwoTrace(args[1], clock) : impy::loadEventTrace(args[1]));
+        if(std::strcmp(args[0], "list") == 0) {
+            list(trace);
+        } else if(std::strcmp(args[0], "summary") == 0) {
+            summary(trace);
+        } else if(std::strcmp(args[0], "chart") == 0) {
+            chart(trace, width);
+        } else {
+            return usage();
+        }
+    } catch(const impy::EventTraceError &e) {
+        std::fprintf(stderr, "impy-timeline: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
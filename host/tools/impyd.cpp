@@ -0,0 +1,736 @@
+/**
+ * @file    impyd.cpp
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Daemon that owns the serial port of a board and shares it between any number of clients.
+ *
+ * Usage:
+ *   impyd [--shm=NAME] [--slots=N] <device> <socket>
+ *
+ * Clients connect to the Unix socket and send console commands, one per line, exactly as they would to the board.
+ * Each response is followed by an EOT character (0x04), like responses to lines preceded with '$' on the board. The
+ * commands of all clients go through one queue, so they never disturb each other.
+ *
+ * The daemon keeps track of the board state and answers these queries from its cache, without touching the board:
+ *   board status           As of the last poll (every 250 ms while a sweep is running)
+ *   board get all          Refreshed after every `board set`
+ *   board wait             Answered when the daemon sees the sweep finish
+ *   board read             Binary formats only, the data of the latest sweep is read once when it finishes
+ *
+ * Other commands that may sweep (`board test`, `board monitor` and the like) drop the cached data. While the board has
+ * scheduled jobs (`board sched`), which sweep without the daemon knowing, `board status` and `board read` always go to
+ * the board.
+ *
+ * Identical read-only commands (`board temp`, `board info`, `board get <option>`, `help`) from several clients are
+ * sent to the board once while the first one is still queued.
+ *
+ * The special command `subscribe` turns a connection into a subscription. For every completed sweep the client then
+ * receives the line `sweep=<number> port=<port> points=<count>`, polar data (format BPH) and raw data (binary with byte
+ * count), followed by EOT. With `--shm` completed sweeps are also published to a ring in shared memory holding the
+ * specified number of sweeps (default 16), see `impy/sweep_ring.hpp`.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "impy/data.hpp"
+#include "impy/device.hpp"
+#include "impy/event_loop.hpp"
+#include "impy/sweep_ring.hpp"
+
+namespace {
+
+constexpr char END_OF_RESPONSE = 0x04;
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+constexpr std::size_t MAX_CLIENT_LINE = 1024;
+constexpr std::size_t MAX_CLIENT_LINES = 256;
+/** Clients (subscribers, mostly) that don't read their output are disconnected when this much is queued. */
+constexpr std::size_t MAX_CLIENT_OUTPUT = 16 * 1024 * 1024;
+
+// Texts from strings_en.h
+const std::string txtAdStatusFinishImpedance = "Impedance measurement finished, points measured: ";
+const std::string txtAdStatusIdle = "No measurement is running.";
+const std::string txtOK = "OK";
+
+bool startsWith(const std::string &str, const std::string &prefix) {
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::string message(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch(const std::exception &e) {
+        return e.what();
+    }
+}
+
+void appendBe32(std::string &out, uint32_t value) {
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+std::string withCount(const std::string &data) {
+    std::string out;
+    appendBe32(out, static_cast<uint32_t>(data.size()));
+    return out + data;
+}
+
+/**
+ * Encodes cartesian data in the board's binary format, computed from polar data the same way the board does.
+ */
+std::string encodeCartesian(const impy::PolarData &polar) {
+    std::string out;
+    out.reserve(polar.size() * impy::IMPEDANCE_RECORD_SIZE);
+    for(std::size_t j = 0; j < polar.size(); j++) {
+        float real = polar.magnitude[j] * std::cos(polar.angle[j]);
+        float imag = polar.magnitude[j] * std::sin(polar.angle[j]);
+        uint32_t bits;
+        appendBe32(out, polar.frequency[j]);
+        std::memcpy(&bits, &real, sizeof(bits));
+        appendBe32(out, bits);
+        std::memcpy(&bits, &imag, sizeof(bits));
+        appendBe32(out, bits);
+    }
+    return out;
+}
+
+/**
+ * Response to one client request, responses are sent in the order of the requests.
+ */
+struct Reply
+{
+    bool ready = false;
+    std::string data;
+};
+
+/**
+ * A connected client. Its lines are handled one at a time, the next one only after the response to the previous one
+ * is ready, so `board wait` followed by `board read` behaves the same as on the board.
+ */
+struct Client
+{
+    int fd;
+    std::string in;
+    std::deque<std::string> lines;          //!< Lines received but not handled yet
+    std::string out;
+    std::deque<std::shared_ptr<Reply>> replies;
+    bool subscriber = false;
+    bool handling = false;                  //!< Whether {@link Server::handleLines} is running for this client
+};
+
+/** A client waiting for a reply. */
+using Waiter = std::pair<uint64_t, std::shared_ptr<Reply>>;
+
+class Server
+{
+public:
+    Server(impy::EventLoop &loop, const std::string &device, const std::string &socketPath,
+            std::optional<impy::SweepRing> ring);
+    ~Server();
+
+    int exitCode() const { return m_exitCode; }
+
+private:
+    void onAccept();
+    void onClient(uint64_t id, uint32_t events);
+    void closeClient(uint64_t id);
+    void handleLines(uint64_t id);
+    void handleLine(uint64_t id, std::string line);
+    void respond(const Waiter &waiter, const std::string &data);
+    void flush(uint64_t id);
+
+    void forward(const std::string &line, const Waiter &waiter, std::function<void(const std::string&)> after);
+    bool readCached(const std::vector<std::string> &args, const Waiter &waiter);
+    void releaseWaiting(const std::string &text);
+    void refreshStatus();
+    void refreshSettings(bool format);
+    void refreshSchedule();
+    void dropData();
+    void startPolling();
+    void fetchSweep(bool publish, uint32_t points);
+    void checkDevice(std::exception_ptr error);
+
+    impy::EventLoop &m_loop;
+    impy::Device m_dev;
+    std::optional<impy::SweepRing> m_ring;
+    std::string m_socketPath;
+    int m_listen = -1;
+
+    std::map<uint64_t, Client> m_clients;
+    uint64_t m_nextClient = 1;
+    //! Read-only commands queued on the board, with all clients waiting for the response
+    std::map<std::string, std::vector<Waiter>> m_shared;
+
+    // Cached board state
+    std::string m_status;                   //!< Output of `board status`
+    std::string m_settings;                 //!< Output of `board get all`
+    std::string m_format;                   //!< Default format for `board read`
+    bool m_running = false;                 //!< Whether a sweep is running
+    bool m_scheduled = false;               //!< Whether the board has scheduled jobs
+    unsigned m_starting = 0;                //!< Number of `board start` commands queued
+    bool m_polling = false;                 //!< Whether a status poll is queued or scheduled
+    uint32_t m_port = 0;
+    std::vector<Waiter> m_waiting;          //!< Clients waiting for the sweep to finish (`board wait`)
+
+    // Data of the latest sweep, in the board's binary format without byte count
+    std::string m_polar;
+    std::string m_cartesian;
+    std::string m_raw;
+    uint64_t m_sweeps = 0;
+
+    int m_exitCode = 0;
+};
+
+Server::Server(impy::EventLoop &loop, const std::string &device, const std::string &socketPath,
+        std::optional<impy::SweepRing> ring) :
+        m_loop(loop), m_dev(loop, device), m_ring(std::move(ring)), m_socketPath(socketPath) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if(socketPath.size() >= sizeof(addr.sun_path)) {
+        throw impy::IoError("Socket path too long: " + socketPath);
+    }
+    std::strcpy(addr.sun_path, socketPath.c_str());
+
+    unlink(socketPath.c_str());
+    m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(m_listen < 0 || bind(m_listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(m_listen, 16) != 0) {
+        throw impy::IoError("Cannot listen on " + socketPath + ": " + std::strerror(errno));
+    }
+    m_loop.add(m_listen, EPOLLIN, [this](uint32_t) { onAccept(); });
+
+    // Fill the cache, and pick up data or a sweep already running on the board
+    refreshSettings(true);
+    m_dev.status([this](impy::Status status, std::exception_ptr error) {
+        checkDevice(error);
+        if(status.validData && status.state != impy::MeasurementState::Sweep) {
+            fetchSweep(false, status.point);
+        }
+    });
+    refreshStatus();
+    refreshSchedule();
+}
+
+Server::~Server() {
+    for(auto &entry : m_clients) {
+        m_loop.remove(entry.second.fd);
+        close(entry.second.fd);
+    }
+    if(m_listen >= 0) {
+        m_loop.remove(m_listen);
+        close(m_listen);
+        unlink(m_socketPath.c_str());
+    }
+}
+
+void Server::onAccept() {
+    int fd;
+    while((fd = accept4(m_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        uint64_t id = m_nextClient++;
+        m_clients[id].fd = fd;
+        m_loop.add(fd, EPOLLIN, [this, id](uint32_t events) { onClient(id, events); });
+    }
+}
+
+void Server::onClient(uint64_t id, uint32_t events) {
+    if(events & EPOLLOUT) {
+        flush(id);
+    }
+    auto it = m_clients.find(id);
+    if(it == m_clients.end() || !(events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+        return;
+    }
+
+    char buf[4096];
+    ssize_t len = recv(it->second.fd, buf, sizeof(buf), 0);
+    if(len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+        closeClient(id);
+        return;
+    }
+    if(len < 0) {
+        return;
+    }
+
+    Client &client = it->second;
+    client.in.append(buf, static_cast<std::size_t>(len));
+    std::size_t end;
+    while((end = client.in.find_first_of("\r\n")) != std::string::npos) {
+        client.lines.push_back(client.in.substr(0, end));
+        client.in.erase(0, end + 1);
+    }
+    if(client.in.size() > MAX_CLIENT_LINE || client.lines.size() > MAX_CLIENT_LINES) {
+        closeClient(id);
+        return;
+    }
+    handleLines(id);
+}
+
+/**
+ * Handles received lines of a client until one of them has to wait for the board.
+ */
+void Server::handleLines(uint64_t id) {
+    auto it = m_clients.find(id);
+    if(it == m_clients.end() || it->second.handling) {
+        return;
+    }
+    it->second.handling = true;
+    while(true) {
+        // Responses already sent to the client have been removed from the queue
+        it = m_clients.find(id);
+        if(it == m_clients.end()) {
+            return;
+        }
+        Client &client = it->second;
+        if(client.lines.empty() || !client.replies.empty()) {
+            client.handling = false;
+            return;
+        }
+        std::string line = std::move(client.lines.front());
+        client.lines.pop_front();
+        handleLine(id, line);
+    }
+}
+
+void Server::closeClient(uint64_t id) {
+    auto it = m_clients.find(id);
+    if(it != m_clients.end()) {
+        m_loop.remove(it->second.fd);
+        close(it->second.fd);
+        m_clients.erase(it);
+    }
+}
+
+void Server::handleLine(uint64_t id, std::string line) {
+    // The board's prefixes make no difference here, all responses are terminated
+    std::size_t start = line.find_first_not_of(" \t$@");
+    if(start == std::string::npos) {
+        return;
+    }
+    line.erase(0, start);
+    line.erase(line.find_last_not_of(" \t") + 1);
+
+    std::vector<std::string> args;
+    for(std::size_t pos = 0; pos < line.size();) {
+        std::size_t end = line.find_first_of(" \t", pos);
+        if(end == std::string::npos) {
+            end = line.size();
+        }
+        if(end > pos) {
+            args.push_back(line.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+
+    Client &client = m_clients[id];
+    auto reply = std::make_shared<Reply>();
+    client.replies.push_back(reply);
+    Waiter waiter(id, reply);
+
+    if(line == "subscribe") {
+        client.subscriber = true;
+        respond(waiter, txtOK + "\r\n");
+        return;
+    }
+
+    bool board = (args.size() >= 2 && args[0] == "board");
+    const std::string sub = (board ? args[1] : std::string());
+
+    if(line == "board status" && !m_status.empty() && !m_scheduled) {
+        respond(waiter, m_status);
+    } else if(line == "board get all" && !m_settings.empty()) {
+        respond(waiter, m_settings);
+    } else if(line == "board wait") {
+        if(m_running || m_starting > 0) {
+            m_waiting.push_back(waiter);
+        } else if(startsWith(m_status, txtAdStatusFinishImpedance)) {
+            respond(waiter, m_status.substr(0, m_status.find("\r\n") + 2));
+        } else {
+            respond(waiter, txtAdStatusIdle + "\r\n");
+        }
+    } else if(board && sub == "read" && readCached(args, waiter)) {
+        // Answered from the cache
+    } else if(board && sub == "start") {
+        m_starting++;
+        forward(line, waiter, [this, args](const std::string &text) {
+            m_starting--;
+            if(text == txtOK) {
+                m_running = true;
+                m_port = static_cast<uint32_t>(std::strtoul(args.size() > 2 ? args[2].c_str() : "0", nullptr, 0));
+                startPolling();
+            } else if(!m_running && m_starting == 0) {
+                releaseWaiting(txtAdStatusIdle + "\r\n");
+            }
+        });
+    } else if(board && sub == "set") {
+        bool format = (line.find("--format") != std::string::npos);
+        forward(line, waiter, [this, format](const std::string&) { refreshSettings(format); });
+    } else if(board && (sub == "stop" || sub == "calibrate" || sub == "measure" || sub == "standby")) {
+        forward(line, waiter, [this](const std::string&) { refreshStatus(); });
+    } else if(board && (sub == "temp" || sub == "info" || sub == "get")) {
+        forward(line, waiter, nullptr);
+    } else if(args[0] == "help") {
+        forward(line, waiter, nullptr);
+    } else {
+        // Anything else might change the state without us knowing, so it's not shared with other clients
+        forward(line, waiter, [this, sub](const std::string&) {
+            if(sub != "read") {
+                dropData();
+            }
+            refreshStatus();
+            if(sub == "sched") {
+                refreshSchedule();
+            }
+        });
+    }
+}
+
+/**
+ * Sends a command to the board. Identical read-only commands (those without a function to call afterwards) are sent
+ * only once while one is queued. `after` is called with the response, which is empty if the command failed.
+ */
+void Server::forward(const std::string &line, const Waiter &waiter, std::function<void(const std::string&)> after) {
+    bool shared = !after;
+    if(shared) {
+        auto it = m_shared.find(line);
+        if(it != m_shared.end()) {
+            it->second.push_back(waiter);
+            return;
+        }
+        m_shared[line].push_back(waiter);
+    }
+
+    impy::Device::Clock::duration timeout = impy::Device::DEFAULT_TIMEOUT;
+    if(startsWith(line, "board calibrate")) {
+        timeout = std::chrono::seconds(60);
+    }
+    m_dev.command(line, [this, line, waiter, shared, after](std::string text, std::exception_ptr error) {
+        checkDevice(error);
+        std::string data = (error ? "Error: " + message(error) : text);
+        if(!data.empty()) {
+            data += "\r\n";
+        }
+
+        if(shared) {
+            std::vector<Waiter> waiters = std::move(m_shared[line]);
+            m_shared.erase(line);
+            for(const Waiter &w : waiters) {
+                respond(w, data);
+            }
+        } else {
+            respond(waiter, data);
+            if(after) {
+                after(text);
+            }
+        }
+    }, timeout);
+}
+
+/**
+ * Answers `board read` from the data of the latest sweep, only binary formats are cached.
+ *
+ * @return `false` if the command needs to go to the board
+ */
+bool Server::readCached(const std::vector<std::string> &args, const Waiter &waiter) {
+    std::string format = m_format;
+    bool raw = false;
+    for(std::size_t j = 2; j < args.size(); j++) {
+        if(startsWith(args[j], "--format=")) {
+            format = args[j].substr(9);
+        } else if(args[j] == "--raw") {
+            raw = true;
+        } else {
+            return false;
+        }
+    }
+    if(format.find('B') == std::string::npos) {
+        return false;
+    }
+
+    if(m_scheduled || (!m_running && m_polar.empty())) {
+        // The board may have data from a sweep the daemon didn't start
+        return false;
+    }
+    if(m_running) {
+        // Same as the board when there is no data
+        std::string none;
+        appendBe32(none, 0);
+        respond(waiter, none);
+        return true;
+    }
+
+    const std::string &data = (raw ? m_raw : format.find('C') != std::string::npos ? m_cartesian : m_polar);
+    respond(waiter, (format.find('H') != std::string::npos ? withCount(data) : data));
+    return true;
+}
+
+void Server::respond(const Waiter &waiter, const std::string &data) {
+    waiter.second->data = data + END_OF_RESPONSE;
+    waiter.second->ready = true;
+    flush(waiter.first);
+    handleLines(waiter.first);
+}
+
+/**
+ * Answers all pending `board wait` commands.
+ */
+void Server::releaseWaiting(const std::string &text) {
+    std::vector<Waiter> waiting = std::move(m_waiting);
+    m_waiting.clear();
+    for(const Waiter &w : waiting) {
+        respond(w, text);
+    }
+}
+
+/**
+ * Moves finished responses (in request order) to the output buffer and writes as much as possible.
+ */
+void Server::flush(uint64_t id) {
+    auto it = m_clients.find(id);
+    if(it == m_clients.end()) {
+        return;
+    }
+    Client &client = it->second;
+    while(!client.replies.empty() && client.replies.front()->ready) {
+        client.out += client.replies.front()->data;
+        client.replies.pop_front();
+    }
+
+    while(!client.out.empty()) {
+        ssize_t len = send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if(len < 0) {
+            if(errno == EAGAIN || errno == EINTR) {
+                break;
+            }
+            closeClient(id);
+            return;
+        }
+        client.out.erase(0, static_cast<std::size_t>(len));
+    }
+    if(client.out.size() > MAX_CLIENT_OUTPUT) {
+        std::fprintf(stderr, "impyd: Client not reading its output, disconnected\n");
+        closeClient(id);
+        return;
+    }
+    m_loop.modify(client.fd, (client.out.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT));
+}
+
+void Server::refreshStatus() {
+    m_dev.command("board status", [this](std::string text, std::exception_ptr error) {
+        checkDevice(error);
+        if(!error) {
+            m_status = text + "\r\n";
+        }
+    });
+}
+
+void Server::refreshSettings(bool format) {
+    m_dev.command("board get all", [this](std::string text, std::exception_ptr error) {
+        checkDevice(error);
+        // The empty line at the end is part of the output
+        m_settings = (error ? std::string() : text + "\r\n\r\n");
+    });
+    if(format) {
+        m_dev.command("board get format", [this](std::string text, std::exception_ptr error) {
+            checkDevice(error);
+            m_format = (error ? std::string() : text);
+        });
+    }
+}
+
+/**
+ * Checks whether the board has scheduled jobs. Boards without `board sched` have none.
+ */
+void Server::refreshSchedule() {
+    m_dev.command("board sched", [this](std::string text, std::exception_ptr error) {
+        checkDevice(error);
+        m_scheduled = (!error && text.find(": port ") != std::string::npos);
+    });
+}
+
+/**
+ * Forgets the data of the latest sweep, when the board may have measured something else since.
+ */
+void Server::dropData() {
+    m_polar.clear();
+    m_cartesian.clear();
+    m_raw.clear();
+}
+
+/**
+ * Polls the status while a sweep is running, which also keeps the cached status up to date.
+ */
+void Server::startPolling() {
+    if(m_polling) {
+        return;
+    }
+    m_polling = true;
+    m_dev.status([this](impy::Status status, std::exception_ptr error) {
+        checkDevice(error);
+        m_polling = false;
+        if(error) {
+            return;
+        }
+
+        std::string text;
+        for(const std::string &line : status.lines) {
+            text += line + "\r\n";
+        }
+        m_status = text;
+
+        if(status.state == impy::MeasurementState::Sweep) {
+            m_polling = true;
+            m_loop.addTimer(POLL_INTERVAL, [this]() {
+                m_polling = false;
+                startPolling();
+            });
+        } else if(status.state == impy::MeasurementState::Finished) {
+            fetchSweep(true, status.point);
+        } else {
+            // Stopped, or the board was reset
+            m_running = false;
+            releaseWaiting(txtAdStatusIdle + "\r\n");
+        }
+    });
+}
+
+/**
+ * Reads the data of the latest sweep into the cache, and publishes it if it is a new sweep.
+ */
+void Server::fetchSweep(bool publish, uint32_t points) {
+    auto polar = std::make_shared<std::vector<uint8_t>>();
+    m_dev.readBinary("board read --format=BPH", impy::IMPEDANCE_RECORD_SIZE,
+            [this, polar](std::vector<uint8_t> data, std::exception_ptr error) {
+        checkDevice(error);
+        *polar = std::move(data);
+    });
+    m_dev.readBinary("board read --format=BH --raw", impy::RAW_RECORD_SIZE,
+            [this, polar, publish, points](std::vector<uint8_t> raw, std::exception_ptr) {
+        impy::SweepRecord record;
+        try {
+            record.polar = impy::decodePolar(polar->data(), polar->size());
+            record.raw = impy::decodeRaw(raw.data(), raw.size());
+        } catch(const impy::ProtocolError &e) {
+            std::fprintf(stderr, "impyd: %s\n", e.what());
+        }
+        m_polar.assign(polar->begin(), polar->end());
+        m_raw.assign(raw.begin(), raw.end());
+        m_cartesian = encodeCartesian(record.polar);
+
+        if(!publish) {
+            return;
+        }
+        m_running = false;
+        releaseWaiting(txtAdStatusFinishImpedance + std::to_string(points) + "\r\n");
+
+        record.sweep = ++m_sweeps;
+        record.port = m_port;
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        if(m_ring) {
+            m_ring->publish(record);
+        }
+
+        std::string event = "sweep=" + std::to_string(record.sweep) + " port=" + std::to_string(record.port) +
+                " points=" + std::to_string(record.polar.size()) + "\r\n" + withCount(m_polar) + withCount(m_raw);
+        std::vector<uint64_t> subscribers;
+        for(auto &entry : m_clients) {
+            if(entry.second.subscriber) {
+                subscribers.push_back(entry.first);
+            }
+        }
+        for(uint64_t id : subscribers) {
+            auto it = m_clients.find(id);
+            if(it != m_clients.end()) {
+                auto reply = std::make_shared<Reply>();
+                it->second.replies.push_back(reply);
+                respond(Waiter(id, reply), event);
+            }
+        }
+    });
+}
+
+/**
+ * Stops the daemon when the board is gone, errors reported by the board itself are passed on to the clients.
+ */
+void Server::checkDevice(std::exception_ptr error) {
+    if(error && m_dev.failed() && m_exitCode == 0) {
+        std::fprintf(stderr, "impyd: %s\n", message(m_dev.error()).c_str());
+        m_exitCode = 1;
+        m_loop.stop();
+    }
+}
+
+int usage() {
+    std::fprintf(stderr, "Usage: impyd [--shm=NAME] [--slots=N] <device> <socket>\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string shm;
+    uint32_t slots = 16;
+    std::vector<std::string> paths;
+
+    for(int j = 1; j < argc; j++) {
+        if(std::strncmp(argv[j], "--shm=", 6) == 0) {
+            shm = argv[j] + 6;
+        } else if(std::strncmp(argv[j], "--slots=", 8) == 0) {
+            slots = static_cast<uint32_t>(std::strtoul(argv[j] + 8, nullptr, 10));
+        } else if(argv[j][0] == '-') {
+            return usage();
+        } else {
+            paths.push_back(argv[j]);
+        }
+    }
+    if(paths.size() != 2 || slots == 0) {
+        return usage();
+    }
+
+    try {
+        impy::EventLoop loop;
+
+        // Handle termination signals in the loop, so everything is cleaned up (socket file, shared memory)
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        sigprocmask(SIG_BLOCK, &mask, nullptr);
+        int sigfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        loop.add(sigfd, EPOLLIN, [&loop](uint32_t) { loop.stop(); });
+
+        std::optional<impy::SweepRing> ring;
+        if(!shm.empty()) {
+            ring = impy::SweepRing::create(shm, slots);
+        }
+        Server server(loop, paths[0], paths[1], std::move(ring));
+        loop.run();
+
+        loop.remove(sigfd);
+        close(sigfd);
+        return server.exitCode();
+    } catch(const std::exception &e) {
+        std::fprintf(stderr, "impyd: %s\n", e.what());
+        return 1;
+    }
+}
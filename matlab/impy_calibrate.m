@@ -2,9 +2,15 @@ function [ ] = impy_calibrate( comport, resistor )
 %IMPY_CALIBRATE Perform a clibration with the specified calibration resistor
 %   This function waits for the calibration to finish, which can take some time with low frequencies.
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %       resistor - Value of the calibration resistor in Ohm
 
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    impy_mex('calibrate', comport, resistor);
+    return;
+end
+
 fprintf(comport, '@board calibrate %d\n', resistor);
 
 str = fgetl(comport);
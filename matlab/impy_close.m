@@ -0,0 +1,13 @@
+function [ ] = impy_close( comport )
+%IMPY_CLOSE Close a port opened with impy_open, or a serial port object
+%   Arguments:
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
+
+if isa(comport, 'uint64')
+    impy_mex('close', comport);
+else
+    fclose(comport);
+    delete(comport);
+end
+
+end
@@ -1,10 +1,16 @@
 function [ sweep ] = impy_getall( comport )
 %IMPY_GETALL Get the current sweep parameters from the board
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %   Returns:
 %       sweep - structure with current sweep parameters
 
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    sweep = impy_mex('getall', comport);
+    return;
+end
+
 fprintf(comport, '@board get all');
 sweep = struct;
 
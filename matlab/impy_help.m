@@ -1,7 +1,7 @@
 function [ ] = impy_help( comport, varargin )
 %IMPY_HELP Read help text from the board and display
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %       topic (optional) - The help topic to get
 %   Returns:
 %       nothing
@@ -19,6 +19,13 @@ else
 end
 
 %% Send command and read response from board
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    line = strjoin(cmd);
+    disp(impy_mex('command', comport, line(2:end)));
+    return;
+end
+
 fprintf(comport, strjoin(cmd));
 
 text = fgetl(comport);
@@ -0,0 +1,17 @@
+function [ comport ] = impy_open( path )
+%IMPY_OPEN Open the board with the native host library (Linux only)
+%   The returned port can be used with all impy_* functions instead of a serial port object. Commands are then handled
+%   by the MEX file impy_mex (build with 'make mex' in the host directory), which decodes binary data straight into
+%   MATLAB arrays and needs no serial port settings like Terminator, Timeout or InputBufferSize.
+%   Arguments:
+%       path - Path of the virtual COM port, for example '/dev/ttyACM0'
+%   Returns:
+%       comport - Port to pass to the impy_* functions, close with impy_close
+
+if ~ischar(path)
+    error('Argument needs to be a string.');
+end
+
+comport = impy_mex('open', path);
+
+end
@@ -3,11 +3,17 @@ function [ finished, numpoints ] = impy_poll( comport )
 %   Note that this function does not return true if, for example, a temperature or calibration measurement was performed
 %   since the sweep finished. It's only meant to be used while a sweep is running.
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %   Returns:
 %       finished - Logical indicating whether measurement has finished
 %       numpoints - Number of points measured, if finished is true
 
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    [finished, numpoints] = impy_mex('poll', comport);
+    return;
+end
+
 fprintf(comport, '@board status');
 status = fgetl(comport);
 
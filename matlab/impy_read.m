@@ -1,21 +1,30 @@
 function [ freq, out ] = impy_read( comport, varargin )
 %IMPY_READ Read measurement data from board
+%   Data is transferred in binary format and decoded in one go, which is a lot faster than parsing ASCII data line by
+%   line. See 'help format' on the board for a description of the binary format.
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %       format (optional) - Format of the data (can be 'polar', 'cartesian' or 'raw')
 %   Returns:
 %       freq - Vector with frequencies
-%       data - Either a 2xN array with magnitude and phase values (for polar format), or a 1xN array of complex values
-%              (for cartesian format)
+%       data - Either a 2xN array with magnitude and phase values (for polar format), a 1xN array of complex values
+%              (for cartesian format), or a 2xN array with real and imaginary parts (for raw format)
+
+%% Native library
+if isa(comport, 'uint64')
+    % Port opened with impy_open, the data is decoded straight into the output arrays
+    [freq, out] = impy_mex('read', comport, varargin{:});
+    return;
+end
 
 %% Process arguments
-format = 'APHFS';
+format = 'BPH';
 polar = true;
 raw = false;
 
 if nargin == 2
     if strcmp(varargin{1}, 'cartesian')
-        format = 'ACHFS';
+        format = 'BCH';
         polar = false;
     elseif strcmp(varargin{1}, 'raw')
         raw = true;
@@ -26,44 +35,73 @@ elseif nargin ~= 1
     error('Only two arguments expected.');
 end
 
-%% Send command and read header from board
+if raw
+    recordSize = 8;     % uint32 frequency, int16 real and imaginary part
+else
+    recordSize = 12;    % uint32 frequency, two single precision values
+end
+
+%% Send command and read byte count
 if ~raw
     fprintf(comport, '@board read --format=%s\n', format);
 else
     fprintf(comport, '@board read --format=%s --raw\n', format);
 end
 
-line = fgetl(comport);
-if isempty(line)
+header = fread(comport, 4, 'uint8');
+if length(header) ~= 4
     error('Error reading from serial device, check connection.');
-elseif isempty(strfind(line, 'Frequency'))
+end
+count = double(frombigendian(uint8(header), 'uint32'));
+
+% Errors that are detected before the format is known are sent as text, which shows up as an absurd byte count
+if count > 4 * 1024 * 1024 || mod(count, recordSize) ~= 0
+    error([char(header(:)') fgetl(comport)]);
+end
+
+%% Read and decode data
+if count == 0
+    % The board sends a byte count of zero if there is no data (or an error occurred)
     freq = [];
     out = [];
-    error(line);
+    return;
+end
+
+payload = fread(comport, count, 'uint8');
+if length(payload) ~= count
+    error('Error reading from serial device, expected %d bytes but got %d.', count, length(payload));
 end
+records = reshape(uint8(payload), recordSize, []);
 
-%% Parse received data
-k = 1;
-line = fgetl(comport);
-while ~isempty(line)
-    if raw
-        data = sscanf(line, '%u %d %d');
-        freq(k) = data(1);
-        out(:,k) = data(2:3);
+freq = double(frombigendian(records(1:4,:), 'uint32'))';
+if raw
+    out = double([ frombigendian(records(5:6,:), 'int16')'; frombigendian(records(7:8,:), 'int16')' ]);
+else
+    first = double(frombigendian(records(5:8,:), 'single'))';
+    second = double(frombigendian(records(9:12,:), 'single'))';
+    if polar
+        out = [ first; second ];
     else
-        data = sscanf(line, '%u %g %g');
-        freq(k) = data(1);
-
-        if polar
-            out(:,k) = data(2:3);
-        else
-            out(k) = data(2) + 1i * data(3);
-        end
+        out = first + 1i * second;
     end
-    
-    k = k + 1;
-    line = fgetl(comport);
 end
 
 end
 
+
+function [ values ] = frombigendian( bytes, type )
+%FROMBIGENDIAN Convert columns of big endian bytes to a column vector of the specified type
+%   Arguments:
+%       bytes - uint8 array, each column holds one value with the most significant byte first
+%       type - MATLAB class name of the values
+%   Returns:
+%       values - Column vector of converted values
+
+values = typecast(bytes(:), type);
+
+[~, ~, endian] = computer;
+if endian == 'L'
+    values = swapbytes(values);
+end
+
+end
@@ -4,7 +4,7 @@ function [ ] = impy_setsweep( comport, sweep )
 %   The following fields are optional: avg, autorange.
 %   Other fields are ignored.
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %       sweep - Sweep specifications, use impy_getall to obtain a structure with current values
 
 %% Check parameters
@@ -18,6 +18,13 @@ if ~all(fields)
     error('Required fields missing from sweep: %s', strjoin(required(~fields)));
 end
 
+%% Native library
+if isa(comport, 'uint64')
+    % Port opened with impy_open
+    impy_mex('setsweep', comport, sweep);
+    return;
+end
+
 %% Build command string
 curr = impy_getall(comport);
 
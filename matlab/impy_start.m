@@ -1,9 +1,15 @@
 function [ ] = impy_start( comport, port )
 %IMPY_START Start a sweep on specified port
 %   Arguments:
-%       comport - Serial port object that has been 'fopen'ed
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
 %       port - The port number to measure
 
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    impy_mex('start', comport, port);
+    return;
+end
+
 fprintf(comport, '@board start %d\n', port);
 
 str = fgetl(comport);
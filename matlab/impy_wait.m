@@ -0,0 +1,32 @@
+function [ numpoints ] = impy_wait( comport )
+%IMPY_WAIT Wait for a running sweep to finish
+%   This function blocks until the board reports that the sweep has finished, so no polling is needed. The Timeout
+%   property of the serial port needs to be longer than the sweep takes.
+%   Arguments:
+%       comport - Serial port object that has been 'fopen'ed, or a port opened with impy_open
+%   Returns:
+%       numpoints - Number of points measured, or 0 if no sweep was running and no data is present
+
+if isa(comport, 'uint64')
+    % Port opened with impy_open, use the native library
+    numpoints = impy_mex('wait', comport);
+    return;
+end
+
+fprintf(comport, '@board wait');
+status = fgetl(comport);
+
+if isempty(status)
+    error('Error reading from serial device, check connection (or increase the Timeout property).');
+elseif ~isempty(strfind(status, 'finished'))
+    split = strsplit(status, ': ');
+    [numpoints, ok] = str2num(split{2});
+    if ~ok
+        warning('Odd reponse from the board, I don''t know what to do: %s', status);
+        numpoints = 0;
+    end
+else
+    numpoints = 0;
+end
+
+end
@@ -6,7 +6,7 @@
 %  2) Send sweep parameters to board using `impy_setsweep`
 %  3) Calibrate with a suitable calibration resistor using `impy_calibrate`
 %  4) Start a sweep on any port with `impy_start`
-%  5) Wait for the sweep to complete using `impy_poll`
+%  5) Wait for the sweep to complete using `impy_wait`
 %  6) Read data in desired format using `impy_read`
 %  7) Repeat from 4) for other ports if needed, calibration is only necessary when sweep parameters change
 
@@ -30,19 +30,26 @@ port = 0;
 
 
 %% Open COM port
-try
-    impy = serial('COM6', 'BaudRate', 115200);
-    % IMPORTANT: Set the Terminator property to either 'CR/LF' or { 'CR/LF', 'LF' } for proper operation
-    % Timeout needs to be set high when low frequencies are used, because in this case calibration can take a long time
-    % I think InputBufferSize needs to be large enough to hold all data sent by 'board read', so 128KB should be plenty
-    set(impy, 'Terminator', { 'CR/LF', 'LF' }, 'Timeout', 120, 'InputBufferSize', 128*1024);
-    fopen(impy);
-catch ex
-    % In case of an error (quite frequent with serial ports in MATLAB), close the port
-    fclose(impy);
-    delete(impy);
-    clear impy;
-    rethrow(ex);
+if isunix && exist('impy_mex', 'file') == 3
+    % Use the native library if it has been built (see impy_open), that's a lot faster
+    impy = impy_open('/dev/ttyACM0');
+else
+    try
+        impy = serial('COM6', 'BaudRate', 115200);
+        % IMPORTANT: Set the Terminator property to either 'CR/LF' or { 'CR/LF', 'LF' } for proper operation
+        % Timeout needs to be set high when low frequencies are used, because in this case calibration can take a long
+        % time
+        % I think InputBufferSize needs to be large enough to hold all data sent by 'board read', so 128KB should be
+        % plenty
+        set(impy, 'Terminator', { 'CR/LF', 'LF' }, 'Timeout', 120, 'InputBufferSize', 128*1024);
+        fopen(impy);
+    catch ex
+        % In case of an error (quite frequent with serial ports in MATLAB), close the port
+        fclose(impy);
+        delete(impy);
+        clear impy;
+        rethrow(ex);
+    end
 end
 
 
@@ -51,9 +58,7 @@ impy_setsweep(impy, sweep);
 impy_calibrate(impy, cal);
 impy_start(impy, port);
 
-while ~impy_poll(impy)
-    pause(1);
-end
+impy_wait(impy);
 
 [freq, data] = impy_read(impy, 'polar');
 [~, raw] = impy_read(impy, 'raw');
@@ -61,8 +66,7 @@ freq = freq / 1e3;
 
 
 %% Close COM port
-fclose(impy);
-delete(impy);
+impy_close(impy);
 clear impy;
 
 
@@ -26,7 +26,8 @@ typedef enum
     AD_CALIBRATE,                   //!< Driver is doing a calibration measurement
     AD_MEASURE_TEMP,                //!< Driver is doing a temperature measurement
     AD_MEASURE_IMPEDANCE,           //!< Driver is doing an impedance measurement
-    AD_MEASURE_IMPEDANCE_AUTORANGE  //!< Driver is doing an impedance measurement with autoranging
+    AD_MEASURE_IMPEDANCE_AUTORANGE, //!< Driver is doing an impedance measurement with autoranging
+    AD_MEASURE_CONTINUOUS           //!< Driver is repeatedly measuring a single frequency
 } AD5933_Status;
 
 /**
@@ -39,6 +40,17 @@ typedef enum
     AD_ERROR        //!< Indicates an error condition
 } AD5933_Error;
 
+/**
+ * Specifies how the conversions of one frequency point are averaged.
+ */
+typedef enum
+{
+    AD_ESTIMATE_MEAN = 0,   //!< Arithmetic mean
+    AD_ESTIMATE_MEDIAN,     //!< Median
+    AD_ESTIMATE_TRIMMED,    //!< Mean of the middle half (interquartile mean)
+    AD_ESTIMATE_CLIPPED     //!< Mean of the values within 3 sigma of the median, sigma estimated from the MAD
+} AD5933_Estimator;
+
 /**
  * Contains parameters of one sweep.
  */
@@ -50,6 +62,9 @@ typedef struct
     uint16_t Settling_Cycles;   //!< Number of settling cycles before a measurement
     uint16_t Settling_Mult;     //!< Settling time multiplier (one of the {@link AD5933_SETTL_MULT} values)
     uint16_t Averages;          //!< The number of averages for each frequency point
+    AD5933_Estimator Estimator; //!< How the averages are combined, other than the mean only for up to
+                                //!< {@link AD5933_MAX_ROBUST_AVERAGES} averages
+    uint8_t Mains_Freq;         //!< Mains frequency in Hz the averages are synchronized to, or 0 to not synchronize
 } AD5933_Sweep;
 
 /**
@@ -94,6 +109,28 @@ typedef struct
     float    Imag;          //!< Imaginary part of the impedance in Ohms
 } AD5933_ImpedanceCartesian;
 
+/**
+ * Specifies the equivalent circuit models an impedance can be converted to.
+ */
+typedef enum
+{
+    AD_MODEL_CS_RS = 0,     //!< Series capacitance and resistance
+    AD_MODEL_CP_RP,         //!< Parallel capacitance and resistance
+    AD_MODEL_LS_RS          //!< Series inductance and resistance
+} AD5933_Model;
+
+/**
+ * Contains an impedance converted to the reactive and resistive element of an equivalent circuit model.
+ */
+typedef struct
+{
+    uint32_t Frequency;     //!< Frequency of the data point in Hz
+    float    Reactive;      //!< Capacitance in F or inductance in H, depending on the model
+    float    Resistance;    //!< Series or parallel resistance in Ohms, depending on the model
+    float    D;             //!< Dissipation factor (|R / X|, the same for series and parallel models)
+    float    Q;             //!< Quality factor (1 / D)
+} AD5933_Equivalent;
+
 /**
  * Contains specifications for the frequency range of a calibration measurement.
  */
@@ -134,6 +171,21 @@ typedef struct
     uint8_t is_2point;              //!< Whether this is single or two point gain factor data
 } AD5933_GainFactor;
 
+/**
+ * Contains the state of a suspended frequency sweep, see {@link AD5933_SuspendSweep}.
+ * 
+ * The clock source is not saved, since it follows from the next frequency to be measured.
+ */
+typedef struct
+{
+    AD5933_Sweep sweep;             //!< Specification of the whole sweep
+    AD5933_RangeSettings range;     //!< Range settings of the sweep
+    AD5933_ImpedanceData *buffer;   //!< Buffer receiving the measurement data
+    uint16_t count;                 //!< The number of points measured before the sweep was suspended
+    uint16_t errors;                //!< I2C errors during the sweep so far
+    float residual;                 //!< Mains phasor sum of the worst point so far, see {@link AD5933_GetMainsRejection}
+} AD5933_SweepContext;
+
 // Macros ---------------------------------------------------------------------
 
 #ifndef LOBYTE
@@ -152,9 +204,15 @@ typedef struct
 #define AD5933_ADDR                         ((uint8_t)(0x0D << 1))
 
 /**
- * Timeout in ms for I2C communication
+ * Timeout in ms for I2C communication, a transfer takes less than 1ms so this only limits how long a stuck bus blocks
+ * the timer interrupt before it is cleared
  */
-#define AD5933_I2C_TIMEOUT                  0x200
+#define AD5933_I2C_TIMEOUT                  5
+
+/**
+ * The number of consecutive I2C errors while measuring a point before a sweep is aborted
+ */
+#define AD5933_MAX_RETRIES                  3
 
 /**
  * The number of averages per frequency point used for calibration measurements
@@ -531,15 +589,52 @@ typedef struct
  */
 #define AD5933_MAX_NUM_INCREMENTS           ((uint16_t)0x1FF)
 
+/**
+ * Maximum number of averages for estimators other than the mean, which need to keep all samples of a point
+ */
+#define AD5933_MAX_ROBUST_AVERAGES          512
+
+/**
+ * Lowest mains frequency in Hz that averaging can be synchronized to
+ */
+#define AD5933_MAINS_FREQ_MIN               40
+
+/**
+ * Highest mains frequency in Hz that averaging can be synchronized to
+ */
+#define AD5933_MAINS_FREQ_MAX               70
+
+/**
+ * Upper limit in dB for the estimated mains rejection, the timing is never that exact
+ */
+#define AD5933_MAINS_REJECTION_MAX          60.0f
+
+/**
+ * Time in ms between {@link AD5933_Init} and the first access to the AD5933
+ */
+#define AD5933_INIT_DELAY                   5
+
 // Exported functions ---------------------------------------------------------
 
 AD5933_Status AD5933_GetStatus(void);
 uint8_t AD5933_IsBusy(void);
 AD5933_Error AD5933_Init(I2C_HandleTypeDef *i2c, TIM_HandleTypeDef *tim);
+AD5933_Error AD5933_FinishInit(void);
 AD5933_Error AD5933_Reset(void);
 AD5933_Error AD5933_MeasureImpedance(const AD5933_Sweep *sweep, const AD5933_RangeSettings *range,
         AD5933_ImpedanceData *buffer);
+AD5933_Error AD5933_RepeatSweep(void);
+AD5933_Error AD5933_ContinueSweep(const AD5933_Sweep *sweep, const AD5933_RangeSettings *range,
+        AD5933_ImpedanceData *buffer);
+AD5933_Error AD5933_SuspendSweep(AD5933_SweepContext *context);
+AD5933_Error AD5933_ResumeSweep(const AD5933_SweepContext *context);
 uint16_t AD5933_GetSweepCount(void);
+uint16_t AD5933_GetErrorCount(void);
+uint32_t AD5933_GetTotalErrorCount(void);
+uint8_t AD5933_WasAborted(void);
+float AD5933_GetMainsRejection(void);
+AD5933_Error AD5933_MeasureContinuous(uint32_t freq, uint16_t settl, uint16_t averages,
+        const AD5933_RangeSettings *range, AD5933_ImpedanceData *buffer);
 AD5933_Error AD5933_MeasureTemperature(float *destination);
 AD5933_Error AD5933_Calibrate(const AD5933_CalibrationSpec *cal, const AD5933_RangeSettings *range,
         AD5933_GainFactorData *data);
@@ -549,6 +644,7 @@ void AD5933_CalculateGainFactor(const AD5933_GainFactorData *data, AD5933_GainFa
 float AD5933_GetMagnitude(const AD5933_ImpedanceData *data, const AD5933_GainFactor *gain);
 float AD5933_GetPhase(const AD5933_ImpedanceData *data, const AD5933_GainFactor *gain);
 void AD5933_ConvertPolarToCartesian(const AD5933_ImpedancePolar *polar, AD5933_ImpedanceCartesian *cart);
+void AD5933_ConvertPolarToEquivalent(const AD5933_ImpedancePolar *polar, AD5933_Model model, AD5933_Equivalent *eq);
 
 uint16_t AD5933_GetVoltageFromRegister(uint16_t reg);
 
@@ -0,0 +1,38 @@
+/**
+ * @file    boottime.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the start-up time measurement.
+ */
+
+#ifndef BOOTTIME_H_
+#define BOOTTIME_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Milestones of the start-up, in the order they are usually reached.
+ */
+typedef enum
+{
+    BOOT_MAIN = 0,          //!< `main` entered, after clock configuration
+    BOOT_PERIPHERALS,       //!< Peripherals initialized, USB enumeration can start
+    BOOT_SETTINGS,          //!< Configuration and settings loaded from EEPROM (or defaults used)
+    BOOT_READY,             //!< AD5933 initialized, commands are accepted
+    BOOT_USB,               //!< USB configured by the host
+    BOOT_FIRST_COMMAND,     //!< First command line received
+    BOOT_FIRST_SWEEP,       //!< First sweep started
+    BOOT_COUNT              //!< Number of milestones, not a valid value
+} Boot_Milestone;
+
+// Exported functions ---------------------------------------------------------
+void Boot_Mark(Boot_Milestone milestone);
+uint32_t Boot_GetTime(Boot_Milestone milestone);
+uint8_t Boot_IsReady(void);
+
+// ----------------------------------------------------------------------------
+
+#endif /* BOOTTIME_H_ */
@@ -11,6 +11,8 @@
 // Includes -------------------------------------------------------------------
 #include <stdint.h>
 #include "usbd_vcp_if.h"
+#include "ad5933.h"
+#include "mask.h"
 
 // Exported type definitions --------------------------------------------------
 /**
@@ -47,6 +49,7 @@ typedef struct
 // Exported functions ---------------------------------------------------------
 void Console_Init(void);
 void Console_ProcessLine(Console_Interface *itf, char *str);
+uint8_t Console_IsProcessing(void);
 
 uint32_t Console_GetFormat(void);
 void Console_SetFormat(uint32_t spec);
@@ -54,6 +57,12 @@ void Console_SetFormat(uint32_t spec);
 // Callbacks
 void Console_CalibrateCallback(void);
 void Console_TempCallback(float temp);
+void Console_SweepCallback(uint32_t points);
+void Console_ContinuousCallback(const AD5933_ImpedancePolar *value);
+void Console_TestCallback(Mask_Verdict verdict, uint32_t freq);
+void Console_ChangeCallback(uint32_t sweep, uint32_t freq, float change);
+void Console_LevelsCallback(uint32_t points);
+void Console_StopCallback(void);
 
 // ----------------------------------------------------------------------------
 
@@ -11,6 +11,7 @@
 // Includes -------------------------------------------------------------------
 #include <stdint.h>
 #include "ad5933.h"
+#include "spectrum.h"
 
 // Exported type definitions --------------------------------------------------
 /**
@@ -80,6 +81,7 @@ uint32_t Convert_FormatSpecToString(char *buf, uint32_t length, uint32_t format)
 Buffer Convert_ConvertPolar(uint32_t format, const AD5933_ImpedancePolar *data, uint32_t count);
 Buffer Convert_ConvertRaw(uint32_t format, const AD5933_ImpedanceData *data, uint32_t count);
 Buffer Convert_ConvertGainFactor(const AD5933_GainFactor *gain);
+Buffer Convert_ConvertFeatures(uint32_t format, const Spectrum_Features *features);
 
 void FreeBuffer(Buffer *buffer);
 
@@ -0,0 +1,34 @@
+/**
+ * @file    decimate.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the window statistics used to reduce long time series.
+ */
+
+#ifndef DECIMATE_H_
+#define DECIMATE_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Contains the running statistics of the values in one window.
+ */
+typedef struct
+{
+    uint32_t Count;     //!< The number of values
+    float Mean;         //!< Mean of the values
+    float SumSquares;   //!< Sum of squared distances from the mean
+    float Min;          //!< Smallest value
+    float Max;          //!< Largest value
+} Decimate_Stats;
+
+// Exported functions ---------------------------------------------------------
+void Decimate_Reset(Decimate_Stats *stats);
+void Decimate_Add(Decimate_Stats *stats, float value);
+float Decimate_GetDeviation(const Decimate_Stats *stats);
+
+// ----------------------------------------------------------------------------
+
+#endif /* DECIMATE_H_ */
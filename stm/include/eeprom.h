@@ -80,7 +80,7 @@ typedef struct
     uint16_t averages;                      //!< Number of averages per frequency point
     uint16_t voltage;                       //!< Output voltage range, register value
     uint16_t attenuation;                   //!< Output voltage attenuation
-    uint16_t pad1;                          //!< Padding for 32 bit alignment (set to 0)
+    uint16_t sweep_averages;                //!< Number of repeated sweeps averaged, `0` means no averaging
     /* Console */
     uint32_t format_spec;                   //!< Console format specification
     /* ETH */
@@ -91,11 +91,13 @@ typedef struct
         /* Sweep */
         unsigned int pga_enabled : 1;       //!< Whether the x5 gain is enabled
         unsigned int autorange : 1;         //!< Whether autoranging is enabled
+        unsigned int estimator : 2;         //!< How averages are combined (an {@link AD5933_Estimator} value)
+        unsigned int mains_freq : 7;        //!< Mains frequency in Hz averages are synchronized to, `0` if none
         /* ETH */
         unsigned int dhcp : 1;              //!< Whether DHCP is enabled
         unsigned int netmask : 5;           //!< The number of bits set in the IP network mask
         /* Metadata */
-        unsigned int reserved : 24;         //!< Reserved for future use, padding to 32 bits (set to 0)
+        unsigned int reserved : 15;         //!< Reserved for future use, padding to 32 bits (set to 0)
     } flags;                                //!< Bitfield for flags and small values
     /* Metadata */
     uint8_t reserved[22];                   //!< Reserved for future use, padding to 64 bytes  (set to 0)
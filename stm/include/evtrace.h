@@ -0,0 +1,74 @@
+/**
+ * @file    evtrace.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the binary event trace.
+ * 
+ * Interrupt handlers, drivers and the console record compact timestamped events with {@link EvTrace_Event}. Events are
+ * written to the ITM stimulus ports when a debugger with SWO enabled is attached, otherwise they are kept in a ring
+ * buffer that can be dumped with the `debug evtrace dump` command. The host tool `impy-timeline` decodes both.
+ */
+
+#ifndef EVTRACE_H_
+#define EVTRACE_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "convert.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * The kind of event recorded.
+ */
+typedef enum
+{
+    EVTRACE_ISR_ENTER = 1,      //!< Interrupt handler entered, `arg8` is the {@link Monitor_Irq}
+    EVTRACE_ISR_EXIT,           //!< Interrupt handler left, `arg8` is the {@link Monitor_Irq}
+    EVTRACE_I2C_START,          //!< I2C transfer started, `arg8` is the {@link I2CTrace_Op}, `arg` the register
+    EVTRACE_I2C_DONE,           //!< I2C transfer finished, `arg8` is the HAL status, `arg` the length
+    EVTRACE_POINT_STORED,       //!< AD5933 sweep point stored, `arg` is the index of the point
+    EVTRACE_USB_PACKET,         //!< USB IN transfer started, `arg` is the length
+    EVTRACE_COMMAND_START,      //!< Console command started
+    EVTRACE_COMMAND_FINISH      //!< Console command finished
+} EvTrace_Type;
+
+/**
+ * A single recorded event.
+ */
+typedef struct
+{
+    uint32_t timestamp;     //!< Value of the DWT cycle counter when the event was recorded
+    uint8_t type;           //!< Kind of event, one of {@link EvTrace_Type}
+    uint8_t arg8;           //!< Event specific argument
+    uint16_t arg;           //!< Event specific argument
+} EvTrace_Record;
+
+// Constants ------------------------------------------------------------------
+/**
+ * The number of events kept in the ring buffer, needs to be a power of 2.
+ */
+#define EVTRACE_BUFFER_SIZE             1024
+
+/**
+ * Version of the binary dump format, incremented when {@link EvTrace_Record} changes.
+ */
+#define EVTRACE_FORMAT_VERSION          1
+
+/**
+ * ITM stimulus port receiving the timestamp of an event, the rest of the record follows on the next port.
+ */
+#define EVTRACE_ITM_PORT                1
+
+// Exported functions ---------------------------------------------------------
+void EvTrace_Init(void);
+void EvTrace_Enable(uint8_t enable);
+uint8_t EvTrace_IsEnabled(void);
+uint8_t EvTrace_IsUsingItm(void);
+void EvTrace_Clear(void);
+Buffer EvTrace_Dump(void);
+void EvTrace_Event(EvTrace_Type type, uint8_t arg8, uint16_t arg);
+
+// ----------------------------------------------------------------------------
+
+#endif /* EVTRACE_H_ */
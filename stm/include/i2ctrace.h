@@ -0,0 +1,80 @@
+/**
+ * @file    i2ctrace.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the I2C transaction trace recorder.
+ * 
+ * The AD5933 and EEPROM drivers issue all I2C transfers through the wrappers declared here, which forward to the HAL
+ * and record the transaction in a ring buffer. The buffer can be dumped in binary with the `debug i2ctrace dump`
+ * command and replayed on the host (see `host/i2ctrace`).
+ */
+
+#ifndef I2CTRACE_H_
+#define I2CTRACE_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "convert.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * The kind of I2C transfer recorded.
+ */
+typedef enum
+{
+    I2CTRACE_MEM_WRITE = 1,     //!< `HAL_I2C_Mem_Write`
+    I2CTRACE_MEM_READ,          //!< `HAL_I2C_Mem_Read`
+    I2CTRACE_TRANSMIT,          //!< `HAL_I2C_Master_Transmit`
+    I2CTRACE_RECEIVE,           //!< `HAL_I2C_Master_Receive`
+    I2CTRACE_DEVICE_READY       //!< `HAL_I2C_IsDeviceReady`
+} I2CTrace_Op;
+
+/**
+ * A single recorded I2C transaction.
+ */
+typedef struct
+{
+    uint32_t timestamp;     //!< Start of the transaction in µs since boot
+    uint32_t duration;      //!< Duration of the transaction in µs
+    uint8_t op;             //!< Kind of transfer, one of {@link I2CTrace_Op}
+    uint8_t address;        //!< Device address (8 bit format)
+    uint16_t reg;           //!< Memory address for memory transfers, first data byte for transmits, otherwise `0`
+    uint16_t length;        //!< Number of data bytes transferred (number of trials for `I2CTRACE_DEVICE_READY`)
+    uint8_t result;         //!< HAL status code
+    uint8_t reserved;       //!< Padding (set to 0)
+    uint8_t data[4];        //!< The first data bytes transferred, needed for replaying reads
+} I2CTrace_Record;
+
+// Constants ------------------------------------------------------------------
+/**
+ * The number of transactions kept in the ring buffer, needs to be a power of 2.
+ */
+#define I2CTRACE_BUFFER_SIZE            256
+
+/**
+ * Version of the binary dump format, incremented when {@link I2CTrace_Record} changes.
+ */
+#define I2CTRACE_FORMAT_VERSION         1
+
+// Exported functions ---------------------------------------------------------
+void I2CTrace_Init(void);
+void I2CTrace_Enable(uint8_t enable);
+uint8_t I2CTrace_IsEnabled(void);
+void I2CTrace_Clear(void);
+Buffer I2CTrace_Dump(void);
+
+HAL_StatusTypeDef I2CTrace_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef I2CTrace_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef I2CTrace_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef I2CTrace_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef I2CTrace_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint32_t Trials,
+        uint32_t Timeout);
+
+// ----------------------------------------------------------------------------
+
+#endif /* I2CTRACE_H_ */
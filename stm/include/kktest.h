@@ -0,0 +1,50 @@
+/**
+ * @file    kktest.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the linear Kramers-Kronig test of sweep data.
+ */
+
+#ifndef KKTEST_H_
+#define KKTEST_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "ad5933.h"
+
+// Constants ------------------------------------------------------------------
+
+/**
+ * The maximum number of Voigt elements (R parallel to C) fitted to a sweep
+ */
+#define KK_MAX_ELEMENTS             16
+
+/**
+ * The number of Voigt elements fitted per decade of the frequency range
+ */
+#define KK_ELEMENTS_PER_DECADE      5
+
+/**
+ * The minimum number of points a sweep needs to be tested
+ */
+#define KK_MIN_POINTS               3
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Contains the result of a Kramers-Kronig test. The residuals are relative to the magnitude of the impedance at each
+ * point, so a residual of `0.01` means the data deviates by 1% from the closest Kramers-Kronig compliant impedance.
+ */
+typedef struct
+{
+    float Residual;             //!< RMS of the relative residuals of real and imaginary parts, NaN if not tested
+    float MaxResidual;          //!< The largest relative residual of a real or imaginary part
+    uint32_t MaxFrequency;      //!< Frequency of the largest residual in Hz
+    uint32_t Elements;          //!< The number of Voigt elements fitted
+} KK_Result;
+
+// Exported functions ---------------------------------------------------------
+uint8_t KK_Test(const AD5933_ImpedancePolar *data, uint32_t count, KK_Result *result);
+
+// ----------------------------------------------------------------------------
+
+#endif /* KKTEST_H_ */
@@ -15,6 +15,16 @@
 #include "console.h"
 #include "ad5933.h"
 #include "eeprom.h"
+#include "monitor.h"
+#include "i2ctrace.h"
+#include "evtrace.h"
+#include "telemetry.h"
+#include "boottime.h"
+#include "mask.h"
+#include "reference.h"
+#include "sweepavg.h"
+#include "schedule.h"
+#include "kktest.h"
 
 // Exported type definitions --------------------------------------------------
 /**
@@ -43,12 +53,31 @@ typedef struct
     AD5933_Status ad_status;    //!< Status code of the AD5933 driver
     uint16_t point;             //!< If a measurement is running, the number of data points already measured
     uint16_t totalPoints;       //!< The number of frequency steps to be measured
+    uint16_t sweep;             //!< If repeated sweeps are averaged, the number of sweeps already measured
+    uint16_t totalSweeps;       //!< The number of repeated sweeps to be averaged, `0` if none
     uint8_t autorange;          //!< Whether autoranging is enabled
     uint8_t interrupted;        //!< Whether the last measurement was interrupted (false if a measurement is running)
     uint8_t validGainFactor;    //!< Whether a valid gain factor for the current range settings is present
     uint8_t validData;          //!< Whether valid measurement data is present
+    uint8_t dataReplaced;       //!< Whether the measurement data was discarded for a scheduled run since the last start
+    uint16_t i2cErrors;         //!< The number of I2C errors recovered from during the running or last measurement
+    uint32_t i2cErrorsTotal;    //!< The number of I2C errors since reset
+    float mainsRejection;       //!< Estimated mains rejection in dB of the running or last sweep, `0` if not synchronized
+    KK_Result kk;               //!< Kramers-Kronig test of the last complete sweep, the residual is NaN if not tested
+    Monitor_MemoryStatus memory;    //!< Stack and heap usage
 } Board_Status;
 
+/**
+ * Contains the result of one step of an amplitude sweep.
+ */
+typedef struct
+{
+    uint32_t Frequency;     //!< Frequency in Hz
+    uint16_t Voltage;       //!< Output voltage in mV p-p, after attenuation
+    float Magnitude;        //!< Magnitude of the impedance in Ohms
+    float Angle;            //!< Angle of the impedance in rad
+} Board_LevelPoint;
+
 // Constants ------------------------------------------------------------------
 #define BOARD_VERSION                   "1.0"
 
@@ -112,6 +141,17 @@ typedef struct
  */
 #define EEPROM_WRITE_INTERVAL           1000
 
+/**
+ * Maximum number of frequencies for an amplitude sweep
+ */
+#define BOARD_LEVEL_MAX_FREQS           8
+
+/**
+ * Maximum number of results of an amplitude sweep, for each frequency one per voltage range (4) and attenuation (up
+ * to 4)
+ */
+#define BOARD_LEVEL_MAX_POINTS          (BOARD_LEVEL_MAX_FREQS * 4 * 4)
+
 // Exported variables ---------------------------------------------------------
 extern USBD_HandleTypeDef hUsbDevice;
 extern I2C_HandleTypeDef hi2c1;
@@ -132,6 +172,9 @@ Board_Error Board_SetPGA(uint8_t enable);
 Board_Error Board_SetAutorange(uint8_t enable);
 Board_Error Board_SetFeedback(uint32_t ohms);
 Board_Error Board_SetAverages(uint16_t value);
+Board_Error Board_SetEstimator(AD5933_Estimator estimator);
+Board_Error Board_SetMainsFreq(uint8_t freq);
+Board_Error Board_SetSweepAverages(uint16_t value);
 
 uint32_t Board_GetStartFreq(void);
 uint32_t Board_GetStopFreq(void);
@@ -140,17 +183,29 @@ uint16_t Board_GetSettlingCycles(void);
 const AD5933_RangeSettings* Board_GetRangeSettings(void);
 uint8_t Board_GetAutorange(void);
 uint16_t Board_GetAverages(void);
+AD5933_Estimator Board_GetEstimator(void);
+uint8_t Board_GetMainsFreq(void);
+uint16_t Board_GetSweepAverages(void);
 
 void Board_GetStatus(Board_Status *result);
 void Board_Reset(void);
 void Board_Standby(void);
 const AD5933_ImpedancePolar* Board_GetDataPolar(uint32_t *count);
 const AD5933_ImpedanceData* Board_GetDataRaw(uint32_t *count);
+AD5933_ImpedancePolar* Board_CopyDataPolar(uint32_t *count);
+AD5933_ImpedanceData* Board_CopyDataRaw(uint32_t *count);
 const AD5933_GainFactor* Board_GetGainFactor(void);
 Board_Error Board_StartSweep(uint8_t port);
+uint8_t Board_IsAveraging(void);
+uint8_t Board_IsSweeping(void);
+Board_Error Board_StartTest(uint8_t port);
+Board_Error Board_StartMonitor(uint8_t port, uint32_t slot, float threshold);
+Board_Error Board_StartLevelSweep(uint8_t port, const uint32_t *freqs, uint32_t count);
+const Board_LevelPoint* Board_GetLevelData(uint32_t *count);
 Board_Error Board_StopSweep(void);
 uint8_t Board_GetPort(void);
 Board_Error Board_MeasureSingleFrequency(uint8_t port, uint32_t freq, AD5933_ImpedancePolar *result);
+Board_Error Board_StartContinuous(uint8_t port, uint32_t freq, uint16_t averages);
 Board_Error Board_MeasureTemperature(Board_TemperatureSource what);
 Board_Error Board_Calibrate(uint32_t ohms);
 
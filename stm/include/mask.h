@@ -0,0 +1,54 @@
+/**
+ * @file    mask.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the limit mask used for pass/fail testing.
+ */
+
+#ifndef MASK_H_
+#define MASK_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "ad5933.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Contains the limits at one frequency of the mask. Limits that are NaN are not checked.
+ */
+typedef struct
+{
+    uint32_t Frequency;     //!< Frequency in Hz
+    float MagnitudeMin;     //!< Lower magnitude limit in Ohms
+    float MagnitudeMax;     //!< Upper magnitude limit in Ohms
+    float AngleMin;         //!< Lower angle limit in rad
+    float AngleMax;         //!< Upper angle limit in rad
+} Mask_Point;
+
+/**
+ * Specifies the result of checking a point against the mask.
+ */
+typedef enum
+{
+    MASK_PASS = 0,          //!< The point is within the limits
+    MASK_FAIL_MAGNITUDE,    //!< The magnitude is outside the limits
+    MASK_FAIL_ANGLE         //!< The angle is outside the limits
+} Mask_Verdict;
+
+// Constants ------------------------------------------------------------------
+
+/**
+ * The maximum number of points of a mask
+ */
+#define MASK_MAX_POINTS         32
+
+// Exported functions ---------------------------------------------------------
+void Mask_Clear(void);
+uint8_t Mask_AddPoint(const Mask_Point *point);
+uint32_t Mask_GetPoints(const Mask_Point **result);
+void Mask_Load(uint32_t start, uint32_t step, uint32_t count);
+Mask_Verdict Mask_Check(uint32_t index, const AD5933_ImpedancePolar *point);
+
+// ----------------------------------------------------------------------------
+
+#endif /* MASK_H_ */
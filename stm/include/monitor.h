@@ -0,0 +1,77 @@
+/**
+ * @file    monitor.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the runtime stack and heap monitor.
+ */
+
+#ifndef MONITOR_H_
+#define MONITOR_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Interrupts for which the stack depth is sampled on entry.
+ */
+typedef enum
+{
+    MON_IRQ_SYSTICK = 0,    //!< SysTick handler
+    MON_IRQ_I2C1,           //!< I2C1 event interrupt (AD5933 and EEPROM)
+    MON_IRQ_SPI3,           //!< SPI3 interrupt (ADG725 mux)
+    MON_IRQ_TIM3,           //!< TIM3 interrupt (driver state machines)
+    MON_IRQ_OTG_FS,         //!< USB interrupt (console processing)
+    MON_IRQ_COUNT           //!< Number of monitored interrupts, not a valid value
+} Monitor_Irq;
+
+/**
+ * Contains memory usage information for stack and heap.
+ */
+typedef struct
+{
+    uint32_t stackSize;         //!< Size of the main stack in bytes
+    uint32_t stackUsed;         //!< Maximum number of stack bytes used since boot (high-water mark)
+    uint32_t heapSize;          //!< Size of the heap in bytes
+    uint32_t heapUsed;          //!< Number of heap bytes currently allocated (including chunk overhead)
+    uint32_t heapFree;          //!< Total number of free heap bytes, including memory not yet claimed by `sbrk`
+    uint32_t heapLargestFree;   //!< Size of the largest contiguous free heap block
+    uint16_t heapFragmentation; //!< Heap fragmentation in per mille, `1000 * (1 - largest / free)`
+    uint32_t allocs;            //!< Number of successful allocations
+    uint32_t frees;             //!< Number of calls to `free` with a non-`NULL` pointer
+    uint32_t allocFailures;     //!< Number of failed allocations
+} Monitor_MemoryStatus;
+
+// Constants ------------------------------------------------------------------
+/**
+ * The pattern used to paint the unused stack at boot.
+ */
+#define MONITOR_STACK_PATTERN           ((uint32_t)0xA5A5A5A5)
+
+// Exported variables ---------------------------------------------------------
+extern uint32_t monitor_irq_sp[MON_IRQ_COUNT];
+
+// Exported functions ---------------------------------------------------------
+void Monitor_PaintStack(void);
+void Monitor_GetMemoryStatus(Monitor_MemoryStatus *result);
+uint32_t Monitor_GetStackHighWater(void);
+uint32_t Monitor_GetIrqStackDepth(Monitor_Irq irq);
+uint32_t Monitor_GetAllocFailures(void);
+
+/**
+ * Records the current stack pointer for the specified interrupt, if it is the lowest seen so far.
+ * This should be called on entry of the interrupt handler.
+ * 
+ * @param irq The interrupt being handled
+ */
+__STATIC_INLINE void Monitor_SampleStack(Monitor_Irq irq) {
+    uint32_t sp = __get_MSP();
+    if(sp < monitor_irq_sp[irq]) {
+        monitor_irq_sp[irq] = sp;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* MONITOR_H_ */
@@ -18,10 +18,15 @@
 
 // Constants ------------------------------------------------------------------
 #define TIM3_INTERVAL               2000    //!< TIM3 interrupt interval in µs
+#define I2C1_GPIO_PORT              GPIOB           //!< I2C1 GPIO port
+#define I2C1_SCL_PIN                GPIO_PIN_6      //!< I2C1 clock pin
+#define I2C1_SDA_PIN                GPIO_PIN_9      //!< I2C1 data pin
+#define I2C_BUS_CLEAR_DELAY         5       //!< Half period of the clock pulses generated by a bus clear in µs
 
 // Exported functions ---------------------------------------------------------
 void MX_Init(void);
 void MX_Init_Ethernet(void);
+HAL_StatusTypeDef MX_I2C_BusClear(I2C_HandleTypeDef *hi2c);
 
 // ----------------------------------------------------------------------------
 
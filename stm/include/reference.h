@@ -0,0 +1,42 @@
+/**
+ * @file    reference.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the reference sweep storage used for differential measurements.
+ */
+
+#ifndef REFERENCE_H_
+#define REFERENCE_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "ad5933.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Specifies how measured data is related to a reference sweep.
+ */
+typedef enum
+{
+    REF_DIFFERENCE = 0,     //!< Complex difference Z - Zref
+    REF_RATIO               //!< Complex ratio Z / Zref, that is magnitude ratio and phase difference
+} Reference_Mode;
+
+// Constants ------------------------------------------------------------------
+
+/**
+ * The number of reference sweeps that can be stored
+ */
+#define REFERENCE_SLOTS         2
+
+// Exported functions ---------------------------------------------------------
+uint8_t Reference_Save(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count);
+void Reference_Clear(uint32_t slot);
+const AD5933_ImpedancePolar* Reference_Get(uint32_t slot, uint32_t *count);
+uint8_t Reference_Apply(uint32_t slot, Reference_Mode mode, const AD5933_ImpedancePolar *data, uint32_t count,
+        AD5933_ImpedancePolar *result);
+float Reference_MaxChange(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count, uint32_t *freq);
+
+// ----------------------------------------------------------------------------
+
+#endif /* REFERENCE_H_ */
@@ -0,0 +1,91 @@
+/**
+ * @file    schedule.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for time-scheduled measurement jobs and the storage of their results.
+ */
+
+#ifndef SCHEDULE_H_
+#define SCHEDULE_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "ad5933.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * A job that starts a frequency sweep periodically.
+ */
+typedef struct
+{
+    uint64_t next;          //!< Time of the next run in ms since reset
+    uint32_t period;        //!< Time between runs in ms
+    uint32_t remaining;     //!< The number of runs left, `0` if the job slot is unused
+    uint32_t missed;        //!< The number of runs skipped because of other measurements or commands
+    float kkLimit;          //!< Kramers-Kronig residual above which a sweep is repeated, `0` to never repeat
+    uint8_t port;           //!< The port to measure on
+} Schedule_Job;
+
+/**
+ * A stored result of a job run.
+ */
+typedef struct
+{
+    uint32_t number;        //!< Sequence number of the run, counting all runs since reset
+    uint64_t time;          //!< Start time of the sweep in ms, see {@link Schedule_GetTime}
+    uint32_t offset;        //!< Index of the first point in the point buffer
+    float kkResidual;       //!< Kramers-Kronig residual of the sweep, NaN if not tested
+    uint16_t count;         //!< The number of points measured
+    uint8_t job;            //!< The job that started the run
+    uint8_t interrupted;    //!< Whether the sweep was interrupted or could not be started
+    uint8_t repeats;        //!< The number of times the sweep was repeated because of a large residual
+} Schedule_Run;
+
+// Constants ------------------------------------------------------------------
+
+/**
+ * The number of jobs that can be scheduled at the same time
+ */
+#define SCHEDULE_MAX_JOBS           4
+
+/**
+ * The number of runs whose results can be stored
+ */
+#define SCHEDULE_MAX_RUNS           64
+
+/**
+ * The number of points that can be stored for all runs together, in CCM RAM
+ */
+#define SCHEDULE_BUFFER_POINTS      4096
+
+/**
+ * The shortest time between runs of a job in ms
+ */
+#define SCHEDULE_MIN_PERIOD         1000
+
+/**
+ * The number of times a sweep with a Kramers-Kronig residual above the limit of its job is repeated
+ */
+#define SCHEDULE_KK_REPEATS         2
+
+// Exported functions ---------------------------------------------------------
+uint64_t Schedule_GetUptime(void);
+void Schedule_SetTime(uint64_t time);
+uint64_t Schedule_GetTime(void);
+uint8_t Schedule_IsTimeSet(void);
+int32_t Schedule_AddJob(uint64_t start, uint32_t period, uint32_t count, uint8_t port, float kkLimit);
+void Schedule_RemoveJob(uint32_t job);
+const Schedule_Job* Schedule_GetJob(uint32_t job);
+int32_t Schedule_GetDueJob(void);
+void Schedule_JobStarted(uint32_t job);
+void Schedule_JobMissed(uint32_t job);
+void Schedule_StoreRun(uint32_t job, uint64_t time, const AD5933_ImpedancePolar *data, uint32_t count,
+        uint8_t interrupted, float kkResidual, uint8_t repeats);
+const Schedule_Run* Schedule_GetRun(uint32_t number, const AD5933_ImpedancePolar **data);
+uint32_t Schedule_GetRunCount(uint32_t *first);
+void Schedule_Clear(void);
+
+// ----------------------------------------------------------------------------
+
+#endif /* SCHEDULE_H_ */
@@ -0,0 +1,49 @@
+/**
+ * @file    spectrum.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the spectral feature extraction.
+ */
+
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "ad5933.h"
+
+// Constants ------------------------------------------------------------------
+
+/**
+ * The maximum number of phase zero crossings whose frequencies are recorded
+ */
+#define SPECTRUM_MAX_CROSSINGS      4
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Contains the features of one sweep. All frequencies are interpolated between the measured points, values that can
+ * not be determined from the sweep are NaN.
+ * 
+ * The structure only consists of 32-bit words, which are sent in this order by `board read --features` in binary
+ * format.
+ */
+typedef struct
+{
+    float MinFrequency;         //!< Frequency of the minimum magnitude in Hz
+    float MinMagnitude;         //!< Minimum magnitude in Ohms
+    float MaxFrequency;         //!< Frequency of the maximum magnitude in Hz
+    float MaxMagnitude;         //!< Maximum magnitude in Ohms
+    float ResonanceFrequency;   //!< Frequency of the first phase zero crossing in Hz
+    float ResonanceQ;           //!< Quality factor of the resonance, from the phase slope at the crossing
+    float ArcFrequency;         //!< Characteristic frequency of a capacitive arc (peak of -X) in Hz
+    float ArcReactance;         //!< Reactance at the peak of the arc in Ohms
+    uint32_t Crossings;         //!< The number of phase zero crossings
+    float CrossingFrequency[SPECTRUM_MAX_CROSSINGS];    //!< Frequencies of the first phase zero crossings in Hz
+} Spectrum_Features;
+
+// Exported functions ---------------------------------------------------------
+void Spectrum_ExtractFeatures(const AD5933_ImpedancePolar *data, uint32_t count, Spectrum_Features *result);
+
+// ----------------------------------------------------------------------------
+
+#endif /* SPECTRUM_H_ */
@@ -18,6 +18,7 @@ const char* const txtErrArgNum = "Wrong number of arguments.";
 const char* const txtErrNoArgs = "No arguments expected.";
 const char* const txtErrNoSubcommand = "Missing command, type 'help' for possible commands.";
 const char* const txtUnknownTopic = "Unknown help topic, type 'help' for possible commands.";
+const char* const txtStartingUp = "Still starting up, try again.";
 const char* const txtUnknownCommand = "Unknown command.";
 const char* const txtUnknownSubcommand = "Unknown subcommand.";
 const char* const txtNotImplemented = "Not yet implemented.";
@@ -33,19 +34,31 @@ const char* const txtGetOnlyWhenAutorangeDisabled = "This value can only be read
 // board status
 const char* const txtAdStatusUnknown = "Unknown AD5933 driver status, something went wrong.";
 const char* const txtAdStatusSweep = "Impedance measurement is running, points measured: ";
+const char* const txtAdStatusSweepAvg = "Averaging sweep ";
 const char* const txtAdStatusTemp = "Temperature measurement is running.";
 const char* const txtAdStatusIdle = "No measurement is running.";
 const char* const txtAdStatusFinishImpedance = "Impedance measurement finished, points measured: ";
 const char* const txtAdStatusCalibrate = "Calibration measurement is running.";
+const char* const txtAdStatusContinuous = "Continuous measurement is running, results: ";
 const char* const txtAutorangeStatus = "Autoranging is ";
 const char* const txtLastInterrupted = "The last measurement was interrupted.";
 const char* const txtValidData = "Measurement data can be read.";
 const char* const txtNoData = "No measurement data is present.";
+const char* const txtDataReplaced = "The measurement data was discarded for a scheduled run, see 'board sched runs'.";
 const char* const txtValidGain = "Calibration finished, measurement can be started.";
 const char* const txtNoGain = "Calibration needed before measurement can be started.";
+const char* const txtMainsRejection = "Estimated mains rejection of the worst point: ";
+const char* const txtKKResidual = "Kramers-Kronig residual: ";
+const char* const txtI2CErrors = "I2C errors in the last measurement: ";
+const char* const txtI2CErrorsTotal = " (since reset ";
+const char* const txtStackUsage = "Stack bytes used: ";
+const char* const txtHeapUsage = "Heap bytes free: ";
+const char* const txtHeapLargestBlock = " (largest block ";
+const char* const txtHeapFragmentation = ", fragmentation ";
 // board info
 const char* const txtAdStatus = "AD5933 driver status: ";
 const char* const txtAdStatusMeasureImpedance = "Impedance measurement is running.";
+const char* const txtAdStatusMeasureContinuous = "Continuous measurement is running.";
 const char* const txtPortsAvailable = "Ports available for measurements: ";
 const char* const txtAttenuationsAvailable = "Possible voltage attenuation factors: ";
 const char* const txtFeedbackResistorValues = "Feedback resistor values: ";
@@ -60,10 +73,23 @@ const char* const txtNoMemory = "\r\nNo external memory installed.";
 const char* const txtFrequencyRange = "Possible frequency range in Hz: ";
 const char* const txtMaxNumIncrements = "Maximum number of frequency increments: ";
 const char* const txtInstalledSize = " installed, size in bytes: ";
+const char* const txtStartupTimes = "Start-up times in ms after reset: ";
 const char* const txtEthernetInstalledMacAddr = "Ethernet installed, MAC address: ";
 // board measure
 const char* const txtBoardBusy = "Another measurement is currently running.";
 const char* const txtImpedance = "Impedance (polar): ";
+// board lcr
+const char* const txtNoGainForFreq = "Calibration needed for this frequency, see 'help lcr'.";
+// board mask, board test
+const char* const txtMaskEmpty = "The limit mask is empty.";
+const char* const txtMaskFull = "The limit mask is full, clear it first.";
+const char* const txtNoMaskOrGain = "A limit mask and calibration are needed for testing.";
+const char* const txtNoLevelGain = "No output level calibrated, or frequency outside the calibrated range.";
+// board monitor, board read, board ref
+const char* const txtNoMatchingReference = "No reference sweep matching the current data or settings in this slot.";
+// board sched
+const char* const txtTimeNotSet = "The time is not set, use 'board sched time' or a relative start time.";
+const char* const txtNoJobSlot = "No free job slot, or invalid period or count (see 'help sched').";
 // board read
 const char* const txtNoReadWhileBusy = "Data can only be read after the measurement is finished.";
 const char* const txtOutOfMemory = "Not enough memory to send all data, try binary format or use fewer points.";
@@ -71,8 +97,12 @@ const char* const txtNotCalibrated = "Calibration not performed.";
 const char* const txtNoRawData = "No raw data is present (raw data is not retained when autoranging is enabled).";
 // board calibrate
 const char* const txtWrongCalibValue = "Unknown resistor value, see 'board info' for possible values.";
+// board telemetry
+const char* const txtWrongTelemetryFormat = "Unknown format, 'json' or 'binary' expected.";
 // board temp
 const char* const txtTempFail = "Temperature measurement failed.";
+// board standby
+const char* const txtStandbyStopped = "Stopped, the board was put in standby.";
 // setup
 const char* const txtWrongFlag = "Invalid flag, 'on' or 'off' expected.";
 const char* const txtWrongTau = "Invalid time constant, needs to be a number in the range 0 to 1000";
@@ -0,0 +1,23 @@
+/**
+ * @file    sweepavg.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the running mean over repeated sweeps.
+ */
+
+#ifndef SWEEPAVG_H_
+#define SWEEPAVG_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "ad5933.h"
+
+// Exported functions ---------------------------------------------------------
+void SweepAvg_Reset(void);
+void SweepAvg_Add(uint32_t index, const AD5933_ImpedanceData *data, AD5933_ImpedanceData *mean);
+uint16_t SweepAvg_GetCount(uint32_t index);
+float SweepAvg_GetDeviation(uint32_t index);
+
+// ----------------------------------------------------------------------------
+
+#endif /* SWEEPAVG_H_ */
@@ -0,0 +1,113 @@
+/**
+ * @file    telemetry.h
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Header file for the device-wide telemetry counters.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+// Includes -------------------------------------------------------------------
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "convert.h"
+#include "monitor.h"
+
+// Exported type definitions --------------------------------------------------
+/**
+ * Counters incremented by the drivers with {@link Telemetry_Count} or {@link Telemetry_Add}.
+ */
+typedef enum
+{
+    TELEMETRY_SWEEPS = 0,       //!< Sweeps completed, not counting aborted ones
+    TELEMETRY_POINTS,           //!< Points measured in sweeps and continuous measurements
+    TELEMETRY_I2C_RETRIES,      //!< AD5933 writes repeated after an I2C error
+    TELEMETRY_USB_STALLS,       //!< USB transfers the host did not read in time, see {@link VCP_Flush}
+    TELEMETRY_USB_BYTES,        //!< Bytes sent over USB
+    TELEMETRY_DROPPED_LINES,    //!< Command lines ignored because a command was still busy
+    TELEMETRY_EEPROM_WRITES,    //!< EEPROM page writes
+    TELEMETRY_COUNTER_COUNT     //!< Number of counters, not a valid value
+} Telemetry_Counter;
+
+/**
+ * A snapshot of all counters and gauges. Counters only ever increase and wrap around at 2^32.
+ */
+typedef struct
+{
+    uint64_t uptime;                        //!< Time since reset in ms
+    uint32_t sweeps;                        //!< See {@link TELEMETRY_SWEEPS}
+    uint32_t points;                        //!< See {@link TELEMETRY_POINTS}
+    uint32_t i2cErrors;                     //!< AD5933 I2C errors recovered from
+    uint32_t i2cRetries;                    //!< See {@link TELEMETRY_I2C_RETRIES}
+    uint32_t usbStalls;                     //!< See {@link TELEMETRY_USB_STALLS}
+    uint32_t usbBytes;                      //!< See {@link TELEMETRY_USB_BYTES}
+    uint32_t droppedLines;                  //!< See {@link TELEMETRY_DROPPED_LINES}
+    uint32_t eepromWrites;                  //!< See {@link TELEMETRY_EEPROM_WRITES}
+    uint32_t heapFailures;                  //!< Failed allocations
+    uint32_t maxIsrTime[MON_IRQ_COUNT];     //!< Longest run of each interrupt handler in ns
+} Telemetry_Status;
+
+// Constants ------------------------------------------------------------------
+/**
+ * Version of the binary format, incremented when {@link Telemetry_Status} changes.
+ */
+#define TELEMETRY_FORMAT_VERSION        1
+
+// Exported variables ---------------------------------------------------------
+extern volatile uint32_t telemetry_counters[TELEMETRY_COUNTER_COUNT];
+extern volatile uint32_t telemetry_isr_cycles[MON_IRQ_COUNT];
+
+// Exported functions ---------------------------------------------------------
+void Telemetry_Get(Telemetry_Status *result);
+Buffer Telemetry_Dump(void);
+
+/**
+ * Adds a value to a counter. This can be called from any interrupt, the exclusive access makes sure no increment is
+ * lost when a handler of higher priority updates the same counter.
+ * 
+ * @param counter The counter
+ * @param value The value to add
+ */
+__STATIC_INLINE void Telemetry_Add(Telemetry_Counter counter, uint32_t value) {
+    volatile uint32_t *p = &telemetry_counters[counter];
+    uint32_t sum;
+    // The exclusive monitor is cleared on exception entry and exit, so an interrupted update is repeated
+    do {
+        sum = __LDREXW(p) + value;
+    } while(__STREXW(sum, p) != 0);
+}
+
+/**
+ * Increments a counter, see {@link Telemetry_Add}.
+ * 
+ * @param counter The counter
+ */
+__STATIC_INLINE void Telemetry_Count(Telemetry_Counter counter) {
+    Telemetry_Add(counter, 1);
+}
+
+/**
+ * Gets the timestamp for {@link Telemetry_IsrExit}, this should be called on entry of the interrupt handler.
+ */
+__STATIC_INLINE uint32_t Telemetry_IsrEnter(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * Records how long the specified interrupt handler ran, if it is the longest seen so far. This includes the time spent
+ * in handlers of higher priority that interrupted it.
+ * 
+ * @param irq The interrupt being handled
+ * @param start The value returned by {@link Telemetry_IsrEnter}
+ */
+__STATIC_INLINE void Telemetry_IsrExit(Monitor_Irq irq, uint32_t start) {
+    uint32_t cycles = DWT->CYCCNT - start;
+    if(cycles > telemetry_isr_cycles[irq]) {
+        telemetry_isr_cycles[irq] = cycles;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* TELEMETRY_H_ */
@@ -18,6 +18,11 @@
  */
 #define MAX_CMDLINE_LENGTH      200
 
+/**
+ * Sent after the complete response to a command line preceded with '$', so programs know when the command finished.
+ */
+#define VCP_END_OF_RESPONSE     0x04
+
 // Exported variables ---------------------------------------------------------
 extern USBD_VCP_ItfTypeDef USBD_VCP_fops;
 
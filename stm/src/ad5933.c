@@ -7,8 +7,11 @@
 
 // Includes -------------------------------------------------------------------
 #include <math.h>
+#include <stdlib.h>
 #include <assert.h>
 #include "ad5933.h"
+#include "i2ctrace.h"
+#include "evtrace.h"
 #include "main.h"
 
 // Private type definitions ---------------------------------------------------
@@ -23,6 +26,10 @@ typedef enum
     AD_EXT_L = 0        //!< External low speed clock (~16.666kHz)
 } AD5933_ClockSource;
 
+// Private constants ----------------------------------------------------------
+//! Used in place of a function code for {@link AD5933_Recover} when a clock change needs to be done again
+#define AD5933_RETRY_CLOCK_CHANGE   ((uint16_t)0xFFFF)
+
 // Private function prototypes ------------------------------------------------
 // AD5933 communication
 static HAL_StatusTypeDef AD5933_SetAddress(uint8_t MemAddress);
@@ -31,18 +38,30 @@ static HAL_StatusTypeDef AD5933_Write16(uint8_t MemAddress, uint16_t value);
 static HAL_StatusTypeDef AD5933_Write24(uint8_t MemAddress, uint32_t value);
 static HAL_StatusTypeDef AD5933_Read16(uint8_t MemAddress, uint16_t *destination);
 static HAL_StatusTypeDef AD5933_WriteFunction(uint16_t code);
-static uint8_t AD5933_ReadStatus();
+static HAL_StatusTypeDef AD5933_ReadStatus(uint8_t *dev_status);
+static HAL_StatusTypeDef AD5933_Transferred(HAL_StatusTypeDef ret);
 // Misc
 static uint32_t AD5933_CalcFrequencyReg(uint32_t freq, uint32_t clock);
 static AD5933_Error AD5933_StartMeasurement(const AD5933_RangeSettings *range, uint32_t freq_start, uint32_t freq_step,
         uint16_t num_incr, uint16_t settl);
-static void AD5933_SetClock(uint32_t freq_start, uint32_t freq_step);
+static AD5933_Error AD5933_SetRange(const AD5933_RangeSettings *range);
+static void AD5933_ResetCounters(void);
+static HAL_StatusTypeDef AD5933_SetClock(uint32_t freq_start, uint32_t freq_step);
 static AD5933_ClockSource AD5933_GetClockSource(uint32_t freq);
-static void AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32_t increments);
+static HAL_StatusTypeDef AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32_t increments);
 // Timer callbacks
 static AD5933_Status AD5933_CallbackTemp(void);
 static AD5933_Status AD5933_CallbackImpedance(void);
+static AD5933_Status AD5933_CallbackContinuous(void);
 static AD5933_Status AD5933_CallbackCalibrate(void);
+static AD5933_Status AD5933_Recover(uint16_t function);
+
+static int32_t AD5933_Select(int32_t *data, uint32_t count, uint32_t k);
+static int16_t AD5933_Estimate(const int16_t *samples, int32_t sum);
+// Mains synchronization
+static uint8_t AD5933_IsSynchronized(void);
+static void AD5933_SyncRecord(void);
+static AD5933_Status AD5933_SyncRepeat(void);
 
 // Private variables ----------------------------------------------------------
 static volatile AD5933_Status status = AD_UNINIT;
@@ -57,6 +76,23 @@ static volatile int32_t sum_real;           //!< Sum of the real values for aver
 static volatile int32_t sum_imag;           //!< Sum of the imaginary values for averaging
 static volatile uint16_t wait_coupl;        //!< Time to wait for coupling capacitor to charge, or 0 to not wait
 static volatile uint32_t wait_tick;         //!< SysTick value where we started waiting
+static uint32_t init_tick;                  //!< SysTick value when the driver was initialized
+static volatile uint16_t error_count;       //!< I2C errors during the running or last measurement
+static volatile uint32_t error_total = 0;   //!< I2C errors since reset
+static uint8_t retries;                     //!< Consecutive I2C errors, reset by every successful transfer
+static uint16_t retry_function;             //!< Function code to be written again after an error, or 0 if none
+static uint32_t clock_freq;                 //!< Start frequency of the last clock change, to do it again after an error
+static uint32_t clock_step;                 //!< Frequency step of the last clock change
+static uint32_t clock_incr;                 //!< Number of increments of the last clock change
+static volatile uint8_t aborted;            //!< Whether the last sweep was aborted because of I2C errors
+static volatile uint32_t tick_count = 0;    //!< Number of timer callbacks, time base for mains synchronization
+static uint32_t conv_tick;                  //!< Value of `tick_count` when the last conversion was started
+static uint32_t point_tick;                 //!< Value of `tick_count` when the current frequency point was started
+static uint32_t sync_step;                  //!< Conversion spacing in mains periods, times the number of averages
+static uint8_t sync_wait;                   //!< Whether the next conversion waits for its mains phase
+static float sync_cos;                      //!< Sum of the mains phasors at the start of each conversion, real part
+static float sync_sin;                      //!< Sum of the mains phasors at the start of each conversion, imaginary part
+static float sync_residual;                 //!< Largest relative mains phasor sum of any point in the sweep
 /**
  * Current clock source to determine if a change is needed during a sweep
  */
@@ -70,9 +106,19 @@ static AD5933_GainFactorData *pGainData;
  */
 static float *pTemperature = NULL;
 /**
- * Pointer to buffer that receives the results of a running frequency sweep
+ * Pointer to buffer that receives the results of a running frequency sweep, or the latest result of a continuous
+ * measurement
  */
 static AD5933_ImpedanceData *pBuffer;
+/**
+ * Samples of the current frequency point, only recorded for estimators other than the mean
+ */
+static int16_t samples_real[AD5933_MAX_ROBUST_AVERAGES];
+static int16_t samples_imag[AD5933_MAX_ROBUST_AVERAGES];
+/**
+ * Working buffer for the estimators, since selection reorders the values
+ */
+static int32_t estimate_buf[AD5933_MAX_ROBUST_AVERAGES];
 
 // Private functions ----------------------------------------------------------
 
@@ -83,7 +129,7 @@ static AD5933_ImpedanceData *pBuffer;
  * @return HAL status code
  */
 static HAL_StatusTypeDef AD5933_SetAddress(uint8_t MemAddress) {
-    return HAL_I2C_Mem_Write(i2cHandle, AD5933_ADDR, AD5933_CMD_SET_ADDRESS, 1, &MemAddress, 1, AD5933_I2C_TIMEOUT);
+    return I2CTrace_Mem_Write(i2cHandle, AD5933_ADDR, AD5933_CMD_SET_ADDRESS, 1, &MemAddress, 1, AD5933_I2C_TIMEOUT);
 }
 
 /**
@@ -94,7 +140,8 @@ static HAL_StatusTypeDef AD5933_SetAddress(uint8_t MemAddress) {
  * @return HAL status code
  */
 static HAL_StatusTypeDef AD5933_Write8(uint8_t MemAddress, uint8_t value) {
-    return HAL_I2C_Mem_Write(i2cHandle, AD5933_ADDR, MemAddress, 1, &value, 1, AD5933_I2C_TIMEOUT);
+    return AD5933_Transferred(
+            I2CTrace_Mem_Write(i2cHandle, AD5933_ADDR, MemAddress, 1, &value, 1, AD5933_I2C_TIMEOUT));
 }
 
 /**
@@ -117,7 +164,7 @@ static HAL_StatusTypeDef AD5933_Write16(uint8_t MemAddress, uint16_t value) {
     data[2] = HIBYTE(value);
     data[3] = LOBYTE(value);
     
-    return HAL_I2C_Master_Transmit(i2cHandle, AD5933_ADDR, data, sizeof(data), AD5933_I2C_TIMEOUT);
+    return AD5933_Transferred(I2CTrace_Master_Transmit(i2cHandle, AD5933_ADDR, data, sizeof(data), AD5933_I2C_TIMEOUT));
 }
 
 /**
@@ -141,7 +188,7 @@ static HAL_StatusTypeDef AD5933_Write24(uint8_t MemAddress, uint32_t value) {
     data[3] = (uint8_t)((value >> 8) & 0xFF);
     data[4] = (uint8_t)(value & 0xFF);
     
-    return HAL_I2C_Master_Transmit(i2cHandle, AD5933_ADDR, data, sizeof(data), AD5933_I2C_TIMEOUT);
+    return AD5933_Transferred(I2CTrace_Master_Transmit(i2cHandle, AD5933_ADDR, data, sizeof(data), AD5933_I2C_TIMEOUT));
 }
 
 /**
@@ -160,13 +207,13 @@ static HAL_StatusTypeDef AD5933_Read16(uint8_t MemAddress, uint16_t *destination
     // AD5933 block read operation: transfer block read command and byte count, after start condition read data
     uint16_t tmp = 0;
     uint16_t cmd = ((uint16_t)AD5933_CMD_BLOCK_READ << 8) | 2;
-    ret = HAL_I2C_Mem_Read(i2cHandle, AD5933_ADDR, cmd, I2C_MEMADD_SIZE_16BIT, (uint8_t *)&tmp, 2, AD5933_I2C_TIMEOUT);
+    ret = I2CTrace_Mem_Read(i2cHandle, AD5933_ADDR, cmd, I2C_MEMADD_SIZE_16BIT, (uint8_t *)&tmp, 2, AD5933_I2C_TIMEOUT);
 #ifdef __ARMEB__
     *destination = tmp;
 #else
     *destination = __REV16(tmp);
 #endif
-    return ret;
+    return AD5933_Transferred(ret);
 }
 
 /**
@@ -177,20 +224,47 @@ static HAL_StatusTypeDef AD5933_Read16(uint8_t MemAddress, uint16_t *destination
  */
 static HAL_StatusTypeDef AD5933_WriteFunction(uint16_t code) {
     uint16_t data = code | range_spec.Voltage_Range | range_spec.PGA_Gain;
+    
+    // Remember when a conversion was started for mains synchronization
+    if(code == AD5933_FUNCTION_START_SWEEP || code == AD5933_FUNCTION_INCREMENT_FREQ ||
+            code == AD5933_FUNCTION_REPEAT_FREQ) {
+        conv_tick = tick_count;
+    }
     return AD5933_Write8(AD5933_CTRL_H_ADDR, HIBYTE(data));
 }
 
 /**
  * Reads the status register from the AD5933 device.
  * 
- * @return Contents of the status register
+ * @param dev_status Pointer to a variable receiving the contents of the status register, `0` if the read fails
+ * @return HAL status code
  */
-static uint8_t AD5933_ReadStatus() {
-    uint8_t data = 0;
+static HAL_StatusTypeDef AD5933_ReadStatus(uint8_t *dev_status) {
+    *dev_status = 0;
     
-    AD5933_SetAddress(AD5933_STATUS_ADDR);
-    HAL_I2C_Master_Receive(i2cHandle, AD5933_ADDR, &data, 1, AD5933_I2C_TIMEOUT);
-    return data;
+    HAL_StatusTypeDef ret = AD5933_SetAddress(AD5933_STATUS_ADDR);
+    if(ret != HAL_OK) {
+        return ret;
+    }
+    ret = I2CTrace_Master_Receive(i2cHandle, AD5933_ADDR, dev_status, 1, AD5933_I2C_TIMEOUT);
+    if(ret != HAL_OK) {
+        *dev_status = 0;
+    }
+    return AD5933_Transferred(ret);
+}
+
+/**
+ * Resets the count of consecutive I2C errors after a successful transfer, so that only errors that keep coming back
+ * abort a sweep in {@link AD5933_Recover}.
+ * 
+ * @param ret HAL status code of the transfer
+ * @return `ret`
+ */
+static HAL_StatusTypeDef AD5933_Transferred(HAL_StatusTypeDef ret) {
+    if(ret == HAL_OK) {
+        retries = 0;
+    }
+    return ret;
 }
 
 /**
@@ -217,6 +291,41 @@ static uint32_t AD5933_CalcFrequencyReg(uint32_t freq, uint32_t clock) {
  */
 static AD5933_Error AD5933_StartMeasurement(const AD5933_RangeSettings *range, uint32_t freq_start, uint32_t freq_step,
         uint16_t num_incr, uint16_t settl) {
+    if(freq_start < AD5933_FREQ_MIN || (freq_start + freq_step * num_incr) > AD5933_FREQ_MAX) {
+        return AD_ERROR;
+    }
+    if(AD5933_SetRange(range) != AD_OK) {
+        return AD_ERROR;
+    }
+    
+    AD5933_ResetCounters();
+    sweep_freq = freq_start;
+    AD5933_WriteFunction(AD5933_FUNCTION_STANDBY);
+    
+    // Send sweep parameters and set clock
+    AD5933_SetClock(freq_start, freq_step);
+    AD5933_Write16(AD5933_NUM_INCR_H_ADDR, num_incr);
+    AD5933_Write16(AD5933_SETTL_H_ADDR, settl);
+    
+    // Switch output on
+    AD5933_WriteFunction(AD5933_FUNCTION_INIT_FREQ);
+    
+    // Start charging coupling capacitor, this is always needed, assuming the output was previously switched off
+    HAL_GPIO_WritePin(AD5933_COUPLING_GPIO_PORT, AD5933_COUPLING_GPIO_PIN, GPIO_PIN_RESET);
+    wait_coupl = board_config.coupling_tau * 4;
+    wait_tick = HAL_GetTick();
+    
+    return AD_OK;
+}
+
+/**
+ * Sets the attenuator and feedback multiplexers for the specified range and keeps a copy of the range settings, which
+ * are written to the AD5933 together with each function code.
+ * 
+ * @param range Pointer to voltage, gain, attenuation and feedback settings
+ * @return {@link AD5933_Error} code, {@link AD_ERROR} if the attenuation or feedback resistor is not fitted
+ */
+static AD5933_Error AD5933_SetRange(const AD5933_RangeSettings *range) {
     uint8_t portAtt = 0;
     uint8_t portFb = 0;
     uint8_t j;
@@ -246,10 +355,6 @@ static AD5933_Error AD5933_StartMeasurement(const AD5933_RangeSettings *range, u
         return AD_ERROR;
     }
     
-    if(freq_start < AD5933_FREQ_MIN || (freq_start + freq_step * num_incr) > AD5933_FREQ_MAX) {
-        return AD_ERROR;
-    }
-    
     // Set attenuator and feedback mux
     HAL_GPIO_WritePin(AD5933_ATTENUATION_GPIO_PORT, AD5933_ATTENUATION_GPIO_0, ((portAtt & (1 << 0)) ? SET : RESET));
     HAL_GPIO_WritePin(AD5933_ATTENUATION_GPIO_PORT, AD5933_ATTENUATION_GPIO_1, ((portAtt & (1 << 1)) ? SET : RESET));
@@ -258,27 +363,23 @@ static AD5933_Error AD5933_StartMeasurement(const AD5933_RangeSettings *range, u
     HAL_GPIO_WritePin(AD5933_FEEDBACK_GPIO_PORT, AD5933_FEEDBACK_GPIO_2, ((portFb & (1 << 2)) ? SET : RESET));
     
     range_spec = *range;
+    return AD_OK;
+}
+
+/**
+ * Resets the point and average counters and the error and synchronization state for a new measurement.
+ */
+static void AD5933_ResetCounters(void) {
     sweep_count = 0;
-    sweep_freq = freq_start;
     avg_count = 0;
     sum_real = 0;
     sum_imag = 0;
-    AD5933_WriteFunction(AD5933_FUNCTION_STANDBY);
-    
-    // Send sweep parameters and set clock
-    AD5933_SetClock(freq_start, freq_step);
-    AD5933_Write16(AD5933_NUM_INCR_H_ADDR, num_incr);
-    AD5933_Write16(AD5933_SETTL_H_ADDR, settl);
-    
-    // Switch output on
-    AD5933_WriteFunction(AD5933_FUNCTION_INIT_FREQ);
-    
-    // Start charging coupling capacitor, this is always needed, assuming the output was previously switched off
-    HAL_GPIO_WritePin(AD5933_COUPLING_GPIO_PORT, AD5933_COUPLING_GPIO_PIN, GPIO_PIN_RESET);
-    wait_coupl = board_config.coupling_tau * 4;
-    wait_tick = HAL_GetTick();
-    
-    return AD_OK;
+    error_count = 0;
+    retries = 0;
+    retry_function = 0;
+    aborted = 0;
+    sync_wait = 0;
+    sync_residual = 0;
 }
 
 /**
@@ -286,8 +387,9 @@ static AD5933_Error AD5933_StartMeasurement(const AD5933_RangeSettings *range, u
  * 
  * @param freq_start The start frequency, this will determine the clock range needed
  * @param freq_step The frequency step
+ * @return HAL status code, not `HAL_OK` if any of the registers could not be written
  */
-static void AD5933_SetClock(uint32_t freq_start, uint32_t freq_step) {
+static HAL_StatusTypeDef AD5933_SetClock(uint32_t freq_start, uint32_t freq_step) {
     uint32_t clk;
     uint8_t ctrl;
     
@@ -324,9 +426,12 @@ static void AD5933_SetClock(uint32_t freq_start, uint32_t freq_step) {
         ctrl = AD5933_CLOCK_EXTERNAL;
     }
     
-    AD5933_Write8(AD5933_CTRL_L_ADDR, ctrl);
-    AD5933_Write24(AD5933_START_FREQ_H_ADDR, AD5933_CalcFrequencyReg(freq_start, clk));
-    AD5933_Write24(AD5933_FREQ_INCR_H_ADDR, AD5933_CalcFrequencyReg(freq_step, clk));
+    if(AD5933_Write8(AD5933_CTRL_L_ADDR, ctrl) != HAL_OK ||
+            AD5933_Write24(AD5933_START_FREQ_H_ADDR, AD5933_CalcFrequencyReg(freq_start, clk)) != HAL_OK ||
+            AD5933_Write24(AD5933_FREQ_INCR_H_ADDR, AD5933_CalcFrequencyReg(freq_step, clk)) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    return HAL_OK;
 }
 
 /**
@@ -358,11 +463,19 @@ static AD5933_ClockSource AD5933_GetClockSource(uint32_t freq) {
  * A clock change is a new sweep to the AD5933, so the start frequency and number of increments needs to be set again
  * to the new values.
  * 
+ * If a write fails, the clock change can be done again as a whole by passing {@link AD5933_RETRY_CLOCK_CHANGE} to
+ * {@link AD5933_Recover}, the parameters are remembered for that.
+ * 
  * @param freq_start The new start frequency, that is the next frequency to be measured
  * @param freq_step The frequency step
  * @param increments The new number of increments, this is the total number less the number of already measured steps
+ * @return HAL status code, not `HAL_OK` if any of the writes failed
  */
-static void AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32_t increments) {
+static HAL_StatusTypeDef AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32_t increments) {
+    clock_freq = freq_start;
+    clock_step = freq_step;
+    clock_incr = increments;
+    
     /*
      * For a clock change we need to set new values for almost everything, but we don't need to charge
      * the coupling capacitor, so that's a plus:
@@ -370,13 +483,188 @@ static void AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32
      *  + Set the number of increments, since to the AD5933 we're starting a new sweep
      *  + Start a new sweep
      */
-    AD5933_WriteFunction(AD5933_FUNCTION_STANDBY);
-    AD5933_SetClock(freq_start, freq_step);
-    AD5933_Write16(AD5933_NUM_INCR_H_ADDR, increments);
-    AD5933_WriteFunction(AD5933_FUNCTION_INIT_FREQ);
+    if(AD5933_WriteFunction(AD5933_FUNCTION_STANDBY) != HAL_OK ||
+            AD5933_SetClock(freq_start, freq_step) != HAL_OK ||
+            AD5933_Write16(AD5933_NUM_INCR_H_ADDR, increments) != HAL_OK ||
+            AD5933_WriteFunction(AD5933_FUNCTION_INIT_FREQ) != HAL_OK) {
+        return HAL_ERROR;
+    }
     // Sometimes the AD5933 will lock up, waiting here seems to prevent this
     HAL_Delay(5);
-    AD5933_WriteFunction(AD5933_FUNCTION_START_SWEEP);
+    return AD5933_WriteFunction(AD5933_FUNCTION_START_SWEEP);
+}
+
+/**
+ * Finds the k-th smallest value with Hoare's selection algorithm (as described by N. Wirth), which takes linear time
+ * on average. The values are reordered so that all values before index `k` are not greater and all values after it
+ * are not less than the result.
+ * 
+ * @param data The values
+ * @param count The number of values
+ * @param k The index of the value to find in sorted order
+ * @return The k-th smallest value
+ */
+static int32_t AD5933_Select(int32_t *data, uint32_t count, uint32_t k) {
+    int32_t lo = 0;
+    int32_t hi = count - 1;
+    
+    while(lo < hi) {
+        int32_t pivot = data[k];
+        int32_t i = lo;
+        int32_t j = hi;
+        do {
+            while(data[i] < pivot) i++;
+            while(pivot < data[j]) j--;
+            if(i <= j) {
+                int32_t tmp = data[i];
+                data[i] = data[j];
+                data[j] = tmp;
+                i++;
+                j--;
+            }
+        } while(i <= j);
+        if(j < (int32_t)k) lo = i;
+        if((int32_t)k < i) hi = j;
+    }
+    return data[k];
+}
+
+/**
+ * Combines the samples of one component of a frequency point with the estimator of the running sweep.
+ * 
+ * @param samples The samples, only used for estimators other than the mean
+ * @param sum The sum of the samples
+ * @return The estimate
+ */
+static int16_t AD5933_Estimate(const int16_t *samples, int32_t sum) {
+    const uint32_t n = sweep_spec.Averages;
+    int32_t median;
+    int32_t limit;
+    uint32_t count;
+    
+    // With fewer than 3 samples there is nothing to reject
+    if(sweep_spec.Estimator == AD_ESTIMATE_MEAN || n < 3) {
+        return sum / (int32_t)n;
+    }
+    
+    for(uint32_t j = 0; j < n; j++) {
+        estimate_buf[j] = samples[j];
+    }
+    median = AD5933_Select(estimate_buf, n, n / 2);
+    
+    switch(sweep_spec.Estimator) {
+        case AD_ESTIMATE_MEDIAN:
+            if(n % 2 == 0) {
+                // The lower middle value is the largest one before the upper middle value
+                int32_t lower = estimate_buf[0];
+                for(uint32_t j = 1; j < n / 2; j++) {
+                    lower = (estimate_buf[j] > lower ? estimate_buf[j] : lower);
+                }
+                median = (median + lower) / 2;
+            }
+            return median;
+            
+        case AD_ESTIMATE_TRIMMED:
+            // Select the lower quartile, then the upper quartile among the values above it
+            count = n - 2 * (n / 4);
+            AD5933_Select(estimate_buf, n, n / 4);
+            AD5933_Select(estimate_buf + n / 4, n - n / 4, count - 1);
+            sum = 0;
+            for(uint32_t j = n / 4; j < n / 4 + count; j++) {
+                sum += estimate_buf[j];
+            }
+            return sum / (int32_t)count;
+            
+        case AD_ESTIMATE_CLIPPED:
+            // Sigma is estimated as 1.4826 times the median absolute deviation
+            for(uint32_t j = 0; j < n; j++) {
+                estimate_buf[j] = abs(samples[j] - median);
+            }
+            limit = (AD5933_Select(estimate_buf, n, n / 2) * 4448 + 500) / 1000;
+            sum = 0;
+            count = 0;
+            for(uint32_t j = 0; j < n; j++) {
+                if(abs(samples[j] - median) <= limit) {
+                    sum += samples[j];
+                    count++;
+                }
+            }
+            return sum / (int32_t)count;
+            
+        default:
+            return sum / (int32_t)n;
+    }
+}
+
+/**
+ * Gets whether the conversions of each frequency point in the running sweep are synchronized to the mains frequency.
+ */
+static uint8_t AD5933_IsSynchronized(void) {
+    return sweep_spec.Mains_Freq != 0 && sweep_spec.Averages > 1;
+}
+
+/**
+ * Records the mains phase at the start of the conversion that has just finished, this needs to be called before
+ * `avg_count` is incremented.
+ * 
+ * Mains pickup adds an error to each result that rotates with the mains phase at the start of the conversion. If the N
+ * conversions of a point are spaced M/N mains periods apart (with M not a multiple of N), their start phases are evenly
+ * distributed over a full turn and the errors cancel in the sum, while unsynchronized averaging only reduces them by
+ * sqrt(N). M is the smallest value for which the spacing is not shorter than the first conversion of the point took.
+ * The phases are recorded from the actual start times, so the estimate includes the timer resolution and conversions
+ * that took longer than the first one.
+ */
+static void AD5933_SyncRecord(void) {
+    const uint32_t n = sweep_spec.Averages;
+    
+    if(avg_count == 0) {
+        // Duration in µs times the mains frequency, which is in mains periods times 1e6
+        uint64_t duration = (uint64_t)(tick_count - conv_tick) * TIM3_INTERVAL * sweep_spec.Mains_Freq;
+        point_tick = conv_tick;
+        sync_step = (duration * n + 999999) / 1000000;
+        if(sync_step == 0) {
+            sync_step = 1;
+        }
+        if(sync_step % n == 0) {
+            sync_step++;
+        }
+        sync_cos = 0;
+        sync_sin = 0;
+    }
+    
+    uint32_t phase = ((uint64_t)(conv_tick - point_tick) * TIM3_INTERVAL * sweep_spec.Mains_Freq) % 1000000;
+    float angle = phase * (2.0f * (float)M_PI / 1000000.0f);
+    sync_cos += cosf(angle);
+    sync_sin += sinf(angle);
+    
+    if(avg_count + 1u == n) {
+        float residual = sqrtf(sync_cos * sync_cos + sync_sin * sync_sin) / n;
+        if(residual > sync_residual) {
+            sync_residual = residual;
+        }
+    }
+}
+
+/**
+ * Starts the next conversion of the current frequency point if it is due, see {@link AD5933_SyncRecord}. Otherwise the
+ * conversion is started by {@link AD5933_TimerCallback} at the timer tick closest to its mains phase.
+ * 
+ * @return The (new) AD5933 status
+ */
+static AD5933_Status AD5933_SyncRepeat(void) {
+    // Start of conversion `avg_count` in timer ticks after the first one, rounded
+    uint64_t den = (uint64_t)sweep_spec.Averages * sweep_spec.Mains_Freq * TIM3_INTERVAL;
+    uint64_t target = ((uint64_t)avg_count * sync_step * 2000000 + den) / (2 * den);
+    
+    if(tick_count - point_tick < target) {
+        sync_wait = 1;
+        return status;
+    }
+    sync_wait = 0;
+    if(AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ) != HAL_OK) {
+        return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+    }
+    return status;
 }
 
 /**
@@ -385,7 +673,10 @@ static void AD5933_DoClockChange(uint32_t freq_start, uint32_t freq_step, uint32
  * @return The (new) AD5933 status
  */
 static AD5933_Status AD5933_CallbackTemp(void) {
-    if(AD5933_ReadStatus() & AD5933_STATUS_VALID_TEMP) {
+    uint8_t dev_status;
+    
+    AD5933_ReadStatus(&dev_status);
+    if(dev_status & AD5933_STATUS_VALID_TEMP) {
         uint16_t data;
         AD5933_Read16(AD5933_TEMP_H_ADDR, &data);
         // Convert data to temperature value
@@ -406,12 +697,27 @@ static AD5933_Status AD5933_CallbackTemp(void) {
  * @return The (new) AD5933 status
  */
 static AD5933_Status AD5933_CallbackImpedance(void) {
-    uint8_t dev_status = AD5933_ReadStatus();
+    uint8_t dev_status;
+    
+    if(AD5933_ReadStatus(&dev_status) != HAL_OK) {
+        // Nothing has been changed yet, just try again
+        return AD5933_Recover(0);
+    }
     
     if(dev_status & AD5933_STATUS_VALID_IMPEDANCE) {
         int16_t tmp_real, tmp_imag;
-        AD5933_Read16(AD5933_REAL_H_ADDR, (uint16_t *)&tmp_real);
-        AD5933_Read16(AD5933_IMAG_H_ADDR, (uint16_t *)&tmp_imag);
+        if(AD5933_Read16(AD5933_REAL_H_ADDR, (uint16_t *)&tmp_real) != HAL_OK ||
+                AD5933_Read16(AD5933_IMAG_H_ADDR, (uint16_t *)&tmp_imag) != HAL_OK) {
+            // The sample could be corrupted, measure it again
+            return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+        }
+        if(AD5933_IsSynchronized()) {
+            AD5933_SyncRecord();
+        }
+        if(sweep_spec.Estimator != AD_ESTIMATE_MEAN) {
+            samples_real[avg_count] = tmp_real;
+            samples_imag[avg_count] = tmp_imag;
+        }
         sum_real += tmp_real;
         sum_imag += tmp_imag;
         avg_count++;
@@ -419,31 +725,80 @@ static AD5933_Status AD5933_CallbackImpedance(void) {
         if(avg_count == sweep_spec.Averages) {
             // Finished with frequency point, save average to result buffer
             AD5933_ImpedanceData *buf = pBuffer + sweep_count;
-            buf->Real = sum_real / sweep_spec.Averages;
-            buf->Imag = sum_imag / sweep_spec.Averages;
+            buf->Real = AD5933_Estimate(samples_real, sum_real);
+            buf->Imag = AD5933_Estimate(samples_imag, sum_imag);
             buf->Frequency = sweep_freq;
+            EvTrace_Event(EVTRACE_POINT_STORED, 0, (uint16_t)sweep_count);
+            Telemetry_Count(TELEMETRY_POINTS);
             sweep_count++;
             sweep_freq += sweep_spec.Freq_Increment;
             
             // Finish or measure next step
             if(dev_status & AD5933_STATUS_SWEEP_COMPLETE) {
+                Telemetry_Count(TELEMETRY_SWEEPS);
                 status = AD_FINISH_IMPEDANCE;
 #ifdef AD5933_LED_USE
                 HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_RESET);
 #endif
             } else {
-                if(clk_source != AD5933_GetClockSource(sweep_freq)) {
-                    AD5933_DoClockChange(sweep_freq, sweep_spec.Freq_Increment,
-                            sweep_spec.Num_Increments - sweep_count);
-                } else {
-                    AD5933_WriteFunction(AD5933_FUNCTION_INCREMENT_FREQ);
-                }
                 avg_count = 0;
                 sum_real = 0;
                 sum_imag = 0;
+                if(clk_source != AD5933_GetClockSource(sweep_freq)) {
+                    if(AD5933_DoClockChange(sweep_freq, sweep_spec.Freq_Increment,
+                            sweep_spec.Num_Increments - sweep_count) != HAL_OK) {
+                        return AD5933_Recover(AD5933_RETRY_CLOCK_CHANGE);
+                    }
+                } else if(AD5933_WriteFunction(AD5933_FUNCTION_INCREMENT_FREQ) != HAL_OK) {
+                    // A write that failed was not acknowledged, so the frequency has not been incremented yet
+                    return AD5933_Recover(AD5933_FUNCTION_INCREMENT_FREQ);
+                }
             }
-        } else {
-            AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ);
+        } else if(AD5933_IsSynchronized()) {
+            return AD5933_SyncRepeat();
+        } else if(AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ) != HAL_OK) {
+            return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+        }
+    }
+    
+    return status;
+}
+
+/**
+ * Timer callback when continuously measuring one frequency.
+ * 
+ * @return The (new) AD5933 status
+ */
+static AD5933_Status AD5933_CallbackContinuous(void) {
+    uint8_t dev_status;
+    
+    if(AD5933_ReadStatus(&dev_status) != HAL_OK) {
+        return AD5933_Recover(0);
+    }
+    
+    if(dev_status & AD5933_STATUS_VALID_IMPEDANCE) {
+        int16_t tmp_real, tmp_imag;
+        if(AD5933_Read16(AD5933_REAL_H_ADDR, (uint16_t *)&tmp_real) != HAL_OK ||
+                AD5933_Read16(AD5933_IMAG_H_ADDR, (uint16_t *)&tmp_imag) != HAL_OK) {
+            return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+        }
+        // Start the next conversion right away, the output stays on the same frequency
+        if(AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ) != HAL_OK) {
+            AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+        }
+        sum_real += tmp_real;
+        sum_imag += tmp_imag;
+        avg_count++;
+        
+        if(avg_count == sweep_spec.Averages) {
+            pBuffer->Real = sum_real / sweep_spec.Averages;
+            pBuffer->Imag = sum_imag / sweep_spec.Averages;
+            pBuffer->Frequency = sweep_freq;
+            Telemetry_Count(TELEMETRY_POINTS);
+            sweep_count++;
+            avg_count = 0;
+            sum_real = 0;
+            sum_imag = 0;
         }
     }
     
@@ -456,12 +811,18 @@ static AD5933_Status AD5933_CallbackImpedance(void) {
  * @return The (new) AD5933 status
  */
 static AD5933_Status AD5933_CallbackCalibrate(void) {
-    uint8_t dev_status = AD5933_ReadStatus();
+    uint8_t dev_status;
+    
+    if(AD5933_ReadStatus(&dev_status) != HAL_OK) {
+        return AD5933_Recover(0);
+    }
     
     if(dev_status & AD5933_STATUS_VALID_IMPEDANCE) {
         int16_t tmp_real, tmp_imag;
-        AD5933_Read16(AD5933_REAL_H_ADDR, (uint16_t *)&tmp_real);
-        AD5933_Read16(AD5933_IMAG_H_ADDR, (uint16_t *)&tmp_imag);
+        if(AD5933_Read16(AD5933_REAL_H_ADDR, (uint16_t *)&tmp_real) != HAL_OK ||
+                AD5933_Read16(AD5933_IMAG_H_ADDR, (uint16_t *)&tmp_imag) != HAL_OK) {
+            return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
+        }
         sum_real += tmp_real;
         sum_imag += tmp_imag;
         avg_count++;
@@ -478,10 +839,12 @@ static AD5933_Status AD5933_CallbackCalibrate(void) {
                 pGainData->point1[range].Imag = sum_imag / AD5933_CALIB_AVERAGES;
                 
                 if(pGainData->is_2point) {
-                    AD5933_WriteFunction(AD5933_FUNCTION_INCREMENT_FREQ);
                     avg_count = 0;
                     sum_real = 0;
                     sum_imag = 0;
+                    if(AD5933_WriteFunction(AD5933_FUNCTION_INCREMENT_FREQ) != HAL_OK) {
+                        return AD5933_Recover(AD5933_FUNCTION_INCREMENT_FREQ);
+                    }
                     return status;
                 }
             }
@@ -493,21 +856,53 @@ static AD5933_Status AD5933_CallbackCalibrate(void) {
                 if(pGainData->is_2point) {
                     step = pGainData->point2[range].Frequency - pGainData->point1[range].Frequency;
                 }
-                AD5933_DoClockChange(pGainData->point1[range].Frequency, step, 1);
                 avg_count = 0;
                 sum_real = 0;
                 sum_imag = 0;
+                if(AD5933_DoClockChange(pGainData->point1[range].Frequency, step, 1) != HAL_OK) {
+                    return AD5933_Recover(AD5933_RETRY_CLOCK_CHANGE);
+                }
             } else {
                 status = AD_FINISH_CALIB;
             }
-        } else {
-            AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ);
+        } else if(AD5933_WriteFunction(AD5933_FUNCTION_REPEAT_FREQ) != HAL_OK) {
+            return AD5933_Recover(AD5933_FUNCTION_REPEAT_FREQ);
         }
     }
     
     return status;
 }
 
+/**
+ * Recovers from an I2C error during a measurement by clearing the bus, the function code that was to be written (or
+ * is needed to measure the sample again) is written on the next timer callback.
+ * 
+ * A sweep is aborted after {@link AD5933_MAX_RETRIES} consecutive errors, keeping the points measured so far. Other
+ * measurements keep trying, since they can be stopped anytime.
+ * 
+ * @param function The function code to write, {@link AD5933_RETRY_CLOCK_CHANGE} to do the last clock change again, or
+ *        `0` if none
+ * @return The (new) AD5933 status
+ */
+static AD5933_Status AD5933_Recover(uint16_t function) {
+    error_count++;
+    error_total++;
+    MX_I2C_BusClear(i2cHandle);
+    retry_function = function;
+    
+    if(++retries > AD5933_MAX_RETRIES && status == AD_MEASURE_IMPEDANCE) {
+        retry_function = 0;
+        aborted = 1;
+        AD5933_WriteFunction(AD5933_FUNCTION_STANDBY);
+        status = AD_FINISH_IMPEDANCE;
+#ifdef AD5933_LED_USE
+        HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_RESET);
+#endif
+    }
+    
+    return status;
+}
+
 // Exported functions ---------------------------------------------------------
 
 /**
@@ -529,7 +924,10 @@ uint8_t AD5933_IsBusy(void) {
 }
 
 /**
- * Initializes the driver with the specified I2C handle for communication.
+ * Initializes the driver with the specified I2C handle for communication and configures the GPIO pins.
+ * 
+ * The AD5933 is not accessed until {@link AD5933_FinishInit} is called, so other initialization can be done in
+ * between while the analog circuitry settles.
  * 
  * @param i2c Pointer to an I2C handle structure that is to be used for communication with the AD5933
  * @param tim Pointer to a timer handle structure that is to be used for the external clock source
@@ -567,7 +965,22 @@ AD5933_Error AD5933_Init(I2C_HandleTypeDef *i2c, TIM_HandleTypeDef *tim) {
     
     i2cHandle = i2c;
     timHandle = tim;
-    HAL_Delay(5);
+    init_tick = HAL_GetTick();
+    
+    return AD_OK;
+}
+
+/**
+ * Finishes initialization by resetting the AD5933, waiting until {@link AD5933_INIT_DELAY} has passed since
+ * {@link AD5933_Init} if necessary.
+ * 
+ * @return `AD_OK`
+ */
+AD5933_Error AD5933_FinishInit(void) {
+    assert_param(i2cHandle != NULL);
+    
+    while(HAL_GetTick() - init_tick < AD5933_INIT_DELAY)
+        ;
     AD5933_Write8(AD5933_CTRL_L_ADDR, LOBYTE(AD5933_CTRL_RESET));
     status = AD_IDLE;
     
@@ -626,6 +1039,9 @@ AD5933_Error AD5933_MeasureImpedance(const AD5933_Sweep *sweep, const AD5933_Ran
     if(sweep->Freq_Increment == 0 || sweep->Num_Increments > AD5933_MAX_NUM_INCREMENTS) {
         return AD_ERROR;
     }
+    if(sweep->Estimator != AD_ESTIMATE_MEAN && sweep->Averages > AD5933_MAX_ROBUST_AVERAGES) {
+        return AD_ERROR;
+    }
     
     pBuffer = buffer;
     sweep_spec = *sweep;
@@ -643,13 +1059,291 @@ AD5933_Error AD5933_MeasureImpedance(const AD5933_Sweep *sweep, const AD5933_Ran
     return ret;
 }
 
+/**
+ * Repeats the last frequency sweep into the same buffer, overwriting the previous results.
+ * 
+ * The output is not switched off after a sweep has finished, so the sweep can be started again right away without
+ * waiting for the coupling capacitor to charge.
+ * 
+ * @return {@link AD5933_Error} code, {@link AD_ERROR} if the last measurement was not a finished sweep
+ */
+AD5933_Error AD5933_RepeatSweep(void) {
+    if(status != AD_FINISH_IMPEDANCE) {
+        return AD_ERROR;
+    }
+    
+    AD5933_ResetCounters();
+    sweep_freq = sweep_spec.Start_Freq;
+    
+    // This is the same as a clock change at the start frequency
+    if(AD5933_DoClockChange(sweep_spec.Start_Freq, sweep_spec.Freq_Increment, sweep_spec.Num_Increments) != HAL_OK) {
+        // Done again by the next timer callback
+        AD5933_Recover(AD5933_RETRY_CLOCK_CHANGE);
+    }
+    status = AD_MEASURE_IMPEDANCE;
+    
+#ifdef AD5933_LED_USE
+    HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_SET);
+#endif
+    return AD_OK;
+}
+
+/**
+ * Starts a new frequency sweep right after a finished one, with possibly different frequencies and range settings.
+ * 
+ * Like with {@link AD5933_RepeatSweep} the output stays on, so the coupling capacitor does not need to be charged again
+ * as long as the DC offset of the AD5933 output stays the same. The offset only depends on the voltage range, so if
+ * that changes (or the last measurement was not a finished sweep) this is the same as {@link AD5933_MeasureImpedance}.
+ * The external attenuation and the feedback resistor are behind the coupling capacitor and can be changed freely.
+ * 
+ * @param sweep The specifications to use for the sweep
+ * @param range The specifications for PGA gain, voltage range, external attenuation and feedback resistor
+ * @param buffer Pointer to a buffer where measurement data is written
+ * @return {@link AD5933_Error} code
+ */
+AD5933_Error AD5933_ContinueSweep(const AD5933_Sweep *sweep, const AD5933_RangeSettings *range,
+        AD5933_ImpedanceData *buffer) {
+    assert_param(sweep != NULL);
+    assert_param(buffer != NULL);
+    assert_param(range != NULL);
+    
+    if(status != AD_FINISH_IMPEDANCE || range->Voltage_Range != range_spec.Voltage_Range) {
+        return AD5933_MeasureImpedance(sweep, range, buffer);
+    }
+    
+    if(sweep->Freq_Increment == 0 || sweep->Num_Increments > AD5933_MAX_NUM_INCREMENTS) {
+        return AD_ERROR;
+    }
+    if(sweep->Estimator != AD_ESTIMATE_MEAN && sweep->Averages > AD5933_MAX_ROBUST_AVERAGES) {
+        return AD_ERROR;
+    }
+    if(sweep->Start_Freq < AD5933_FREQ_MIN ||
+            (sweep->Start_Freq + sweep->Freq_Increment * sweep->Num_Increments) > AD5933_FREQ_MAX) {
+        return AD_ERROR;
+    }
+    if(AD5933_SetRange(range) != AD_OK) {
+        return AD_ERROR;
+    }
+    
+    pBuffer = buffer;
+    sweep_spec = *sweep;
+    AD5933_ResetCounters();
+    sweep_freq = sweep->Start_Freq;
+    AD5933_Write16(AD5933_SETTL_H_ADDR, sweep->Settling_Cycles | sweep->Settling_Mult);
+    if(AD5933_DoClockChange(sweep->Start_Freq, sweep->Freq_Increment, sweep->Num_Increments) != HAL_OK) {
+        // Done again by the next timer callback
+        AD5933_Recover(AD5933_RETRY_CLOCK_CHANGE);
+    }
+    status = AD_MEASURE_IMPEDANCE;
+    
+#ifdef AD5933_LED_USE
+    HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_SET);
+#endif
+    return AD_OK;
+}
+
+/**
+ * Suspends the running frequency sweep, so another measurement can be done before it is continued with
+ * {@link AD5933_ResumeSweep}.
+ * 
+ * The point being measured is discarded and measured again when the sweep is resumed, since its conversions need to
+ * follow each other for settling and mains synchronization, and the other measurement overwrites the samples kept for
+ * the robust estimators. If the coupling capacitor has been charged, the output stays on and the driver status is
+ * {@link AD_FINISH_IMPEDANCE}, so a measurement started with {@link AD5933_ContinueSweep} doesn't need to charge it
+ * again. Otherwise the AD5933 is put in standby and the status is {@link AD_IDLE}.
+ * 
+ * This must not be preempted by {@link AD5933_TimerCallback}.
+ * 
+ * @param context Pointer to a structure receiving the state of the sweep
+ * @return {@link AD5933_Error} code, {@link AD_ERROR} if no sweep is running
+ */
+AD5933_Error AD5933_SuspendSweep(AD5933_SweepContext *context) {
+    assert_param(context != NULL);
+    
+    if(status != AD_MEASURE_IMPEDANCE) {
+        return AD_ERROR;
+    }
+    
+    context->sweep = sweep_spec;
+    context->range = range_spec;
+    context->buffer = pBuffer;
+    context->count = sweep_count;
+    context->errors = error_count;
+    context->residual = sync_residual;
+    
+    retry_function = 0;
+    sync_wait = 0;
+    if(wait_coupl) {
+        wait_coupl = 0;
+        HAL_GPIO_WritePin(AD5933_COUPLING_GPIO_PORT, AD5933_COUPLING_GPIO_PIN, GPIO_PIN_SET);
+        AD5933_WriteFunction(AD5933_FUNCTION_STANDBY);
+        status = AD_IDLE;
+    } else {
+        status = AD_FINISH_IMPEDANCE;
+    }
+    
+#ifdef AD5933_LED_USE
+    HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_RESET);
+#endif
+    return AD_OK;
+}
+
+/**
+ * Resumes a frequency sweep suspended with {@link AD5933_SuspendSweep}, starting at the first point not measured yet.
+ * 
+ * Like with {@link AD5933_ContinueSweep}, the coupling capacitor is only charged again if the output was switched off
+ * or the voltage range has changed in the meantime. The settling cycles are always waited for, since the device under
+ * test or the frequency may have changed.
+ * 
+ * @param context Pointer to the state of the sweep
+ * @return {@link AD5933_Error} code
+ */
+AD5933_Error AD5933_ResumeSweep(const AD5933_SweepContext *context) {
+    AD5933_Error ret;
+    
+    assert_param(context != NULL);
+    assert(status != AD_UNINIT);
+    
+    if(AD5933_IsBusy()) {
+        return AD_BUSY;
+    }
+    if(context->count > context->sweep.Num_Increments) {
+        return AD_ERROR;
+    }
+    
+    uint32_t freq = context->sweep.Start_Freq + context->sweep.Freq_Increment * context->count;
+    uint16_t remaining = context->sweep.Num_Increments - context->count;
+    uint16_t settl = context->sweep.Settling_Cycles | context->sweep.Settling_Mult;
+    HAL_StatusTypeDef clock = HAL_OK;
+    
+    if(status != AD_FINISH_IMPEDANCE || context->range.Voltage_Range != range_spec.Voltage_Range) {
+        ret = AD5933_StartMeasurement(&context->range, freq, context->sweep.Freq_Increment, remaining, settl);
+    } else {
+        ret = AD5933_SetRange(&context->range);
+        if(ret == AD_OK) {
+            AD5933_ResetCounters();
+            sweep_freq = freq;
+            AD5933_Write16(AD5933_SETTL_H_ADDR, settl);
+            clock = AD5933_DoClockChange(freq, context->sweep.Freq_Increment, remaining);
+        }
+    }
+    if(ret != AD_OK) {
+        return ret;
+    }
+    
+    pBuffer = context->buffer;
+    sweep_spec = context->sweep;
+    sweep_count = context->count;
+    error_count = context->errors;
+    sync_residual = context->residual;
+    if(clock != HAL_OK) {
+        // Done again by the next timer callback
+        AD5933_Recover(AD5933_RETRY_CLOCK_CHANGE);
+    }
+    status = AD_MEASURE_IMPEDANCE;
+    
+#ifdef AD5933_LED_USE
+    HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_SET);
+#endif
+    return AD_OK;
+}
+
 /**
  * Gets the number of data points already measured. This value only has meaning if a sweep is running.
+ * 
+ * For a continuous measurement this is the number of results so far, wrapping around at 65536.
  */
 uint16_t AD5933_GetSweepCount(void) {
     return sweep_count;
 }
 
+/**
+ * Gets the number of I2C errors the driver recovered from during the running or last measurement.
+ */
+uint16_t AD5933_GetErrorCount(void) {
+    return error_count;
+}
+
+/**
+ * Gets the number of I2C errors since reset.
+ */
+uint32_t AD5933_GetTotalErrorCount(void) {
+    return error_total;
+}
+
+/**
+ * Gets whether the last sweep was aborted after {@link AD5933_MAX_RETRIES} consecutive I2C errors. The points measured
+ * before the abort are valid, {@link AD5933_GetSweepCount} returns their number.
+ */
+uint8_t AD5933_WasAborted(void) {
+    return aborted;
+}
+
+/**
+ * Gets the estimated reduction of mains pickup in the running or last sweep, for the point with the worst timing.
+ * 
+ * This is how much the pickup at the mains frequency is reduced by averaging the conversions of each point, for
+ * comparison unsynchronized averaging reduces it by 10*log10(N) dB on average. Harmonics of the mains frequency are
+ * cancelled as well, unless the harmonic number times M is a multiple of N (see {@link AD5933_SyncRecord}).
+ * 
+ * @return Rejection in dB, `0` if the sweep is not synchronized or no point has been measured yet
+ */
+float AD5933_GetMainsRejection(void) {
+    if(!AD5933_IsSynchronized() || sweep_count == 0) {
+        return 0;
+    }
+    if(sync_residual <= 0) {
+        return AD5933_MAINS_REJECTION_MAX;
+    }
+    return fminf(-20.0f * log10f(sync_residual), AD5933_MAINS_REJECTION_MAX);
+}
+
+/**
+ * Initiates a continuous measurement at a single frequency, that keeps running until the driver is reset.
+ * 
+ * Each result is the average of the specified number of conversions and overwrites the previous result in `buffer`,
+ * the sweep count is incremented whenever a new result is available.
+ * 
+ * @param freq The output frequency in Hz
+ * @param settl Settling time register value
+ * @param averages The number of conversions averaged for each result
+ * @param range The specifications for PGA gain, voltage range, external attenuation and feedback resistor
+ * @param buffer Pointer to a structure where the latest result is written
+ * @return {@link AD5933_Error} code
+ */
+AD5933_Error AD5933_MeasureContinuous(uint32_t freq, uint16_t settl, uint16_t averages,
+        const AD5933_RangeSettings *range, AD5933_ImpedanceData *buffer) {
+    AD5933_Error ret;
+    
+    assert_param(buffer != NULL);
+    assert_param(range != NULL);
+    assert(status != AD_UNINIT);
+    
+    if(AD5933_IsBusy()) {
+        return AD_BUSY;
+    }
+    if(averages == 0) {
+        return AD_ERROR;
+    }
+    
+    pBuffer = buffer;
+    sweep_spec.Averages = averages;
+    sweep_spec.Estimator = AD_ESTIMATE_MEAN;
+    sweep_spec.Mains_Freq = 0;
+    
+    // The frequency is never incremented, so the sweep parameters don't matter beyond the start frequency
+    ret = AD5933_StartMeasurement(range, freq, 0, 1, settl);
+    
+    if(ret != AD_ERROR) {
+        status = AD_MEASURE_CONTINUOUS;
+        
+#ifdef AD5933_LED_USE
+        HAL_GPIO_WritePin(AD5933_LED_GPIO_PORT, AD5933_LED_GPIO_PIN, GPIO_PIN_SET);
+#endif
+    }
+    return ret;
+}
+
 /**
  * Initiates a device temperature measurement on the AD5933 with the specified destination address.
  * 
@@ -753,9 +1447,12 @@ AD5933_Error AD5933_Calibrate(const AD5933_CalibrationSpec *cal, const AD5933_Ra
  * @return The (new) AD5933 status
  */
 AD5933_Status AD5933_TimerCallback(void) {
+    tick_count++;
+    
     switch(status) {
         case AD_MEASURE_IMPEDANCE:
         case AD_MEASURE_IMPEDANCE_AUTORANGE:
+        case AD_MEASURE_CONTINUOUS:
         case AD_CALIBRATE:
             if(wait_coupl) {
                 if(HAL_GetTick() - wait_tick > wait_coupl) {
@@ -763,10 +1460,27 @@ AD5933_Status AD5933_TimerCallback(void) {
                     HAL_GPIO_WritePin(AD5933_COUPLING_GPIO_PORT, AD5933_COUPLING_GPIO_PIN, GPIO_PIN_SET);
                     
                     // Start sweep
-                    AD5933_WriteFunction(AD5933_FUNCTION_START_SWEEP);
+                    if(AD5933_WriteFunction(AD5933_FUNCTION_START_SWEEP) != HAL_OK) {
+                        return AD5933_Recover(AD5933_FUNCTION_START_SWEEP);
+                    }
+                }
+                return status;
+            }
+            if(retry_function != 0) {
+                // Repeat the write or clock change that failed, or start measuring the sample again
+                Telemetry_Count(TELEMETRY_I2C_RETRIES);
+                HAL_StatusTypeDef ret = (retry_function == AD5933_RETRY_CLOCK_CHANGE ?
+                        AD5933_DoClockChange(clock_freq, clock_step, clock_incr) :
+                        AD5933_WriteFunction(retry_function));
+                if(ret != HAL_OK) {
+                    return AD5933_Recover(retry_function);
                 }
+                retry_function = 0;
                 return status;
             }
+            if(sync_wait) {
+                return AD5933_SyncRepeat();
+            }
             break;
         default:
             break;
@@ -787,6 +1501,9 @@ AD5933_Status AD5933_TimerCallback(void) {
         case AD_MEASURE_IMPEDANCE:
             return AD5933_CallbackImpedance();
             
+        case AD_MEASURE_CONTINUOUS:
+            return AD5933_CallbackContinuous();
+            
         case AD_CALIBRATE:
             return AD5933_CallbackCalibrate();
     }
@@ -916,6 +1633,43 @@ void AD5933_ConvertPolarToCartesian(const AD5933_ImpedancePolar *polar, AD5933_I
     cart->Imag = polar->Magnitude * imag;
 }
 
+/**
+ * Converts an impedance value from the polar representation to the values of an equivalent circuit model.
+ * 
+ * @param polar Pointer to a polar impedance structure
+ * @param model The equivalent circuit model
+ * @param eq Pointer to an equivalent circuit structure to be populated
+ */
+void AD5933_ConvertPolarToEquivalent(const AD5933_ImpedancePolar *polar, AD5933_Model model, AD5933_Equivalent *eq) {
+    AD5933_ImpedanceCartesian z;
+    float omega = (float)M_TWOPI * polar->Frequency;
+    float mag2;
+    
+    AD5933_ConvertPolarToCartesian(polar, &z);
+    switch(model) {
+        case AD_MODEL_CS_RS:
+            eq->Reactive = -1.0f / (omega * z.Imag);
+            eq->Resistance = z.Real;
+            break;
+            
+        case AD_MODEL_CP_RP:
+            // Parallel values from the admittance 1 / Z = (R - jX) / |Z|^2
+            mag2 = polar->Magnitude * polar->Magnitude;
+            eq->Reactive = -z.Imag / (omega * mag2);
+            eq->Resistance = mag2 / z.Real;
+            break;
+            
+        case AD_MODEL_LS_RS:
+            eq->Reactive = z.Imag / omega;
+            eq->Resistance = z.Real;
+            break;
+    }
+    
+    eq->Frequency = polar->Frequency;
+    eq->D = fabsf(z.Real / z.Imag);
+    eq->Q = fabsf(z.Imag / z.Real);
+}
+
 /**
  * Gets the corresponding voltage in mV for a voltage range register value (one of the {@link AD5933_VOLTAGE} values).
  * 
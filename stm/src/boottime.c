@@ -0,0 +1,71 @@
+/**
+ * @file    boottime.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Start-up time measurement.
+ * 
+ * Records when each {@link Boot_Milestone} is first reached, in µs since `HAL_Init` (which runs right after reset),
+ * so the time from power-on to the first measurement can be reported and optimized.
+ */
+
+// Includes -------------------------------------------------------------------
+#include "boottime.h"
+
+// Private variables ----------------------------------------------------------
+static uint32_t times[BOOT_COUNT];
+static volatile uint32_t reached = 0;   //!< Bit mask of the milestones reached
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Records the current time for a milestone, unless it has been reached before.
+ * 
+ * @param milestone The milestone reached
+ */
+void Boot_Mark(Boot_Milestone milestone) {
+    uint32_t tick, val;
+    
+    if(milestone >= BOOT_COUNT || (reached & (1UL << milestone))) {
+        return;
+    }
+    
+    // Make sure the tick count and counter value belong together
+    do {
+        tick = HAL_GetTick();
+        val = SysTick->VAL;
+    } while(tick != HAL_GetTick());
+    
+    uint32_t cyclesPerMicro = SystemCoreClock / 1000000;
+    uint32_t time = tick * 1000 + (SysTick->LOAD - val) / (cyclesPerMicro ? cyclesPerMicro : 1);
+    
+    // This is called from main and the USB interrupt, so check and update the mask without being interrupted
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if(!(reached & (1UL << milestone))) {
+        times[milestone] = time;
+        reached |= (1UL << milestone);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Gets the time a milestone was reached.
+ * 
+ * @param milestone The milestone
+ * @return The time in µs since reset, or `0` if the milestone has not been reached
+ */
+uint32_t Boot_GetTime(Boot_Milestone milestone) {
+    if(milestone >= BOOT_COUNT || !(reached & (1UL << milestone))) {
+        return 0;
+    }
+    return times[milestone];
+}
+
+/**
+ * Gets whether start-up is finished and commands can be processed.
+ */
+uint8_t Boot_IsReady(void) {
+    return (reached & (1UL << BOOT_READY)) != 0;
+}
+
+// ----------------------------------------------------------------------------
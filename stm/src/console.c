@@ -13,6 +13,7 @@
 #include "main.h"
 #include "util.h"
 #include "convert.h"
+#include "decimate.h"
 // Pull in support function needed for float formatting with printf
 __ASM (".global _printf_float");
 
@@ -20,21 +21,40 @@ __ASM (".global _printf_float");
 typedef enum
 {
     CON_ARG_INVALID = 0,
+    // board lcr
+    CON_ARG_LCR_AVG,
+    CON_ARG_LCR_COUNT,
+    CON_ARG_LCR_MODEL,
+    // board log
+    CON_ARG_LOG_AVG,
+    CON_ARG_LOG_COUNT,
+    CON_ARG_LOG_WINDOW,
+    // board monitor
+    CON_ARG_MONITOR_COUNT,
     // board read
     CON_ARG_READ_FORMAT,
     CON_ARG_READ_RAW,
     CON_ARG_READ_GAIN,
+    CON_ARG_READ_FEATURES,
+    CON_ARG_READ_DIFF,
+    CON_ARG_READ_RATIO,
+    CON_ARG_READ_STDDEV,
+    CON_ARG_READ_SCHED,
+    CON_ARG_READ_LEVELS,
     // board set/get
     CON_ARG_SET_AUTORANGE,
     CON_ARG_SET_AVG,
+    CON_ARG_SET_AVG_MODE,
     CON_ARG_SET_ECHO,
     CON_ARG_SET_FEEDBACK,
     CON_ARG_SET_FORMAT,
     CON_ARG_SET_GAIN,
+    CON_ARG_SET_MAINS,
     CON_ARG_SET_SETTL,
     CON_ARG_SET_START,
     CON_ARG_SET_STEPS,
     CON_ARG_SET_STOP,
+    CON_ARG_SET_SWEEP_AVG,
     CON_ARG_SET_VOLTAGE,
     // eth set
     CON_ARG_SET_DHCP,
@@ -117,19 +137,31 @@ static const Console_Arg* Console_GetArg(const char *arg, const Console_Arg *arg
 static const char* Console_GetArgValue(const char *arg);
 static Console_FlagValue Console_GetFlag(const char *str);
 __STATIC_INLINE void Console_Flush(void);
+static void Console_ContinuousError(Board_Error ok, uint32_t port, uint32_t freq, uint32_t averages);
+static Buffer Console_ConvertLevels(uint32_t format, const Board_LevelPoint *data, uint32_t count);
 // Command line processors
 static void Console_Board(uint32_t argc, char **argv);
 static void Console_BoardCalibrate(uint32_t argc, char **argv);
 static void Console_BoardGet(uint32_t argc, char **argv);
 static void Console_BoardInfo(uint32_t argc, char **argv);
+static void Console_BoardLcr(uint32_t argc, char **argv);
+static void Console_BoardLevels(uint32_t argc, char **argv);
+static void Console_BoardLog(uint32_t argc, char **argv);
+static void Console_BoardMask(uint32_t argc, char **argv);
 static void Console_BoardMeasure(uint32_t argc, char **argv);
+static void Console_BoardMonitor(uint32_t argc, char **argv);
 static void Console_BoardRead(uint32_t argc, char **argv);
+static void Console_BoardRef(uint32_t argc, char **argv);
+static void Console_BoardSched(uint32_t argc, char **argv);
 static void Console_BoardSet(uint32_t argc, char **argv);
 static void Console_BoardStandby(uint32_t argc, char **argv);
 static void Console_BoardStart(uint32_t argc, char **argv);
 static void Console_BoardStatus(uint32_t argc, char **argv);
 static void Console_BoardStop(uint32_t argc, char **argv);
+static void Console_BoardTelemetry(uint32_t argc, char **argv);
 static void Console_BoardTemp(uint32_t argc, char **argv);
+static void Console_BoardTest(uint32_t argc, char **argv);
+static void Console_BoardWait(uint32_t argc, char **argv);
 static void Console_Eth(uint32_t argc, char **argv);
 static void Console_Usb(uint32_t argc, char **argv);
 static void Console_Help(uint32_t argc, char **argv);
@@ -153,6 +185,17 @@ static Buffer board_read_data = {
     .size = 0
 };
 static Console_Interface *interface = NULL;
+static volatile uint8_t processing = 0;         //!< Whether a command line is being processed right now
+static volatile uint8_t sweep_wait = 0;         //!< Whether `board wait` is waiting for a sweep to finish
+static volatile uint32_t lcr_remaining = 0;     //!< The number of results `board lcr` is still waiting for
+static AD5933_Model lcr_model;                  //!< The equivalent circuit model used for the `board lcr` command
+static volatile uint8_t test_wait = 0;          //!< Whether `board test` is waiting for the verdict
+static volatile uint8_t levels_wait = 0;        //!< Whether `board levels` is waiting for the amplitude sweep
+static volatile uint32_t monitor_remaining = 0; //!< The number of changes `board monitor` is still waiting for
+static volatile uint32_t log_remaining = 0;     //!< The number of windows `board log` is still waiting for
+static uint32_t log_window;                     //!< The number of results in a window of `board log`
+static Decimate_Stats log_magnitude;            //!< Statistics of the magnitude in the current `board log` window
+static Decimate_Stats log_angle;                //!< Statistics of the angle in the current `board log` window
 
 // Console definition
 //! This is the main help text
@@ -167,10 +210,18 @@ static Console_HelpEntry txtHelpTopics[] = {
     TOPIC("eth"),
     TOPIC("usb"),
     TOPIC("format"),
+    TOPIC("features"),
     TOPIC("settl"),
     TOPIC("voltage"),
     TOPIC("autorange"),
     TOPIC("calibrate"),
+    TOPIC("lcr"),
+    TOPIC("levels"),
+    TOPIC("log"),
+    TOPIC("mask"),
+    TOPIC("ref"),
+    TOPIC("sched"),
+    TOPIC("telemetry"),
     TOPIC("ranges"),
     TOPIC("echo"),
     TOPIC("setup"),
@@ -194,10 +245,20 @@ static const Console_Arg argsBoardSet[] = {
     { "gain",       CON_ARG_SET_GAIN,       CON_FLAG },
     { "feedback",   CON_ARG_SET_FEEDBACK,   CON_INT },
     { "avg",        CON_ARG_SET_AVG,        CON_INT },
+    { "avg-mode",   CON_ARG_SET_AVG_MODE,   CON_STRING },
+    { "mains",      CON_ARG_SET_MAINS,      CON_INT },
+    { "sweep-avg",  CON_ARG_SET_SWEEP_AVG,  CON_INT },
     { "format",     CON_ARG_SET_FORMAT,     CON_STRING },
     { "autorange",  CON_ARG_SET_AUTORANGE,  CON_FLAG },
     { "echo",       CON_ARG_SET_ECHO,       CON_FLAG }
 };
+//! Names of the estimators for `board set --avg-mode`
+static const char* const estimatorNames[] = {
+    [AD_ESTIMATE_MEAN] = "mean",
+    [AD_ESTIMATE_MEDIAN] = "median",
+    [AD_ESTIMATE_TRIMMED] = "trimmed",
+    [AD_ESTIMATE_CLIPPED] = "clipped"
+};
 
 // Include string definitions in the desired language
 #include "strings_en.h"
@@ -386,6 +447,121 @@ __STATIC_INLINE void Console_Flush(void) {
     }
 }
 
+/**
+ * Prints why a continuous measurement for the 'board lcr' or 'board log' command could not be started. Invalid
+ * arguments are reported as such, any other error means that there is no gain factor for the frequency.
+ * 
+ * @param ok The result of {@link Board_StartContinuous}
+ * @param port The port passed to {@link Board_StartContinuous}
+ * @param freq The frequency passed to {@link Board_StartContinuous}
+ * @param averages The number of averages passed to {@link Board_StartContinuous}
+ */
+static void Console_ContinuousError(Board_Error ok, uint32_t port, uint32_t freq, uint32_t averages) {
+    const char *arg = NULL;
+    
+    if(ok == BOARD_BUSY) {
+        interface->SendLine(txtBoardBusy);
+        return;
+    }
+    
+    if(port > PORT_MAX) {
+        arg = "port";
+    } else if(freq < AD5933_FREQ_MIN || freq > AD5933_FREQ_MAX) {
+        arg = "freq";
+    } else if(averages == 0 || averages > UINT16_MAX) {
+        arg = "avg";
+    }
+    
+    if(arg != NULL) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine(arg);
+    } else {
+        interface->SendLine(txtNoGainForFreq);
+    }
+}
+
+/**
+ * Converts the results of an amplitude sweep for the 'board read --levels' command.
+ * 
+ * In binary format each point is frequency, output voltage, magnitude and angle as big endian 32 bit values, in ASCII
+ * format one line is printed for each point, like the polar data of 'board read'.
+ * 
+ * @param format Format specifier
+ * @param data Results of the amplitude sweep
+ * @param count Number of results
+ * @return A buffer allocated with `malloc`, `data` is `NULL` if there is not enough memory
+ */
+static Buffer Console_ConvertLevels(uint32_t format, const Board_LevelPoint *data, uint32_t count) {
+    uint32_t alloc;
+    uint32_t size = 0;
+    char separator = ' ';
+    Buffer ret = {
+        .data = NULL,
+        .size = 0
+    };
+    
+    if(format & FORMAT_FLAG_BINARY) {
+        alloc = count * 16 + (format & FORMAT_FLAG_HEADER ? 4 : 0);
+        uint32_t *buffer = malloc(alloc);
+        if(buffer == NULL) {
+            return ret;
+        }
+        
+        uint32_t *p = buffer;
+        if(format & FORMAT_FLAG_HEADER) {
+            *p++ = count * 16;
+        }
+        for(uint32_t j = 0; j < count; j++) {
+            *p++ = data[j].Frequency;
+            *p++ = data[j].Voltage;
+            *p++ = *((const uint32_t *)&data[j].Magnitude);
+            *p++ = *((const uint32_t *)&data[j].Angle);
+        }
+#ifndef __ARMEB__
+        for(uint32_t j = 0; j < alloc / 4; j++) {
+            buffer[j] = __REV(buffer[j]);
+        }
+#endif
+        
+        ret.data = buffer;
+        ret.size = alloc;
+        return ret;
+    }
+    
+    switch(format & FORMAT_MASK_SEPARATOR) {
+        case FORMAT_FLAG_TAB:
+            separator = '\t';
+            break;
+        case FORMAT_FLAG_COMMA:
+            separator = ',';
+            break;
+    }
+    
+    // Frequency, voltage, 2 floats or hex values with separators and newline, second line break at the end
+    alloc = count * (8 + 1 + 5 + 1 + 13 + 1 + 13 + 2) + 2 + 1;
+    char *buffer = malloc(alloc);
+    if(buffer == NULL) {
+        return ret;
+    }
+    
+    for(uint32_t j = 0; j < count; j++) {
+        if(format & FORMAT_FLAG_HEX) {
+            size += snprintf(buffer + size, alloc - size, "%.8lx%c%.4x%c%.8lx%c%.8lx\r\n", data[j].Frequency,
+                    separator, data[j].Voltage, separator, *((const uint32_t *)&data[j].Magnitude), separator,
+                    *((const uint32_t *)&data[j].Angle));
+        } else {
+            size += snprintf(buffer + size, alloc - size, "%lu%c%u%c%.6g%c%.6g\r\n", data[j].Frequency, separator,
+                    data[j].Voltage, separator, data[j].Magnitude, separator, data[j].Angle);
+        }
+    }
+    buffer[size++] = '\r';
+    buffer[size++] = '\n';
+    
+    ret.data = buffer;
+    ret.size = size;
+    return ret;
+}
+
 // Command processing functions -----------------------------------------------
 
 /**
@@ -405,8 +581,18 @@ static void Console_Board(uint32_t argc, char **argv) {
         { "status",     Console_BoardStatus },
         { "temp",       Console_BoardTemp },
         { "measure",    Console_BoardMeasure },
+        { "lcr",        Console_BoardLcr },
+        { "levels",     Console_BoardLevels },
+        { "log",        Console_BoardLog },
+        { "mask",       Console_BoardMask },
+        { "test",       Console_BoardTest },
         { "standby",    Console_BoardStandby },
-        { "read",       Console_BoardRead }
+        { "monitor",    Console_BoardMonitor },
+        { "read",       Console_BoardRead },
+        { "ref",        Console_BoardRef },
+        { "sched",      Console_BoardSched },
+        { "telemetry",  Console_BoardTelemetry },
+        { "wait",       Console_BoardWait }
     };
     
     if(argc == 1) {
@@ -493,6 +679,20 @@ static void Console_BoardGet(uint32_t argc, char **argv) {
             interface->SendLine(buf);
             break;
             
+        case CON_ARG_SET_AVG_MODE:
+            interface->SendLine(estimatorNames[Board_GetEstimator()]);
+            break;
+            
+        case CON_ARG_SET_MAINS:
+            snprintf(buf, NUMEL(buf), "%u", Board_GetMainsFreq());
+            interface->SendLine(buf);
+            break;
+            
+        case CON_ARG_SET_SWEEP_AVG:
+            snprintf(buf, NUMEL(buf), "%u", Board_GetSweepAverages());
+            interface->SendLine(buf);
+            break;
+            
         case CON_ARG_SET_ECHO:
             // Well, do you see what you're typing or not?
             interface->SendLine(interface->GetEcho() ? txtEnabled : txtDisabled);
@@ -575,6 +775,17 @@ static void Console_BoardGet(uint32_t argc, char **argv) {
                 snprintf(buf, NUMEL(buf), "%u", Board_GetAverages());
                 interface->SendLine(buf);
                 
+                interface->SendString("avg-mode=");
+                interface->SendLine(estimatorNames[Board_GetEstimator()]);
+                
+                interface->SendString("mains=");
+                snprintf(buf, NUMEL(buf), "%u", Board_GetMainsFreq());
+                interface->SendLine(buf);
+                
+                interface->SendString("sweep-avg=");
+                snprintf(buf, NUMEL(buf), "%u", Board_GetSweepAverages());
+                interface->SendLine(buf);
+                
                 interface->SendString("autorange=");
                 interface->SendLine(autorange ? txtEnabled : txtDisabled);
                 
@@ -646,6 +857,9 @@ static void Console_BoardInfo(uint32_t argc, char **argv __attribute__((unused))
         case AD_MEASURE_IMPEDANCE_AUTORANGE:
             temp = txtAdStatusMeasureImpedance;
             break;
+        case AD_MEASURE_CONTINUOUS:
+            temp = txtAdStatusMeasureContinuous;
+            break;
         case AD_CALIBRATE:
             temp = txtAdStatusCalibrate;
             break;
@@ -703,6 +917,22 @@ static void Console_BoardInfo(uint32_t argc, char **argv __attribute__((unused))
     }
     interface->SendLine(NULL);
     
+    // Start-up milestones, in the order of Boot_Milestone
+    static const char *milestones[] = { "main", "init", "settings", "ready", "usb", "command", "sweep" };
+    _Static_assert(NUMEL(milestones) == BOOT_COUNT, "Start-up milestone names missing");
+    interface->SendString(txtStartupTimes);
+    interface->SendString("(boot)");
+    for(uint32_t j = 0; j < BOOT_COUNT; j++) {
+        uint32_t time = Boot_GetTime((Boot_Milestone)j);
+        if(time != 0) {
+            snprintf(buf, NUMEL(buf), " %s=%.1f", milestones[j], time / 1000.0f);
+        } else {
+            snprintf(buf, NUMEL(buf), " %s=-", milestones[j]);
+        }
+        interface->SendString(buf);
+    }
+    interface->SendLine(NULL);
+    
     // USB info
     if(board_config.peripherals.usbh) {
         interface->SendLine(NULL);
@@ -774,22 +1004,38 @@ static void Console_BoardInfo(uint32_t argc, char **argv __attribute__((unused))
 }
 
 /**
- * Processes the 'board measure' command. This command finishes immediately.
+ * Processes the 'board lcr' command. This command finishes when {@link Console_ContinuousCallback} has been called for
+ * the requested number of results.
+ * 
+ * The output is left running at the measurement frequency after the command finishes, so another 'board lcr' with the
+ * same port, frequency and averages gets its results without waiting for the coupling capacitor to charge. Use
+ * 'board stop' to switch it off.
  * 
  * @param argc Number of arguments
  * @param argv Array of arguments
  */
-static void Console_BoardMeasure(uint32_t argc, char **argv) {
-    // Arguments: port, freq
-    AD5933_ImpedancePolar result;
+static void Console_BoardLcr(uint32_t argc, char **argv) {
+    // Arguments: port, freq, [options]
+    static const Console_Arg args[] = {
+        { "model",  CON_ARG_LCR_MODEL,  CON_STRING },
+        { "avg",    CON_ARG_LCR_AVG,    CON_INT },
+        { "count",  CON_ARG_LCR_COUNT,  CON_INT }
+    };
+    static const char* const models[] = {
+        [AD_MODEL_CS_RS] = "cs",
+        [AD_MODEL_CP_RP] = "cp",
+        [AD_MODEL_LS_RS] = "ls"
+    };
+    
     Board_Error ok;
     uint32_t port;
     uint32_t freq;
+    uint32_t averages = Board_GetAverages();
+    uint32_t count = 1;
+    AD5933_Model model = AD_MODEL_CS_RS;
     const char *end;
-    char *buf;
-    const uint32_t buflen = 64;
     
-    if(argc != 3) {
+    if(argc < 3) {
         interface->SendLine(txtErrArgNum);
         interface->CommandFinish();
         return;
@@ -811,100 +1057,55 @@ static void Console_BoardMeasure(uint32_t argc, char **argv) {
         return;
     }
     
-    ok = Board_MeasureSingleFrequency((uint8_t)port, freq, &result);
-    
-    switch(ok) {
-        case BOARD_OK:
-            interface->SendString(txtImpedance);
-            buf = malloc(buflen);
-            if(buf != NULL) {
-                snprintf(buf, buflen, "%g < %g", result.Magnitude, result.Angle);
-                interface->SendLine(buf);
-                free(buf);
-            } else {
-                interface->SendLine("PANIC!");
-            }
-            break;
-            
-        case BOARD_BUSY:
-            interface->SendLine(txtBoardBusy);
-            break;
-            
-        case BOARD_ERROR:
-            interface->SendLine(txtNoGain);
-            break;
-    }
-    
-    interface->CommandFinish();
-}
-
-/**
- * Processes the 'board read' command. This command finishes immediately.
- * 
- * @param argc Number of arguments
- * @param argv Array of arguments
- */
-static void Console_BoardRead(uint32_t argc, char **argv) {
-    static const Console_Arg args[] = {
-        { "format", CON_ARG_READ_FORMAT,    CON_STRING },
-        { "raw",    CON_ARG_READ_RAW,       CON_FLAG },
-        { "gain",   CON_ARG_READ_GAIN,      CON_FLAG }
-    };
-    
-    uint32_t format = format_spec;
-    const AD5933_ImpedancePolar *data;
-    const AD5933_GainFactor *gain;
-    const AD5933_ImpedanceData *raw;
-    uint32_t count;
-    Console_ArgID mode = CON_ARG_INVALID;
-    const char *err = NULL;
-    
-    // In case data from the previous command has not been deallocated, do so now
-    FreeBuffer(&board_read_data);
-    
-    // Check status, we also allow for incomplete data to be retrieved (status == AD_IDLE)
-    if(AD5933_IsBusy()) {
-        interface->SendLine(txtNoReadWhileBusy);
-        interface->CommandFinish();
-        return;
-    }
-    
-    // Process additional arguments, if any
-    for(uint32_t j = 1; j < argc; j++) {
+    for(uint32_t j = 3; j < argc; j++) {
         const Console_Arg *arg = Console_GetArg(argv[j], args, NUMEL(args));
         const char *value = Console_GetArgValue(argv[j]);
-        
         uint32_t intval = 0;
         
         if(arg == NULL) {
-            // Complain about unknown arguments and bail out
             interface->SendString(txtUnknownOption);
             interface->SendLine(argv[j]);
             interface->CommandFinish();
             return;
         }
         
+        if(arg->type == CON_INT) {
+            intval = IntFromSiString(value, &end);
+            if(end == NULL || intval == 0) {
+                interface->SendString(txtInvalidValue);
+                interface->SendLine(arg->arg);
+                interface->CommandFinish();
+                return;
+            }
+        }
+        
         switch(arg->id) {
-            case CON_ARG_READ_FORMAT:
-                intval = Convert_FormatSpecFromString(value);
-                if(intval != 0) {
-                    format = intval;
-                } else {
+            case CON_ARG_LCR_MODEL:
+                intval = 0;
+                while(intval < NUMEL(models) && (value == NULL || strcmp(value, models[intval]) != 0)) {
+                    intval++;
+                }
+                if(intval == NUMEL(models)) {
                     interface->SendString(txtInvalidValue);
                     interface->SendLine(arg->arg);
                     interface->CommandFinish();
                     return;
                 }
+                model = (AD5933_Model)intval;
                 break;
                 
-            case CON_ARG_READ_GAIN:
-            case CON_ARG_READ_RAW:
-                if(mode != CON_ARG_INVALID) {
-                    interface->SendLine(txtOnlyOneArg);
+            case CON_ARG_LCR_AVG:
+                if(intval > UINT16_MAX) {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
                     interface->CommandFinish();
                     return;
                 }
-                mode = arg->id;
+                averages = intval;
+                break;
+                
+            case CON_ARG_LCR_COUNT:
+                count = intval;
                 break;
                 
             default:
@@ -916,244 +1117,1434 @@ static void Console_BoardRead(uint32_t argc, char **argv) {
         }
     }
     
-    switch(mode) {
-        default:
-            // Get and assemble data to be sent
-            data = Board_GetDataPolar(&count);
-            if(data == NULL) {
-                err = txtNoData;
-                break;
-            }
-            
-            board_read_data = Convert_ConvertPolar(format, data, count);
-            if(board_read_data.data != NULL) {
-                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
-            } else {
-                err = txtOutOfMemory;
-            }
-            break;
-            
-        case CON_ARG_READ_GAIN:
-            gain = Board_GetGainFactor();
-            if(gain == NULL) {
-                interface->SendLine(txtNotCalibrated);
-                break;
-            }
-            
-            board_read_data = Convert_ConvertGainFactor(gain);
-            if(board_read_data.data != NULL) {
-                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
-            } else {
-                interface->SendLine(txtOutOfMemory);
-            }
-            break;
-            
-        case CON_ARG_READ_RAW:
-            raw = Board_GetDataRaw(&count);
-            if(raw == NULL) {
-                err = txtNoRawData;
-                break;
-            }
-            
-            board_read_data = Convert_ConvertRaw(format, raw, count);
-            if(board_read_data.data != NULL) {
-                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
-            } else {
-                err = txtOutOfMemory;
-            }
-            break;
-    }
+    // Results can arrive as soon as the measurement is started
+    lcr_model = model;
+    lcr_remaining = count;
     
-    if(err != NULL) {
-        if(format & FORMAT_FLAG_ASCII) {
-            interface->SendLine(err);
-        } else {
-            count = 0;
-            interface->SendBuffer((uint8_t *)&count, 4);
-        }
+    ok = Board_StartContinuous((uint8_t)port, freq, (uint16_t)averages);
+    if(ok == BOARD_OK) {
+        return;
     }
     
+    lcr_remaining = 0;
+    Console_ContinuousError(ok, port, freq, averages);
     interface->CommandFinish();
 }
 
 /**
- * Processes the 'board set' command for all the defined options. This command finishes immediately.
+ * Processes the 'board log' command. This command finishes when {@link Console_ContinuousCallback} has been called for
+ * the requested number of windows.
  * 
- * All options are processed in the order they appear on the command line, that means for options that are specified
- * multiple times, the last occurrence counts.
+ * Like 'board lcr' this measures a single frequency continuously, but only the statistics of each window of results
+ * are printed, so the output rate is independent of the measurement rate.
  * 
  * @param argc Number of arguments
  * @param argv Array of arguments
  */
-static void Console_BoardSet(uint32_t argc, char **argv) {
-    if(argc == 1) {
+static void Console_BoardLog(uint32_t argc, char **argv) {
+    // Arguments: port, freq, [options]
+    static const Console_Arg args[] = {
+        { "window", CON_ARG_LOG_WINDOW, CON_INT },
+        { "avg",    CON_ARG_LOG_AVG,    CON_INT },
+        { "count",  CON_ARG_LOG_COUNT,  CON_INT }
+    };
+    
+    Board_Error ok;
+    uint32_t port;
+    uint32_t freq;
+    uint32_t averages = Board_GetAverages();
+    uint32_t count = 1;
+    uint32_t window = 100;
+    const char *end;
+    
+    if(argc < 3) {
         interface->SendLine(txtErrArgNum);
         interface->CommandFinish();
         return;
     }
     
-    for(uint32_t j = 1; j < argc; j++) {
-        const Console_Arg *arg = Console_GetArg(argv[j], argsBoardSet, NUMEL(argsBoardSet));
+    port = IntFromSiString(argv[1], &end);
+    if(end == NULL || port > PORT_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("port");
+        interface->CommandFinish();
+        return;
+    }
+    
+    freq = IntFromSiString(argv[2], &end);
+    if(end == NULL || freq < AD5933_FREQ_MIN || freq > AD5933_FREQ_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("freq");
+        interface->CommandFinish();
+        return;
+    }
+    
+    for(uint32_t j = 3; j < argc; j++) {
+        const Console_Arg *arg = Console_GetArg(argv[j], args, NUMEL(args));
         const char *value = Console_GetArgValue(argv[j]);
-        
-        Console_FlagValue flag = CON_FLAG_INVALID;
-        uint32_t intval = 0;
+        uint32_t intval;
         
         if(arg == NULL) {
-            // Complain about unknown arguments but ignore otherwise
             interface->SendString(txtUnknownOption);
             interface->SendLine(argv[j]);
-            continue;
+            interface->CommandFinish();
+            return;
         }
         
-        const char *end;
-        switch(arg->type) {
-            case CON_FLAG:
-                flag = Console_GetFlag(value);
-                if(flag == CON_FLAG_INVALID) {
-                    interface->SendString(txtInvalidValue);
-                    interface->SendLine(arg->arg);
-                    continue;
-                }
-                break;
-                
-            case CON_INT:
-                intval = IntFromSiString(value, &end);
-                if(end == NULL) {
-                    interface->SendString(txtInvalidValue);
-                    interface->SendLine(arg->arg);
-                    continue;
-                }
-                break;
-                
-            case CON_STRING:
-                // Handled by each argument
-                break;
+        intval = IntFromSiString(value, &end);
+        if(end == NULL || intval == 0 || (arg->id == CON_ARG_LOG_AVG && intval > UINT16_MAX)) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine(arg->arg);
+            interface->CommandFinish();
+            return;
         }
         
-        const uint8_t autorange = Board_GetAutorange();
-        Board_Error ok = BOARD_OK;
         switch(arg->id) {
-            case CON_ARG_SET_AUTORANGE:
-                Board_SetAutorange(flag == CON_FLAG_ON);
-                if(AD5933_IsBusy()) {
-                    interface->SendLine(txtEffectiveNextSweep);
-                }
-                break;
-                
-            case CON_ARG_SET_AVG:
-                if((intval & ~0xFFFF) == 0) {
-                    ok = Board_SetAverages(intval);
-                } else {
-                    ok = BOARD_ERROR;
-                }
-                break;
-                
-            case CON_ARG_SET_ECHO:
-                interface->SetEcho(flag == CON_FLAG_ON);
-                break;
-                
-            case CON_ARG_SET_FEEDBACK:
-                if(autorange) {
-                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
-                    interface->SendLine(arg->arg);
-                } else {
-                    ok = Board_SetFeedback(intval);
-                }
-                break;
-                
-            case CON_ARG_SET_FORMAT:
-                intval = Convert_FormatSpecFromString(value);
-                if(intval != 0) {
-                    format_spec = intval;
-                    MarkSettingsDirty();
-                } else {
-                    ok = BOARD_ERROR;
-                }
-                break;
-                
-            case CON_ARG_SET_GAIN:
-                if(autorange) {
-                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
-                    interface->SendLine(arg->arg);
-                } else {
-                    ok = Board_SetPGA(flag == CON_FLAG_ON);
-                }
-                break;
-                
-            case CON_ARG_SET_SETTL:
-                intval = 1;
-                char *mult = strchr(value, 'x');
-                if(mult != NULL) {
-                    *mult++ = 0;
-                    intval = strtoul(mult, NULL, 10);
-                }
-                ok = Board_SetSettlingCycles(strtoul(value, NULL, 10), (uint8_t)intval);
-                break;
-                
-            case CON_ARG_SET_START:
-                ok = Board_SetStartFreq(intval);
-                break;
-                
-            case CON_ARG_SET_STEPS:
-                ok = Board_SetFreqSteps(intval);
+            case CON_ARG_LOG_WINDOW:
+                window = intval;
                 break;
                 
-            case CON_ARG_SET_STOP:
-                ok = Board_SetStopFreq(intval);
+            case CON_ARG_LOG_AVG:
+                averages = intval;
                 break;
                 
-            case CON_ARG_SET_VOLTAGE:
-                if(autorange) {
-                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
-                    interface->SendLine(arg->arg);
-                } else {
-                    ok = Board_SetVoltageRange(intval);
-                }
+            case CON_ARG_LOG_COUNT:
+                count = intval;
                 break;
                 
             default:
                 // Should not happen, means that a defined argument has no switch case
                 interface->SendLine(txtNotImplemented);
-                break;
+                interface->SendLine(arg->arg);
+                interface->CommandFinish();
+                return;
         }
-        
-        if(ok == BOARD_BUSY) {
-            interface->SendString(txtSetOnlyWhenIdle);
-            interface->SendLine(arg->arg);
-            
-        } else if(ok == BOARD_ERROR) {
+    }
+    
+    // Results can arrive as soon as the measurement is started
+    Decimate_Reset(&log_magnitude);
+    Decimate_Reset(&log_angle);
+    log_window = window;
+    log_remaining = count;
+    
+    ok = Board_StartContinuous((uint8_t)port, freq, (uint16_t)averages);
+    if(ok == BOARD_OK) {
+        return;
+    }
+    
+    log_remaining = 0;
+    Console_ContinuousError(ok, port, freq, averages);
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board mask' command. This command finishes immediately.
+ * 
+ * Without arguments the mask points are printed, 'board mask clear' removes all points, otherwise a point is added
+ * with frequency, magnitude limits and optional angle limits (in degrees). A '-' instead of a limit means that it is
+ * not checked.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardMask(uint32_t argc, char **argv) {
+    // Arguments: [clear | freq min max [anglemin anglemax]]
+    const Mask_Point *points;
+    Mask_Point point;
+    float *limits[] = { &point.MagnitudeMin, &point.MagnitudeMax, &point.AngleMin, &point.AngleMax };
+    const char *end;
+    char buf[80];
+    
+    if(argc == 1) {
+        uint32_t count = Mask_GetPoints(&points);
+        if(count == 0) {
+            interface->SendLine(txtMaskEmpty);
+        }
+        for(uint32_t j = 0; j < count; j++) {
+            snprintf(buf, NUMEL(buf), "%lu %g %g %g %g", points[j].Frequency, points[j].MagnitudeMin,
+                    points[j].MagnitudeMax, points[j].AngleMin * (180 / M_PI), points[j].AngleMax * (180 / M_PI));
+            interface->SendLine(buf);
+        }
+        interface->CommandFinish();
+        return;
+    }
+    
+    if(argc == 2 && strcmp(argv[1], "clear") == 0) {
+        Mask_Clear();
+        interface->SendLine(txtOK);
+        interface->CommandFinish();
+        return;
+    }
+    
+    if(argc != 4 && argc != 6) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    point.Frequency = IntFromSiString(argv[1], &end);
+    if(end == NULL || point.Frequency < AD5933_FREQ_MIN || point.Frequency > AD5933_FREQ_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("freq");
+        interface->CommandFinish();
+        return;
+    }
+    
+    for(uint32_t j = 0; j < NUMEL(limits); j++) {
+        if(j + 2 >= argc || strcmp(argv[j + 2], "-") == 0) {
+            *limits[j] = NAN;
+            continue;
+        }
+        *limits[j] = FloatFromSiString(argv[j + 2], &end);
+        if(end == NULL) {
             interface->SendString(txtInvalidValue);
-            interface->SendLine(arg->arg);
+            interface->SendLine(argv[j + 2]);
+            interface->CommandFinish();
+            return;
         }
     }
+    point.AngleMin *= (float)(M_PI / 180);
+    point.AngleMax *= (float)(M_PI / 180);
     
+    interface->SendLine(Mask_AddPoint(&point) ? txtOK : txtMaskFull);
     interface->CommandFinish();
 }
 
 /**
- * Processes the 'board standby' command. This command finishes immediately.
+ * Processes the 'board levels' command. This command finishes when {@link Console_LevelsCallback} is called.
  * 
  * @param argc Number of arguments
  * @param argv Array of arguments
  */
-static void Console_BoardStandby(uint32_t argc, char **argv __attribute__((unused))) {
-    if(argc == 1) {
-        Board_Standby();
+static void Console_BoardLevels(uint32_t argc, char **argv) {
+    // Arguments: port, freq...
+    uint32_t freqs[BOARD_LEVEL_MAX_FREQS];
+    Board_Error ok;
+    uint32_t port;
+    const char *end;
+    
+    if(argc < 3 || argc - 2 > BOARD_LEVEL_MAX_FREQS) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    port = IntFromSiString(argv[1], &end);
+    if(end == NULL || port > PORT_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("port");
+        interface->CommandFinish();
+        return;
+    }
+    
+    for(uint32_t j = 2; j < argc; j++) {
+        freqs[j - 2] = IntFromSiString(argv[j], &end);
+        if(end == NULL || freqs[j - 2] < AD5933_FREQ_MIN || freqs[j - 2] > AD5933_FREQ_MAX) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("freq");
+            interface->CommandFinish();
+            return;
+        }
+    }
+    
+    levels_wait = 1;
+    ok = Board_StartLevelSweep(port, freqs, argc - 2);
+    if(ok == BOARD_OK) {
+        return;
+    }
+    
+    levels_wait = 0;
+    interface->SendLine(ok == BOARD_BUSY ? txtBoardBusy : txtNoLevelGain);
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board measure' command. This command finishes immediately.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardMeasure(uint32_t argc, char **argv) {
+    // Arguments: port, freq
+    AD5933_ImpedancePolar result;
+    Board_Error ok;
+    uint32_t port;
+    uint32_t freq;
+    const char *end;
+    char *buf;
+    const uint32_t buflen = 64;
+    
+    if(argc != 3) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    port = IntFromSiString(argv[1], &end);
+    if(end == NULL || port > PORT_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("port");
+        interface->CommandFinish();
+        return;
+    }
+    
+    freq = IntFromSiString(argv[2], &end);
+    if(end == NULL || freq < AD5933_FREQ_MIN || freq > AD5933_FREQ_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("freq");
+        interface->CommandFinish();
+        return;
+    }
+    
+    ok = Board_MeasureSingleFrequency((uint8_t)port, freq, &result);
+    
+    switch(ok) {
+        case BOARD_OK:
+            interface->SendString(txtImpedance);
+            buf = malloc(buflen);
+            if(buf != NULL) {
+                snprintf(buf, buflen, "%g < %g", result.Magnitude, result.Angle);
+                interface->SendLine(buf);
+                free(buf);
+            } else {
+                interface->SendLine("PANIC!");
+            }
+            break;
+            
+        case BOARD_BUSY:
+            interface->SendLine(txtBoardBusy);
+            break;
+            
+        case BOARD_ERROR:
+            interface->SendLine(txtNoGain);
+            break;
+    }
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board monitor' command. This command finishes when {@link Console_ChangeCallback} has been called for
+ * the requested number of changes.
+ * 
+ * Sweeps are repeated on the specified port and compared to a reference sweep, only sweeps that differ by more than
+ * the threshold are reported. The data of the last reported sweep can be read afterwards.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardMonitor(uint32_t argc, char **argv) {
+    // Arguments: port, slot, threshold, [options]
+    static const Console_Arg args[] = {
+        { "count",  CON_ARG_MONITOR_COUNT,  CON_INT }
+    };
+    
+    Board_Error ok;
+    uint32_t port;
+    uint32_t slot;
+    float threshold;
+    uint32_t count = 1;
+    const char *end;
+    
+    if(argc < 4) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    port = IntFromSiString(argv[1], &end);
+    if(end == NULL || port > PORT_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("port");
+        interface->CommandFinish();
+        return;
+    }
+    
+    slot = IntFromSiString(argv[2], &end);
+    if(end == NULL || slot >= REFERENCE_SLOTS) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("slot");
+        interface->CommandFinish();
+        return;
+    }
+    
+    threshold = FloatFromSiString(argv[3], &end);
+    if(end == NULL || !(threshold >= 0)) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("threshold");
+        interface->CommandFinish();
+        return;
+    }
+    
+    for(uint32_t j = 4; j < argc; j++) {
+        const Console_Arg *arg = Console_GetArg(argv[j], args, NUMEL(args));
+        const char *value = Console_GetArgValue(argv[j]);
+        
+        if(arg == NULL) {
+            interface->SendString(txtUnknownOption);
+            interface->SendLine(argv[j]);
+            interface->CommandFinish();
+            return;
+        }
+        
+        count = IntFromSiString(value, &end);
+        if(end == NULL || count == 0) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine(arg->arg);
+            interface->CommandFinish();
+            return;
+        }
+    }
+    
+    // Changes can be reported as soon as the first sweep is finished
+    monitor_remaining = count;
+    
+    ok = Board_StartMonitor((uint8_t)port, slot, threshold);
+    if(ok == BOARD_OK) {
+        return;
+    }
+    
+    monitor_remaining = 0;
+    interface->SendLine(ok == BOARD_BUSY ? txtBoardBusy : txtNoMatchingReference);
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board read' command. This command finishes immediately.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardRead(uint32_t argc, char **argv) {
+    static const Console_Arg args[] = {
+        { "format",     CON_ARG_READ_FORMAT,    CON_STRING },
+        { "raw",        CON_ARG_READ_RAW,       CON_FLAG },
+        { "gain",       CON_ARG_READ_GAIN,      CON_FLAG },
+        { "features",   CON_ARG_READ_FEATURES,  CON_FLAG },
+        { "diff",       CON_ARG_READ_DIFF,      CON_INT },
+        { "ratio",      CON_ARG_READ_RATIO,     CON_INT },
+        { "stddev",     CON_ARG_READ_STDDEV,    CON_FLAG },
+        { "sched",      CON_ARG_READ_SCHED,     CON_INT },
+        { "levels",     CON_ARG_READ_LEVELS,    CON_FLAG }
+    };
+    
+    uint32_t format = format_spec;
+    const AD5933_ImpedancePolar *data;
+    AD5933_ImpedancePolar *copy = NULL;
+    const AD5933_GainFactor *gain;
+    AD5933_ImpedanceData *raw = NULL;
+    Spectrum_Features features;
+    AD5933_ImpedancePolar *relative;
+    uint32_t count;
+    uint32_t slot = 0;
+    uint32_t run = 0;
+    const Schedule_Run *stored;
+    const Board_LevelPoint *levels;
+    Console_ArgID mode = CON_ARG_INVALID;
+    const char *err = NULL;
+    
+    // In case data from the previous command has not been deallocated, do so now
+    FreeBuffer(&board_read_data);
+    
+    // Process additional arguments, if any
+    for(uint32_t j = 1; j < argc; j++) {
+        const Console_Arg *arg = Console_GetArg(argv[j], args, NUMEL(args));
+        const char *value = Console_GetArgValue(argv[j]);
+        
+        uint32_t intval = 0;
+        
+        if(arg == NULL) {
+            // Complain about unknown arguments and bail out
+            interface->SendString(txtUnknownOption);
+            interface->SendLine(argv[j]);
+            interface->CommandFinish();
+            return;
+        }
+        
+        switch(arg->id) {
+            case CON_ARG_READ_FORMAT:
+                intval = Convert_FormatSpecFromString(value);
+                if(intval != 0) {
+                    format = intval;
+                } else {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
+                    interface->CommandFinish();
+                    return;
+                }
+                break;
+                
+            case CON_ARG_READ_DIFF:
+            case CON_ARG_READ_RATIO:
+                slot = IntFromSiString(value, &value);
+                if(value == NULL || slot >= REFERENCE_SLOTS) {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
+                    interface->CommandFinish();
+                    return;
+                }
+                // Fall through, only one of these can be specified
+            case CON_ARG_READ_GAIN:
+            case CON_ARG_READ_RAW:
+            case CON_ARG_READ_FEATURES:
+            case CON_ARG_READ_STDDEV:
+            case CON_ARG_READ_LEVELS:
+                if(mode != CON_ARG_INVALID) {
+                    interface->SendLine(txtOnlyOneArg);
+                    interface->CommandFinish();
+                    return;
+                }
+                mode = arg->id;
+                break;
+                
+            case CON_ARG_READ_SCHED:
+                run = IntFromSiString(value, &value);
+                if(value == NULL) {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
+                    interface->CommandFinish();
+                    return;
+                }
+                if(mode != CON_ARG_INVALID) {
+                    interface->SendLine(txtOnlyOneArg);
+                    interface->CommandFinish();
+                    return;
+                }
+                mode = arg->id;
+                break;
+                
+            default:
+                // Should not happen, means that a defined argument has no switch case
+                interface->SendLine(txtNotImplemented);
+                interface->SendLine(arg->arg);
+                interface->CommandFinish();
+                return;
+        }
+    }
+    
+    // Check status, we also allow for incomplete data to be retrieved (status == AD_IDLE) and for the mean of repeated
+    // sweeps while they are being averaged, stored runs of scheduled jobs can be read anytime
+    if(AD5933_IsBusy() && !Board_IsAveraging() && mode != CON_ARG_READ_SCHED) {
+        interface->SendLine(txtNoReadWhileBusy);
+        interface->CommandFinish();
+        return;
+    }
+    
+    // The data is copied, since TIM3 may fold another repetition into it while it is converted
+    switch(mode) {
+        default:
+            // Get and assemble data to be sent
+            data = copy = Board_CopyDataPolar(&count);
+            if(data == NULL) {
+                err = (count ? txtOutOfMemory : txtNoData);
+                break;
+            }
+            
+            board_read_data = Convert_ConvertPolar(format, data, count);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                err = txtOutOfMemory;
+            }
+            break;
+            
+        case CON_ARG_READ_GAIN:
+            gain = Board_GetGainFactor();
+            if(gain == NULL) {
+                interface->SendLine(txtNotCalibrated);
+                break;
+            }
+            
+            board_read_data = Convert_ConvertGainFactor(gain);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                interface->SendLine(txtOutOfMemory);
+            }
+            break;
+            
+        case CON_ARG_READ_FEATURES:
+            data = copy = Board_CopyDataPolar(&count);
+            if(data == NULL) {
+                err = (count ? txtOutOfMemory : txtNoData);
+                break;
+            }
+            
+            Spectrum_ExtractFeatures(data, count, &features);
+            board_read_data = Convert_ConvertFeatures(format, &features);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                err = txtOutOfMemory;
+            }
+            break;
+            
+        case CON_ARG_READ_DIFF:
+        case CON_ARG_READ_RATIO:
+            data = copy = Board_CopyDataPolar(&count);
+            if(data == NULL) {
+                err = (count ? txtOutOfMemory : txtNoData);
+                break;
+            }
+            
+            relative = malloc(count * sizeof(*relative));
+            if(relative == NULL) {
+                err = txtOutOfMemory;
+                break;
+            }
+            if(Reference_Apply(slot, (mode == CON_ARG_READ_DIFF ? REF_DIFFERENCE : REF_RATIO), data, count,
+                    relative)) {
+                board_read_data = Convert_ConvertPolar(format, relative, count);
+                if(board_read_data.data != NULL) {
+                    interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+                } else {
+                    err = txtOutOfMemory;
+                }
+            } else {
+                err = txtNoMatchingReference;
+            }
+            free(relative);
+            break;
+            
+        case CON_ARG_READ_STDDEV:
+            data = copy = Board_CopyDataPolar(&count);
+            if(data == NULL) {
+                err = (count ? txtOutOfMemory : txtNoData);
+                break;
+            }
+            
+            relative = malloc(count * sizeof(*relative));
+            if(relative == NULL) {
+                err = txtOutOfMemory;
+                break;
+            }
+            for(uint32_t j = 0; j < count; j++) {
+                float deviation = SweepAvg_GetDeviation(j);
+                relative[j].Frequency = data[j].Frequency;
+                relative[j].Magnitude = data[j].Magnitude * deviation;
+                relative[j].Angle = deviation;
+            }
+            board_read_data = Convert_ConvertPolar(format, relative, count);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                err = txtOutOfMemory;
+            }
+            free(relative);
+            break;
+            
+        case CON_ARG_READ_SCHED:
+            stored = Schedule_GetRun(run, &data);
+            if(stored == NULL || stored->count == 0) {
+                err = txtNoData;
+                break;
+            }
+            
+            board_read_data = Convert_ConvertPolar(format, data, stored->count);
+            if(board_read_data.data == NULL) {
+                err = txtOutOfMemory;
+            } else if(Schedule_GetRun(run, NULL) == NULL) {
+                // Overwritten by a run that finished meanwhile
+                FreeBuffer(&board_read_data);
+                err = txtNoData;
+            } else {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            }
+            break;
+            
+        case CON_ARG_READ_RAW:
+            raw = Board_CopyDataRaw(&count);
+            if(raw == NULL) {
+                err = (count ? txtOutOfMemory : txtNoRawData);
+                break;
+            }
+            
+            board_read_data = Convert_ConvertRaw(format, raw, count);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                err = txtOutOfMemory;
+            }
+            break;
+            
+        case CON_ARG_READ_LEVELS:
+            levels = Board_GetLevelData(&count);
+            if(count == 0) {
+                err = txtNoData;
+                break;
+            }
+            
+            board_read_data = Console_ConvertLevels(format, levels, count);
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                err = txtOutOfMemory;
+            }
+            break;
+    }
+    
+    if(err != NULL) {
+        if(format & FORMAT_FLAG_ASCII) {
+            interface->SendLine(err);
+        } else {
+            count = 0;
+            interface->SendBuffer((uint8_t *)&count, 4);
+        }
+    }
+    
+    free(copy);
+    free(raw);
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board set' command for all the defined options. This command finishes immediately.
+ * 
+ * All options are processed in the order they appear on the command line, that means for options that are specified
+ * multiple times, the last occurrence counts.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardSet(uint32_t argc, char **argv) {
+    if(argc == 1) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    for(uint32_t j = 1; j < argc; j++) {
+        const Console_Arg *arg = Console_GetArg(argv[j], argsBoardSet, NUMEL(argsBoardSet));
+        const char *value = Console_GetArgValue(argv[j]);
+        
+        Console_FlagValue flag = CON_FLAG_INVALID;
+        uint32_t intval = 0;
+        
+        if(arg == NULL) {
+            // Complain about unknown arguments but ignore otherwise
+            interface->SendString(txtUnknownOption);
+            interface->SendLine(argv[j]);
+            continue;
+        }
+        
+        const char *end;
+        switch(arg->type) {
+            case CON_FLAG:
+                flag = Console_GetFlag(value);
+                if(flag == CON_FLAG_INVALID) {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
+                    continue;
+                }
+                break;
+                
+            case CON_INT:
+                intval = IntFromSiString(value, &end);
+                if(end == NULL) {
+                    interface->SendString(txtInvalidValue);
+                    interface->SendLine(arg->arg);
+                    continue;
+                }
+                break;
+                
+            case CON_STRING:
+                // Handled by each argument
+                break;
+        }
+        
+        const uint8_t autorange = Board_GetAutorange();
+        Board_Error ok = BOARD_OK;
+        switch(arg->id) {
+            case CON_ARG_SET_AUTORANGE:
+                Board_SetAutorange(flag == CON_FLAG_ON);
+                if(AD5933_IsBusy()) {
+                    interface->SendLine(txtEffectiveNextSweep);
+                }
+                break;
+                
+            case CON_ARG_SET_AVG:
+                if((intval & ~0xFFFF) == 0) {
+                    ok = Board_SetAverages(intval);
+                } else {
+                    ok = BOARD_ERROR;
+                }
+                break;
+                
+            case CON_ARG_SET_AVG_MODE:
+                intval = 0;
+                while(intval < NUMEL(estimatorNames) && (value == NULL || strcmp(value, estimatorNames[intval]) != 0)) {
+                    intval++;
+                }
+                ok = Board_SetEstimator((AD5933_Estimator)intval);
+                break;
+                
+            case CON_ARG_SET_MAINS:
+                if((intval & ~0xFF) == 0) {
+                    ok = Board_SetMainsFreq(intval);
+                } else {
+                    ok = BOARD_ERROR;
+                }
+                break;
+                
+            case CON_ARG_SET_SWEEP_AVG:
+                if((intval & ~0xFFFF) == 0) {
+                    ok = Board_SetSweepAverages(intval);
+                } else {
+                    ok = BOARD_ERROR;
+                }
+                break;
+                
+            case CON_ARG_SET_ECHO:
+                interface->SetEcho(flag == CON_FLAG_ON);
+                break;
+                
+            case CON_ARG_SET_FEEDBACK:
+                if(autorange) {
+                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
+                    interface->SendLine(arg->arg);
+                } else {
+                    ok = Board_SetFeedback(intval);
+                }
+                break;
+                
+            case CON_ARG_SET_FORMAT:
+                intval = Convert_FormatSpecFromString(value);
+                if(intval != 0) {
+                    format_spec = intval;
+                    MarkSettingsDirty();
+                } else {
+                    ok = BOARD_ERROR;
+                }
+                break;
+                
+            case CON_ARG_SET_GAIN:
+                if(autorange) {
+                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
+                    interface->SendLine(arg->arg);
+                } else {
+                    ok = Board_SetPGA(flag == CON_FLAG_ON);
+                }
+                break;
+                
+            case CON_ARG_SET_SETTL:
+                intval = 1;
+                char *mult = strchr(value, 'x');
+                if(mult != NULL) {
+                    *mult++ = 0;
+                    intval = strtoul(mult, NULL, 10);
+                }
+                ok = Board_SetSettlingCycles(strtoul(value, NULL, 10), (uint8_t)intval);
+                break;
+                
+            case CON_ARG_SET_START:
+                ok = Board_SetStartFreq(intval);
+                break;
+                
+            case CON_ARG_SET_STEPS:
+                ok = Board_SetFreqSteps(intval);
+                break;
+                
+            case CON_ARG_SET_STOP:
+                ok = Board_SetStopFreq(intval);
+                break;
+                
+            case CON_ARG_SET_VOLTAGE:
+                if(autorange) {
+                    interface->SendString(txtSetOnlyWhenAutorangeDisabled);
+                    interface->SendLine(arg->arg);
+                } else {
+                    ok = Board_SetVoltageRange(intval);
+                }
+                break;
+                
+            default:
+                // Should not happen, means that a defined argument has no switch case
+                interface->SendLine(txtNotImplemented);
+                break;
+        }
+        
+        if(ok == BOARD_BUSY) {
+            interface->SendString(txtSetOnlyWhenIdle);
+            interface->SendLine(arg->arg);
+            
+        } else if(ok == BOARD_ERROR) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine(arg->arg);
+        }
+    }
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board standby' command. This command finishes immediately.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardStandby(uint32_t argc, char **argv __attribute__((unused))) {
+    if(argc == 1) {
+        Board_Standby();
+    } else {
+        interface->SendLine(txtErrNoArgs);
+    }
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board start' command. This command finishes immediately.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardStart(uint32_t argc, char **argv) {
+    // Arguments: port
+    Board_Error ok;
+    uint32_t port;
+    const char *end;
+    
+    if(argc != 2) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    
+    port = IntFromSiString(argv[1], &end);
+    if(end == NULL || port > PORT_MAX) {
+        interface->SendString(txtInvalidValue);
+        interface->SendLine("port");
+        interface->CommandFinish();
+        return;
+    }
+    
+    ok = Board_StartSweep(port);
+    switch(ok) {
+        case BOARD_OK:
+            interface->SendLine(txtOK);
+            break;
+        case BOARD_BUSY:
+            interface->SendLine(txtBoardBusy);
+            break;
+        case BOARD_ERROR:
+            interface->SendLine(txtNoGain);
+            break;
+    }
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board status' command. This command finished immediately.
+ * 
+ * Prints the current AD5933 driver status, whether autoranging is enabled and, if a sweep is running, the number of
+ * data points already recorded. The last two lines always show stack and heap usage.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardStatus(uint32_t argc, char **argv __attribute__((unused))) {
+    Board_Status status;
+    char buf[48];
+    
+    if(argc != 1) {
+        interface->SendLine(txtErrNoArgs);
+        interface->CommandFinish();
+        return;
+    }
+    
+    Board_GetStatus(&status);
+    switch(status.ad_status) {
+        case AD_MEASURE_IMPEDANCE:
+        case AD_MEASURE_IMPEDANCE_AUTORANGE:
+            // Point count
+            interface->SendString(txtAdStatusSweep);
+            snprintf(buf, NUMEL(buf), "%u", status.point);
+            interface->SendString(buf);
+            interface->SendString(txtOf);
+            snprintf(buf, NUMEL(buf), "%u", status.totalPoints);
+            interface->SendLine(buf);
+            if(status.totalSweeps) {
+                interface->SendString(txtAdStatusSweepAvg);
+                snprintf(buf, NUMEL(buf), "%u", status.sweep + 1);
+                interface->SendString(buf);
+                interface->SendString(txtOf);
+                snprintf(buf, NUMEL(buf), "%u", status.totalSweeps);
+                interface->SendLine(buf);
+            }
+            // Autorange status
+            interface->SendString(txtAutorangeStatus);
+            interface->SendString(status.autorange ? txtEnabled : txtDisabled);
+            interface->SendLine(".");
+            break;
+            
+        case AD_IDLE:
+        case AD_FINISH_TEMP:
+        case AD_FINISH_CALIB:
+            interface->SendLine(txtAdStatusIdle);
+            if(status.interrupted) {
+                interface->SendLine(txtLastInterrupted);
+            }
+            if(status.dataReplaced) {
+                interface->SendLine(txtDataReplaced);
+            }
+            interface->SendLine(status.validData ? txtValidData : txtNoData);
+            interface->SendLine(status.validGainFactor ? txtValidGain : txtNoGain);
+            break;
+            
+        case AD_FINISH_IMPEDANCE:
+            interface->SendString(txtAdStatusFinishImpedance);
+            snprintf(buf, NUMEL(buf), "%u", status.point);
+            interface->SendLine(buf);
+            if(status.interrupted) {
+                interface->SendLine(txtLastInterrupted);
+            }
+            if(status.mainsRejection > 0) {
+                snprintf(buf, NUMEL(buf), "%.1f dB", status.mainsRejection);
+                interface->SendString(txtMainsRejection);
+                interface->SendLine(buf);
+            }
+            if(!isnan(status.kk.Residual)) {
+                snprintf(buf, NUMEL(buf), "%.3g (max %.3g at %lu Hz)", status.kk.Residual, status.kk.MaxResidual,
+                        status.kk.MaxFrequency);
+                interface->SendString(txtKKResidual);
+                interface->SendLine(buf);
+            }
+            if(status.dataReplaced) {
+                interface->SendLine(txtDataReplaced);
+            }
+            interface->SendLine(status.validData ? txtValidData : txtNoData);
+            interface->SendLine(status.validGainFactor ? txtValidGain : txtNoGain);
+            break;
+            
+        case AD_MEASURE_TEMP:
+            interface->SendLine(txtAdStatusTemp);
+            break;
+            
+        case AD_MEASURE_CONTINUOUS:
+            interface->SendString(txtAdStatusContinuous);
+            snprintf(buf, NUMEL(buf), "%u", status.point);
+            interface->SendLine(buf);
+            break;
+            
+        case AD_CALIBRATE:
+            interface->SendLine(txtAdStatusCalibrate);
+            break;
+            
+        default:
+            // Should not happen, driver should be initialized by now.
+            interface->SendLine(txtAdStatusUnknown);
+            break;
+    }
+    
+    // I2C errors
+    if(status.i2cErrorsTotal) {
+        interface->SendString(txtI2CErrors);
+        snprintf(buf, NUMEL(buf), "%u", status.i2cErrors);
+        interface->SendString(buf);
+        interface->SendString(txtI2CErrorsTotal);
+        snprintf(buf, NUMEL(buf), "%lu", status.i2cErrorsTotal);
+        interface->SendString(buf);
+        interface->SendLine(")");
+    }
+    
+    // Memory usage
+    interface->SendString(txtStackUsage);
+    snprintf(buf, NUMEL(buf), "%lu", status.memory.stackUsed);
+    interface->SendString(buf);
+    interface->SendString(txtOf);
+    snprintf(buf, NUMEL(buf), "%lu", status.memory.stackSize);
+    interface->SendLine(buf);
+    interface->SendString(txtHeapUsage);
+    snprintf(buf, NUMEL(buf), "%lu", status.memory.heapFree);
+    interface->SendString(buf);
+    interface->SendString(txtHeapLargestBlock);
+    snprintf(buf, NUMEL(buf), "%lu", status.memory.heapLargestFree);
+    interface->SendString(buf);
+    interface->SendString(txtHeapFragmentation);
+    snprintf(buf, NUMEL(buf), "%u.%u%%)", status.memory.heapFragmentation / 10, status.memory.heapFragmentation % 10);
+    interface->SendLine(buf);
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board stop' command. This command finishes immediately.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardStop(uint32_t argc, char **argv __attribute__((unused))) {
+    if(argc == 1) {
+        // A sweep suspended for 'board temp' is stopped as well, instead of being resumed afterwards
+        if(Board_IsSweeping()) {
+            Board_StopSweep();
+            interface->SendLine(txtOK);
+        } else {
+            interface->SendLine(txtAdStatusIdle);
+        }
+    } else {
+        interface->SendLine(txtErrNoArgs);
+    }
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board telemetry' command. This command finishes immediately.
+ * 
+ * Prints all telemetry counters and gauges as one line of JSON, or sends them in binary format (see telemetry.c).
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardTelemetry(uint32_t argc, char **argv) {
+    static const char *irqNames[MON_IRQ_COUNT] = { "systick", "i2c1", "spi3", "tim3", "otg_fs" };
+    Telemetry_Status st;
+    char buf[100];
+    
+    if(argc > 2) {
+        interface->SendLine(txtErrArgNum);
+        
+    } else if(argc == 2 && strcmp(argv[1], "binary") == 0) {
+        // The buffer is sent asynchronously, so keep it around until the next read or dump
+        FreeBuffer(&board_read_data);
+        board_read_data = Telemetry_Dump();
+        if(board_read_data.data != NULL) {
+            interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+        } else {
+            // Not on the stack, since it is sent after this function returns
+            static uint32_t zero = 0;
+            interface->SendBuffer((uint8_t *)&zero, 4);
+        }
+        
+    } else if(argc == 2 && strcmp(argv[1], "json") != 0) {
+        interface->SendLine(txtWrongTelemetryFormat);
+        
+    } else {
+        Telemetry_Get(&st);
+        // Seconds and milliseconds separately, printf can't do 64 bit integers
+        snprintf(buf, NUMEL(buf), "{\"uptime\":%lu.%03lu,\"sweeps\":%lu,\"points\":%lu,",
+                (uint32_t)(st.uptime / 1000), (uint32_t)(st.uptime % 1000), st.sweeps, st.points);
+        interface->SendString(buf);
+        snprintf(buf, NUMEL(buf), "\"i2cErrors\":%lu,\"i2cRetries\":%lu,\"usbStalls\":%lu,\"usbBytes\":%lu,",
+                st.i2cErrors, st.i2cRetries, st.usbStalls, st.usbBytes);
+        interface->SendString(buf);
+        snprintf(buf, NUMEL(buf), "\"droppedLines\":%lu,\"eepromWrites\":%lu,\"heapFailures\":%lu,",
+                st.droppedLines, st.eepromWrites, st.heapFailures);
+        interface->SendString(buf);
+        interface->SendString("\"maxIsrNs\":{");
+        for(uint32_t j = 0; j < MON_IRQ_COUNT; j++) {
+            snprintf(buf, NUMEL(buf), "%s\"%s\":%lu", (j ? "," : ""), irqNames[j], st.maxIsrTime[j]);
+            interface->SendString(buf);
+        }
+        interface->SendLine("}}");
+    }
+    
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board temp' command. This command finishes when {@link Console_TempCallback} is called.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardTemp(uint32_t argc, char **argv __attribute__((unused))) {
+    Board_Error ok;
+    
+    if(argc != 1) {
+        interface->SendLine(txtErrNoArgs);
+        interface->CommandFinish();
+        return;
+    }
+    
+    ok = Board_MeasureTemperature(TEMP_AD5933);
+    if(ok != BOARD_OK) {
+        interface->SendLine(ok == BOARD_BUSY ? txtBoardBusy : txtTempFail);
+        interface->CommandFinish();
+    }
+}
+
+/**
+ * Processes the 'board ref' command. This command finishes immediately.
+ * 
+ * Without arguments the reference slots are listed, 'board ref save <slot>' stores the current measurement data as
+ * reference and 'board ref clear [<slot>]' removes one or all references.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardRef(uint32_t argc, char **argv) {
+    // Arguments: [(save <slot> | clear [<slot>])]
+    const AD5933_ImpedancePolar *data;
+    uint32_t count;
+    uint32_t slot = REFERENCE_SLOTS;
+    const char *end;
+    char buf[60];
+    
+    if(argc == 1) {
+        for(uint32_t j = 0; j < REFERENCE_SLOTS; j++) {
+            data = Reference_Get(j, &count);
+            if(data != NULL) {
+                snprintf(buf, NUMEL(buf), "%lu: %lu points, %lu to %lu Hz", j, count, data[0].Frequency,
+                        data[count - 1].Frequency);
+            } else {
+                snprintf(buf, NUMEL(buf), "%lu: empty", j);
+            }
+            interface->SendLine(buf);
+        }
+        interface->CommandFinish();
+        return;
+    }
+    
+    if(argc > 3 || (strcmp(argv[1], "save") == 0 && argc != 3)) {
+        interface->SendLine(txtErrArgNum);
+        interface->CommandFinish();
+        return;
+    }
+    if(argc == 3) {
+        slot = IntFromSiString(argv[2], &end);
+        if(end == NULL || slot >= REFERENCE_SLOTS) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("slot");
+            interface->CommandFinish();
+            return;
+        }
+    }
+    
+    if(strcmp(argv[1], "save") == 0) {
+        if(AD5933_IsBusy()) {
+            interface->SendLine(txtNoReadWhileBusy);
+        } else {
+            data = Board_GetDataPolar(&count);
+            interface->SendLine(Reference_Save(slot, data, count) ? txtOK : txtNoData);
+        }
+    } else if(strcmp(argv[1], "clear") == 0) {
+        if(slot < REFERENCE_SLOTS) {
+            Reference_Clear(slot);
+        } else {
+            for(uint32_t j = 0; j < REFERENCE_SLOTS; j++) {
+                Reference_Clear(j);
+            }
+        }
+        interface->SendLine(txtOK);
+    } else {
+        interface->SendLine(txtUnknownSubcommand);
+    }
+    interface->CommandFinish();
+}
+
+/**
+ * Processes the 'board sched' command. This command finishes immediately.
+ * 
+ * Without arguments the time and the jobs are listed, 'board sched time <seconds>' sets the time,
+ * 'board sched add <port> <start> <period> <count> [--kk=LIMIT]' adds a job, 'board sched clear [<job>]' removes one
+ * or all jobs and 'board sched runs' lists the stored results.
+ * 
+ * @param argc Number of arguments
+ * @param argv Array of arguments
+ */
+static void Console_BoardSched(uint32_t argc, char **argv) {
+    // Arguments: [(time <seconds> | add <port> <start> <period> <count> [--kk=LIMIT] | clear [<job>] | runs)]
+    const Schedule_Job *job;
+    const Schedule_Run *run;
+    uint32_t first;
+    uint32_t count;
+    uint64_t time;
+    const char *end;
+    char buf[120];
+    
+    if(argc == 1) {
+        time = Schedule_GetTime();
+        snprintf(buf, NUMEL(buf), "Time: %lu.%03lu%s", (uint32_t)(time / 1000), (uint32_t)(time % 1000),
+                (Schedule_IsTimeSet() ? "" : " s since reset (not set)"));
+        interface->SendLine(buf);
+        uint64_t now = Schedule_GetUptime();
+        for(uint32_t j = 0; j < SCHEDULE_MAX_JOBS; j++) {
+            job = Schedule_GetJob(j);
+            if(job != NULL) {
+                uint64_t wait = (job->next > now ? job->next - now : 0);
+                int len = snprintf(buf, NUMEL(buf), "Job %lu: port %u, next in %lu.%03lu s, every %lu s, %lu left, "
+                        "%lu missed", j, job->port, (uint32_t)(wait / 1000), (uint32_t)(wait % 1000),
+                        job->period / 1000, job->remaining, job->missed);
+                if(job->kkLimit > 0) {
+                    snprintf(buf + len, NUMEL(buf) - len, ", KK limit %g", job->kkLimit);
+                }
+            } else {
+                snprintf(buf, NUMEL(buf), "Job %lu: unused", j);
+            }
+            interface->SendLine(buf);
+        }
+        count = Schedule_GetRunCount(&first);
+        if(count) {
+            snprintf(buf, NUMEL(buf), "Stored runs: %lu to %lu", first, first + count - 1);
+        } else {
+            snprintf(buf, NUMEL(buf), "Stored runs: none, next is %lu", first);
+        }
+        interface->SendLine(buf);
+        interface->CommandFinish();
+        return;
+    }
+    
+    if(strcmp(argv[1], "time") == 0) {
+        if(argc != 3) {
+            interface->SendLine(txtErrArgNum);
+            interface->CommandFinish();
+            return;
+        }
+        time = IntFromSiString(argv[2], &end);
+        if(end == NULL || time == 0) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("seconds");
+        } else {
+            Schedule_SetTime(time * 1000);
+            interface->SendLine(txtOK);
+        }
+        
+    } else if(strcmp(argv[1], "add") == 0) {
+        uint32_t port, start, period;
+        float kkLimit = 0;
+        if(argc != 6 && argc != 7) {
+            interface->SendLine(txtErrArgNum);
+            interface->CommandFinish();
+            return;
+        }
+        port = IntFromSiString(argv[2], &end);
+        if(end == NULL || port > PORT_MAX) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("port");
+            interface->CommandFinish();
+            return;
+        }
+        // The start is either absolute or relative to now if it starts with '+'
+        start = IntFromSiString(argv[3] + (argv[3][0] == '+'), &end);
+        if(end == NULL) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("start");
+            interface->CommandFinish();
+            return;
+        }
+        if(argv[3][0] == '+') {
+            time = Schedule_GetUptime() + start * (uint64_t)1000;
+        } else if(!Schedule_IsTimeSet()) {
+            interface->SendLine(txtTimeNotSet);
+            interface->CommandFinish();
+            return;
+        } else {
+            // Jobs are scheduled in time since reset, a start in the past means right away
+            uint64_t now = Schedule_GetTime();
+            uint64_t at = start * (uint64_t)1000;
+            time = Schedule_GetUptime() + (at > now ? at - now : 0);
+        }
+        period = IntFromSiString(argv[4], &end);
+        if(end == NULL || period > UINT32_MAX / 1000) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("period");
+            interface->CommandFinish();
+            return;
+        }
+        count = IntFromSiString(argv[5], &end);
+        if(end == NULL) {
+            interface->SendString(txtInvalidValue);
+            interface->SendLine("count");
+            interface->CommandFinish();
+            return;
+        }
+        if(argc == 7) {
+            // Relative residual above which a sweep is repeated
+            if(strncmp(argv[6], "--kk=", 5) == 0) {
+                kkLimit = FloatFromSiString(argv[6] + 5, &end);
+            } else {
+                end = NULL;
+            }
+            if(end == NULL || !(kkLimit > 0)) {
+                interface->SendString(txtInvalidValue);
+                interface->SendLine("kk");
+                interface->CommandFinish();
+                return;
+            }
+        }
+        
+        int32_t ret = Schedule_AddJob(time, period * 1000, count, (uint8_t)port, kkLimit);
+        if(ret < 0) {
+            interface->SendLine(txtNoJobSlot);
+        } else {
+            snprintf(buf, NUMEL(buf), "Job %ld", ret);
+            interface->SendLine(buf);
+        }
+        
+    } else if(strcmp(argv[1], "clear") == 0) {
+        if(argc > 3) {
+            interface->SendLine(txtErrArgNum);
+            interface->CommandFinish();
+            return;
+        }
+        if(argc == 3) {
+            first = IntFromSiString(argv[2], &end);
+            if(end == NULL || first >= SCHEDULE_MAX_JOBS) {
+                interface->SendString(txtInvalidValue);
+                interface->SendLine("job");
+                interface->CommandFinish();
+                return;
+            }
+            Schedule_RemoveJob(first);
+        } else {
+            for(uint32_t j = 0; j < SCHEDULE_MAX_JOBS; j++) {
+                Schedule_RemoveJob(j);
+            }
+        }
+        interface->SendLine(txtOK);
+        
+    } else if(strcmp(argv[1], "runs") == 0) {
+        // The list can be longer than the output buffer, so send it from a buffer kept like the 'board read' data
+        FreeBuffer(&board_read_data);
+        count = Schedule_GetRunCount(&first);
+        uint32_t alloc = count * (NUMEL(buf) + 1) + 1;
+        uint32_t size = 0;
+        char *list = malloc(alloc);
+        if(list == NULL) {
+            interface->SendLine(txtOutOfMemory);
+            interface->CommandFinish();
+            return;
+        }
+        
+        for(uint32_t j = first; j - first < count; j++) {
+            run = Schedule_GetRun(j, NULL);
+            if(run == NULL) {
+                // Overwritten while listing
+                continue;
+            }
+            int len = snprintf(buf, NUMEL(buf), "%lu: job %u, time %lu.%03lu, %u points%s", run->number, run->job,
+                    (uint32_t)(run->time / 1000), (uint32_t)(run->time % 1000), run->count,
+                    (run->interrupted ? ", interrupted" : ""));
+            if(!isnan(run->kkResidual)) {
+                len += snprintf(buf + len, NUMEL(buf) - len, ", KK %.3g", run->kkResidual);
+            }
+            if(run->repeats) {
+                snprintf(buf + len, NUMEL(buf) - len, ", repeated %u times", run->repeats);
+            }
+            size += snprintf(list + size, alloc - size, "%s\r\n", buf);
+        }
+        
+        board_read_data.data = list;
+        board_read_data.size = size;
+        if(size > 0) {
+            interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+        }
+        
     } else {
-        interface->SendLine(txtErrNoArgs);
+        interface->SendLine(txtUnknownSubcommand);
     }
-    
     interface->CommandFinish();
 }
 
 /**
- * Processes the 'board start' command. This command finishes immediately.
+ * Processes the 'board test' command. This command finishes when {@link Console_TestCallback} is called.
  * 
  * @param argc Number of arguments
  * @param argv Array of arguments
  */
-static void Console_BoardStart(uint32_t argc, char **argv) {
+static void Console_BoardTest(uint32_t argc, char **argv) {
     // Arguments: port
     Board_Error ok;
     uint32_t port;
@@ -1173,32 +2564,27 @@ static void Console_BoardStart(uint32_t argc, char **argv) {
         return;
     }
     
-    ok = Board_StartSweep(port);
-    switch(ok) {
-        case BOARD_OK:
-            interface->SendLine(txtOK);
-            break;
-        case BOARD_BUSY:
-            interface->SendLine(txtBoardBusy);
-            break;
-        case BOARD_ERROR:
-            interface->SendLine(txtNoGain);
-            break;
+    test_wait = 1;
+    ok = Board_StartTest(port);
+    if(ok == BOARD_OK) {
+        return;
     }
     
+    test_wait = 0;
+    interface->SendLine(ok == BOARD_BUSY ? txtBoardBusy : txtNoMaskOrGain);
     interface->CommandFinish();
 }
 
 /**
- * Processes the 'board status' command. This command finished immediately.
+ * Processes the 'board wait' command. If a sweep is running, this command finishes when {@link Console_SweepCallback}
+ * is called, otherwise it finishes immediately.
  * 
- * Prints the current AD5933 driver status, whether autoranging is enabled and, if a sweep is running, the number of
- * data points already recorded.
+ * This allows scripts to wait for the end of a sweep without polling with 'board status'.
  * 
  * @param argc Number of arguments
  * @param argv Array of arguments
  */
-static void Console_BoardStatus(uint32_t argc, char **argv __attribute__((unused))) {
+static void Console_BoardWait(uint32_t argc, char **argv __attribute__((unused))) {
     Board_Status status;
     char buf[16];
     
@@ -1208,97 +2594,27 @@ static void Console_BoardStatus(uint32_t argc, char **argv __attribute__((unused
         return;
     }
     
-    Board_GetStatus(&status);
-    switch(status.ad_status) {
-        case AD_MEASURE_IMPEDANCE:
-        case AD_MEASURE_IMPEDANCE_AUTORANGE:
-            // Point count
-            interface->SendString(txtAdStatusSweep);
-            snprintf(buf, NUMEL(buf), "%u", status.point);
-            interface->SendString(buf);
-            interface->SendString(txtOf);
-            snprintf(buf, NUMEL(buf), "%u", status.totalPoints);
-            interface->SendLine(buf);
-            // Autorange status
-            interface->SendString(txtAutorangeStatus);
-            interface->SendString(status.autorange ? txtEnabled : txtDisabled);
-            interface->SendLine(".");
-            break;
-            
-        case AD_IDLE:
-        case AD_FINISH_TEMP:
-        case AD_FINISH_CALIB:
-            interface->SendLine(txtAdStatusIdle);
-            if(status.interrupted) {
-                interface->SendLine(txtLastInterrupted);
-            }
-            interface->SendLine(status.validData ? txtValidData : txtNoData);
-            interface->SendLine(status.validGainFactor ? txtValidGain : txtNoGain);
-            break;
-            
-        case AD_FINISH_IMPEDANCE:
-            interface->SendString(txtAdStatusFinishImpedance);
-            snprintf(buf, NUMEL(buf), "%u", status.point);
-            interface->SendLine(buf);
-            interface->SendLine(status.validData ? txtValidData : txtNoData);
-            interface->SendLine(status.validGainFactor ? txtValidGain : txtNoGain);
-            break;
-            
-        case AD_MEASURE_TEMP:
-            interface->SendLine(txtAdStatusTemp);
-            break;
-            
-        case AD_CALIBRATE:
-            interface->SendLine(txtAdStatusCalibrate);
-            break;
-            
-        default:
-            // Should not happen, driver should be initialized by now.
-            interface->SendLine(txtAdStatusUnknown);
-            break;
+    // The sweep could finish in the timer interrupt between checking the status and setting the flag
+    __disable_irq();
+    AD5933_Status ad_status = AD5933_GetStatus();
+    if(ad_status == AD_MEASURE_IMPEDANCE || ad_status == AD_MEASURE_IMPEDANCE_AUTORANGE) {
+        sweep_wait = 1;
     }
+    __enable_irq();
     
-    interface->CommandFinish();
-}
-
-/**
- * Processes the 'board stop' command. This command finishes immediately.
- * 
- * @param argc Number of arguments
- * @param argv Array of arguments
- */
-static void Console_BoardStop(uint32_t argc, char **argv __attribute__((unused))) {
-    if(argc == 1) {
-        AD5933_Status status = AD5933_GetStatus();
-        if(status == AD_MEASURE_IMPEDANCE || status == AD_MEASURE_IMPEDANCE_AUTORANGE) {
-            Board_StopSweep();
-            interface->SendLine(txtOK);
-        } else {
-            interface->SendLine(txtAdStatusIdle);
-        }
-    } else {
-        interface->SendLine(txtErrNoArgs);
-    }
-    interface->CommandFinish();
-}
-
-/**
- * Processes the 'board temp' command. This command finishes when {@link Console_TempCallback} is called.
- * 
- * @param argc Number of arguments
- * @param argv Array of arguments
- */
-static void Console_BoardTemp(uint32_t argc, char **argv __attribute__((unused))) {
-    if(argc != 1) {
-        interface->SendLine(txtErrNoArgs);
-        interface->CommandFinish();
+    if(sweep_wait) {
         return;
     }
     
-    if(Board_MeasureTemperature(TEMP_AD5933) != BOARD_OK) {
-        interface->SendLine(txtTempFail);
-        interface->CommandFinish();
+    Board_GetStatus(&status);
+    if(status.ad_status == AD_FINISH_IMPEDANCE) {
+        interface->SendString(txtAdStatusFinishImpedance);
+        snprintf(buf, NUMEL(buf), "%u", status.point);
+        interface->SendLine(buf);
+    } else {
+        interface->SendLine(txtAdStatusIdle);
     }
+    interface->CommandFinish();
 }
 
 /**
@@ -1471,6 +2787,9 @@ static void Console_UsbWrite(uint32_t argc, char **argv) {
 static void Console_Help(uint32_t argc, char **argv) {
     Console_HelpEntry *topic = NULL;
     
+    // The help text is only parsed when it is first needed, which saves start-up time
+    Console_InitHelp();
+    
     switch(argc) {
         case 1:
             // Command without arguments, print usage
@@ -1740,7 +3059,7 @@ static void Console_Setup(uint32_t argc, char **argv) {
 static void Console_Debug(uint32_t argc __attribute__((unused)), char **argv __attribute__((unused))) {
 #ifdef DEBUG
     if(argc == 1) {
-        interface->SendLine("echo, malloc, leak, usb-paksize, heap, mux, output, dump");
+        interface->SendLine("echo, malloc, leak, usb-paksize, heap, mux, output, dump, i2ctrace, evtrace");
         interface->CommandFinish();
         return;
     }
@@ -1834,6 +3153,26 @@ static void Console_Debug(uint32_t argc __attribute__((unused)), char **argv __a
                 &_estack, &_Main_Stack_Limit, (uint32_t)(&_estack - &_Main_Stack_Limit));
         interface->SendString(buf);
         
+        Monitor_MemoryStatus mem;
+        Monitor_GetMemoryStatus(&mem);
+        snprintf(buf, NUMEL(buf), "Stack high-water mark: %lu\r\n", mem.stackUsed);
+        interface->SendString(buf);
+        snprintf(buf, NUMEL(buf), "Heap used: %lu, free: %lu, largest free block: %lu\r\n",
+                mem.heapUsed, mem.heapFree, mem.heapLargestFree);
+        interface->SendString(buf);
+        snprintf(buf, NUMEL(buf), "Fragmentation: %u.%u%%\r\n", mem.heapFragmentation / 10, mem.heapFragmentation % 10);
+        interface->SendString(buf);
+        snprintf(buf, NUMEL(buf), "Allocations: %lu, frees: %lu, failed: %lu\r\n",
+                mem.allocs, mem.frees, mem.allocFailures);
+        interface->SendString(buf);
+        
+        // Stack depth on interrupt entry, including whatever was interrupted
+        static const char *irqNames[MON_IRQ_COUNT] = { "SysTick", "I2C1", "SPI3", "TIM3", "OTG_FS" };
+        for(uint32_t j = 0; j < MON_IRQ_COUNT; j++) {
+            snprintf(buf, NUMEL(buf), "Stack depth on %s entry: %lu\r\n", irqNames[j], Monitor_GetIrqStackDepth(j));
+            interface->SendString(buf);
+        }
+        
     } else if(strcmp(argv[1], "mux") == 0) {
         // Set output mux port, or disable
         if(argc != 3) {
@@ -1911,6 +3250,71 @@ static void Console_Debug(uint32_t argc __attribute__((unused)), char **argv __a
             }
             free(buffer);
         }
+    } else if(strcmp(argv[1], "i2ctrace") == 0) {
+        // Control the I2C transaction trace, or dump it in binary format (see i2ctrace.c for the format)
+        if(argc != 3) {
+            interface->SendLine(I2CTrace_IsEnabled() ? txtEnabled : txtDisabled);
+            
+        } else if(strcmp(argv[2], "dump") == 0) {
+            // The buffer is sent asynchronously, so keep it around until the next read or dump
+            FreeBuffer(&board_read_data);
+            board_read_data = I2CTrace_Dump();
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                // Not on the stack, since it is sent after this function returns
+                static uint32_t zero = 0;
+                interface->SendBuffer((uint8_t *)&zero, 4);
+            }
+            
+        } else if(strcmp(argv[2], "clear") == 0) {
+            I2CTrace_Clear();
+            interface->SendLine(txtOK);
+            
+        } else {
+            Console_FlagValue flag = Console_GetFlag(argv[2]);
+            if(flag == CON_FLAG_INVALID) {
+                interface->SendLine(txtWrongFlag);
+            } else {
+                I2CTrace_Enable(flag == CON_FLAG_ON);
+                interface->SendLine(txtOK);
+            }
+        }
+        
+    } else if(strcmp(argv[1], "evtrace") == 0) {
+        // Control the event trace, or dump the ring buffer in binary format (see evtrace.c for the format)
+        if(argc != 3) {
+            interface->SendLine(EvTrace_IsEnabled() ? txtEnabled : txtDisabled);
+            if(EvTrace_IsUsingItm()) {
+                interface->SendLine("Writing to ITM.");
+            }
+            
+        } else if(strcmp(argv[2], "dump") == 0) {
+            // The buffer is sent asynchronously, so keep it around until the next read or dump
+            FreeBuffer(&board_read_data);
+            board_read_data = EvTrace_Dump();
+            if(board_read_data.data != NULL) {
+                interface->SendBuffer((uint8_t *)board_read_data.data, board_read_data.size);
+            } else {
+                // Not on the stack, since it is sent after this function returns
+                static uint32_t zero = 0;
+                interface->SendBuffer((uint8_t *)&zero, 4);
+            }
+            
+        } else if(strcmp(argv[2], "clear") == 0) {
+            EvTrace_Clear();
+            interface->SendLine(txtOK);
+            
+        } else {
+            Console_FlagValue flag = Console_GetFlag(argv[2]);
+            if(flag == CON_FLAG_INVALID) {
+                interface->SendLine(txtWrongFlag);
+            } else {
+                EvTrace_Enable(flag == CON_FLAG_ON);
+                interface->SendLine(txtOK);
+            }
+        }
+        
     } else {
         interface->SendLine(txtUnknownSubcommand);
     }
@@ -1927,8 +3331,6 @@ static void Console_Debug(uint32_t argc __attribute__((unused)), char **argv __a
  * This function sets up the console and should be called before any other console functions.
  */
 void Console_Init(void) {
-    Console_InitHelp();
-    
     format_spec = FORMAT_DEFAULT;
 }
 
@@ -1946,15 +3348,32 @@ void Console_ProcessLine(Console_Interface *itf, char *str) {
     
     interface = itf;
     argc = Console_GetArguments(str);
+    processing = 1;
     
     if(argc == 0) {
         // Command line is empty, do nothing
         interface->CommandFinish();
         
+    } else if(!Boot_IsReady()) {
+        // The drivers are still being initialized, which must not be interfered with
+        interface->SendLine(txtStartingUp);
+        interface->CommandFinish();
+        
     } else if(!Console_CallProcessor(argc, arguments, commands, NUMEL(commands))) {
         interface->SendLine(txtUnknownCommand);
         interface->CommandFinish();
     }
+    processing = 0;
+}
+
+/**
+ * Checks whether a command line is being processed right now. Higher priority interrupts use this to keep from
+ * starting measurements in the middle of a command, the command may still be waiting for a callback afterwards.
+ * 
+ * @return `1` while {@link Console_ProcessLine} is running, `0` otherwise
+ */
+uint8_t Console_IsProcessing(void) {
+    return processing;
 }
 
 /**
@@ -1996,4 +3415,170 @@ void Console_TempCallback(float temp) {
     interface->CommandFinish();
 }
 
+/**
+ * Called for each result of a continuous measurement, prints it for a pending 'board lcr' command or adds it to the
+ * window of a pending 'board log' command, and finishes the command after the last result or window.
+ * 
+ * @param value The measured impedance
+ */
+void Console_ContinuousCallback(const AD5933_ImpedancePolar *value) {
+    static const char* const names[][2] = {
+        [AD_MODEL_CS_RS] = { "Cs", "Rs" },
+        [AD_MODEL_CP_RP] = { "Cp", "Rp" },
+        [AD_MODEL_LS_RS] = { "Ls", "Rs" }
+    };
+    AD5933_Equivalent eq;
+    char buf[128];
+    
+    if(log_remaining) {
+        Decimate_Add(&log_magnitude, value->Magnitude);
+        Decimate_Add(&log_angle, value->Angle);
+        if(log_magnitude.Count < log_window) {
+            return;
+        }
+        
+        snprintf(buf, NUMEL(buf), "%lu %.6g %.6g %.6g %.4g %.6g %.6g %.6g %.4g", log_magnitude.Count,
+                log_magnitude.Mean, log_magnitude.Min, log_magnitude.Max, Decimate_GetDeviation(&log_magnitude),
+                log_angle.Mean, log_angle.Min, log_angle.Max, Decimate_GetDeviation(&log_angle));
+        interface->SendLine(buf);
+        Console_Flush();
+        Decimate_Reset(&log_magnitude);
+        Decimate_Reset(&log_angle);
+        
+        if(--log_remaining == 0) {
+            interface->CommandFinish();
+        }
+        return;
+    }
+    
+    if(!lcr_remaining) {
+        return;
+    }
+    
+    AD5933_ConvertPolarToEquivalent(value, lcr_model, &eq);
+    snprintf(buf, NUMEL(buf), "%s=%.5g %s=%.5g D=%.5g Q=%.5g", names[lcr_model][0], eq.Reactive,
+            names[lcr_model][1], eq.Resistance, eq.D, eq.Q);
+    interface->SendLine(buf);
+    Console_Flush();
+    
+    if(--lcr_remaining == 0) {
+        interface->CommandFinish();
+    }
+}
+
+/**
+ * Called when a monitoring sweep differs significantly from the reference, prints the change and finishes the
+ * 'board monitor' command when enough changes have been reported.
+ * 
+ * @param sweep The number of the sweep since monitoring was started, starting at 1
+ * @param freq The frequency of the largest change
+ * @param change The largest relative change |Z - Zref| / |Zref|
+ */
+void Console_ChangeCallback(uint32_t sweep, uint32_t freq, float change) {
+    char buf[48];
+    
+    if(!monitor_remaining) {
+        return;
+    }
+    
+    // The event is not localized for easier parsing
+    snprintf(buf, NUMEL(buf), "CHANGE %lu %lu %.4g", sweep, freq, change);
+    interface->SendLine(buf);
+    
+    if(--monitor_remaining == 0) {
+        // Keep the data of this sweep for reading
+        Board_StopSweep();
+        Console_Flush();
+        interface->CommandFinish();
+    } else {
+        Console_Flush();
+    }
+}
+
+/**
+ * Called when a limit mask test is finished, prints the verdict and finishes the 'board test' command.
+ * 
+ * @param verdict The verdict, either {@link MASK_PASS} or the reason the first failing point failed
+ * @param freq The frequency of the first failing point
+ */
+void Console_TestCallback(Mask_Verdict verdict, uint32_t freq) {
+    char buf[32];
+    
+    if(!test_wait) {
+        return;
+    }
+    test_wait = 0;
+    
+    // The verdict is not localized for easier parsing
+    if(verdict == MASK_PASS) {
+        interface->SendLine("PASS");
+    } else {
+        snprintf(buf, NUMEL(buf), "FAIL %lu %s", freq, (verdict == MASK_FAIL_MAGNITUDE ? "magnitude" : "angle"));
+        interface->SendLine(buf);
+    }
+    Console_Flush();
+    interface->CommandFinish();
+}
+
+/**
+ * Called when an amplitude sweep is finished or stopped, prints the number of results and finishes the 'board levels'
+ * command. The results are read with 'board read --levels'.
+ * 
+ * @param points The number of results
+ */
+void Console_LevelsCallback(uint32_t points) {
+    char buf[64];
+    
+    if(!levels_wait) {
+        return;
+    }
+    levels_wait = 0;
+    
+    // The results don't fit into the output buffer, so only the number is printed and 'board read --levels' sends them
+    snprintf(buf, NUMEL(buf), "%lu results, read with 'board read --levels'", points);
+    interface->SendLine(buf);
+    Console_Flush();
+    interface->CommandFinish();
+}
+
+/**
+ * Called when all measurements have been stopped for standby, finishes a command that is still waiting for one of
+ * them, since its callback will not be called anymore.
+ */
+void Console_StopCallback(void) {
+    if(!sweep_wait && !lcr_remaining && !test_wait && !levels_wait && !monitor_remaining && !log_remaining) {
+        return;
+    }
+    sweep_wait = 0;
+    lcr_remaining = 0;
+    test_wait = 0;
+    levels_wait = 0;
+    monitor_remaining = 0;
+    log_remaining = 0;
+    
+    interface->SendLine(txtStandbyStopped);
+    Console_Flush();
+    interface->CommandFinish();
+}
+
+/**
+ * Called when a frequency sweep is finished, finishes a pending 'board wait' command.
+ * 
+ * @param points The number of points measured
+ */
+void Console_SweepCallback(uint32_t points) {
+    char buf[16];
+    
+    if(!sweep_wait) {
+        return;
+    }
+    sweep_wait = 0;
+    
+    interface->SendString(txtAdStatusFinishImpedance);
+    snprintf(buf, NUMEL(buf), "%lu", points);
+    interface->SendLine(buf);
+    Console_Flush();
+    interface->CommandFinish();
+}
+
 // ----------------------------------------------------------------------------
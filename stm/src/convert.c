@@ -649,6 +649,86 @@ Buffer Convert_ConvertGainFactor(const AD5933_GainFactor *gain) {
     return ret;
 }
 
+/**
+ * Converts sweep features according to the format specified.
+ * 
+ * In binary format the features are sent as 32-bit big endian words in the order of the {@link Spectrum_Features}
+ * structure, in ASCII format as text suitable for parsing. Only the encoding and header flags are used.
+ * 
+ * The buffer for the resulting data is obtained by `malloc` and can thus be `free`d when no longer needed.
+ * If the required amount of memory cannot be allocated, a buffer containing a `NULL` pointer is returned.
+ * 
+ * @param format Format specification for the conversion
+ * @param features Pointer to the features to convert
+ * @return A buffer structure with the converted features
+ */
+Buffer Convert_ConvertFeatures(uint32_t format, const Spectrum_Features *features) {
+    static const char* const text = "min={%g,%g}\r\nmax={%g,%g}\r\nresonance={%g,%g}\r\narc={%g,%g}\r\n"
+            "crossings=%lu\r\ncrossingFreq={%g";
+    static const char* const end = "}\r\n\r\n";
+    static const char* const next = ",%g";
+    
+    uint32_t alloc = 0;
+    void *buffer;
+    uint32_t size = 0;
+    Buffer ret = {
+        .data = NULL,
+        .size = 0
+    };
+    
+    assert_param(features != NULL);
+    
+    if(format & FORMAT_FLAG_BINARY) {
+        const uint32_t *words = (const uint32_t *)features;
+        alloc = sizeof(Spectrum_Features) + (format & FORMAT_FLAG_HEADER ? 4 : 0);
+        
+        buffer = malloc(alloc);
+        if(buffer == NULL) {
+            return ret;
+        }
+        
+        if(format & FORMAT_FLAG_HEADER) {
+#ifdef __ARMEB__
+            *((uint32_t *)buffer) = sizeof(Spectrum_Features);
+#else
+            *((uint32_t *)buffer) = __REV(sizeof(Spectrum_Features));
+#endif
+            size += 4;
+        }
+        for(uint32_t j = 0; j < sizeof(Spectrum_Features) / 4; j++) {
+#ifdef __ARMEB__
+            *((uint32_t *)(buffer + size)) = words[j];
+#else
+            *((uint32_t *)(buffer + size)) = __REV(words[j]);
+#endif
+            size += 4;
+        }
+        
+    } else {
+        // Text + 8 floats + count + crossing frequencies with separators + terminating 0
+        alloc = strlen(text) + strlen(end) + 8 * 13 + 10 + SPECTRUM_MAX_CROSSINGS * 14 + 1;
+        
+        buffer = malloc(alloc);
+        if(buffer == NULL) {
+            return ret;
+        }
+        
+        size += snprintf(buffer + size, alloc - size, text, features->MinFrequency, features->MinMagnitude,
+                features->MaxFrequency, features->MaxMagnitude, features->ResonanceFrequency, features->ResonanceQ,
+                features->ArcFrequency, features->ArcReactance, features->Crossings, features->CrossingFrequency[0]);
+        for(uint32_t j = 1; j < SPECTRUM_MAX_CROSSINGS; j++) {
+            size += snprintf(buffer + size, alloc - size, next, features->CrossingFrequency[j]);
+        }
+        
+        // Copy termination
+        size = memccpy(buffer + size, end, 0, alloc - size) - buffer - 1;
+    }
+    
+    ret.data = buffer;
+    ret.size = size;
+    return ret;
+}
+
 /**
  * Frees the memory allocated for the specified buffer and sets its values to zero.
  * 
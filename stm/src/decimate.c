@@ -0,0 +1,63 @@
+/**
+ * @file    decimate.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Window statistics used to reduce long time series.
+ * 
+ * Instead of every value only the mean, minimum, maximum and standard deviation of a window of values is kept, which
+ * are updated with each value (using Welford's algorithm for mean and variance) so no values need to be stored.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <math.h>
+#include "decimate.h"
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Starts a new window.
+ * 
+ * @param stats The statistics to reset
+ */
+void Decimate_Reset(Decimate_Stats *stats) {
+    stats->Count = 0;
+    stats->Mean = 0.0f;
+    stats->SumSquares = 0.0f;
+    stats->Min = INFINITY;
+    stats->Max = -INFINITY;
+}
+
+/**
+ * Adds a value to the window.
+ * 
+ * @param stats The statistics of the window
+ * @param value The value to add
+ */
+void Decimate_Add(Decimate_Stats *stats, float value) {
+    float delta = value - stats->Mean;
+    
+    stats->Count++;
+    stats->Mean += delta / stats->Count;
+    stats->SumSquares += delta * (value - stats->Mean);
+    if(value < stats->Min) {
+        stats->Min = value;
+    }
+    if(value > stats->Max) {
+        stats->Max = value;
+    }
+}
+
+/**
+ * Gets the standard deviation of the values in a window.
+ * 
+ * @param stats The statistics of the window
+ * @return The sample standard deviation, or NaN if there are fewer than two values
+ */
+float Decimate_GetDeviation(const Decimate_Stats *stats) {
+    if(stats->Count < 2) {
+        return NAN;
+    }
+    return sqrtf(stats->SumSquares / (stats->Count - 1));
+}
+
+// ----------------------------------------------------------------------------
@@ -9,6 +9,8 @@
 #include <assert.h>
 #include <stddef.h>
 #include "eeprom.h"
+#include "i2ctrace.h"
+#include "telemetry.h"
 
 // Check structure size constants, buffer data without the checksum needs to be aligned to 32 bits for CRC calculation
 _Static_assert((EEPROM_CONFIG_SIZE & 3) == 0, "Configuration buffer not aligned");
@@ -50,7 +52,7 @@ static HAL_StatusTypeDef EE_Read(uint16_t address, uint8_t *buffer, uint16_t len
     assert_param(length > 0 && address + length <= EEPROM_SIZE);
     
     uint8_t dev_addr = MAKE_ADDRESS(address, e2_state);
-    return HAL_I2C_Mem_Read(i2cHandle, dev_addr, address, 1, buffer, length, EEPROM_I2C_TIMEOUT);
+    return I2CTrace_Mem_Read(i2cHandle, dev_addr, address, 1, buffer, length, EEPROM_I2C_TIMEOUT);
 }
 
 /**
@@ -72,9 +74,10 @@ static HAL_StatusTypeDef EE_Write(uint16_t address, uint8_t *buffer, uint16_t le
     }
     
     HAL_StatusTypeDef ret =
-            HAL_I2C_Mem_Write(i2cHandle, MAKE_ADDRESS(address, e2_state), address, 1, buffer, len, EEPROM_I2C_TIMEOUT);
+            I2CTrace_Mem_Write(i2cHandle, MAKE_ADDRESS(address, e2_state), address, 1, buffer, len, EEPROM_I2C_TIMEOUT);
     
     if(ret == HAL_OK) {
+        Telemetry_Count(TELEMETRY_EEPROM_WRITES);
         write_buf = buffer + len;
         write_addr = address + len;
         write_len = length - len;
@@ -151,7 +154,7 @@ EEPROM_Error EE_Init(I2C_HandleTypeDef *i2c, CRC_HandleTypeDef *crc, uint8_t e2_
     crcHandle = crc;
     e2_state = (e2_set ? EEPROM_M24C08_ADDR_E2 : 0);
     
-    if(HAL_I2C_IsDeviceReady(i2c, MAKE_ADDRESS(0, e2_state), 10, EEPROM_I2C_TIMEOUT) == HAL_OK) {
+    if(I2CTrace_IsDeviceReady(i2c, MAKE_ADDRESS(0, e2_state), 10, EEPROM_I2C_TIMEOUT) == HAL_OK) {
         status = EE_IDLE;
         return EE_OK;
     }
@@ -346,7 +349,7 @@ EEPROM_Status EE_TimerCallback(void) {
                 status = EE_WRITE_WAIT;
             } else {
                 // Finished writing, wait for EEPROM to complete write cycle
-                if(HAL_I2C_IsDeviceReady(i2cHandle, MAKE_ADDRESS(0, e2_state), 1, EEPROM_I2C_TIMEOUT) == HAL_OK) {
+                if(I2CTrace_IsDeviceReady(i2cHandle, MAKE_ADDRESS(0, e2_state), 1, EEPROM_I2C_TIMEOUT) == HAL_OK) {
                     status = EE_FINISH;
                 }
             }
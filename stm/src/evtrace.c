@@ -0,0 +1,194 @@
+/**
+ * @file    evtrace.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Binary event trace for timeline analysis.
+ * 
+ * Recording an event takes a few dozen cycles, so unlike `printf` style tracing it can be used in interrupt handlers
+ * and other hot paths to see how acquisition, conversion and transfer overlap. Timestamps are DWT cycle counter values,
+ * which wrap after about 35 seconds at 120MHz and are unwrapped by the host.
+ * 
+ * When a debugger is attached and has enabled the ITM stimulus ports {@link EVTRACE_ITM_PORT} and the one after it,
+ * each event is written as two 32 bit words: the timestamp to the first port and the rest of the record to the second.
+ * If the ITM is still busy with a previous event, the event is dropped instead of waiting, so only the second word of
+ * an event can wait for the first one to be sent. Without a debugger events are recorded in a ring buffer, where the
+ * oldest events are overwritten when it is full.
+ * 
+ * Binary dump format (big endian, like the `board read` binary format):
+ *  + `uint32_t` number of bytes following
+ *  + `uint16_t` format version ({@link EVTRACE_FORMAT_VERSION}), `uint16_t` record size
+ *  + `uint32_t` number of records, `uint32_t` number of records lost due to overwriting or a busy ITM
+ *  + `uint32_t` core clock frequency in Hz
+ *  + the records in chronological order, each one an {@link EvTrace_Record} with multi-byte fields swapped
+ */
+
+// Includes -------------------------------------------------------------------
+#include <stdlib.h>
+#include "evtrace.h"
+
+// The host decoder relies on this layout
+_Static_assert(sizeof(EvTrace_Record) == 8, "Bad EvTrace_Record definition");
+_Static_assert(IS_POWER_OF_TWO(EVTRACE_BUFFER_SIZE), "EVTRACE_BUFFER_SIZE must be a power of 2");
+
+// Private type definitions ---------------------------------------------------
+/**
+ * Header of a binary trace dump, after the byte count.
+ */
+typedef struct
+{
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    uint32_t dropped;
+    uint32_t clock;
+} EvTrace_DumpHeader;
+
+// Private variables ----------------------------------------------------------
+static EvTrace_Record records[EVTRACE_BUFFER_SIZE];
+static volatile uint32_t head = 0;          //!< Total number of records ever written, index of the next record
+static volatile uint32_t lost = 0;          //!< Number of events dropped because the ITM was busy
+static volatile uint8_t enabled = 0;
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Enables the DWT cycle counter used for timestamps and clears the ring buffer.
+ */
+void EvTrace_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    EvTrace_Clear();
+}
+
+/**
+ * Enables or disables recording of events.
+ * 
+ * @param enable `0` to disable recording, nonzero value to enable
+ */
+void EvTrace_Enable(uint8_t enable) {
+    enabled = (enable ? 1 : 0);
+}
+
+/**
+ * Gets whether recording of events is enabled.
+ */
+uint8_t EvTrace_IsEnabled(void) {
+    return enabled;
+}
+
+/**
+ * Gets whether events are currently written to the ITM instead of the ring buffer.
+ */
+uint8_t EvTrace_IsUsingItm(void) {
+    return (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) && (ITM->TCR & ITM_TCR_ITMENA_Msk) &&
+            (ITM->TER & (3UL << EVTRACE_ITM_PORT)) == (3UL << EVTRACE_ITM_PORT);
+}
+
+/**
+ * Discards all recorded events.
+ */
+void EvTrace_Clear(void) {
+    head = 0;
+    lost = 0;
+}
+
+/**
+ * Records an event, this can be called from any interrupt priority.
+ * 
+ * @param type The kind of event
+ * @param arg8 Event specific argument
+ * @param arg Event specific argument
+ */
+void EvTrace_Event(EvTrace_Type type, uint8_t arg8, uint16_t arg) {
+    if(!enabled) {
+        return;
+    }
+    
+    // Keep the two ITM words or the ring buffer slot together when preempted
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t timestamp = DWT->CYCCNT;
+    
+    if(EvTrace_IsUsingItm()) {
+        // Reading a stimulus port returns 0 while its FIFO is full
+        if(ITM->PORT[EVTRACE_ITM_PORT].u32 != 0) {
+            ITM->PORT[EVTRACE_ITM_PORT].u32 = timestamp;
+            while(ITM->PORT[EVTRACE_ITM_PORT + 1].u32 == 0)
+                ;
+            ITM->PORT[EVTRACE_ITM_PORT + 1].u32 = type | (arg8 << 8) | ((uint32_t)arg << 16);
+        } else {
+            lost++;
+        }
+    } else {
+        EvTrace_Record *rec = &records[head & (EVTRACE_BUFFER_SIZE - 1)];
+        rec->timestamp = timestamp;
+        rec->type = type;
+        rec->arg8 = arg8;
+        rec->arg = arg;
+        head++;
+    }
+    
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Converts the recorded events to the binary dump format described at the top of this file.
+ * 
+ * Note that the returned buffer needs to be freed by the caller, using {@link FreeBuffer}.
+ * 
+ * @return Buffer with the dump, `data` is `NULL` if not enough memory is available
+ */
+Buffer EvTrace_Dump(void) {
+    Buffer ret = {
+        .data = NULL,
+        .size = 0
+    };
+    
+    // Don't record the dump itself, and don't let new records mess up the order while copying
+    uint8_t wasEnabled = enabled;
+    enabled = 0;
+    
+    uint32_t end = head;
+    uint32_t count = (end < EVTRACE_BUFFER_SIZE ? end : EVTRACE_BUFFER_SIZE);
+    uint32_t alloc = 4 + sizeof(EvTrace_DumpHeader) + count * sizeof(EvTrace_Record);
+    
+    uint8_t *buffer = malloc(alloc);
+    if(buffer == NULL) {
+        enabled = wasEnabled;
+        return ret;
+    }
+    
+    EvTrace_DumpHeader *hdr = (EvTrace_DumpHeader *)(buffer + 4);
+    EvTrace_Record *out = (EvTrace_Record *)(buffer + 4 + sizeof(EvTrace_DumpHeader));
+#ifdef __ARMEB__
+    *((uint32_t *)buffer) = alloc - 4;
+    hdr->version = EVTRACE_FORMAT_VERSION;
+    hdr->recordSize = sizeof(EvTrace_Record);
+    hdr->count = count;
+    hdr->dropped = end - count + lost;
+    hdr->clock = SystemCoreClock;
+#else
+    *((uint32_t *)buffer) = __REV(alloc - 4);
+    hdr->version = __REV16(EVTRACE_FORMAT_VERSION);
+    hdr->recordSize = __REV16(sizeof(EvTrace_Record));
+    hdr->count = __REV(count);
+    hdr->dropped = __REV(end - count + lost);
+    hdr->clock = __REV(SystemCoreClock);
+#endif
+    
+    for(uint32_t j = 0; j < count; j++) {
+        const EvTrace_Record *rec = &records[(end - count + j) & (EVTRACE_BUFFER_SIZE - 1)];
+        out[j] = *rec;
+#ifndef __ARMEB__
+        out[j].timestamp = __REV(rec->timestamp);
+        out[j].arg = __REV16(rec->arg);
+#endif
+    }
+    
+    enabled = wasEnabled;
+    ret.data = buffer;
+    ret.size = alloc;
+    return ret;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,280 @@
+/**
+ * @file    i2ctrace.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   I2C transaction trace recorder.
+ * 
+ * Every transfer issued through the wrappers in this file is recorded in a ring buffer with start time, duration,
+ * address, register, length, HAL result and the first few data bytes. When the buffer is full the oldest records are
+ * overwritten. Recording costs a few cycles per transfer, which is nothing compared to the transfer itself, so it is
+ * enabled by default.
+ * 
+ * Binary dump format (big endian, like the `board read` binary format):
+ *  + `uint32_t` number of bytes following
+ *  + `uint16_t` format version ({@link I2CTRACE_FORMAT_VERSION}), `uint16_t` record size
+ *  + `uint32_t` number of records, `uint32_t` number of records lost due to overwriting
+ *  + the records in chronological order, each one an {@link I2CTrace_Record} with multi-byte fields swapped
+ */
+
+// Includes -------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "i2ctrace.h"
+#include "evtrace.h"
+
+// The host decoder relies on this layout
+_Static_assert(sizeof(I2CTrace_Record) == 20, "Bad I2CTrace_Record definition");
+_Static_assert(IS_POWER_OF_TWO(I2CTRACE_BUFFER_SIZE), "I2CTRACE_BUFFER_SIZE must be a power of 2");
+
+// Private type definitions ---------------------------------------------------
+/**
+ * Header of a binary trace dump, after the byte count.
+ */
+typedef struct
+{
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    uint32_t dropped;
+} I2CTrace_DumpHeader;
+
+// Private function prototypes ------------------------------------------------
+static uint32_t I2CTrace_GetMicros(void);
+static I2CTrace_Record* I2CTrace_Begin(I2CTrace_Op op, uint16_t address, uint16_t reg, uint16_t length);
+static void I2CTrace_End(I2CTrace_Record *rec, uint32_t start, HAL_StatusTypeDef result, const uint8_t *data);
+
+// Private variables ----------------------------------------------------------
+static I2CTrace_Record records[I2CTRACE_BUFFER_SIZE];
+static volatile uint32_t head = 0;          //!< Total number of records ever started, index of the next record
+static volatile uint8_t enabled = 1;
+static uint32_t cyclesPerMicro = 1;
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Gets the time since boot in µs from the SysTick counter, this wraps after about 71 minutes.
+ */
+static uint32_t I2CTrace_GetMicros(void) {
+    uint32_t tick, val;
+    
+    // Make sure the tick count and counter value belong together
+    do {
+        tick = HAL_GetTick();
+        val = SysTick->VAL;
+    } while(tick != HAL_GetTick());
+    
+    return tick * 1000 + (SysTick->LOAD - val) / cyclesPerMicro;
+}
+
+/**
+ * Reserves the next record in the ring buffer and fills in the static fields.
+ * 
+ * @return Pointer to the record, or `NULL` if tracing is disabled
+ */
+static I2CTrace_Record* I2CTrace_Begin(I2CTrace_Op op, uint16_t address, uint16_t reg, uint16_t length) {
+    EvTrace_Event(EVTRACE_I2C_START, op, reg);
+    if(!enabled) {
+        return NULL;
+    }
+    
+    // Transfers can be started from different interrupt priorities, so reserve the slot atomically
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    I2CTrace_Record *rec = &records[head & (I2CTRACE_BUFFER_SIZE - 1)];
+    head++;
+    __set_PRIMASK(primask);
+    
+    rec->timestamp = I2CTrace_GetMicros();
+    rec->op = op;
+    rec->address = (uint8_t)address;
+    rec->reg = reg;
+    rec->length = length;
+    rec->reserved = 0;
+    return rec;
+}
+
+/**
+ * Completes a record after the transfer has finished.
+ * 
+ * @param rec The record returned by {@link I2CTrace_Begin}, can be `NULL`
+ * @param start Cycle counter value when the transfer started
+ * @param result HAL status code of the transfer
+ * @param data Pointer to the transferred data, or `NULL`
+ */
+static void I2CTrace_End(I2CTrace_Record *rec, uint32_t start, HAL_StatusTypeDef result, const uint8_t *data) {
+    EvTrace_Event(EVTRACE_I2C_DONE, (uint8_t)result, (rec != NULL ? rec->length : 0));
+    if(rec == NULL) {
+        return;
+    }
+    
+    rec->duration = (DWT->CYCCNT - start) / cyclesPerMicro;
+    rec->result = (uint8_t)result;
+    memset(rec->data, 0, sizeof(rec->data));
+    if(data != NULL) {
+        memcpy(rec->data, data, (rec->length < sizeof(rec->data) ? rec->length : sizeof(rec->data)));
+    }
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Initializes the trace recorder and enables the DWT cycle counter used for measuring transfer durations.
+ * This needs to be called before any I2C transfers are made.
+ */
+void I2CTrace_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    
+    cyclesPerMicro = SystemCoreClock / 1000000;
+    if(cyclesPerMicro == 0) {
+        cyclesPerMicro = 1;
+    }
+    I2CTrace_Clear();
+}
+
+/**
+ * Enables or disables recording of transactions.
+ * 
+ * @param enable `0` to disable recording, nonzero value to enable
+ */
+void I2CTrace_Enable(uint8_t enable) {
+    enabled = (enable ? 1 : 0);
+}
+
+/**
+ * Gets whether recording of transactions is enabled.
+ */
+uint8_t I2CTrace_IsEnabled(void) {
+    return enabled;
+}
+
+/**
+ * Discards all recorded transactions.
+ */
+void I2CTrace_Clear(void) {
+    head = 0;
+}
+
+/**
+ * Converts the recorded transactions to the binary dump format described at the top of this file.
+ * 
+ * Note that the returned buffer needs to be freed by the caller, using {@link FreeBuffer}.
+ * 
+ * @return Buffer with the dump, `data` is `NULL` if not enough memory is available
+ */
+Buffer I2CTrace_Dump(void) {
+    Buffer ret = {
+        .data = NULL,
+        .size = 0
+    };
+    
+    // Don't record the dump itself, and don't let new records mess up the order while copying
+    uint8_t wasEnabled = enabled;
+    enabled = 0;
+    
+    uint32_t end = head;
+    uint32_t count = (end < I2CTRACE_BUFFER_SIZE ? end : I2CTRACE_BUFFER_SIZE);
+    uint32_t alloc = 4 + sizeof(I2CTrace_DumpHeader) + count * sizeof(I2CTrace_Record);
+    
+    uint8_t *buffer = malloc(alloc);
+    if(buffer == NULL) {
+        enabled = wasEnabled;
+        return ret;
+    }
+    
+    I2CTrace_DumpHeader *hdr = (I2CTrace_DumpHeader *)(buffer + 4);
+    I2CTrace_Record *out = (I2CTrace_Record *)(buffer + 4 + sizeof(I2CTrace_DumpHeader));
+#ifdef __ARMEB__
+    *((uint32_t *)buffer) = alloc - 4;
+    hdr->version = I2CTRACE_FORMAT_VERSION;
+    hdr->recordSize = sizeof(I2CTrace_Record);
+    hdr->count = count;
+    hdr->dropped = end - count;
+#else
+    *((uint32_t *)buffer) = __REV(alloc - 4);
+    hdr->version = __REV16(I2CTRACE_FORMAT_VERSION);
+    hdr->recordSize = __REV16(sizeof(I2CTrace_Record));
+    hdr->count = __REV(count);
+    hdr->dropped = __REV(end - count);
+#endif
+
+    for(uint32_t j = 0; j < count; j++) {
+        const I2CTrace_Record *rec = &records[(end - count + j) & (I2CTRACE_BUFFER_SIZE - 1)];
+        out[j] = *rec;
+#ifndef __ARMEB__
+        out[j].timestamp = __REV(rec->timestamp);
+        out[j].duration = __REV(rec->duration);
+        out[j].reg = __REV16(rec->reg);
+        out[j].length = __REV16(rec->length);
+#endif
+    }
+    
+    enabled = wasEnabled;
+    ret.data = buffer;
+    ret.size = alloc;
+    return ret;
+}
+
+// HAL wrappers ---------------------------------------------------------------
+
+/**
+ * Recording wrapper for `HAL_I2C_Mem_Write`.
+ */
+HAL_StatusTypeDef I2CTrace_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    I2CTrace_Record *rec = I2CTrace_Begin(I2CTRACE_MEM_WRITE, DevAddress, MemAddress, Size);
+    uint32_t start = DWT->CYCCNT;
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Write(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, Timeout);
+    I2CTrace_End(rec, start, ret, pData);
+    return ret;
+}
+
+/**
+ * Recording wrapper for `HAL_I2C_Mem_Read`.
+ */
+HAL_StatusTypeDef I2CTrace_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+        uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    I2CTrace_Record *rec = I2CTrace_Begin(I2CTRACE_MEM_READ, DevAddress, MemAddress, Size);
+    uint32_t start = DWT->CYCCNT;
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Read(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, Timeout);
+    I2CTrace_End(rec, start, ret, pData);
+    return ret;
+}
+
+/**
+ * Recording wrapper for `HAL_I2C_Master_Transmit`.
+ */
+HAL_StatusTypeDef I2CTrace_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout) {
+    I2CTrace_Record *rec = I2CTrace_Begin(I2CTRACE_TRANSMIT, DevAddress, (Size > 0 ? pData[0] : 0), Size);
+    uint32_t start = DWT->CYCCNT;
+    HAL_StatusTypeDef ret = HAL_I2C_Master_Transmit(hi2c, DevAddress, pData, Size, Timeout);
+    I2CTrace_End(rec, start, ret, pData);
+    return ret;
+}
+
+/**
+ * Recording wrapper for `HAL_I2C_Master_Receive`.
+ */
+HAL_StatusTypeDef I2CTrace_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+        uint16_t Size, uint32_t Timeout) {
+    I2CTrace_Record *rec = I2CTrace_Begin(I2CTRACE_RECEIVE, DevAddress, 0, Size);
+    uint32_t start = DWT->CYCCNT;
+    HAL_StatusTypeDef ret = HAL_I2C_Master_Receive(hi2c, DevAddress, pData, Size, Timeout);
+    I2CTrace_End(rec, start, ret, pData);
+    return ret;
+}
+
+/**
+ * Recording wrapper for `HAL_I2C_IsDeviceReady`.
+ */
+HAL_StatusTypeDef I2CTrace_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint32_t Trials,
+        uint32_t Timeout) {
+    I2CTrace_Record *rec = I2CTrace_Begin(I2CTRACE_DEVICE_READY, DevAddress, 0, (uint16_t)Trials);
+    uint32_t start = DWT->CYCCNT;
+    HAL_StatusTypeDef ret = HAL_I2C_IsDeviceReady(hi2c, DevAddress, Trials, Timeout);
+    I2CTrace_End(rec, start, ret, NULL);
+    return ret;
+}
+
+// ----------------------------------------------------------------------------
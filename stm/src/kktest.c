@@ -0,0 +1,209 @@
+/**
+ * @file    kktest.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Linear Kramers-Kronig test of sweep data, to detect sweeps distorted by drift or interference.
+ * 
+ * The impedance is fitted with a series resistance, inductance and capacitance and a fixed set of Voigt elements
+ * (R parallel to C) whose time constants are logarithmically spaced over the inverse of the frequency range. The model
+ * is linear in its parameters, so the fit is a weighted linear least squares problem. Real and imaginary parts are
+ * fitted together with each point weighted by the inverse of its magnitude, data that doesn't satisfy the
+ * Kramers-Kronig relations can't be fitted and leaves a large residual.
+ * 
+ * The least squares problem is solved by a QR decomposition with Givens rotations that processes one row at a time, so
+ * only the triangular factor needs to be stored instead of the whole basis matrix, and the solution is accurate in
+ * single precision where the normal equations would not be. Testing a sweep of 512 points takes about 20ms.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <string.h>
+#include <math.h>
+#include "kktest.h"
+
+// Private constants ----------------------------------------------------------
+//! The number of parameters besides the Voigt elements (series R, L and C)
+#define KK_SERIES_PARAMS        3
+//! The maximum number of parameters
+#define KK_MAX_PARAMS           (KK_MAX_ELEMENTS + KK_SERIES_PARAMS)
+//! Parameters whose diagonal element is smaller than this relative to the largest one are set to zero
+#define KK_RANK_TOLERANCE       1e-6f
+
+// Private function prototypes ------------------------------------------------
+static void KK_Basis(float omega, float wmin, float wmax, uint32_t elements, float *re, float *im);
+static void KK_AddRow(float *a, float b, uint32_t n);
+
+// Private variables ----------------------------------------------------------
+// Not on the stack since they are too large, which makes KK_Test not reentrant
+static float tau[KK_MAX_ELEMENTS];              //!< Time constants of the Voigt elements in s
+static float triangle[KK_MAX_PARAMS][KK_MAX_PARAMS];    //!< Upper triangular factor R of the QR decomposition
+static float qtb[KK_MAX_PARAMS];                //!< The first rows of Q^T b
+static float params[KK_MAX_PARAMS];             //!< The fitted parameters, scaled like the basis
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Calculates the basis functions of the model at one frequency, for the real and the imaginary part.
+ * 
+ * Inductance and capacitance are scaled to the ends of the frequency range, so all basis functions are at most 1.
+ * 
+ * @param omega Angular frequency
+ * @param wmin Lowest angular frequency of the sweep
+ * @param wmax Highest angular frequency of the sweep
+ * @param elements The number of Voigt elements
+ * @param re Array receiving the basis functions of the real part
+ * @param im Array receiving the basis functions of the imaginary part
+ */
+static void KK_Basis(float omega, float wmin, float wmax, uint32_t elements, float *re, float *im) {
+    re[0] = 1.0f;
+    im[0] = 0.0f;
+    re[1] = 0.0f;
+    im[1] = omega / wmax;
+    re[2] = 0.0f;
+    im[2] = -wmin / omega;
+    for(uint32_t k = 0; k < elements; k++) {
+        float wt = omega * tau[k];
+        float d = 1.0f / (1.0f + wt * wt);
+        re[KK_SERIES_PARAMS + k] = d;
+        im[KK_SERIES_PARAMS + k] = -wt * d;
+    }
+}
+
+/**
+ * Adds a row to the QR decomposition, by rotating it into the triangular factor until it is zero. What is left of the
+ * right hand side is the residual of this row.
+ * 
+ * @param a The row of the basis matrix, which is overwritten
+ * @param b The right hand side of the row
+ * @param n The number of parameters
+ */
+static void KK_AddRow(float *a, float b, uint32_t n) {
+    for(uint32_t k = 0; k < n; k++) {
+        if(a[k] == 0.0f) {
+            continue;
+        }
+        float r = sqrtf(triangle[k][k] * triangle[k][k] + a[k] * a[k]);
+        float c = triangle[k][k] / r;
+        float s = a[k] / r;
+        triangle[k][k] = r;
+        for(uint32_t j = k + 1; j < n; j++) {
+            float t = triangle[k][j];
+            triangle[k][j] = c * t + s * a[j];
+            a[j] = c * a[j] - s * t;
+        }
+        float t = qtb[k];
+        qtb[k] = c * t + s * b;
+        b = c * b - s * t;
+    }
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Tests whether sweep data satisfies the Kramers-Kronig relations, which holds for a linear, causal and stable system
+ * that doesn't change during the sweep.
+ * 
+ * The number of Voigt elements follows from the frequency range, see {@link KK_ELEMENTS_PER_DECADE}. Points with a
+ * magnitude of zero are skipped. This function is not reentrant.
+ * 
+ * @param data Sweep data with ascending frequencies
+ * @param count Number of points in the sweep
+ * @param result Pointer to a structure receiving the result
+ * @return Whether the data could be tested, if not the residual is NaN
+ */
+uint8_t KK_Test(const AD5933_ImpedancePolar *data, uint32_t count, KK_Result *result) {
+    float re[KK_MAX_PARAMS];
+    float im[KK_MAX_PARAMS];
+    uint32_t used = 0;
+    
+    result->Residual = NAN;
+    result->MaxResidual = NAN;
+    result->MaxFrequency = 0;
+    result->Elements = 0;
+    if(count < KK_MIN_POINTS || data[0].Frequency == 0 || data[count - 1].Frequency <= data[0].Frequency) {
+        return 0;
+    }
+    
+    float wmin = 2.0f * (float)M_PI * data[0].Frequency;
+    float wmax = 2.0f * (float)M_PI * data[count - 1].Frequency;
+    uint32_t elements = (uint32_t)ceilf(KK_ELEMENTS_PER_DECADE * log10f(wmax / wmin)) + 1;
+    if(elements > KK_MAX_ELEMENTS) {
+        elements = KK_MAX_ELEMENTS;
+    }
+    uint32_t n = elements + KK_SERIES_PARAMS;
+    
+    // Time constants from 1/wmax to 1/wmin
+    for(uint32_t k = 0; k < elements; k++) {
+        float x = (elements > 1 ? (float)k / (elements - 1) : 0.5f);
+        tau[k] = powf(wmax / wmin, x) / wmax;
+    }
+    
+    memset(triangle, 0, sizeof(triangle));
+    memset(qtb, 0, sizeof(qtb));
+    for(uint32_t j = 0; j < count; j++) {
+        if(!(data[j].Magnitude > 0.0f)) {
+            continue;
+        }
+        // Divide the rows by the magnitude, so the right hand side is the unit vector of the impedance
+        float w = 1.0f / data[j].Magnitude;
+        KK_Basis(2.0f * (float)M_PI * data[j].Frequency, wmin, wmax, elements, re, im);
+        for(uint32_t k = 0; k < n; k++) {
+            re[k] *= w;
+            im[k] *= w;
+        }
+        KK_AddRow(re, cosf(data[j].Angle), n);
+        KK_AddRow(im, sinf(data[j].Angle), n);
+        used++;
+    }
+    if(2 * used <= n) {
+        return 0;
+    }
+    
+    // Back substitution, parameters that can't be determined from the data are left out of the model
+    float maxDiag = 0.0f;
+    for(uint32_t k = 0; k < n; k++) {
+        maxDiag = fmaxf(maxDiag, fabsf(triangle[k][k]));
+    }
+    for(uint32_t k = n; k-- > 0;) {
+        float sum = qtb[k];
+        for(uint32_t j = k + 1; j < n; j++) {
+            sum -= triangle[k][j] * params[j];
+        }
+        params[k] = (fabsf(triangle[k][k]) > KK_RANK_TOLERANCE * maxDiag ? sum / triangle[k][k] : 0.0f);
+    }
+    
+    // Residuals relative to the magnitude at each point
+    float sumSquares = 0.0f;
+    float maxResidual = 0.0f;
+    for(uint32_t j = 0; j < count; j++) {
+        if(!(data[j].Magnitude > 0.0f)) {
+            continue;
+        }
+        float w = 1.0f / data[j].Magnitude;
+        float fitRe = 0.0f;
+        float fitIm = 0.0f;
+        KK_Basis(2.0f * (float)M_PI * data[j].Frequency, wmin, wmax, elements, re, im);
+        for(uint32_t k = 0; k < n; k++) {
+            fitRe += re[k] * params[k];
+            fitIm += im[k] * params[k];
+        }
+        float dRe = fabsf(cosf(data[j].Angle) - w * fitRe);
+        float dIm = fabsf(sinf(data[j].Angle) - w * fitIm);
+        sumSquares += dRe * dRe + dIm * dIm;
+        if(fmaxf(dRe, dIm) > maxResidual) {
+            maxResidual = fmaxf(dRe, dIm);
+            result->MaxFrequency = data[j].Frequency;
+        }
+    }
+    
+    float residual = sqrtf(sumSquares / (2 * used));
+    if(!isfinite(residual)) {
+        result->MaxFrequency = 0;
+        return 0;
+    }
+    result->Residual = residual;
+    result->MaxResidual = maxResidual;
+    result->Elements = elements;
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
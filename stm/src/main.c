@@ -7,6 +7,8 @@
 
 // Includes -------------------------------------------------------------------
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "main.h"
 
 // Private function prototypes ------------------------------------------------
@@ -15,6 +17,24 @@ static void UpdateSettings(void);
 static void InitFromEEPROM(void);
 static void Handle_TIM3_AD5933(void);
 static void Handle_TIM3_EEPROM(void);
+static void Handle_TIM3_Schedule(void);
+static void FinishScheduledRun(void);
+static void TestSweep(void);
+static void CheckMask(void);
+static void CheckChange(void);
+static Board_Error StartSweep(uint8_t port, uint16_t sweeps);
+static void FoldSweep(void);
+static void InvalidateGain(void);
+static void CacheGain(void);
+static uint8_t GetLevelIndex(const AD5933_RangeSettings *r, uint32_t *att, uint32_t *volt);
+static Board_Error StartLevelStep(void);
+static void StepLevelSweep(void);
+static void FinishLevelSweep(void);
+static Board_Error Preempt(void);
+static void Resume(void);
+static void PowerDown(void);
+static uint8_t MaskTIM3(void);
+static void UnmaskTIM3(uint8_t enabled);
 
 // Variables ------------------------------------------------------------------
 USBD_HandleTypeDef hUsbDevice;
@@ -58,9 +78,11 @@ static AD5933_RangeSettings range;
 static uint32_t stopFreq;
 static uint8_t lastPort;
 static uint8_t autorange;       // Whether autoranging should be enabled for the next sweep
+static uint16_t sweepAverages;  // Number of repeated sweeps averaged
 
 // Data
 static AD5933_ImpedanceData bufData[AD5933_MAX_NUM_INCREMENTS + 1];
+static AD5933_ImpedanceData bufSweep[AD5933_MAX_NUM_INCREMENTS + 1];    // Data of one repetition when averaging
 static uint8_t validData = 0;
 static AD5933_ImpedancePolar bufPolar[AD5933_MAX_NUM_INCREMENTS + 1];
 static uint8_t validPolar = 0;
@@ -71,30 +93,87 @@ static AD5933_GainFactorData gainData;
 static AD5933_GainFactor gainFactor;        // Current gain factor, could have changed since the measurement finished
 static uint8_t validGain = 0;               // Whether gainFactor is valid for the current sweep parameters
 static float temp;                          // Result from temperature measurements
+static AD5933_ImpedanceData contData;       // Latest result of a continuous measurement
+static uint32_t contFreq;                   // Frequency of the running continuous measurement
+static uint16_t contAverages;               // Averages of the running continuous measurement
+static uint16_t contCount;                  // Number of continuous measurement results already handled
+static volatile uint8_t maskTest = 0;       // Whether the running sweep is checked against the limit mask
+static uint32_t maskChecked;                // Number of points of the running sweep already checked
+static volatile uint8_t monitorActive = 0;  // Whether sweeps are repeated and compared to a reference
+static uint32_t monitorSlot;                // Reference slot used for monitoring
+static float monitorThreshold;              // Relative change that is reported when monitoring
+static uint32_t monitorSweeps;              // Number of sweeps finished since monitoring was started
+static volatile uint16_t avgSweeps = 0;     // Number of sweeps averaged for the running measurement, 0 if none
+static uint16_t avgSweep;                   // Number of the running repetition, starting at 0
+static uint32_t avgFolded;                  // Number of points of the running repetition already averaged
+
+// Output levels
+static const uint16_t voltages[] = { 200, 400, 1000, 2000 };   // AD5933 output voltages in mV p-p
+static const uint16_t voltageRanges[] = {                       // Register values for `voltages`
+    AD5933_VOLTAGE_0_2,
+    AD5933_VOLTAGE_0_4,
+    AD5933_VOLTAGE_1,
+    AD5933_VOLTAGE_2
+};
+// Gain factors calibrated for each attenuation and voltage, valid as long as the other range settings don't change
+static AD5933_GainFactor gainCache[NUMEL(board_config.attenuations)][NUMEL(voltages)];
+static uint8_t gainCached[NUMEL(board_config.attenuations)][NUMEL(voltages)];
+static volatile uint8_t levelActive = 0;    // Whether an amplitude sweep is running
+static uint32_t levelFreqs[BOARD_LEVEL_MAX_FREQS];  // Frequencies of the amplitude sweep
+static uint32_t levelFreqCount;
+static uint8_t levelAtt[NUMEL(board_config.attenuations) * NUMEL(voltages)];    // Attenuation index of each level
+static uint8_t levelVolt[NUMEL(board_config.attenuations) * NUMEL(voltages)];   // Voltage index of each level
+static uint32_t levelLevelCount;
+static uint32_t levelStep;                  // Index of the running step, the frequency changes fastest
+static AD5933_ImpedanceData levelBuf[2];
+static Board_LevelPoint levelData[BOARD_LEVEL_MAX_POINTS];
+static uint32_t levelCount = 0;
+static volatile uint8_t preempted = 0;      // Whether a sweep is suspended for an urgent measurement
+static AD5933_SweepContext preemptContext;  // State of the suspended sweep
+static volatile uint8_t preemptStop = 0;    // Whether the suspended sweep is stopped as soon as it is resumed
+static volatile uint8_t schedActive = 0;    // Whether the running sweep was started by a scheduled job
+static uint32_t schedJob;                   // Job that started the running sweep
+static uint64_t schedTime;                  // Start time of the running scheduled sweep
+static uint8_t schedPort;                   // Port of the running scheduled sweep
+static float schedLimit;                    // Kramers-Kronig residual limit of the running scheduled sweep
+static uint8_t schedRepeats;                // The number of times the running scheduled sweep has been repeated
+static uint8_t schedReplaced = 0;           // Whether the measurement data was discarded for a scheduled run
+static KK_Result kkResult = { NAN, NAN, 0, 0 };    // Kramers-Kronig test of the last complete sweep
+static volatile uint8_t kkPending = 0;      // Whether the last complete sweep still needs to be tested
+static volatile uint32_t sweepSerial = 0;   // Number of sweeps started, tells whether the data changed during a test
+static volatile uint8_t singleActive = 0;   // Whether a single point is being measured, see Board_MeasureSingleFrequency
 
 // main and Interrupt handlers ------------------------------------------------
 
 __attribute__((noreturn))
 int main(int argc __attribute__((unused)), char* argv[] __attribute__((unused))) {
     // At this stage the system clock should have already been configured at high speed.
+    Boot_Mark(BOOT_MAIN);
+    Monitor_PaintStack();
     MX_Init();
+    EvTrace_Init();
+    I2CTrace_Init();
+    Boot_Mark(BOOT_PERIPHERALS);
     Console_Init();
     SetDefaults();
     
+    // The AD5933 needs some time after its pins are configured, read the EEPROM meanwhile
+    AD5933_Init(&hi2c1, &htim10);
     if(EE_Init(&hi2c1, &hcrc, EEPROM_E2_PIN_SET) == EE_OK) {
         board_has_eeprom = 1;
         InitFromEEPROM();
     }
-    
-    AD5933_Init(&hi2c1, &htim10);
+    Boot_Mark(BOOT_SETTINGS);
+    AD5933_FinishInit();
     
     // Call configuration dependent initialization functions
     if(board_config.peripherals.eth) {
         MX_Init_Ethernet();
     }
     
-    // Start timer for periodic interrupt generation
+    // Start timer for periodic interrupt generation, commands are accepted from now on
     HAL_TIM_Base_Start_IT(&htim3);
+    Boot_Mark(BOOT_READY);
     
     while(1) {
         // Do stuff.
@@ -111,6 +190,7 @@ int main(int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
     if(htim->Instance == TIM3) {
         Handle_TIM3_AD5933();
+        Handle_TIM3_Schedule();
         Handle_TIM3_EEPROM();
     }
 }
@@ -122,13 +202,57 @@ static void Handle_TIM3_AD5933(void) {
     static AD5933_Status prevStatus = AD_UNINIT;
     
     AD5933_Status status = AD5933_TimerCallback();
+    if(singleActive) {
+        // A single point is not a sweep, its end is only passed on to Board_MeasureSingleFrequency
+        if(status == AD_FINISH_IMPEDANCE) {
+            singleActive = 0;
+        }
+        prevStatus = status;
+        return;
+    }
+    if(preempted) {
+        // The state of the suspended sweep is left alone until it is resumed
+        if(status == AD_FINISH_TEMP) {
+            Resume();
+            Console_TempCallback(temp);
+            if(preemptStop) {
+                preemptStop = 0;
+                Board_StopSweep();
+            }
+        }
+        return;
+    }
+    if(status == AD_MEASURE_CONTINUOUS && AD5933_GetSweepCount() != contCount) {
+        AD5933_ImpedancePolar value;
+        contCount = AD5933_GetSweepCount();
+        value.Frequency = contData.Frequency;
+        value.Magnitude = AD5933_GetMagnitude(&contData, &gainFactor);
+        value.Angle = AD5933_GetPhase(&contData, &gainFactor);
+        Console_ContinuousCallback(&value);
+    }
+    if(levelActive) {
+        StepLevelSweep();
+        // The next step is started when one is finished
+        status = AD5933_GetStatus();
+    }
+    if(avgSweeps) {
+        FoldSweep();
+        // The next repetition is started when one is finished
+        status = AD5933_GetStatus();
+    }
+    if(maskTest) {
+        CheckMask();
+        // The sweep is stopped when a point fails
+        status = AD5933_GetStatus();
+    }
     if(prevStatus == status) {
         return;
     }
     switch(status) {
         case AD_FINISH_IMPEDANCE:
             pointCount = AD5933_GetSweepCount();
-            interrupted = 0;
+            // A sweep aborted after repeated I2C errors keeps the points measured so far
+            interrupted = AD5933_WasAborted();
             
             if(prevStatus == AD_MEASURE_IMPEDANCE) {
                 validData = 1;
@@ -138,11 +262,36 @@ static void Handle_TIM3_AD5933(void) {
                 validData = 0;
                 validPolar = 1;
             }
+            avgSweeps = 0;
+            if(!interrupted && prevStatus == AD_MEASURE_IMPEDANCE) {
+                if(schedActive && schedLimit > 0) {
+                    // Whether the run is repeated depends on the test, so it can't wait
+                    uint32_t count;
+                    const AD5933_ImpedancePolar *data = Board_GetDataPolar(&count);
+                    KK_Test(data, (data != NULL ? count : 0), &kkResult);
+                } else {
+                    // The test takes too long for this interrupt, it is run when the result is asked for
+                    kkPending = 1;
+                }
+            }
+            Console_SweepCallback(pointCount);
+            if(maskTest) {
+                // All points have been checked by now
+                maskTest = 0;
+                Console_TestCallback(MASK_PASS, 0);
+            }
+            if(monitorActive) {
+                CheckChange();
+            }
+            if(schedActive) {
+                FinishScheduledRun();
+            }
             break;
             
         case AD_FINISH_CALIB:
             AD5933_CalculateGainFactor(&gainData, &gainFactor);
             validGain = 1;
+            CacheGain();
             Console_CalibrateCallback();
             break;
             
@@ -156,6 +305,109 @@ static void Handle_TIM3_AD5933(void) {
     prevStatus = status;
 }
 
+/**
+ * Handles TIM3 period elapsed event for scheduled jobs, starts a sweep for a job that is due as soon as no other
+ * measurement is running.
+ * 
+ * A run that is due while a console command is being processed is skipped and counted as missed, since starting a
+ * sweep from here could interrupt the command halfway through setting up a measurement of its own.
+ */
+static void Handle_TIM3_Schedule(void) {
+    int32_t job = Schedule_GetDueJob();
+    if(job < 0 || AD5933_IsBusy() || preempted) {
+        return;
+    }
+    if(Console_IsProcessing()) {
+        Schedule_JobMissed(job);
+        return;
+    }
+    
+    const Schedule_Job *j = Schedule_GetJob(job);
+    uint8_t port = j->port;
+    Schedule_JobStarted(job);
+    schedTime = Schedule_GetTime();
+    if(StartSweep(port, sweepAverages) == BOARD_OK) {
+        schedJob = job;
+        schedPort = port;
+        schedLimit = j->kkLimit;
+        schedRepeats = 0;
+        schedActive = 1;
+    } else {
+        // Not calibrated, record the failed run so it doesn't go unnoticed
+        Schedule_StoreRun(job, schedTime, NULL, 0, 1, NAN, 0);
+    }
+}
+
+/**
+ * Stores the data of a finished or stopped scheduled sweep and switches the output off until the next run.
+ * 
+ * If the job has a Kramers-Kronig residual limit and the finished sweep exceeds it, the sweep is repeated right away
+ * instead, up to {@link SCHEDULE_KK_REPEATS} times, and the last one is stored. A sweep that could not be tested
+ * (residual is NaN) is stored right away, repeating it would not change that.
+ */
+static void FinishScheduledRun(void) {
+    const AD5933_ImpedancePolar *data;
+    uint32_t count;
+    
+    schedActive = 0;
+    data = Board_GetDataPolar(&count);
+    if(schedLimit > 0 && !interrupted && data != NULL && isfinite(kkResult.Residual) &&
+            kkResult.Residual > schedLimit && schedRepeats < SCHEDULE_KK_REPEATS) {
+        uint64_t time = Schedule_GetTime();
+        if(StartSweep(schedPort, sweepAverages) == BOARD_OK) {
+            schedTime = time;
+            schedRepeats++;
+            schedActive = 1;
+            return;
+        }
+    }
+    Schedule_StoreRun(schedJob, schedTime, data, count, interrupted || data == NULL, kkResult.Residual, schedRepeats);
+    
+    // The buffers held the data of an interactive sweep before, don't let `board read` return the run in its place
+    validData = 0;
+    validPolar = 0;
+    pointCount = 0;
+    interrupted = 0;
+    kkPending = 0;
+    kkResult.Residual = NAN;
+    kkResult.MaxResidual = NAN;
+    schedReplaced = 1;
+    PowerDown();
+}
+
+/**
+ * Runs the Kramers-Kronig test of the last complete sweep, unless it has been tested already. The test takes up to
+ * about 20 ms, so it is only run when the result is asked for, with TIM3 running.
+ */
+static void TestSweep(void) {
+    AD5933_ImpedancePolar *data = NULL;
+    uint32_t count = 0;
+    uint32_t serial;
+    KK_Result result;
+    
+    uint8_t tim3 = MaskTIM3();
+    uint8_t pending = kkPending;
+    if(pending) {
+        kkPending = 0;
+        serial = sweepSerial;
+        data = Board_CopyDataPolar(&count);
+    }
+    UnmaskTIM3(tim3);
+    if(!pending) {
+        return;
+    }
+    
+    KK_Test(data, (data != NULL ? count : 0), &result);
+    free(data);
+    
+    // A sweep started meanwhile has reset the result, which must not be overwritten with that of the old data
+    tim3 = MaskTIM3();
+    if(serial == sweepSerial) {
+        kkResult = result;
+    }
+    UnmaskTIM3(tim3);
+}
+
 /**
  * Handles TIM3 period elapsed event for the EEPROM driver.
  */
@@ -181,6 +433,257 @@ static void Handle_TIM3_EEPROM(void) {
 
 // Private functions ----------------------------------------------------------
 
+/**
+ * Checks the points measured since the last call against the limit mask, stops the sweep and reports the verdict
+ * on the first point that fails.
+ */
+static void CheckMask(void) {
+    uint32_t count = AD5933_GetSweepCount();
+    
+    while(maskChecked < count) {
+        AD5933_ImpedancePolar point;
+        point.Frequency = bufData[maskChecked].Frequency;
+        point.Magnitude = AD5933_GetMagnitude(&bufData[maskChecked], &gainFactor);
+        point.Angle = AD5933_GetPhase(&bufData[maskChecked], &gainFactor);
+        
+        Mask_Verdict verdict = Mask_Check(maskChecked, &point);
+        if(verdict != MASK_PASS) {
+            maskTest = 0;
+            if(AD5933_GetStatus() == AD_MEASURE_IMPEDANCE) {
+                Board_StopSweep();
+            }
+            Console_TestCallback(verdict, point.Frequency);
+            return;
+        }
+        maskChecked++;
+    }
+}
+
+/**
+ * Compares a finished monitoring sweep to the reference, reports a significant change and starts the next sweep.
+ */
+static void CheckChange(void) {
+    const AD5933_ImpedancePolar *data;
+    uint32_t count;
+    uint32_t freq;
+    
+    monitorSweeps++;
+    data = Board_GetDataPolar(&count);
+    float change = Reference_MaxChange(monitorSlot, data, count, &freq);
+    if(change > monitorThreshold) {
+        // The callback may stop monitoring
+        Console_ChangeCallback(monitorSweeps, freq, change);
+    }
+    
+    if(monitorActive && Board_StartSweep(lastPort) != BOARD_OK) {
+        monitorActive = 0;
+    }
+}
+
+/**
+ * Adds the points measured since the last call to the running mean over repeated sweeps and starts the next
+ * repetition when one is finished.
+ * 
+ * The mean is written to the data buffer, so it can be read at any time. Until the first repetition is finished only
+ * the points measured so far are available.
+ */
+static void FoldSweep(void) {
+    uint32_t count = AD5933_GetSweepCount();
+    
+    if(avgFolded < count) {
+        while(avgFolded < count) {
+            SweepAvg_Add(avgFolded, &bufSweep[avgFolded], &bufData[avgFolded]);
+            avgFolded++;
+        }
+        if(avgSweep == 0) {
+            pointCount = avgFolded;
+        }
+        validData = 1;
+        validPolar = 0;
+        dataGainFactor = gainFactor;
+    }
+    
+    if(AD5933_GetStatus() == AD_FINISH_IMPEDANCE && avgSweep + 1 < avgSweeps && !AD5933_WasAborted()) {
+        if(AD5933_RepeatSweep() == AD_OK) {
+            avgSweep++;
+            avgFolded = 0;
+        }
+    }
+}
+
+/**
+ * Marks the current gain factor and the gain factors of all output levels as invalid, this is needed whenever range
+ * settings other than the output level or the frequency range change.
+ */
+static void InvalidateGain(void) {
+    validGain = 0;
+    memset(gainCached, 0, sizeof(gainCached));
+}
+
+/**
+ * Keeps the current gain factor for the current output level, so it can be used again after the level is changed.
+ */
+static void CacheGain(void) {
+    uint32_t att, volt;
+    
+    if(GetLevelIndex(&range, &att, &volt)) {
+        gainCache[att][volt] = gainFactor;
+        gainCached[att][volt] = 1;
+    }
+}
+
+/**
+ * Finds the attenuation and voltage indices of the output level of the specified range settings.
+ * 
+ * @param r The range settings
+ * @param att Pointer to a variable receiving the index in `board_config.attenuations`
+ * @param volt Pointer to a variable receiving the index in `voltages`
+ * @return `1` if the level was found, `0` otherwise
+ */
+static uint8_t GetLevelIndex(const AD5933_RangeSettings *r, uint32_t *att, uint32_t *volt) {
+    for(uint32_t j = 0; j < NUMEL(board_config.attenuations) && board_config.attenuations[j]; j++) {
+        if(board_config.attenuations[j] != r->Attenuation) {
+            continue;
+        }
+        for(uint32_t k = 0; k < NUMEL(voltageRanges); k++) {
+            if(voltageRanges[k] == r->Voltage_Range) {
+                *att = j;
+                *volt = k;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Starts measuring the current step of the amplitude sweep.
+ * 
+ * @return {@link Board_Error} code
+ */
+static Board_Error StartLevelStep(void) {
+    uint32_t level = levelStep / levelFreqCount;
+    AD5933_RangeSettings r = range;
+    r.Attenuation = board_config.attenuations[levelAtt[level]];
+    r.Voltage_Range = voltageRanges[levelVolt[level]];
+    
+    // AD5933 cannot measure a single frequency, make room for two
+    AD5933_Sweep sw = sweep;
+    sw.Start_Freq = levelFreqs[levelStep % levelFreqCount];
+    sw.Freq_Increment = 1;
+    sw.Num_Increments = 1;
+    
+    return (AD5933_ContinueSweep(&sw, &r, &levelBuf[0]) == AD_OK ? BOARD_OK : BOARD_ERROR);
+}
+
+/**
+ * Stores the result of a finished amplitude sweep step and starts the next one, or finishes the amplitude sweep after
+ * the last step.
+ */
+static void StepLevelSweep(void) {
+    if(AD5933_GetStatus() != AD_FINISH_IMPEDANCE) {
+        return;
+    }
+    if(AD5933_WasAborted()) {
+        FinishLevelSweep();
+        return;
+    }
+    
+    uint32_t level = levelStep / levelFreqCount;
+    const AD5933_GainFactor *gain = &gainCache[levelAtt[level]][levelVolt[level]];
+    Board_LevelPoint *point = &levelData[levelCount++];
+    point->Frequency = levelBuf[0].Frequency;
+    point->Voltage = voltages[levelVolt[level]] / board_config.attenuations[levelAtt[level]];
+    point->Magnitude = AD5933_GetMagnitude(&levelBuf[0], gain);
+    point->Angle = AD5933_GetPhase(&levelBuf[0], gain);
+    
+    levelStep++;
+    if(levelStep == levelLevelCount * levelFreqCount || StartLevelStep() != BOARD_OK) {
+        FinishLevelSweep();
+    }
+}
+
+/**
+ * Switches the output off after an amplitude sweep and passes the number of results to {@link Console_LevelsCallback}.
+ */
+static void FinishLevelSweep(void) {
+    levelActive = 0;
+    PowerDown();
+    Console_LevelsCallback(levelCount);
+}
+
+/**
+ * Suspends the running sweep for an urgent measurement, which needs to call {@link Resume} when it is finished.
+ * 
+ * Sweeps of any kind (averaged, tested, monitored or amplitude sweeps) can be suspended, since their board state is
+ * only updated by {@link Handle_TIM3_AD5933} while no sweep is suspended.
+ * 
+ * @return {@link BOARD_OK} if the sweep was suspended, {@link BOARD_BUSY} if the running measurement can't be suspended
+ */
+static Board_Error Preempt(void) {
+    AD5933_Error ret;
+    
+    if(preempted) {
+        return BOARD_BUSY;
+    }
+    
+    // The driver state must not change while it is saved
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
+    ret = AD5933_SuspendSweep(&preemptContext);
+    if(ret == AD_OK) {
+        preempted = 1;
+        preemptStop = 0;
+    }
+    HAL_NVIC_EnableIRQ(TIM3_IRQn);
+    
+    return (ret == AD_OK ? BOARD_OK : BOARD_BUSY);
+}
+
+/**
+ * Resumes the sweep suspended by {@link Preempt} on its port.
+ */
+static void Resume(void) {
+    uint8_t port = lastPort;
+    
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
+    
+    // Set output mux
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_RESET);
+    HAL_SPI_Transmit(&hspi3, &port, 1, BOARD_SPI_TIMEOUT);
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_SET);
+    
+    preempted = 0;
+    if(AD5933_ResumeSweep(&preemptContext) != AD_OK) {
+        // Only possible if the board configuration was changed in the meantime
+        Board_StopSweep();
+    }
+    
+    HAL_NVIC_EnableIRQ(TIM3_IRQn);
+}
+
+/**
+ * Keeps {@link Handle_TIM3_AD5933} from changing the measurement data, for example by folding a repeated sweep into
+ * it, until {@link UnmaskTIM3} is called. Unlike a plain `HAL_NVIC_DisableIRQ` this can be nested and used from TIM3.
+ * 
+ * @return Whether the TIM3 interrupt was enabled before, to be passed on to {@link UnmaskTIM3}
+ */
+static uint8_t MaskTIM3(void) {
+    uint8_t enabled = (NVIC->ISER[(uint32_t)TIM3_IRQn >> 5] & (1UL << ((uint32_t)TIM3_IRQn & 0x1F))) != 0;
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
+    return enabled;
+}
+
+/**
+ * Undoes {@link MaskTIM3}.
+ * 
+ * @param enabled The value returned by the matching call to {@link MaskTIM3}
+ */
+static void UnmaskTIM3(uint8_t enabled) {
+    if(enabled) {
+        HAL_NVIC_EnableIRQ(TIM3_IRQn);
+    }
+}
+
 static void SetDefaults(void) {
     sweep.Num_Increments = 50;
     sweep.Start_Freq = 10000;
@@ -188,6 +691,9 @@ static void SetDefaults(void) {
     sweep.Settling_Cycles = 16;
     sweep.Settling_Mult = AD5933_SETTL_MULT_1;
     sweep.Averages = 1;
+    sweep.Estimator = AD_ESTIMATE_MEAN;
+    sweep.Mains_Freq = 0;
+    sweepAverages = 1;
     
     range.PGA_Gain = AD5933_GAIN_1;
     range.Voltage_Range = AD5933_VOLTAGE_1;
@@ -197,9 +703,10 @@ static void SetDefaults(void) {
     autorange = 0;
     validData = 0;
     validPolar = 0;
-    validGain = 0;
+    InvalidateGain();
     pointCount = 0;
     interrupted = 0;
+    schedReplaced = 0;
     
     UpdateSettings();
     settings.serial = 0;
@@ -214,6 +721,9 @@ static void UpdateSettings(void) {
     settings.stop_freq = stopFreq;
     settings.settling_cycles = sweep.Settling_Cycles | sweep.Settling_Mult;
     settings.averages = sweep.Averages;
+    settings.sweep_averages = sweepAverages;
+    settings.flags.estimator = sweep.Estimator;
+    settings.flags.mains_freq = sweep.Mains_Freq;
     
     settings.flags.pga_enabled = (range.PGA_Gain == AD5933_GAIN_5 ? 1 : 0);
     settings.voltage = range.Voltage_Range;
@@ -241,6 +751,13 @@ static void InitFromEEPROM(void) {
         sweep.Settling_Cycles = settings.settling_cycles & AD5933_MAX_SETTL;
         sweep.Settling_Mult = settings.settling_cycles & ~AD5933_MAX_SETTL;
         sweep.Averages = settings.averages;
+        // Settings written by older firmware have no sweep averages
+        sweepAverages = (settings.sweep_averages != 0 ? settings.sweep_averages : 1);
+        sweep.Estimator = (AD5933_Estimator)settings.flags.estimator;
+        if(sweep.Estimator != AD_ESTIMATE_MEAN && sweep.Averages > AD5933_MAX_ROBUST_AVERAGES) {
+            sweep.Estimator = AD_ESTIMATE_MEAN;
+        }
+        sweep.Mains_Freq = settings.flags.mains_freq;
         
         range.PGA_Gain = (settings.flags.pga_enabled ? AD5933_GAIN_5 : AD5933_GAIN_1);
         range.Voltage_Range = settings.voltage;
@@ -272,8 +789,11 @@ Board_Error Board_SetStartFreq(uint32_t freq) {
         return BOARD_ERROR;
     }
     
-    sweep.Start_Freq = freq;
-    validGain = 0;
+    // Setting the same value again, like a host applying all settings at once does, keeps the calibration
+    if(freq != sweep.Start_Freq) {
+        sweep.Start_Freq = freq;
+        InvalidateGain();
+    }
     MarkSettingsDirty();
     return BOARD_OK;
 }
@@ -294,8 +814,10 @@ Board_Error Board_SetStopFreq(uint32_t freq) {
         return BOARD_ERROR;
     }
     
-    stopFreq = freq;
-    validGain = 0;
+    if(freq != stopFreq) {
+        stopFreq = freq;
+        InvalidateGain();
+    }
     MarkSettingsDirty();
     return BOARD_OK;
 }
@@ -361,6 +883,9 @@ Board_Error Board_SetSettlingCycles(uint16_t cycles, uint8_t multiplier) {
  * Sets the voltage range used for a sweep.
  * The value can be <i>0.2V</i>, <i>0.4V</i>, <i>1V</i> or <i>2V</i>, attenuated by the values in `board_config`.
  * 
+ * A gain factor calibrated at the new voltage range is used again, as long as the other range settings and the
+ * frequency range have not changed since.
+ * 
  * @param voltage The output voltage in mV
  * @return {@link Board_Error} code
  */
@@ -369,20 +894,15 @@ Board_Error Board_SetVoltageRange(uint16_t voltage) {
         return BOARD_BUSY;
     }
     
-    static const uint16_t voltages[] = { 200, 400, 1000, 2000 };
-    static const uint16_t voltage_values[] = {
-        AD5933_VOLTAGE_0_2,
-        AD5933_VOLTAGE_0_4,
-        AD5933_VOLTAGE_1,
-        AD5933_VOLTAGE_2
-    };
-    
     for(uint32_t j = 0; j < NUMEL(board_config.attenuations) && board_config.attenuations[j]; j++) {
         for(uint32_t k = 0; k < NUMEL(voltages); k++) {
             if(voltage == voltages[k] / board_config.attenuations[j]) {
                 range.Attenuation = board_config.attenuations[j];
-                range.Voltage_Range = voltage_values[k];
-                validGain = 0;
+                range.Voltage_Range = voltageRanges[k];
+                validGain = gainCached[j][k];
+                if(validGain) {
+                    gainFactor = gainCache[j][k];
+                }
                 MarkSettingsDirty();
                 return BOARD_OK;
             }
@@ -403,9 +923,10 @@ Board_Error Board_SetPGA(uint8_t enable) {
         return BOARD_BUSY;
     }
     
-    if(!autorange) {
-        range.PGA_Gain = (enable ? AD5933_GAIN_5 : AD5933_GAIN_1);
-        validGain = 0;
+    uint16_t gain = (enable ? AD5933_GAIN_5 : AD5933_GAIN_1);
+    if(!autorange && gain != range.PGA_Gain) {
+        range.PGA_Gain = gain;
+        InvalidateGain();
     }
     
     MarkSettingsDirty();
@@ -446,8 +967,10 @@ Board_Error Board_SetFeedback(uint32_t ohms) {
         if(!fb) {
             return BOARD_ERROR;
         }
-        range.Feedback_Value = fb;
-        validGain = 0;
+        if(fb != range.Feedback_Value) {
+            range.Feedback_Value = fb;
+            InvalidateGain();
+        }
     }
     
     MarkSettingsDirty();
@@ -464,7 +987,7 @@ Board_Error Board_SetAverages(uint16_t value) {
     if(AD5933_IsBusy()) {
         return BOARD_BUSY;
     }
-    if(value == 0) {
+    if(value == 0 || (sweep.Estimator != AD_ESTIMATE_MEAN && value > AD5933_MAX_ROBUST_AVERAGES)) {
         return BOARD_ERROR;
     }
     
@@ -473,6 +996,66 @@ Board_Error Board_SetAverages(uint16_t value) {
     return BOARD_OK;
 }
 
+/**
+ * Sets how the averages for each frequency point are combined. Estimators other than the mean can only be used with
+ * up to {@link AD5933_MAX_ROBUST_AVERAGES} averages.
+ * 
+ * @param estimator The estimator
+ * @return {@link Board_Error} code
+ */
+Board_Error Board_SetEstimator(AD5933_Estimator estimator) {
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    if(estimator > AD_ESTIMATE_CLIPPED ||
+            (estimator != AD_ESTIMATE_MEAN && sweep.Averages > AD5933_MAX_ROBUST_AVERAGES)) {
+        return BOARD_ERROR;
+    }
+    
+    sweep.Estimator = estimator;
+    MarkSettingsDirty();
+    return BOARD_OK;
+}
+
+/**
+ * Sets the mains frequency that the averages for each frequency point are synchronized to, which cancels mains pickup
+ * with far fewer averages.
+ * 
+ * @param freq The mains frequency in Hz, or `0` to not synchronize
+ * @return {@link Board_Error} code
+ */
+Board_Error Board_SetMainsFreq(uint8_t freq) {
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    if(freq != 0 && (freq < AD5933_MAINS_FREQ_MIN || freq > AD5933_MAINS_FREQ_MAX)) {
+        return BOARD_ERROR;
+    }
+    
+    sweep.Mains_Freq = freq;
+    MarkSettingsDirty();
+    return BOARD_OK;
+}
+
+/**
+ * Sets the number of repeated sweeps that are averaged.
+ * 
+ * @param value the number of sweeps, a value of `1` means no averaging is performed
+ * @return {@link Board_Error} code
+ */
+Board_Error Board_SetSweepAverages(uint16_t value) {
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    if(value == 0) {
+        return BOARD_ERROR;
+    }
+    
+    sweepAverages = value;
+    MarkSettingsDirty();
+    return BOARD_OK;
+}
+
 /**
  * Gets the current start frequency used for a sweep.
  */
@@ -534,6 +1117,27 @@ uint16_t Board_GetAverages(void) {
     return sweep.Averages;
 }
 
+/**
+ * Gets how the averages for each frequency point are combined.
+ */
+AD5933_Estimator Board_GetEstimator(void) {
+    return sweep.Estimator;
+}
+
+/**
+ * Gets the mains frequency the averages are synchronized to, `0` if they are not synchronized.
+ */
+uint8_t Board_GetMainsFreq(void) {
+    return sweep.Mains_Freq;
+}
+
+/**
+ * Gets the current number of repeated sweeps that are averaged.
+ */
+uint16_t Board_GetSweepAverages(void) {
+    return sweepAverages;
+}
+
 /**
  * Gets the current measurement status.
  * 
@@ -543,9 +1147,18 @@ void Board_GetStatus(Board_Status *result) {
     result->ad_status = AD5933_GetStatus();
     result->point = AD5933_GetSweepCount();
     result->totalPoints = sweep.Num_Increments;
+    result->sweep = avgSweep;
+    result->totalSweeps = avgSweeps;
     result->interrupted = interrupted;
     result->validGainFactor = validGain;
     result->validData = validData || validPolar;
+    result->dataReplaced = schedReplaced;
+    result->i2cErrors = AD5933_GetErrorCount();
+    result->i2cErrorsTotal = AD5933_GetTotalErrorCount();
+    result->mainsRejection = AD5933_GetMainsRejection();
+    TestSweep();
+    result->kk = kkResult;
+    Monitor_GetMemoryStatus(&result->memory);
     
     switch(result->ad_status) {
         case AD_MEASURE_IMPEDANCE:
@@ -569,16 +1182,35 @@ void Board_GetStatus(Board_Status *result) {
  *  + Running measurements are stopped, AD5933 is reset
  */
 void Board_Reset(void) {
+    Board_Standby();
     SetDefaults();
     Console_Init();
-    Board_Standby();
+    Mask_Clear();
+    for(uint32_t j = 0; j < REFERENCE_SLOTS; j++) {
+        Reference_Clear(j);
+    }
+    Schedule_Clear();
+    kkPending = 0;
+    kkResult.Residual = NAN;
+    kkResult.MaxResidual = NAN;
     MarkSettingsDirty();
 }
 
 /**
- * Puts the AD5933 in standby mode, switches off the low speed clock and disconnects the output ports.
+ * Stops any running or suspended measurement like {@link Board_StopSweep}, finishes a console command that is still
+ * waiting for it, then puts the AD5933 in standby mode, switches off the low speed clock and disconnects the output
+ * ports.
  */
 void Board_Standby(void) {
+    Board_StopSweep();
+    Console_StopCallback();
+}
+
+/**
+ * Puts the AD5933 in standby mode, switches off the low speed clock and disconnects the output ports, without
+ * touching the board state.
+ */
+static void PowerDown(void) {
     uint8_t data = ADG725_CHIP_ENABLE_NOT;
     HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_RESET);
     HAL_SPI_Transmit(&hspi3, &data, 1, BOARD_SPI_TIMEOUT);
@@ -591,10 +1223,17 @@ void Board_Standby(void) {
 /**
  * Gets a pointer to the converted measurement data in polar format.
  * 
+ * While repeated sweeps are averaged the buffer is updated by TIM3, use {@link Board_CopyDataPolar} to get data that
+ * doesn't change while it is used.
+ * 
  * @param count Pointer to a variable receiving the number of points in the buffer
  * @return Pointer to the data buffer, or `NULL` if no data is available
  */
 const AD5933_ImpedancePolar* Board_GetDataPolar(uint32_t *count) {
+    const AD5933_ImpedancePolar *ret = &bufPolar[0];
+    
+    // A repetition folded in halfway through would leave a mix of old and new points marked as valid
+    uint8_t tim3 = MaskTIM3();
     if(!validPolar) {
         if(validData) {
             for(uint32_t j = 0; j < pointCount; j++) {
@@ -605,13 +1244,37 @@ const AD5933_ImpedancePolar* Board_GetDataPolar(uint32_t *count) {
             validPolar = 1;
         } else {
             // Neither raw nor polar data, nothing to return
-            *count = 0;
-            return NULL ;
+            ret = NULL;
         }
     }
+    *count = (ret != NULL ? pointCount : 0);
+    UnmaskTIM3(tim3);
     
-    *count = pointCount;
-    return &bufPolar[0];
+    return ret;
+}
+
+/**
+ * Copies the converted measurement data in polar format, the copy stays consistent while repeated sweeps are folded
+ * into the data.
+ * 
+ * @param count Pointer to a variable receiving the number of points, `0` if no data is available
+ * @return Pointer to the copy, which needs to be freed by the caller, or `NULL` if no data is available or there is
+ *         not enough memory (with `count` set)
+ */
+AD5933_ImpedancePolar* Board_CopyDataPolar(uint32_t *count) {
+    AD5933_ImpedancePolar *copy = NULL;
+    
+    uint8_t tim3 = MaskTIM3();
+    const AD5933_ImpedancePolar *data = Board_GetDataPolar(count);
+    if(data != NULL) {
+        copy = malloc(*count * sizeof(*copy));
+        if(copy != NULL) {
+            memcpy(copy, data, *count * sizeof(*copy));
+        }
+    }
+    UnmaskTIM3(tim3);
+    
+    return copy;
 }
 
 /**
@@ -630,6 +1293,29 @@ const AD5933_ImpedanceData* Board_GetDataRaw(uint32_t *count) {
     }
 }
 
+/**
+ * Copies the raw measurement data, the copy stays consistent while repeated sweeps are folded into the data.
+ * 
+ * @param count Pointer to a variable receiving the number of points, `0` if no raw data is available
+ * @return Pointer to the copy, which needs to be freed by the caller, or `NULL` if no raw data is available or there
+ *         is not enough memory (with `count` set)
+ */
+AD5933_ImpedanceData* Board_CopyDataRaw(uint32_t *count) {
+    AD5933_ImpedanceData *copy = NULL;
+    
+    uint8_t tim3 = MaskTIM3();
+    const AD5933_ImpedanceData *data = Board_GetDataRaw(count);
+    if(data != NULL) {
+        copy = malloc(*count * sizeof(*copy));
+        if(copy != NULL) {
+            memcpy(copy, data, *count * sizeof(*copy));
+        }
+    }
+    UnmaskTIM3(tim3);
+    
+    return copy;
+}
+
 /**
  * Gets a pointer to the calibrated gain factor.
  * 
@@ -650,9 +1336,12 @@ const AD5933_GainFactor* Board_GetGainFactor(void) {
  * Initiates a frequency sweep on the specified port.
  * 
  * @param port Port number for the sweep, needs to be in the range 0 to {@link PORT_MAX}
+ * @param sweeps The number of repeated sweeps that are averaged
  * @return {@link Board_Error} code
  */
-Board_Error Board_StartSweep(uint8_t port) {
+static Board_Error StartSweep(uint8_t port, uint16_t sweeps) {
+    AD5933_Error ret;
+    
     if(AD5933_IsBusy()) {
         return BOARD_BUSY;
     }
@@ -668,36 +1357,249 @@ Board_Error Board_StartSweep(uint8_t port) {
     // TODO implement autorange
     sweep.Freq_Increment = (stopFreq - sweep.Start_Freq) / (sweep.Num_Increments != 0 ? sweep.Num_Increments : 1);
     
-    if(AD5933_MeasureImpedance(&sweep, &range, &bufData[0]) == AD_OK) {
+    SweepAvg_Reset();
+    if(sweeps > 1) {
+        // Repetitions are measured into a separate buffer, the data buffer holds the mean
+        ret = AD5933_MeasureImpedance(&sweep, &range, &bufSweep[0]);
+    } else {
+        ret = AD5933_MeasureImpedance(&sweep, &range, &bufData[0]);
+    }
+    
+    if(ret == AD_OK) {
         validPolar = 0;
         validData = 0;
         interrupted = 0;
+        schedReplaced = 0;
+        kkPending = 0;
+        sweepSerial++;
+        kkResult.Residual = NAN;
+        kkResult.MaxResidual = NAN;
         lastPort = port;
+        avgSweep = 0;
+        avgFolded = 0;
+        avgSweeps = (sweeps > 1 ? sweeps : 0);
+        Boot_Mark(BOOT_FIRST_SWEEP);
         return BOARD_OK;
     } else {
         return BOARD_ERROR;
     }
 }
 
+/**
+ * Initiates a frequency sweep on the specified port. If sweep averaging is enabled, the sweep is repeated and the
+ * mean is updated after every point.
+ * 
+ * @param port Port number for the sweep, needs to be in the range 0 to {@link PORT_MAX}
+ * @return {@link Board_Error} code
+ */
+Board_Error Board_StartSweep(uint8_t port) {
+    return StartSweep(port, sweepAverages);
+}
+
+/**
+ * Checks whether repeated sweeps are currently being averaged. In this case the mean of the sweeps so far can be
+ * read while the measurement is running.
+ */
+uint8_t Board_IsAveraging(void) {
+    return (avgSweeps != 0);
+}
+
+/**
+ * Checks whether a sweep or continuous measurement is running, including a sweep that is suspended while an urgent
+ * measurement (like a temperature measurement) is made, that is whether {@link Board_StopSweep} has anything to stop.
+ */
+uint8_t Board_IsSweeping(void) {
+    AD5933_Status status = AD5933_GetStatus();
+    return (preempted || levelActive || status == AD_MEASURE_IMPEDANCE || status == AD_MEASURE_IMPEDANCE_AUTORANGE ||
+            status == AD_MEASURE_CONTINUOUS);
+}
+
+/**
+ * Initiates a frequency sweep on the specified port that is checked against the limit mask as the points are
+ * measured. The sweep is stopped at the first point that fails, the verdict is passed to
+ * {@link Console_TestCallback}.
+ * 
+ * @param port Port number for the sweep, needs to be in the range 0 to {@link PORT_MAX}
+ * @return {@link Board_Error} code, {@link BOARD_ERROR} also if the mask is empty
+ */
+Board_Error Board_StartTest(uint8_t port) {
+    const Mask_Point *points;
+    Board_Error ret;
+    
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    // Points can only be checked with a gain factor
+    if(Mask_GetPoints(&points) == 0 || !validGain) {
+        return BOARD_ERROR;
+    }
+    
+    // A test is a single sweep, so it can be stopped at the first point that fails
+    ret = StartSweep(port, 1);
+    if(ret == BOARD_OK) {
+        Mask_Load(sweep.Start_Freq, sweep.Freq_Increment, sweep.Num_Increments + 1);
+        maskChecked = 0;
+        maskTest = 1;
+    }
+    return ret;
+}
+
+/**
+ * Starts repeating frequency sweeps on the specified port, until {@link Board_StopSweep} is called. After each sweep
+ * the data is compared to a reference sweep, and if the largest relative change exceeds the threshold it is passed to
+ * {@link Console_ChangeCallback}.
+ * 
+ * @param port Port number for the sweeps, needs to be in the range 0 to {@link PORT_MAX}
+ * @param slot The reference slot, the reference needs to have the same frequency plan as the current settings
+ * @param threshold The relative change |Z - Zref| / |Zref| that is reported
+ * @return {@link Board_Error} code
+ */
+Board_Error Board_StartMonitor(uint8_t port, uint32_t slot, float threshold) {
+    const AD5933_ImpedancePolar *ref;
+    uint32_t count;
+    Board_Error ret;
+    
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    ref = Reference_Get(slot, &count);
+    if(ref == NULL || count != (uint32_t)sweep.Num_Increments + 1 || ref[0].Frequency != sweep.Start_Freq ||
+            !(threshold >= 0) || !validGain) {
+        return BOARD_ERROR;
+    }
+    
+    ret = Board_StartSweep(port);
+    if(ret == BOARD_OK) {
+        monitorSlot = slot;
+        monitorThreshold = threshold;
+        monitorSweeps = 0;
+        monitorActive = 1;
+    }
+    return ret;
+}
+
+/**
+ * Starts an amplitude sweep, that measures the specified frequencies on the specified port at each output level
+ * (voltage range and attenuation) with a calibrated gain factor. Levels that have not been calibrated since the other
+ * range settings or the frequency range were changed are skipped. {@link Console_LevelsCallback} is called when the
+ * amplitude sweep is finished.
+ * 
+ * The levels are measured in the order of the AD5933 voltage ranges, and the output is kept on between steps, so the
+ * coupling capacitor only needs to be charged when the voltage range changes.
+ * 
+ * @param port Port number for the measurement, needs to be in the range 0 to {@link PORT_MAX}
+ * @param freqs The frequencies to measure, which need to be in the calibrated frequency range
+ * @param count The number of frequencies, at most {@link BOARD_LEVEL_MAX_FREQS}
+ * @return {@link Board_Error} code, {@link BOARD_ERROR} also if no level has been calibrated
+ */
+Board_Error Board_StartLevelSweep(uint8_t port, const uint32_t *freqs, uint32_t count) {
+    if(AD5933_IsBusy()) {
+        return BOARD_BUSY;
+    }
+    if(port > PORT_MAX || count == 0 || count > BOARD_LEVEL_MAX_FREQS) {
+        return BOARD_ERROR;
+    }
+    for(uint32_t j = 0; j < count; j++) {
+        // Calibration is only valid in the current frequency range
+        if(freqs[j] < sweep.Start_Freq || freqs[j] > stopFreq || freqs[j] >= AD5933_FREQ_MAX) {
+            return BOARD_ERROR;
+        }
+    }
+    
+    levelLevelCount = 0;
+    for(uint32_t k = 0; k < NUMEL(voltages); k++) {
+        for(uint32_t j = 0; j < NUMEL(board_config.attenuations) && board_config.attenuations[j]; j++) {
+            if(gainCached[j][k]) {
+                levelAtt[levelLevelCount] = j;
+                levelVolt[levelLevelCount] = k;
+                levelLevelCount++;
+            }
+        }
+    }
+    if(levelLevelCount == 0) {
+        return BOARD_ERROR;
+    }
+    
+    // Set output mux
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_RESET);
+    HAL_SPI_Transmit(&hspi3, &port, 1, BOARD_SPI_TIMEOUT);
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_SET);
+    
+    memcpy(levelFreqs, freqs, count * sizeof(freqs[0]));
+    levelFreqCount = count;
+    levelStep = 0;
+    levelCount = 0;
+    if(StartLevelStep() != BOARD_OK) {
+        return BOARD_ERROR;
+    }
+    lastPort = port;
+    levelActive = 1;
+    return BOARD_OK;
+}
+
+/**
+ * Gets the results of the running or last amplitude sweep, ordered by output voltage range, attenuation and frequency.
+ * 
+ * @param count Pointer to a variable receiving the number of results
+ * @return Pointer to the results
+ */
+const Board_LevelPoint* Board_GetLevelData(uint32_t *count) {
+    *count = levelCount;
+    return &levelData[0];
+}
+
 /**
  * Stops a currently running frequency measurement, if any. Always resets the AD5933 and disconnects output ports.
  * 
  * When no measurement is running, this function can be used to switch off the AD5933 so no output signal is generated.
  * 
+ * A sweep that is suspended for a temperature measurement is only stopped when that has finished, so the temperature
+ * is still reported.
+ * 
  * @return {@link BOARD_OK}
  */
 Board_Error Board_StopSweep(void) {
+    if(preempted) {
+        if(AD5933_IsBusy()) {
+            // The urgent measurement is left to finish, the sweep is stopped when it is resumed after that
+            preemptStop = 1;
+            return BOARD_OK;
+        }
+        // A suspended sweep is stopped like a running one
+        Resume();
+    }
+    if(levelActive) {
+        // Keeps the results measured so far
+        FinishLevelSweep();
+        return BOARD_OK;
+    }
+    
     AD5933_Status status = AD5933_GetStatus();
     if(status == AD_MEASURE_IMPEDANCE) {
         interrupted = 1;
         validData = 1;
+        pointCount = AD5933_GetSweepCount();
         dataGainFactor = gainFactor;
+        if(avgSweeps) {
+            // The data buffer holds the mean, all points are valid after the first repetition
+            FoldSweep();
+            pointCount = (avgSweep > 0 ? (uint32_t)sweep.Num_Increments + 1 : avgFolded);
+            validPolar = 0;
+        }
     } else if(status == AD_MEASURE_IMPEDANCE_AUTORANGE) {
         interrupted = 1;
         validPolar = 1;
     }
+    maskTest = 0;
+    monitorActive = 0;
+    avgSweeps = 0;
+    if(schedActive) {
+        // A stopped run is not repeated
+        schedLimit = 0;
+        FinishScheduledRun();
+    }
     
-    Board_Standby();
+    PowerDown();
     return BOARD_OK;
 }
 
@@ -711,17 +1613,21 @@ uint8_t Board_GetPort(void) {
 /**
  * Measures a single frequency point on the specified port with the current range settings.
  * 
+ * A running sweep is suspended for the measurement and resumed afterwards on its port, starting with the point that was
+ * being measured. The output is kept on, so the coupling capacitor doesn't need to be charged unless the sweep uses a
+ * different voltage range (which is only possible for an amplitude sweep).
+ * 
  * @param port The port to measure on
  * @param freq The frequency to measure
  * @param result Pointer to a structure receiving the converted impedance value
- * @return {@link Board_Error} code
+ * @return {@link Board_Error} code, {@link BOARD_BUSY} if a measurement other than a sweep is running
  */
 Board_Error Board_MeasureSingleFrequency(uint8_t port, uint32_t freq, AD5933_ImpedancePolar *result) {
+    AD5933_Error ret;
+    uint8_t preempt;
+    
     assert_param(result != NULL);
     
-    if(AD5933_IsBusy()) {
-        return BOARD_BUSY;
-    }
     if(freq < AD5933_FREQ_MIN || freq > AD5933_FREQ_MAX || port > PORT_MAX || (!validGain && !autorange)) {
         return BOARD_ERROR;
     }
@@ -729,6 +1635,15 @@ Board_Error Board_MeasureSingleFrequency(uint8_t port, uint32_t freq, AD5933_Imp
     if(freq < sweep.Start_Freq || freq > stopFreq) {
         return BOARD_ERROR;
     }
+    preempt = AD5933_IsBusy();
+    if(preempt && Preempt() != BOARD_OK) {
+        return BOARD_BUSY;
+    }
+    
+    // Set output mux
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_RESET);
+    HAL_SPI_Transmit(&hspi3, &port, 1, BOARD_SPI_TIMEOUT);
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_SET);
     
     // AD5933 cannot measure a single frequency, make room for two
     AD5933_ImpedanceData buffer[2];
@@ -738,9 +1653,20 @@ Board_Error Board_MeasureSingleFrequency(uint8_t port, uint32_t freq, AD5933_Imp
     sw.Num_Increments = 1;
     
     // TODO implement autorange
-    AD5933_MeasureImpedance(&sw, &range, &buffer[0]);
-    while(AD5933_GetStatus() != AD_FINISH_IMPEDANCE) {
-        HAL_Delay(2);
+    singleActive = 1;
+    ret = AD5933_ContinueSweep(&sw, &range, &buffer[0]);
+    if(ret == AD_OK) {
+        // Cleared by TIM3, which then doesn't take the end of the measurement for the end of a sweep
+        while(singleActive) {
+            HAL_Delay(2);
+        }
+    }
+    singleActive = 0;
+    if(preempt) {
+        Resume();
+    }
+    if(ret != AD_OK) {
+        return BOARD_ERROR;
     }
     
     result->Frequency = freq;
@@ -751,16 +1677,77 @@ Board_Error Board_MeasureSingleFrequency(uint8_t port, uint32_t freq, AD5933_Imp
 }
 
 /**
- * Initiates a temperature measurement from the specified source and returns the value measured.
- * This function blocks until a value is available.
+ * Starts measuring a single frequency continuously on the specified port with the current range settings, until
+ * {@link Board_StopSweep} is called. Each result is passed to {@link Console_ContinuousCallback}.
  * 
- * @param what Which temperature to measure
+ * If a continuous measurement with the same parameters is already running, it is left running so results are
+ * available right away, otherwise it is restarted.
+ * 
+ * @param port The port to measure on
+ * @param freq The frequency to measure
+ * @param averages The number of conversions averaged for each result
  * @return {@link Board_Error} code
  */
+Board_Error Board_StartContinuous(uint8_t port, uint32_t freq, uint16_t averages) {
+    AD5933_Status status = AD5933_GetStatus();
+    
+    if(status == AD_MEASURE_CONTINUOUS && port == lastPort && freq == contFreq && averages == contAverages) {
+        return BOARD_OK;
+    }
+    if(AD5933_IsBusy() && status != AD_MEASURE_CONTINUOUS) {
+        return BOARD_BUSY;
+    }
+    if(freq < AD5933_FREQ_MIN || freq > AD5933_FREQ_MAX || port > PORT_MAX || averages == 0 || !validGain) {
+        return BOARD_ERROR;
+    }
+    // Calibration is only valid in the current frequency range
+    if(freq < sweep.Start_Freq || freq > stopFreq) {
+        return BOARD_ERROR;
+    }
+    
+    if(status == AD_MEASURE_CONTINUOUS) {
+        AD5933_Reset();
+    }
+    
+    // Set output mux
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_RESET);
+    HAL_SPI_Transmit(&hspi3, &port, 1, BOARD_SPI_TIMEOUT);
+    HAL_GPIO_WritePin(BOARD_SPI_SS_GPIO_PORT, BOARD_SPI_SS_GPIO_MUX, GPIO_PIN_SET);
+    
+    contCount = 0;
+    if(AD5933_MeasureContinuous(freq, sweep.Settling_Cycles | sweep.Settling_Mult, averages, &range,
+            &contData) == AD_OK) {
+        lastPort = port;
+        contFreq = freq;
+        contAverages = averages;
+        return BOARD_OK;
+    } else {
+        return BOARD_ERROR;
+    }
+}
+
+/**
+ * Initiates a temperature measurement from the specified source, the value is passed to {@link Console_TempCallback}.
+ * 
+ * A running sweep is suspended for the measurement and resumed before the callback. The coupling capacitor is charged
+ * again then, since the AD5933 leaves the frequency sweep mode to measure the temperature.
+ * 
+ * @param what Which temperature to measure
+ * @return {@link Board_Error} code, {@link BOARD_BUSY} if a measurement other than a sweep is running
+ */
 Board_Error Board_MeasureTemperature(Board_TemperatureSource what) {
+    uint8_t preempt;
+    
     switch(what) {
         case TEMP_AD5933:
+            preempt = AD5933_IsBusy();
+            if(preempt && Preempt() != BOARD_OK) {
+                return BOARD_BUSY;
+            }
             if(AD5933_MeasureTemperature(&temp) != AD_OK) {
+                if(preempt) {
+                    Resume();
+                }
                 return BOARD_ERROR;
             }
             break;
@@ -0,0 +1,151 @@
+/**
+ * @file    mask.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Limit mask for pass/fail testing of sweeps.
+ * 
+ * The mask is defined by limits at a number of frequencies. Before a sweep the limits are interpolated linearly onto
+ * the frequencies of the sweep, so each point can be checked with a few comparisons as soon as it has been measured.
+ * Points outside the frequency range of the mask are not checked.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <math.h>
+#include "mask.h"
+
+// Private function prototypes ------------------------------------------------
+__STATIC_INLINE float Mask_Lerp(float a, float b, float t);
+
+// Private variables ----------------------------------------------------------
+static Mask_Point points[MASK_MAX_POINTS];          //!< Mask points, sorted by frequency
+static uint32_t pointCount = 0;                     //!< The number of mask points
+static float magMin[AD5933_MAX_NUM_INCREMENTS + 1]; //!< Lower magnitude limits on the sweep grid
+static float magMax[AD5933_MAX_NUM_INCREMENTS + 1]; //!< Upper magnitude limits on the sweep grid
+static float angMin[AD5933_MAX_NUM_INCREMENTS + 1]; //!< Lower angle limits on the sweep grid
+static float angMax[AD5933_MAX_NUM_INCREMENTS + 1]; //!< Upper angle limits on the sweep grid
+static uint32_t gridCount = 0;                      //!< The number of points the mask was loaded for
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Interpolates linearly between two values.
+ */
+__STATIC_INLINE float Mask_Lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Removes all points from the mask.
+ */
+void Mask_Clear(void) {
+    pointCount = 0;
+    gridCount = 0;
+}
+
+/**
+ * Adds a point to the mask, replacing a point with the same frequency.
+ * 
+ * @param point The point to add
+ * @return `1` if the point was added, `0` if the mask is full
+ */
+uint8_t Mask_AddPoint(const Mask_Point *point) {
+    uint32_t j = 0;
+    
+    assert_param(point != NULL);
+    
+    while(j < pointCount && points[j].Frequency < point->Frequency) {
+        j++;
+    }
+    
+    if(j == pointCount || points[j].Frequency != point->Frequency) {
+        if(pointCount == MASK_MAX_POINTS) {
+            return 0;
+        }
+        for(uint32_t k = pointCount; k > j; k--) {
+            points[k] = points[k - 1];
+        }
+        pointCount++;
+    }
+    points[j] = *point;
+    return 1;
+}
+
+/**
+ * Gets the points of the mask.
+ * 
+ * @param result Pointer to a variable receiving the address of the points, sorted by frequency
+ * @return The number of points
+ */
+uint32_t Mask_GetPoints(const Mask_Point **result) {
+    *result = points;
+    return pointCount;
+}
+
+/**
+ * Interpolates the mask onto the frequencies of a sweep, this needs to be called before checking points.
+ * 
+ * @param start The start frequency of the sweep
+ * @param step The frequency increment of the sweep
+ * @param count The number of points of the sweep
+ */
+void Mask_Load(uint32_t start, uint32_t step, uint32_t count) {
+    uint32_t k = 0;
+    
+    assert_param(count <= NUMEL(magMin));
+    
+    for(uint32_t j = 0; j < count; j++) {
+        uint32_t freq = start + j * step;
+        
+        // Find the mask segment containing the frequency, frequencies are increasing
+        while(k + 1 < pointCount && points[k + 1].Frequency <= freq) {
+            k++;
+        }
+        
+        if(pointCount == 0 || freq < points[0].Frequency || freq > points[pointCount - 1].Frequency) {
+            magMin[j] = NAN;
+            magMax[j] = NAN;
+            angMin[j] = NAN;
+            angMax[j] = NAN;
+        } else if(points[k].Frequency == freq || k + 1 == pointCount) {
+            magMin[j] = points[k].MagnitudeMin;
+            magMax[j] = points[k].MagnitudeMax;
+            angMin[j] = points[k].AngleMin;
+            angMax[j] = points[k].AngleMax;
+        } else {
+            const Mask_Point *p0 = &points[k];
+            const Mask_Point *p1 = &points[k + 1];
+            float t = (float)(freq - p0->Frequency) / (float)(p1->Frequency - p0->Frequency);
+            magMin[j] = Mask_Lerp(p0->MagnitudeMin, p1->MagnitudeMin, t);
+            magMax[j] = Mask_Lerp(p0->MagnitudeMax, p1->MagnitudeMax, t);
+            angMin[j] = Mask_Lerp(p0->AngleMin, p1->AngleMin, t);
+            angMax[j] = Mask_Lerp(p0->AngleMax, p1->AngleMax, t);
+        }
+    }
+    gridCount = count;
+}
+
+/**
+ * Checks a measured point against the mask.
+ * 
+ * @param index The index of the point in the sweep
+ * @param point The measured point
+ * @return A {@link Mask_Verdict}
+ */
+Mask_Verdict Mask_Check(uint32_t index, const AD5933_ImpedancePolar *point) {
+    if(index >= gridCount) {
+        return MASK_PASS;
+    }
+    
+    // Comparisons with NaN are false, so missing limits always pass
+    if(point->Magnitude < magMin[index] || point->Magnitude > magMax[index]) {
+        return MASK_FAIL_MAGNITUDE;
+    }
+    if(point->Angle < angMin[index] || point->Angle > angMax[index]) {
+        return MASK_FAIL_ANGLE;
+    }
+    return MASK_PASS;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,204 @@
+/**
+ * @file    monitor.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Runtime stack and heap monitoring.
+ * 
+ * The unused part of the main stack is painted with {@link MONITOR_STACK_PATTERN} at boot, the high-water mark is
+ * found by scanning for the first overwritten word from the stack limit upwards. Interrupt handlers call
+ * {@link Monitor_SampleStack} on entry to record the deepest stack pointer seen for each interrupt.
+ * 
+ * Heap statistics are gathered by walking the free list of the newlib-nano allocator, allocation counters are kept by
+ * wrapping `malloc`, `calloc`, `realloc` and `free` (linker flags `--wrap=malloc` etc.), so only allocations made by
+ * application code are counted, not those made internally by newlib.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <stdlib.h>
+#include <unistd.h>
+#include "monitor.h"
+
+// Private type definitions ---------------------------------------------------
+/**
+ * Chunk header used by the newlib-nano allocator, `size` includes the header.
+ */
+typedef struct Monitor_MallocChunk
+{
+    long size;
+    struct Monitor_MallocChunk *next;
+} Monitor_MallocChunk;
+
+// Private function prototypes ------------------------------------------------
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void *ptr, size_t size);
+void __wrap_free(void *ptr);
+
+// Private variables ----------------------------------------------------------
+// Defined by the linker
+extern char _Heap_Begin;
+extern char _Heap_Limit;
+extern char _Main_Stack_Limit;
+extern char _estack;
+// Defined by newlib-nano
+extern Monitor_MallocChunk *__malloc_free_list;
+
+static volatile uint32_t allocs = 0;
+static volatile uint32_t frees = 0;
+static volatile uint32_t allocFailures = 0;
+
+// Exported variables ---------------------------------------------------------
+/**
+ * Lowest stack pointer value seen on entry for each interrupt in {@link Monitor_Irq}.
+ */
+uint32_t monitor_irq_sp[MON_IRQ_COUNT] = {
+    [0 ... MON_IRQ_COUNT - 1] = UINT32_MAX
+};
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Paints the unused part of the main stack with {@link MONITOR_STACK_PATTERN}.
+ * This should be the first thing called in `main`, interrupts are disabled while the stack is painted.
+ */
+void Monitor_PaintStack(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    uint32_t *p = (uint32_t *)&_Main_Stack_Limit;
+    uint32_t *sp = (uint32_t *)__get_MSP();
+    while(p < sp) {
+        *p++ = MONITOR_STACK_PATTERN;
+    }
+    
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Gets the maximum number of bytes used on the main stack since boot.
+ * 
+ * If this is equal to the stack size, the stack has probably overflowed into the heap.
+ */
+uint32_t Monitor_GetStackHighWater(void) {
+    const uint32_t *p = (const uint32_t *)&_Main_Stack_Limit;
+    const uint32_t *end = (const uint32_t *)&_estack;
+    while(p < end && *p == MONITOR_STACK_PATTERN) {
+        p++;
+    }
+    return (uint32_t)((const char *)end - (const char *)p);
+}
+
+/**
+ * Gets the deepest stack use seen on entry of the specified interrupt handler, including the interrupted context.
+ * 
+ * @param irq The interrupt
+ * @return Stack depth in bytes, or `0` if the interrupt has not occurred yet
+ */
+uint32_t Monitor_GetIrqStackDepth(Monitor_Irq irq) {
+    assert_param(irq < MON_IRQ_COUNT);
+    
+    uint32_t sp = monitor_irq_sp[irq];
+    if(sp == UINT32_MAX) {
+        return 0;
+    }
+    return (uint32_t)&_estack - sp;
+}
+
+/**
+ * Gets the number of failed allocations since boot, without walking the heap like {@link Monitor_GetMemoryStatus}.
+ */
+uint32_t Monitor_GetAllocFailures(void) {
+    return allocFailures;
+}
+
+/**
+ * Gets stack and heap usage information.
+ * 
+ * @param result Pointer to a structure to be populated
+ */
+void Monitor_GetMemoryStatus(Monitor_MemoryStatus *result) {
+    uint32_t freeList = 0;
+    uint32_t largest = 0;
+    
+    assert_param(result != NULL);
+    
+    result->stackSize = (uint32_t)(&_estack - &_Main_Stack_Limit);
+    result->stackUsed = Monitor_GetStackHighWater();
+    result->heapSize = (uint32_t)(&_Heap_Limit - &_Heap_Begin);
+    
+    // Allocations can happen from interrupts, so don't let anyone touch the free list while walking it
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    char *brk = sbrk(0);
+    for(const Monitor_MallocChunk *chunk = __malloc_free_list; chunk != NULL; chunk = chunk->next) {
+        freeList += chunk->size;
+        if((uint32_t)chunk->size > largest) {
+            largest = chunk->size;
+        }
+    }
+    result->allocs = allocs;
+    result->frees = frees;
+    result->allocFailures = allocFailures;
+    
+    __set_PRIMASK(primask);
+    
+    // Memory above the break can still be claimed by the allocator
+    uint32_t unclaimed = (uint32_t)(&_Heap_Limit - brk);
+    if(unclaimed > largest) {
+        largest = unclaimed;
+    }
+    
+    result->heapUsed = (uint32_t)(brk - &_Heap_Begin) - freeList;
+    result->heapFree = freeList + unclaimed;
+    result->heapLargestFree = largest;
+    result->heapFragmentation = (result->heapFree != 0 ?
+            (uint16_t)(1000 - (uint64_t)largest * 1000 / result->heapFree) : 0);
+}
+
+// Allocator wrappers ---------------------------------------------------------
+
+void* __wrap_malloc(size_t size) {
+    void *ptr = __real_malloc(size);
+    if(ptr != NULL) {
+        allocs++;
+    } else {
+        allocFailures++;
+    }
+    return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void *ptr = __real_calloc(count, size);
+    if(ptr != NULL) {
+        allocs++;
+    } else {
+        allocFailures++;
+    }
+    return ptr;
+}
+
+void* __wrap_realloc(void *ptr, size_t size) {
+    void *ret = __real_realloc(ptr, size);
+    if(ret == NULL && size != 0) {
+        allocFailures++;
+    } else if(ptr == NULL) {
+        allocs++;
+    } else if(size == 0) {
+        frees++;
+    }
+    return ret;
+}
+
+void __wrap_free(void *ptr) {
+    if(ptr != NULL) {
+        frees++;
+    }
+    __real_free(ptr);
+}
+
+// ----------------------------------------------------------------------------
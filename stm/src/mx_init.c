@@ -17,6 +17,7 @@ static void MX_TIM3_Init(void);
 static void MX_TIM10_Init(void);
 static void MX_CRC_Init(void);
 static void MX_USB_DEVICE_Init(void);
+static void MX_DelayMicros(uint32_t us);
 
 // Exported functions ---------------------------------------------------------
 
@@ -74,6 +75,57 @@ void MX_Init_Ethernet(void) {
     HAL_RCC_MCOConfig(RCC_MCO2, RCC_MCO2SOURCE_PLLI2SCLK, RCC_MCODIV_1);
 }
 
+/**
+ * Recovers the I2C bus after an error, for example when a slave holds SDA low after a disturbed transfer.
+ * 
+ * The peripheral is disabled and up to 9 clock pulses are generated until the slave releases SDA, followed by a stop
+ * condition. The peripheral is then reset, in case it is stuck with the busy flag set, and initialized again.
+ * This needs the DWT cycle counter to be running (see {@link I2CTrace_Init}).
+ * 
+ * @param hi2c The I2C handle, only I2C1 is supported
+ * @return `HAL_OK` if SDA is released after the bus clear, `HAL_ERROR` otherwise
+ */
+HAL_StatusTypeDef MX_I2C_BusClear(I2C_HandleTypeDef *hi2c) {
+    GPIO_InitTypeDef init;
+    
+    assert_param(hi2c->Instance == I2C1);
+    HAL_I2C_DeInit(hi2c);
+    
+    // Drive the pins directly, the pull-ups are external
+    HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SCL_PIN | I2C1_SDA_PIN, GPIO_PIN_SET);
+    init.Pin = I2C1_SCL_PIN | I2C1_SDA_PIN;
+    init.Mode = GPIO_MODE_OUTPUT_OD;
+    init.Pull = GPIO_NOPULL;
+    init.Speed = GPIO_SPEED_FAST;
+    HAL_GPIO_Init(I2C1_GPIO_PORT, &init);
+    MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    
+    // Clock out the rest of the byte a slave may be stuck in
+    for(uint32_t j = 0; j < 9 && HAL_GPIO_ReadPin(I2C1_GPIO_PORT, I2C1_SDA_PIN) == GPIO_PIN_RESET; j++) {
+        HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SCL_PIN, GPIO_PIN_RESET);
+        MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+        HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SCL_PIN, GPIO_PIN_SET);
+        MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    }
+    
+    // Stop condition: SDA going high while SCL is high
+    HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SCL_PIN, GPIO_PIN_RESET);
+    MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SDA_PIN, GPIO_PIN_RESET);
+    MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SCL_PIN, GPIO_PIN_SET);
+    MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    HAL_GPIO_WritePin(I2C1_GPIO_PORT, I2C1_SDA_PIN, GPIO_PIN_SET);
+    MX_DelayMicros(I2C_BUS_CLEAR_DELAY);
+    GPIO_PinState sda = HAL_GPIO_ReadPin(I2C1_GPIO_PORT, I2C1_SDA_PIN);
+    
+    __I2C1_FORCE_RESET();
+    __I2C1_RELEASE_RESET();
+    HAL_I2C_Init(hi2c);
+    
+    return (sda == GPIO_PIN_SET ? HAL_OK : HAL_ERROR);
+}
+
 // Private functions ----------------------------------------------------------
 
 /**
@@ -320,4 +372,16 @@ static void MX_USB_DEVICE_Init(void) {
     USBD_Start(&hUsbDevice);
 }
 
+/**
+ * Waits for the specified time using the DWT cycle counter.
+ * 
+ * @param us The time to wait in µs
+ */
+static void MX_DelayMicros(uint32_t us) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles = us * (SystemCoreClock / 1000000);
+    while(DWT->CYCCNT - start < cycles)
+        ;
+}
+
 // ----------------------------------------------------------------------------
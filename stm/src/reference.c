@@ -0,0 +1,185 @@
+/**
+ * @file    reference.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Reference sweep storage used for differential measurements.
+ * 
+ * A reference sweep is a copy of the converted data of a previous sweep. Measured data can be related to a reference
+ * with the same frequency plan, either as complex difference or as complex ratio, and the largest relative change can
+ * be determined for change detection.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "reference.h"
+
+// Private function prototypes ------------------------------------------------
+static uint8_t Reference_Matches(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count);
+__STATIC_INLINE float Reference_WrapAngle(float angle);
+
+// Private variables ----------------------------------------------------------
+static AD5933_ImpedancePolar refData[REFERENCE_SLOTS][AD5933_MAX_NUM_INCREMENTS + 1];
+static uint32_t refCount[REFERENCE_SLOTS] = { 0 };
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Checks whether data has the same frequencies as a reference sweep. The data can have fewer points than the
+ * reference, which is the case for an interrupted sweep.
+ */
+static uint8_t Reference_Matches(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count) {
+    if(slot >= REFERENCE_SLOTS || refCount[slot] == 0 || count > refCount[slot]) {
+        return 0;
+    }
+    for(uint32_t j = 0; j < count; j++) {
+        if(data[j].Frequency != refData[slot][j].Frequency) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Wraps an angle difference to the range -pi to pi.
+ */
+__STATIC_INLINE float Reference_WrapAngle(float angle) {
+    if(angle > (float)M_PI) {
+        return angle - 2 * (float)M_PI;
+    } else if(angle < -(float)M_PI) {
+        return angle + 2 * (float)M_PI;
+    }
+    return angle;
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Stores data as reference sweep, replacing the previous reference in the slot.
+ * 
+ * @param slot The reference slot, needs to be less than {@link REFERENCE_SLOTS}
+ * @param data The converted data to store
+ * @param count The number of points
+ * @return `1` if the reference was stored, `0` if the slot is invalid or there is no data
+ */
+uint8_t Reference_Save(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count) {
+    if(slot >= REFERENCE_SLOTS || data == NULL || count == 0 || count > NUMEL(refData[0])) {
+        return 0;
+    }
+    
+    memcpy(refData[slot], data, count * sizeof(*data));
+    refCount[slot] = count;
+    return 1;
+}
+
+/**
+ * Removes a reference sweep.
+ * 
+ * @param slot The reference slot, invalid slot numbers are ignored
+ */
+void Reference_Clear(uint32_t slot) {
+    if(slot < REFERENCE_SLOTS) {
+        refCount[slot] = 0;
+    }
+}
+
+/**
+ * Gets a reference sweep.
+ * 
+ * @param slot The reference slot
+ * @param count Pointer to a variable receiving the number of points of the reference
+ * @return Pointer to the reference data, or `NULL` if the slot is empty or invalid
+ */
+const AD5933_ImpedancePolar* Reference_Get(uint32_t slot, uint32_t *count) {
+    if(slot >= REFERENCE_SLOTS || refCount[slot] == 0) {
+        *count = 0;
+        return NULL;
+    }
+    *count = refCount[slot];
+    return refData[slot];
+}
+
+/**
+ * Relates measured data to a reference sweep with the same frequency plan.
+ * 
+ * With {@link REF_DIFFERENCE} the result is the complex difference Z - Zref, with {@link REF_RATIO} it is the complex
+ * ratio Z / Zref, so the magnitude is the magnitude ratio and the angle is the phase difference.
+ * 
+ * @param slot The reference slot
+ * @param mode How the data is related to the reference
+ * @param data The measured data
+ * @param count The number of points
+ * @param result Pointer to a buffer receiving `count` points, may be the same as `data`
+ * @return `1` on success, `0` if the slot is empty or the frequencies do not match
+ */
+uint8_t Reference_Apply(uint32_t slot, Reference_Mode mode, const AD5933_ImpedancePolar *data, uint32_t count,
+        AD5933_ImpedancePolar *result) {
+    if(!Reference_Matches(slot, data, count)) {
+        return 0;
+    }
+    
+    for(uint32_t j = 0; j < count; j++) {
+        const AD5933_ImpedancePolar *ref = &refData[slot][j];
+        AD5933_ImpedanceCartesian z;
+        AD5933_ImpedanceCartesian zref;
+        
+        switch(mode) {
+            case REF_DIFFERENCE:
+                AD5933_ConvertPolarToCartesian(&data[j], &z);
+                AD5933_ConvertPolarToCartesian(ref, &zref);
+                result[j].Frequency = data[j].Frequency;
+                result[j].Magnitude = hypotf(z.Real - zref.Real, z.Imag - zref.Imag);
+                result[j].Angle = atan2f(z.Imag - zref.Imag, z.Real - zref.Real);
+                break;
+            
+            case REF_RATIO:
+                result[j].Frequency = data[j].Frequency;
+                result[j].Magnitude = data[j].Magnitude / ref->Magnitude;
+                result[j].Angle = Reference_WrapAngle(data[j].Angle - ref->Angle);
+                break;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Determines the largest relative change |Z - Zref| / |Zref| of measured data compared to a reference sweep.
+ * 
+ * @param slot The reference slot
+ * @param data The measured data
+ * @param count The number of points
+ * @param freq Pointer to a variable receiving the frequency of the largest change, or `NULL`
+ * @return The largest relative change, or NaN if the slot is empty or the frequencies do not match
+ */
+float Reference_MaxChange(uint32_t slot, const AD5933_ImpedancePolar *data, uint32_t count, uint32_t *freq) {
+    float max = 0.0f;
+    uint32_t maxFreq = 0;
+    
+    if(!Reference_Matches(slot, data, count)) {
+        return NAN;
+    }
+    
+    for(uint32_t j = 0; j < count; j++) {
+        const AD5933_ImpedancePolar *ref = &refData[slot][j];
+        AD5933_ImpedanceCartesian z;
+        AD5933_ImpedanceCartesian zref;
+        
+        if(ref->Magnitude == 0) {
+            continue;
+        }
+        AD5933_ConvertPolarToCartesian(&data[j], &z);
+        AD5933_ConvertPolarToCartesian(ref, &zref);
+        float change = hypotf(z.Real - zref.Real, z.Imag - zref.Imag) / ref->Magnitude;
+        if(change > max) {
+            max = change;
+            maxFreq = data[j].Frequency;
+        }
+    }
+    
+    if(freq != NULL) {
+        *freq = maxFreq;
+    }
+    return max;
+}
+
+// ----------------------------------------------------------------------------
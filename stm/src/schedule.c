@@ -0,0 +1,301 @@
+/**
+ * @file    schedule.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Time-scheduled measurement jobs and the storage of their results.
+ * 
+ * A job starts a frequency sweep with the current settings at a start time and then periodically, for a number of
+ * runs. Run times are kept in ms since reset, derived from SysTick and thus from the crystal oscillator, and are
+ * computed from the start time so they don't drift. The board has no 32kHz crystal for the RTC, so the absolute time is
+ * an offset set by the host that is added to the time since reset.
+ * 
+ * Results of finished runs are stored with their start time in a ring buffer in CCM RAM, where the oldest runs are
+ * overwritten when it is full. Each run is stored in one piece, so it can be read without copying.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <string.h>
+#include "schedule.h"
+
+// Private function prototypes ------------------------------------------------
+static void Schedule_DropRun(void);
+__STATIC_INLINE uint32_t Schedule_RunSize(const Schedule_Run *run);
+
+// Private variables ----------------------------------------------------------
+static uint64_t uptime = 0;                 //!< Time since reset in ms, extended from the 32 bit SysTick counter
+static uint32_t lastTick = 0;               //!< SysTick counter when `uptime` was last updated
+static uint64_t epoch = 0;                  //!< Absolute time at reset in ms
+static uint8_t timeSet = 0;
+static Schedule_Job jobs[SCHEDULE_MAX_JOBS];
+static Schedule_Run runs[SCHEDULE_MAX_RUNS];
+static uint32_t runFirst = 0;               //!< Index of the oldest stored run in `runs`
+static uint32_t runCount = 0;               //!< The number of stored runs
+static uint32_t runNumber = 0;              //!< Sequence number of the next run
+static uint32_t writePos = 0;               //!< Index in `points` where the next run is stored
+// Not initialized at startup, which doesn't matter since only stored runs are ever read
+static AD5933_ImpedancePolar points[SCHEDULE_BUFFER_POINTS] __attribute__((section(".bss.CCMRAM")));
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Removes the oldest stored run.
+ */
+static void Schedule_DropRun(void) {
+    runFirst = (runFirst + 1) % SCHEDULE_MAX_RUNS;
+    runCount--;
+}
+
+/**
+ * Gets the number of points a run takes in the point buffer, which is at least one so that the runs are in the order
+ * of their offsets even if some of them have no points.
+ */
+__STATIC_INLINE uint32_t Schedule_RunSize(const Schedule_Run *run) {
+    return (run->count ? run->count : 1);
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Gets the time since reset in ms. This needs to be called at least every 49 days so the SysTick counter wrapping is
+ * noticed, which is the case as long as {@link Schedule_GetDueJob} is called periodically.
+ */
+uint64_t Schedule_GetUptime(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t tick = HAL_GetTick();
+    uptime += (uint32_t)(tick - lastTick);
+    lastTick = tick;
+    uint64_t ret = uptime;
+    __set_PRIMASK(primask);
+    return ret;
+}
+
+/**
+ * Sets the absolute time.
+ * 
+ * @param time The current time in ms, usually since the Unix epoch
+ */
+void Schedule_SetTime(uint64_t time) {
+    epoch = time - Schedule_GetUptime();
+    timeSet = 1;
+}
+
+/**
+ * Gets the absolute time in ms, or the time since reset if no time has been set.
+ */
+uint64_t Schedule_GetTime(void) {
+    return Schedule_GetUptime() + epoch;
+}
+
+/**
+ * Gets whether the absolute time has been set.
+ */
+uint8_t Schedule_IsTimeSet(void) {
+    return timeSet;
+}
+
+/**
+ * Adds a job to the schedule.
+ * 
+ * @param start Time of the first run in ms since reset
+ * @param period Time between runs in ms, at least {@link SCHEDULE_MIN_PERIOD}
+ * @param count The number of runs
+ * @param port The port to measure on
+ * @param kkLimit Kramers-Kronig residual above which a sweep is repeated, `0` to never repeat
+ * @return Number of the job, or `-1` if the parameters are invalid or no job slot is free
+ */
+int32_t Schedule_AddJob(uint64_t start, uint32_t period, uint32_t count, uint8_t port, float kkLimit) {
+    if(period < SCHEDULE_MIN_PERIOD || count == 0) {
+        return -1;
+    }
+    
+    for(uint32_t j = 0; j < SCHEDULE_MAX_JOBS; j++) {
+        if(jobs[j].remaining == 0) {
+            jobs[j].next = start;
+            jobs[j].period = period;
+            jobs[j].missed = 0;
+            jobs[j].kkLimit = kkLimit;
+            jobs[j].port = port;
+            jobs[j].remaining = count;
+            return j;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Removes a job from the schedule, a run that has already been started is not affected.
+ * 
+ * @param job Number of the job, invalid numbers are ignored
+ */
+void Schedule_RemoveJob(uint32_t job) {
+    if(job < SCHEDULE_MAX_JOBS) {
+        jobs[job].remaining = 0;
+    }
+}
+
+/**
+ * Gets a scheduled job.
+ * 
+ * @param job Number of the job
+ * @return Pointer to the job, or `NULL` if the number is invalid or the job slot is unused
+ */
+const Schedule_Job* Schedule_GetJob(uint32_t job) {
+    if(job >= SCHEDULE_MAX_JOBS || jobs[job].remaining == 0) {
+        return NULL;
+    }
+    return &jobs[job];
+}
+
+/**
+ * Gets the job that is due the longest, this should be called periodically.
+ * 
+ * @return Number of the job, or `-1` if no job is due
+ */
+int32_t Schedule_GetDueJob(void) {
+    uint64_t now = Schedule_GetUptime();
+    int32_t ret = -1;
+    
+    for(uint32_t j = 0; j < SCHEDULE_MAX_JOBS; j++) {
+        if(jobs[j].remaining && jobs[j].next <= now && (ret < 0 || jobs[j].next < jobs[ret].next)) {
+            ret = j;
+        }
+    }
+    return ret;
+}
+
+/**
+ * Advances a job to its next run after the due run has been started. If the run was started more than a period late,
+ * the runs that have been missed meanwhile are skipped.
+ * 
+ * @param job Number of the job
+ */
+void Schedule_JobStarted(uint32_t job) {
+    uint64_t now = Schedule_GetUptime();
+    Schedule_Job *j;
+    
+    if(job >= SCHEDULE_MAX_JOBS || jobs[job].remaining == 0) {
+        return;
+    }
+    
+    j = &jobs[job];
+    j->remaining--;
+    j->next += j->period;
+    while(j->remaining && j->next <= now) {
+        j->remaining--;
+        j->missed++;
+        j->next += j->period;
+    }
+}
+
+/**
+ * Advances a job to its next run without starting the due run, which is counted as missed.
+ * 
+ * @param job Number of the job
+ */
+void Schedule_JobMissed(uint32_t job) {
+    if(job >= SCHEDULE_MAX_JOBS || jobs[job].remaining == 0) {
+        return;
+    }
+    
+    jobs[job].missed++;
+    Schedule_JobStarted(job);
+}
+
+/**
+ * Stores the result of a run, overwriting the oldest runs if necessary.
+ * 
+ * @param job Number of the job that started the run
+ * @param time Start time of the sweep in ms, from {@link Schedule_GetTime}
+ * @param data The converted data, may be `NULL` if `count` is `0`
+ * @param count The number of points
+ * @param interrupted Whether the sweep was interrupted or could not be started
+ * @param kkResidual Kramers-Kronig residual of the sweep, NaN if not tested
+ * @param repeats The number of times the sweep was repeated
+ */
+void Schedule_StoreRun(uint32_t job, uint64_t time, const AD5933_ImpedancePolar *data, uint32_t count,
+        uint8_t interrupted, float kkResidual, uint8_t repeats) {
+    if(count > SCHEDULE_BUFFER_POINTS) {
+        count = SCHEDULE_BUFFER_POINTS;
+    }
+    if(runCount == SCHEDULE_MAX_RUNS) {
+        Schedule_DropRun();
+    }
+    
+    uint32_t size = (count ? count : 1);
+    if(writePos + size > SCHEDULE_BUFFER_POINTS) {
+        // Wrap around, the runs stored after the write position are the oldest ones
+        while(runCount && runs[runFirst].offset >= writePos) {
+            Schedule_DropRun();
+        }
+        writePos = 0;
+    }
+    // Drop the oldest runs as long as they overlap the new one
+    while(runCount && runs[runFirst].offset < writePos + size &&
+            runs[runFirst].offset + Schedule_RunSize(&runs[runFirst]) > writePos) {
+        Schedule_DropRun();
+    }
+    
+    Schedule_Run *run = &runs[(runFirst + runCount) % SCHEDULE_MAX_RUNS];
+    run->number = runNumber++;
+    run->time = time;
+    run->offset = writePos;
+    run->count = count;
+    run->job = job;
+    run->interrupted = interrupted;
+    run->kkResidual = kkResidual;
+    run->repeats = repeats;
+    if(count) {
+        memcpy(&points[writePos], data, count * sizeof(*data));
+    }
+    writePos += size;
+    runCount++;
+}
+
+/**
+ * Gets a stored run.
+ * 
+ * The data of a run can be overwritten when another run is stored, so a caller preempted by that needs to check that
+ * the run is still stored after using the data.
+ * 
+ * @param number Sequence number of the run
+ * @param data Pointer to a variable receiving a pointer to the data, or `NULL`
+ * @return Pointer to the run, or `NULL` if no run with this number is stored
+ */
+const Schedule_Run* Schedule_GetRun(uint32_t number, const AD5933_ImpedancePolar **data) {
+    const Schedule_Run *run;
+    
+    if(runCount == 0 || number - runs[runFirst].number >= runCount) {
+        return NULL;
+    }
+    run = &runs[(runFirst + (number - runs[runFirst].number)) % SCHEDULE_MAX_RUNS];
+    if(data != NULL) {
+        *data = &points[run->offset];
+    }
+    return run;
+}
+
+/**
+ * Gets the number of stored runs.
+ * 
+ * @param first Pointer to a variable receiving the sequence number of the oldest stored run, which is also the
+ *              number of the next run if none is stored
+ * @return The number of stored runs, their sequence numbers are consecutive
+ */
+uint32_t Schedule_GetRunCount(uint32_t *first) {
+    *first = (runCount ? runs[runFirst].number : runNumber);
+    return runCount;
+}
+
+/**
+ * Removes all jobs and stored runs, the time is kept.
+ */
+void Schedule_Clear(void) {
+    for(uint32_t j = 0; j < SCHEDULE_MAX_JOBS; j++) {
+        jobs[j].remaining = 0;
+    }
+    runCount = 0;
+    writePos = 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,155 @@
+/**
+ * @file    spectrum.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Extraction of spectral features (extrema, phase zero crossings, resonance, arc peak) from a sweep.
+ * 
+ * Extrema are refined by fitting a parabola through the extreme point and its neighbours, phase zero crossings by
+ * linear interpolation between the points on either side. The sweep is assumed to have equally spaced frequencies.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <math.h>
+#include "spectrum.h"
+
+// Private function prototypes ------------------------------------------------
+static float Spectrum_Vertex(float y0, float y1, float y2, float *peak);
+static void Spectrum_Extremum(const AD5933_ImpedancePolar *data, uint32_t count, uint32_t j, float *freq,
+        float *value);
+__STATIC_INLINE float Spectrum_Reactance(const AD5933_ImpedancePolar *point);
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Finds the vertex of the parabola through three equally spaced points.
+ * 
+ * @param y0 Value left of the extreme point
+ * @param y1 Value at the extreme point
+ * @param y2 Value right of the extreme point
+ * @param peak Pointer to a variable receiving the value at the vertex
+ * @return The position of the vertex relative to the extreme point, in steps (between `-0.5` and `0.5`)
+ */
+static float Spectrum_Vertex(float y0, float y1, float y2, float *peak) {
+    float denom = y0 - 2.0f * y1 + y2;
+    float p = (denom != 0.0f ? 0.5f * (y0 - y2) / denom : 0.0f);
+    
+    *peak = y1 - 0.25f * (y0 - y2) * p;
+    return p;
+}
+
+/**
+ * Interpolates the magnitude extremum at the specified point.
+ * 
+ * @param data Sweep data
+ * @param count Number of points in the sweep
+ * @param j Index of the extreme point
+ * @param freq Pointer to a variable receiving the frequency of the extremum
+ * @param value Pointer to a variable receiving the magnitude of the extremum
+ */
+static void Spectrum_Extremum(const AD5933_ImpedancePolar *data, uint32_t count, uint32_t j, float *freq,
+        float *value) {
+    if(j == 0 || j == count - 1) {
+        // Can't interpolate at the ends of the sweep
+        *freq = data[j].Frequency;
+        *value = data[j].Magnitude;
+        return;
+    }
+    
+    float p = Spectrum_Vertex(data[j - 1].Magnitude, data[j].Magnitude, data[j + 1].Magnitude, value);
+    *freq = data[j].Frequency + p * 0.5f * ((float)data[j + 1].Frequency - (float)data[j - 1].Frequency);
+}
+
+/**
+ * Gets the reactance (imaginary part of the impedance) of a point.
+ */
+__STATIC_INLINE float Spectrum_Reactance(const AD5933_ImpedancePolar *point) {
+    return point->Magnitude * sinf(point->Angle);
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Extracts the features of a sweep.
+ * 
+ * The resonance is taken to be the first phase zero crossing, its quality factor is calculated from the phase slope
+ * there (`Q = f0 / 2 * |d(phase) / df|`, which is exact for series and parallel RLC circuits). The arc peak is the
+ * most negative reactance, it is only reported when it lies inside the sweep.
+ * 
+ * @param data Sweep data in polar format
+ * @param count Number of points in the sweep
+ * @param result Pointer to a structure receiving the features
+ */
+void Spectrum_ExtractFeatures(const AD5933_ImpedancePolar *data, uint32_t count, Spectrum_Features *result) {
+    uint32_t jmin = 0;
+    uint32_t jmax = 0;
+    uint32_t jarc = 0;
+    float xarc = INFINITY;
+    
+    assert_param(data != NULL || count == 0);
+    assert_param(result != NULL);
+    
+    result->MinFrequency = NAN;
+    result->MinMagnitude = NAN;
+    result->MaxFrequency = NAN;
+    result->MaxMagnitude = NAN;
+    result->ResonanceFrequency = NAN;
+    result->ResonanceQ = NAN;
+    result->ArcFrequency = NAN;
+    result->ArcReactance = NAN;
+    result->Crossings = 0;
+    for(uint32_t j = 0; j < SPECTRUM_MAX_CROSSINGS; j++) {
+        result->CrossingFrequency[j] = NAN;
+    }
+    
+    if(count == 0) {
+        return;
+    }
+    
+    for(uint32_t j = 0; j < count; j++) {
+        float x = Spectrum_Reactance(&data[j]);
+        
+        if(data[j].Magnitude < data[jmin].Magnitude) {
+            jmin = j;
+        }
+        if(data[j].Magnitude > data[jmax].Magnitude) {
+            jmax = j;
+        }
+        if(x < xarc) {
+            xarc = x;
+            jarc = j;
+        }
+        
+        if(j == 0) {
+            continue;
+        }
+        
+        // Phase zero crossing, unless the phase wraps around at +-pi
+        float a = data[j - 1].Angle;
+        float b = data[j].Angle;
+        if((a < 0.0f) != (b < 0.0f) && fabsf(b - a) < (float)M_PI) {
+            float df = (float)data[j].Frequency - (float)data[j - 1].Frequency;
+            float f = data[j - 1].Frequency + a / (a - b) * df;
+            
+            if(result->Crossings == 0) {
+                result->ResonanceFrequency = f;
+                result->ResonanceQ = 0.5f * f * fabsf((b - a) / df);
+            }
+            if(result->Crossings < SPECTRUM_MAX_CROSSINGS) {
+                result->CrossingFrequency[result->Crossings] = f;
+            }
+            result->Crossings++;
+        }
+    }
+    
+    Spectrum_Extremum(data, count, jmin, &result->MinFrequency, &result->MinMagnitude);
+    Spectrum_Extremum(data, count, jmax, &result->MaxFrequency, &result->MaxMagnitude);
+    
+    if(xarc < 0.0f && jarc != 0 && jarc != count - 1) {
+        float p = Spectrum_Vertex(Spectrum_Reactance(&data[jarc - 1]), xarc, Spectrum_Reactance(&data[jarc + 1]),
+                &result->ArcReactance);
+        result->ArcFrequency = data[jarc].Frequency +
+                p * 0.5f * ((float)data[jarc + 1].Frequency - (float)data[jarc - 1].Frequency);
+    }
+}
+
+// ----------------------------------------------------------------------------
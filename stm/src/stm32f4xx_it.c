@@ -80,39 +80,58 @@ void __attribute__((naked)) HardFault_Handler(void) {
  * This function handles the System tick timer.
  */
 void SysTick_Handler(void) {
+    uint32_t start = Telemetry_IsrEnter();
+    Monitor_SampleStack(MON_IRQ_SYSTICK);
     HAL_IncTick();
+    Telemetry_IsrExit(MON_IRQ_SYSTICK, start);
 }
 
 /**
  * This function handles I2C1 event interrupt.
  */
 void I2C1_EV_IRQHandler(void) {
+    uint32_t start = Telemetry_IsrEnter();
+    Monitor_SampleStack(MON_IRQ_I2C1);
     NVIC_ClearPendingIRQ(I2C1_EV_IRQn);
     HAL_I2C_EV_IRQHandler(&hi2c1);
+    Telemetry_IsrExit(MON_IRQ_I2C1, start);
 }
 
 /**
  * This function handles SPI3 global interrupt.
  */
 void SPI3_IRQHandler(void) {
+    uint32_t start = Telemetry_IsrEnter();
+    Monitor_SampleStack(MON_IRQ_SPI3);
     NVIC_ClearPendingIRQ(SPI3_IRQn);
     HAL_SPI_IRQHandler(&hspi3);
+    Telemetry_IsrExit(MON_IRQ_SPI3, start);
 }
 
 /**
  * This function handles TIM3 global interrupt.
  */
 void TIM3_IRQHandler(void) {
+    uint32_t start = Telemetry_IsrEnter();
+    Monitor_SampleStack(MON_IRQ_TIM3);
+    EvTrace_Event(EVTRACE_ISR_ENTER, MON_IRQ_TIM3, 0);
     NVIC_ClearPendingIRQ(TIM3_IRQn);
     HAL_TIM_IRQHandler(&htim3);
+    EvTrace_Event(EVTRACE_ISR_EXIT, MON_IRQ_TIM3, 0);
+    Telemetry_IsrExit(MON_IRQ_TIM3, start);
 }
 
 /**
  * This function handles USB On The Go FS global interrupt.
  */
 void OTG_FS_IRQHandler(void) {
+    uint32_t start = Telemetry_IsrEnter();
+    Monitor_SampleStack(MON_IRQ_OTG_FS);
+    EvTrace_Event(EVTRACE_ISR_ENTER, MON_IRQ_OTG_FS, 0);
     NVIC_ClearPendingIRQ(OTG_FS_IRQn);
     HAL_PCD_IRQHandler(&hpcd_FS);
+    EvTrace_Event(EVTRACE_ISR_EXIT, MON_IRQ_OTG_FS, 0);
+    Telemetry_IsrExit(MON_IRQ_OTG_FS, start);
 }
 
 // ----------------------------------------------------------------------------
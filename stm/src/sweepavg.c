@@ -0,0 +1,89 @@
+/**
+ * @file    sweepavg.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Running mean and variance over repeated sweeps.
+ * 
+ * Each point of a sweep is averaged over all repetitions measured so far with Welford's algorithm, so the mean is
+ * valid after every point and the variance is available without storing the individual sweeps. The mean and variance
+ * are kept for the complex raw values, the variance is the sum of the variances of the real and imaginary parts.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "sweepavg.h"
+
+// Private variables ----------------------------------------------------------
+static float meanReal[AD5933_MAX_NUM_INCREMENTS + 1];   //!< Mean of the real parts
+static float meanImag[AD5933_MAX_NUM_INCREMENTS + 1];   //!< Mean of the imaginary parts
+static float sumSquares[AD5933_MAX_NUM_INCREMENTS + 1]; //!< Sum of squared distances from the mean
+static uint16_t samples[AD5933_MAX_NUM_INCREMENTS + 1]; //!< The number of sweeps averaged for each point
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Discards all averaged data, this needs to be called before the first sweep.
+ */
+void SweepAvg_Reset(void) {
+    memset(samples, 0, sizeof(samples));
+}
+
+/**
+ * Adds a measured point to the running mean.
+ * 
+ * @param index The index of the point in the sweep
+ * @param data The measured point
+ * @param mean Pointer to a structure receiving the mean of the point, rounded to raw data resolution
+ */
+void SweepAvg_Add(uint32_t index, const AD5933_ImpedanceData *data, AD5933_ImpedanceData *mean) {
+    assert_param(index < NUMEL(samples));
+    
+    uint16_t n = ++samples[index];
+    if(n == 1) {
+        meanReal[index] = data->Real;
+        meanImag[index] = data->Imag;
+        sumSquares[index] = 0.0f;
+    } else {
+        float dReal = data->Real - meanReal[index];
+        float dImag = data->Imag - meanImag[index];
+        meanReal[index] += dReal / n;
+        meanImag[index] += dImag / n;
+        sumSquares[index] += dReal * (data->Real - meanReal[index]) + dImag * (data->Imag - meanImag[index]);
+    }
+    
+    mean->Frequency = data->Frequency;
+    mean->Real = (int16_t)lrintf(meanReal[index]);
+    mean->Imag = (int16_t)lrintf(meanImag[index]);
+}
+
+/**
+ * Gets the number of sweeps averaged for a point.
+ * 
+ * @param index The index of the point in the sweep
+ * @return The number of sweeps
+ */
+uint16_t SweepAvg_GetCount(uint32_t index) {
+    return (index < NUMEL(samples) ? samples[index] : 0);
+}
+
+/**
+ * Gets the relative standard deviation of a point, that is the standard deviation of one component of the raw value
+ * divided by the magnitude of the mean, assuming the noise is the same in both components.
+ * 
+ * For small deviations this is the standard deviation of the angle in rad, and multiplied by the magnitude of the
+ * impedance it is the standard deviation of the magnitude.
+ * 
+ * @param index The index of the point in the sweep
+ * @return The relative standard deviation, or NaN if fewer than two sweeps were averaged for the point
+ */
+float SweepAvg_GetDeviation(uint32_t index) {
+    if(SweepAvg_GetCount(index) < 2) {
+        return NAN;
+    }
+    
+    float variance = sumSquares[index] / (2 * (samples[index] - 1));
+    return sqrtf(variance) / hypotf(meanReal[index], meanImag[index]);
+}
+
+// ----------------------------------------------------------------------------
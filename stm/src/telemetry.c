@@ -0,0 +1,146 @@
+/**
+ * @file    telemetry.c
+ * @author  Peter Feichtinger
+ * @date    18.10.2026
+ * @brief   Device-wide telemetry counters for monitoring boards in the field.
+ * 
+ * The drivers increment the counters in {@link Telemetry_Counter} where the events happen, which takes a few cycles
+ * and no locking. Values the drivers count anyway (I2C errors, failed allocations) and the gauges (uptime, longest run
+ * of each interrupt handler) are only collected when the telemetry is read, so everything can be read at once with the
+ * `board telemetry` command, as JSON or in binary format. Nothing is ever reset, the host computes rates from the
+ * difference between two reads.
+ * 
+ * Binary format (big endian, like the `board read` binary format):
+ *  + `uint32_t` number of bytes following
+ *  + `uint16_t` format version ({@link TELEMETRY_FORMAT_VERSION}), `uint16_t` number of values following
+ *  + `uint32_t` uptime in ms, high word first
+ *  + `uint32_t` sweeps, points, I2C errors, I2C retries, USB stalls, USB bytes, dropped lines, EEPROM writes and heap
+ *    failures in this order
+ *  + `uint32_t` longest run of each interrupt handler in ns, in the order of {@link Monitor_Irq}
+ * 
+ * Values added in later versions are appended, so a host can read the ones it knows and skip the rest.
+ */
+
+// Includes -------------------------------------------------------------------
+#include <stdlib.h>
+#include "telemetry.h"
+#include "ad5933.h"
+#include "schedule.h"
+
+// Private constants ----------------------------------------------------------
+//! The number of 32 bit values in the binary format
+#define TELEMETRY_VALUES        (2 + 9 + MON_IRQ_COUNT)
+
+// Private function prototypes ------------------------------------------------
+static uint32_t Telemetry_CyclesToNs(uint32_t cycles);
+
+// Exported variables ---------------------------------------------------------
+/**
+ * The counters in {@link Telemetry_Counter}, only to be changed with {@link Telemetry_Add}.
+ */
+volatile uint32_t telemetry_counters[TELEMETRY_COUNTER_COUNT] = { 0 };
+
+/**
+ * Longest run of each interrupt handler in {@link Monitor_Irq} in core clock cycles.
+ */
+volatile uint32_t telemetry_isr_cycles[MON_IRQ_COUNT] = { 0 };
+
+// Private functions ----------------------------------------------------------
+
+/**
+ * Converts a number of core clock cycles to ns.
+ */
+static uint32_t Telemetry_CyclesToNs(uint32_t cycles) {
+    return (uint32_t)((uint64_t)cycles * 1000000000 / SystemCoreClock);
+}
+
+// Exported functions ---------------------------------------------------------
+
+/**
+ * Gets the current value of all counters and gauges.
+ * 
+ * @param result Pointer to a structure to be populated
+ */
+void Telemetry_Get(Telemetry_Status *result) {
+    uint32_t counters[TELEMETRY_COUNTER_COUNT];
+    uint32_t cycles[MON_IRQ_COUNT];
+    
+    assert_param(result != NULL);
+    
+    // Take the counters at the same moment, so rates computed from them fit together
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for(uint32_t j = 0; j < TELEMETRY_COUNTER_COUNT; j++) {
+        counters[j] = telemetry_counters[j];
+    }
+    for(uint32_t j = 0; j < MON_IRQ_COUNT; j++) {
+        cycles[j] = telemetry_isr_cycles[j];
+    }
+    result->i2cErrors = AD5933_GetTotalErrorCount();
+    result->heapFailures = Monitor_GetAllocFailures();
+    __set_PRIMASK(primask);
+    
+    result->uptime = Schedule_GetUptime();
+    result->sweeps = counters[TELEMETRY_SWEEPS];
+    result->points = counters[TELEMETRY_POINTS];
+    result->i2cRetries = counters[TELEMETRY_I2C_RETRIES];
+    result->usbStalls = counters[TELEMETRY_USB_STALLS];
+    result->usbBytes = counters[TELEMETRY_USB_BYTES];
+    result->droppedLines = counters[TELEMETRY_DROPPED_LINES];
+    result->eepromWrites = counters[TELEMETRY_EEPROM_WRITES];
+    for(uint32_t j = 0; j < MON_IRQ_COUNT; j++) {
+        result->maxIsrTime[j] = Telemetry_CyclesToNs(cycles[j]);
+    }
+}
+
+/**
+ * Gets all counters and gauges in binary format (see above).
+ * 
+ * @return A buffer allocated with `malloc`, `data` is `NULL` if there is not enough memory
+ */
+Buffer Telemetry_Dump(void) {
+    Buffer ret = {
+        .data = NULL,
+        .size = 0
+    };
+    
+    uint32_t alloc = 4 + 4 + TELEMETRY_VALUES * 4;
+    uint32_t *buffer = malloc(alloc);
+    if(buffer == NULL) {
+        return ret;
+    }
+    
+    Telemetry_Status st;
+    Telemetry_Get(&st);
+    
+    uint32_t *p = buffer;
+    *p++ = alloc - 4;
+    *p++ = ((uint32_t)TELEMETRY_FORMAT_VERSION << 16) | TELEMETRY_VALUES;
+    *p++ = (uint32_t)(st.uptime >> 32);
+    *p++ = (uint32_t)st.uptime;
+    *p++ = st.sweeps;
+    *p++ = st.points;
+    *p++ = st.i2cErrors;
+    *p++ = st.i2cRetries;
+    *p++ = st.usbStalls;
+    *p++ = st.usbBytes;
+    *p++ = st.droppedLines;
+    *p++ = st.eepromWrites;
+    *p++ = st.heapFailures;
+    for(uint32_t j = 0; j < MON_IRQ_COUNT; j++) {
+        *p++ = st.maxIsrTime[j];
+    }
+    assert_param((uint8_t *)p - (uint8_t *)buffer == alloc);
+    
+#ifndef __ARMEB__
+    for(uint32_t j = 0; j < alloc / 4; j++) {
+        buffer[j] = __REV(buffer[j]);
+    }
+#endif
+    
+    ret.data = buffer;
+    ret.size = alloc;
+    return ret;
+}
+
+// ----------------------------------------------------------------------------
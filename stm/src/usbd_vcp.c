@@ -40,6 +40,8 @@
 #include "usbd_vcp.h"
 #include "usbd_desc.h"
 #include "usbd_ctlreq.h"
+#include "evtrace.h"
+#include "telemetry.h"
 
 // Private function prototypes ------------------------------------------------
 static uint8_t USBD_VCP_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
@@ -560,6 +562,8 @@ uint8_t USBD_VCP_TransmitPacket(USBD_HandleTypeDef *pdev) {
     if(hcdc->TxState == 0) {
         // Transmit next packet
         USBD_LL_Transmit(pdev, VCP_IN_EP, hcdc->TxBuffer, hcdc->TxLength);
+        EvTrace_Event(EVTRACE_USB_PACKET, 0, (uint16_t)hcdc->TxLength);
+        Telemetry_Add(TELEMETRY_USB_BYTES, hcdc->TxLength);
         
         // Tx Transfer in progress
         hcdc->TxState = 1;
@@ -13,6 +13,8 @@
 // Constants ------------------------------------------------------------------
 #define APP_RX_BUFFER_SIZE      VCP_DATA_HS_MAX_PACKET_SIZE
 #define APP_TX_BUFFER_SIZE      2048
+//! Time in ms a transfer may take on top of one packet per frame before it is counted as a stall
+#define VCP_STALL_TIMEOUT       100
 
 // Private variables ----------------------------------------------------------
 static USBD_VCP_LineCodingTypeDef linecoding =
@@ -34,12 +36,20 @@ static uint32_t VCPTxBufStart = 0;
 // External buffer to be transmitted, or NULL if none
 static const uint8_t *VCPTxExternalBuf;
 static uint32_t VCPTxExternalLen;
+// Tick when the running transfer was started, its length and whether it has been counted as a stall
+static uint32_t VCPTxStartTick;
+static uint32_t VCPTxLength;
+static uint8_t VCPTxStalled;
 // Whether to echo characters received from the host, enabled by default
 static uint8_t echo_enabled = 1;
 // The current command line text (0 terminated)
 static uint8_t VCP_cmdline[MAX_CMDLINE_LENGTH + 1];
 // Whether the current command is still busy and input should be ignored
 static uint8_t cmd_busy = 0;
+// Whether the response to the current command is to be terminated with VCP_END_OF_RESPONSE (line preceded with '$')
+static uint8_t cmd_framed = 0;
+// Whether VCP_END_OF_RESPONSE is to be sent once the external buffer has been transmitted
+static uint8_t end_pending = 0;
 
 // Private function prototypes ------------------------------------------------
 static int8_t VCP_Init     (void);
@@ -47,6 +57,8 @@ static int8_t VCP_DeInit   (void);
 static int8_t VCP_Control  (uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t VCP_Receive  (uint8_t* pbuf, uint32_t Len);
 static int8_t VCP_Transmit (void);
+static void VCP_CountDropped(const uint8_t *buf, const uint8_t *end);
+static uint8_t VCP_StartTransfer(uint8_t *buf, uint32_t len);
 
 USBD_VCP_ItfTypeDef USBD_VCP_fops =
 {
@@ -80,6 +92,7 @@ static int8_t VCP_Init(void) {
     USBD_VCP_SetTxBuffer(&hUsbDevice, VCPTxBuffer, 0);
     USBD_VCP_SetRxBuffer(&hUsbDevice, VCPRxBuffer);
     VCP_cmdline[0] = 0;
+    Boot_Mark(BOOT_USB);
     
     return USBD_OK;
 }
@@ -165,20 +178,28 @@ static int8_t VCP_Receive(uint8_t* Buf, uint32_t Len) {
     static uint8_t cmd_newline = 1;
     // Current length of received command
     static uint8_t cmd_len = 0;
-    // Whether to disable echo for the current line (when preceded with '@')
+    // Whether to disable echo for the current line (when preceded with '@' or '$')
     static uint8_t echo_suppress = 0;
+    // Whether the current line was preceded with '$'
+    static uint8_t frame_line = 0;
     
     uint8_t * const rxend = Buf + Len;
+    uint8_t *rxbuf = Buf;
     uint8_t *txbuf = VCPTxBuffer + VCPTxBufEnd;
     uint32_t txlen = 0;
     uint8_t call = 0;
     
     // If previous command is busy, ignore input
-    for(uint8_t *rxbuf = Buf; rxbuf < rxend && !cmd_busy; rxbuf++) {
+    for(; rxbuf < rxend && !cmd_busy; rxbuf++) {
         if(cmd_newline && *rxbuf == '@') {
             echo_suppress = 1;
             continue;
         }
+        if(cmd_newline && *rxbuf == '$') {
+            echo_suppress = 1;
+            frame_line = 1;
+            continue;
+        }
         
         if(echo_enabled && !echo_suppress) {
             if(txbuf == (VCPTxBuffer + APP_TX_BUFFER_SIZE)) {
@@ -214,6 +235,8 @@ static int8_t VCP_Receive(uint8_t* Buf, uint32_t Len) {
             echo_suppress = 0;
             cmd_len = 0;
             cmd_busy = 1;
+            cmd_framed = frame_line;
+            frame_line = 0;
             call = 1;
             
             // We only process one command  at a time so skip remaining characters
@@ -245,8 +268,12 @@ static int8_t VCP_Receive(uint8_t* Buf, uint32_t Len) {
             VCPTxBufEnd -= APP_TX_BUFFER_SIZE;
         }
     }
+    // Anything after the end of the command line is ignored as well
+    VCP_CountDropped(rxbuf + call, rxend);
     
     if(call) {
+        EvTrace_Event(EVTRACE_COMMAND_START, 0, 0);
+        Boot_Mark(BOOT_FIRST_COMMAND);
         Console_ProcessLine(&console_interface, (char *)VCP_cmdline);
     }
     
@@ -265,6 +292,47 @@ static int8_t VCP_Transmit(void) {
     return USBD_OK;
 }
 
+/**
+ * Starts a transfer to the host and remembers when, so {@link VCP_Flush} can tell a stalled host from a long transfer.
+ * 
+ * @param buf The data to send
+ * @param len The number of bytes to send, at most 64KB
+ * @return Whether the transfer was started
+ */
+static uint8_t VCP_StartTransfer(uint8_t *buf, uint32_t len) {
+    USBD_VCP_SetTxBuffer(&hUsbDevice, buf, (uint16_t)len);
+    if(USBD_VCP_TransmitPacket(&hUsbDevice) != USBD_OK) {
+        return 0;
+    }
+    VCPTxStartTick = HAL_GetTick();
+    VCPTxLength = len;
+    VCPTxStalled = 0;
+    return 1;
+}
+
+/**
+ * Counts the command lines in input that is ignored because a command is busy, so hosts that don't wait for the
+ * response before sending the next command show up in the telemetry. Empty lines are not counted.
+ * 
+ * @param buf Pointer to the first ignored character
+ * @param end Pointer past the last ignored character
+ */
+static void VCP_CountDropped(const uint8_t *buf, const uint8_t *end) {
+    // Whether characters of a line have been ignored since the last line break
+    static uint8_t partial = 0;
+    
+    for(; buf < end; buf++) {
+        if(*buf == '\r' || *buf == '\n') {
+            if(partial) {
+                Telemetry_Count(TELEMETRY_DROPPED_LINES);
+                partial = 0;
+            }
+        } else {
+            partial = 1;
+        }
+    }
+}
+
 // Exported functions ---------------------------------------------------------
 
 /**
@@ -288,8 +356,21 @@ uint8_t VCP_GetEcho(void) {
 /**
  * This function should be called by the command line processor when it is finished with processing the current command
  * and new console input should be possible.
+ * 
+ * If the command line was preceded with '$', {@link VCP_END_OF_RESPONSE} is sent after the response. When an external
+ * buffer is still being sent, this is deferred until the buffer has been transmitted.
  */
 void VCP_CommandFinish(void) {
+    EvTrace_Event(EVTRACE_COMMAND_FINISH, 0, 0);
+    if(cmd_framed) {
+        cmd_framed = 0;
+        if(VCPTxExternalBuf != NULL) {
+            end_pending = 1;
+        } else {
+            VCP_SendChar(VCP_END_OF_RESPONSE);
+            VCP_Flush();
+        }
+    }
     cmd_busy = 0;
 }
 
@@ -420,6 +501,12 @@ void VCP_Flush(void) {
     
     // Don't do anything if transfer in progress
     if(((USBD_VCP_HandleTypeDef *)hUsbDevice.pClassData)->TxState) {
+        // A host reading normally fetches at least one packet per frame, much slower means it stopped reading
+        if(!VCPTxStalled &&
+                HAL_GetTick() - VCPTxStartTick > VCP_STALL_TIMEOUT + VCPTxLength / VCP_DATA_FS_MAX_PACKET_SIZE) {
+            VCPTxStalled = 1;
+            Telemetry_Count(TELEMETRY_USB_STALLS);
+        }
         return;
     }
     
@@ -431,8 +518,7 @@ void VCP_Flush(void) {
             buffsize = VCPTxBufEnd - VCPTxBufStart;
         }
         
-        USBD_VCP_SetTxBuffer(&hUsbDevice, VCPTxBuffer + VCPTxBufStart, buffsize);
-        if(USBD_VCP_TransmitPacket(&hUsbDevice) == USBD_OK) {
+        if(VCP_StartTransfer(VCPTxBuffer + VCPTxBufStart, buffsize)) {
             VCPTxBufStart += buffsize;
             if(VCPTxBufStart == APP_TX_BUFFER_SIZE) {
                 VCPTxBufStart = 0;
@@ -440,14 +526,18 @@ void VCP_Flush(void) {
         }
         
     } else if(VCPTxExternalBuf != NULL) {
-        USBD_VCP_SetTxBuffer(&hUsbDevice, (uint8_t *)VCPTxExternalBuf, (uint16_t)(VCPTxExternalLen & 0xFFFF));
-        if(USBD_VCP_TransmitPacket(&hUsbDevice) == USBD_OK) {
+        if(VCP_StartTransfer((uint8_t *)VCPTxExternalBuf, VCPTxExternalLen & 0xFFFF)) {
             if(VCPTxExternalLen & ~0xFFFF) {
                 // Buffer is larger than 64KB and needs to be sent using multiple transmissions
                 VCPTxExternalLen -= 0xFFFF;
                 VCPTxExternalBuf += 0xFFFF;
             } else {
                 VCPTxExternalBuf = NULL;
+                if(end_pending) {
+                    // Sent with the next transmission, after this one is complete
+                    end_pending = 0;
+                    VCP_SendChar(VCP_END_OF_RESPONSE);
+                }
             }
         }
     }
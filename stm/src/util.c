@@ -7,6 +7,7 @@
 
 // Includes -------------------------------------------------------------------
 #include <string.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include <stdio.h>
 #include "util.h"
@@ -112,6 +113,60 @@ uint32_t IntFromSiString(const char *str, const char **end) {
     }
 }
 
+/**
+ * Convert a floating point value from a string with possible SI suffix (like `1.5k` or `-20`).
+ * 
+ * Leading white space is ignored and parsing stops at the first space character, like {@link IntFromSiString}.
+ * 
+ * Possible SI suffixes for this function are:
+ *  + `SI_PREFIX_MILLI` = m
+ *  + `SI_PREFIX_KILO` = k
+ *  + `SI_PREFIX_MEGA` = M
+ * 
+ * @param str Pointer to a string containing a numeric value
+ * @param end Pointer to a variable receiving the position of the first character after the number, or `NULL`
+ * @return The converted numeric value, or `0` in case of an error
+ */
+float FloatFromSiString(const char *str, const char **end) {
+    char *pos;
+    float val;
+    
+    if(str == NULL) {
+        if(end != NULL) *end = NULL;
+        return 0.0f;
+    }
+    
+    val = strtof(str, &pos);
+    if(pos == str) {
+        if(end != NULL) *end = NULL;
+        return 0.0f;
+    }
+    
+    // Check for valid suffix
+    switch(*pos) {
+        case SI_PREFIX_MILLI:
+            val *= 1e-3f;
+            pos++;
+            break;
+        case SI_PREFIX_KILO:
+            val *= 1e3f;
+            pos++;
+            break;
+        case SI_PREFIX_MEGA:
+            val *= 1e6f;
+            pos++;
+            break;
+    }
+    
+    if(isspace((unsigned char)*pos) || *pos == 0) {
+        if(end != NULL) *end = pos;
+        return val;
+    } else {
+        if(end != NULL) *end = NULL;
+        return 0.0f;
+    }
+}
+
 /**
  * Convert an integer value to a string with possible SI suffix (like `100k`).
  * 